@@ -46,6 +46,15 @@ void board_init(void)
 #ifndef MTD_NATIVE_FILENAME
 #define MTD_NATIVE_FILENAME    "MEMORY.bin"
 #endif
+/* set to model the timing of a real flash, in us */
+#ifndef MTD_NATIVE_PAGE_PROGRAM_TIME
+#define MTD_NATIVE_PAGE_PROGRAM_TIME    0
+#endif
+#ifndef MTD_NATIVE_SECTOR_ERASE_TIME
+#define MTD_NATIVE_SECTOR_ERASE_TIME    0
+#endif
+
+static uint32_t mtd0_erase_count[MTD_NATIVE_SECTOR_NUM];
 
 static mtd_native_dev_t mtd0_dev = {
     .dev = {
@@ -55,6 +64,9 @@ static mtd_native_dev_t mtd0_dev = {
         .page_size = MTD_NATIVE_PAGE_SIZE,
     },
     .fname = MTD_NATIVE_FILENAME,
+    .page_program_time = MTD_NATIVE_PAGE_PROGRAM_TIME,
+    .sector_erase_time = MTD_NATIVE_SECTOR_ERASE_TIME,
+    .erase_count = mtd0_erase_count,
 };
 
 mtd_dev_t *mtd0 = (mtd_dev_t *)&mtd0_dev;
@@ -11,6 +11,21 @@
  * @defgroup    core_sync Synchronization
  * @brief       Mutex for thread synchronization
  * @ingroup     core
+ *
+ * With the pseudo module `core_mutex_priority_inheritance`, a mutex records
+ * its owner, and a thread blocking on a mutex lends its priority to the owner
+ * until the owner unlocks the mutex. If the owner itself waits for another
+ * mutex, the priority is passed on to that mutex's owner, and so on. This
+ * bounds the time a high priority thread waits for a mutex held by a low
+ * priority thread to the length of the critical section, no matter how many
+ * threads of medium priority are ready to run.
+ *
+ * A thread runs with the highest of its own priority and the priorities of
+ * the threads waiting for any mutex it holds. The priority is recomputed
+ * whenever a waiter is added or a mutex changes hands, so mutexes can be
+ * unlocked in any order. Mutexes locked from interrupt context or initialized
+ * with @ref MUTEX_INIT_LOCKED have no owner and don't pass on priorities, so
+ * mutexes used for signaling work as before.
  * @{
  *
  * @file
@@ -23,7 +38,9 @@
 #define MUTEX_H
 
 #include <stddef.h>
+#include <stdint.h>
 
+#include "kernel_types.h"
 #include "list.h"
 
 #ifdef __cplusplus
@@ -33,25 +50,45 @@
 /**
  * @brief Mutex structure. Must never be modified by the user.
  */
-typedef struct {
+typedef struct mutex {
     /**
      * @brief   The process waiting queue of the mutex. **Must never be changed
      *          by the user.**
      * @internal
      */
     list_node_t queue;
+#if defined(MODULE_CORE_MUTEX_PRIORITY_INHERITANCE) || defined(DOXYGEN)
+    /**
+     * @brief   The thread holding the mutex, KERNEL_PID_UNDEF if unknown
+     * @internal
+     */
+    kernel_pid_t owner;
+    /**
+     * @brief   Next mutex held by the same owner
+     * @internal
+     */
+    struct mutex *next_held;
+#endif
 } mutex_t;
 
 /**
  * @brief Static initializer for mutex_t.
  * @details This initializer is preferable to mutex_init().
  */
+#if defined(MODULE_CORE_MUTEX_PRIORITY_INHERITANCE) && !defined(DOXYGEN)
+#define MUTEX_INIT { { NULL }, KERNEL_PID_UNDEF, NULL }
+#else
 #define MUTEX_INIT { { NULL } }
+#endif
 
 /**
  * @brief Static initializer for mutex_t with a locked mutex
  */
+#if defined(MODULE_CORE_MUTEX_PRIORITY_INHERITANCE) && !defined(DOXYGEN)
+#define MUTEX_INIT_LOCKED { { MUTEX_LOCKED }, KERNEL_PID_UNDEF, NULL }
+#else
 #define MUTEX_INIT_LOCKED { { MUTEX_LOCKED } }
+#endif
 
 /**
  * @cond INTERNAL
@@ -72,6 +109,10 @@ typedef struct {
 static inline void mutex_init(mutex_t *mutex)
 {
     mutex->queue.next = NULL;
+#ifdef MODULE_CORE_MUTEX_PRIORITY_INHERITANCE
+    mutex->owner = KERNEL_PID_UNDEF;
+    mutex->next_held = NULL;
+#endif
 }
 
 /**
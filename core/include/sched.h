@@ -119,6 +119,18 @@ int sched_run(void);
  */
 void sched_set_status(thread_t *process, unsigned int status);
 
+/**
+ * @brief   Change the priority of a thread
+ *
+ * Moves the thread to the run queue of its new priority if it is on a run
+ * queue. The active thread stays in front of its new run queue, other threads
+ * are appended. Does not yield, use sched_switch() afterwards if needed.
+ *
+ * @param[in]   thread      thread to change the priority of
+ * @param[in]   priority    new priority, less than SCHED_PRIO_LEVELS
+ */
+void sched_change_priority(thread_t *thread, uint8_t priority);
+
 /**
  * @brief       Yield if approriate.
  *
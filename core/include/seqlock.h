@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_sync
+ * @brief       Sequence lock for data that is read often and written rarely
+ *
+ * A sequence lock protects data without making readers block or write to
+ * memory: a reader copies the data and checks afterwards whether a writer
+ * changed it in the meantime, in which case it copies again.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * unsigned seq;
+ * do {
+ *     seq = seqlock_read_begin(&lock);
+ *     copy = data;
+ * } while (seqlock_read_retry(&lock, seq));
+ *
+ * (writer:)
+ * unsigned state = seqlock_write_begin(&lock);
+ * data = new_data;
+ * seqlock_write_end(&lock, state);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A writer disables interrupts, so writes must be short, and writers never
+ * wait for each other or for readers. Readers can run in any context,
+ * including interrupts. As no thread can preempt a writer, a reader on a
+ * single core never retries: it only does so when it runs in parallel to a
+ * writer, e.g. in a thread of the host on native.
+ *
+ * Readers must only copy the data, not follow pointers in it, as the memory
+ * they point to may be gone by the time the reader finds out the data
+ * changed. A reader must not use the copy before seqlock_read_retry()
+ * returned false.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Sequence lock API
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdbool.h>
+
+#include "irq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Sequence lock structure
+ */
+typedef struct {
+    unsigned seq;   /**< incremented before and after a write, so it is odd
+                         while a write is in progress */
+} seqlock_t;
+
+/**
+ * @brief   Static initializer for a sequence lock
+ */
+#define SEQLOCK_INIT    { 0 }
+
+/**
+ * @brief   Initialize a sequence lock
+ *
+ * @param[out] lock     sequence lock to initialize
+ */
+static inline void seqlock_init(seqlock_t *lock)
+{
+    lock->seq = 0;
+}
+
+/**
+ * @brief   Start reading
+ *
+ * Must not be called by a writer between seqlock_write_begin() and
+ * seqlock_write_end().
+ *
+ * @param[in] lock      sequence lock protecting the data
+ *
+ * @return  sequence number to pass to seqlock_read_retry()
+ */
+static inline unsigned seqlock_read_begin(const seqlock_t *lock)
+{
+    unsigned seq;
+
+    /* a write in progress on another core */
+    while ((seq = __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE)) & 1) {}
+    return seq;
+}
+
+/**
+ * @brief   Check whether the data was changed while reading it
+ *
+ * @param[in] lock      sequence lock protecting the data
+ * @param[in] seq       return value of seqlock_read_begin()
+ *
+ * @return  true if the data has to be read again
+ * @return  false if the data read is consistent
+ */
+static inline bool seqlock_read_retry(const seqlock_t *lock, unsigned seq)
+{
+    /* the data must be read before the sequence number */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&lock->seq, __ATOMIC_RELAXED) != seq;
+}
+
+/**
+ * @brief   Start writing
+ *
+ * Disables interrupts until seqlock_write_end().
+ *
+ * @param[in,out] lock  sequence lock protecting the data
+ *
+ * @return  interrupt state to pass to seqlock_write_end()
+ */
+static inline unsigned seqlock_write_begin(seqlock_t *lock)
+{
+    unsigned state = irq_disable();
+
+    __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELAXED);
+    /* the data must be written after the sequence number */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return state;
+}
+
+/**
+ * @brief   Finish writing
+ *
+ * @param[in,out] lock  sequence lock protecting the data
+ * @param[in] state     return value of seqlock_write_begin()
+ */
+static inline void seqlock_write_end(seqlock_t *lock, unsigned state)
+{
+    __atomic_store_n(&lock->seq, lock->seq + 1, __ATOMIC_RELEASE);
+    irq_restore(state);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEQLOCK_H */
+/** @} */
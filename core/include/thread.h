@@ -184,20 +184,26 @@ struct _thread {
     clist_node_t rq_entry;          /**< run queue entry                */
 
 #if defined(MODULE_CORE_MSG) || defined(MODULE_CORE_THREAD_FLAGS) \
-    || defined(MODULE_CORE_MBOX)
-    void *wait_data;                /**< used by msg, mbox and thread
-                                         flags                          */
+    || defined(MODULE_CORE_MBOX) \
+    || defined(MODULE_CORE_MUTEX_PRIORITY_INHERITANCE)
+    void *wait_data;                /**< used by msg, mbox, thread flags
+                                         and mutex priority inheritance */
 #endif
 #if defined(MODULE_CORE_MSG)
     list_node_t msg_waiters;        /**< threads waiting on message     */
     cib_t msg_queue;                /**< message queue                  */
     msg_t *msg_array;               /**< memory holding messages        */
 #endif
+#if defined(MODULE_CORE_MUTEX_PRIORITY_INHERITANCE)
+    struct mutex *held_mutexes;     /**< mutexes owned by the thread    */
+    uint8_t base_priority;          /**< priority without inheritance   */
+#endif
 
-#if defined(DEVELHELP) || defined(SCHED_TEST_STACK) || defined(MODULE_MPU_STACK_GUARD)
+#if defined(DEVELHELP) || defined(SCHED_TEST_STACK) || \
+    defined(MODULE_MPU_STACK_GUARD) || defined(MODULE_STACKMON)
     char *stack_start;              /**< thread's stack start address   */
 #endif
-#ifdef DEVELHELP
+#if defined(DEVELHELP) || defined(MODULE_STACKMON)
     const char *name;               /**< thread's name                  */
     int stack_size;                 /**< thread's stack size            */
 #endif
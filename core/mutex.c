@@ -32,6 +32,100 @@
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+#ifdef MODULE_CORE_MUTEX_PRIORITY_INHERITANCE
+/* Returns the base priority of a thread, raised to the priority of the first
+ * waiter of every mutex it holds. Wait queues are sorted by priority. */
+static uint8_t _inherited_priority(thread_t *thread)
+{
+    uint8_t priority = thread->base_priority;
+
+    for (mutex_t *m = thread->held_mutexes; m; m = m->next_held) {
+        list_node_t *head = m->queue.next;
+        if (head && (head != MUTEX_LOCKED)) {
+            thread_t *waiter = container_of((clist_node_t *)head, thread_t,
+                                            rq_entry);
+            if (waiter->priority < priority) {
+                priority = waiter->priority;
+            }
+        }
+    }
+    return priority;
+}
+
+/* Recomputes the priority of a thread and passes a change on along the chain
+ * of mutex owners it waits for. Called with interrupts disabled. */
+static void _update_priority(thread_t *thread)
+{
+    while (thread) {
+        uint8_t priority = _inherited_priority(thread);
+        if (priority == thread->priority) {
+            return;
+        }
+        DEBUG("PID[%" PRIkernel_pid "]: priority %" PRIu16 " -> %" PRIu16 "\n",
+              thread->pid, (uint16_t)thread->priority, (uint16_t)priority);
+        sched_change_priority(thread, priority);
+        if (thread->status != STATUS_MUTEX_BLOCKED) {
+            return;
+        }
+        /* keep the wait queue of the next mutex sorted by priority */
+        mutex_t *mutex = thread->wait_data;
+        list_remove(&mutex->queue, (list_node_t *)&thread->rq_entry);
+        thread_add_to_list(&mutex->queue, thread);
+        thread = (thread_t *)thread_get(mutex->owner);
+    }
+}
+
+/* Moves the mutex to the held list of its new owner and recomputes the
+ * priorities of both owners. Called with interrupts disabled. */
+static void _set_owner(mutex_t *mutex, kernel_pid_t pid)
+{
+    thread_t *old = (thread_t *)thread_get(mutex->owner);
+    thread_t *new = (thread_t *)thread_get(pid);
+
+    if (old) {
+        for (mutex_t **m = &old->held_mutexes; *m; m = &(*m)->next_held) {
+            if (*m == mutex) {
+                *m = mutex->next_held;
+                break;
+            }
+        }
+    }
+    mutex->next_held = NULL;
+    mutex->owner = pid;
+    if (new) {
+        mutex->next_held = new->held_mutexes;
+        new->held_mutexes = mutex;
+    }
+    if (old) {
+        _update_priority(old);
+    }
+    if (new) {
+        _update_priority(new);
+    }
+}
+
+/* Lends the priority of the blocking thread to the owner of the mutex, and on
+ * to the owner of the mutex that one waits for. Called with interrupts
+ * disabled. */
+static void _inherit_priority(mutex_t *mutex, thread_t *me)
+{
+    me->wait_data = mutex;
+    _update_priority((thread_t *)thread_get(mutex->owner));
+}
+#else
+static inline void _set_owner(mutex_t *mutex, kernel_pid_t pid)
+{
+    (void)mutex;
+    (void)pid;
+}
+
+static inline void _inherit_priority(mutex_t *mutex, thread_t *me)
+{
+    (void)mutex;
+    (void)me;
+}
+#endif
+
 int _mutex_lock(mutex_t *mutex, int blocking)
 {
     unsigned irqstate = irq_disable();
@@ -41,6 +135,7 @@ int _mutex_lock(mutex_t *mutex, int blocking)
     if (mutex->queue.next == NULL) {
         /* mutex is unlocked. */
         mutex->queue.next = MUTEX_LOCKED;
+        _set_owner(mutex, irq_is_in() ? KERNEL_PID_UNDEF : sched_active_pid);
         DEBUG("PID[%" PRIkernel_pid "]: mutex_wait early out.\n",
               sched_active_pid);
         irq_restore(irqstate);
@@ -58,6 +153,7 @@ int _mutex_lock(mutex_t *mutex, int blocking)
         else {
             thread_add_to_list(&mutex->queue, me);
         }
+        _inherit_priority(mutex, me);
         irq_restore(irqstate);
         thread_yield_higher();
         /* We were woken up by scheduler. Waker removed us from queue.
@@ -85,6 +181,7 @@ void mutex_unlock(mutex_t *mutex)
 
     if (mutex->queue.next == MUTEX_LOCKED) {
         mutex->queue.next = NULL;
+        _set_owner(mutex, KERNEL_PID_UNDEF);
         /* the mutex was locked and no thread was waiting for it */
         irq_restore(irqstate);
         return;
@@ -97,6 +194,7 @@ void mutex_unlock(mutex_t *mutex)
     DEBUG("mutex_unlock: waking up waiting thread %" PRIkernel_pid "\n",
           process->pid);
     sched_set_status(process, STATUS_PENDING);
+    _set_owner(mutex, process->pid);
 
     if (!mutex->queue.next) {
         mutex->queue.next = MUTEX_LOCKED;
@@ -116,6 +214,7 @@ void mutex_unlock_and_sleep(mutex_t *mutex)
     if (mutex->queue.next) {
         if (mutex->queue.next == MUTEX_LOCKED) {
             mutex->queue.next = NULL;
+            _set_owner(mutex, KERNEL_PID_UNDEF);
         }
         else {
             list_node_t *next = list_remove_head(&mutex->queue);
@@ -123,6 +222,7 @@ void mutex_unlock_and_sleep(mutex_t *mutex)
                                              rq_entry);
             DEBUG("PID[%" PRIkernel_pid "]: waking up waiter.\n", process->pid);
             sched_set_status(process, STATUS_PENDING);
+            _set_owner(mutex, process->pid);
             if (!mutex->queue.next) {
                 mutex->queue.next = MUTEX_LOCKED;
             }
@@ -23,6 +23,7 @@
 
 #include "sched.h"
 #include "clist.h"
+#include "assert.h"
 #include "bitarithm.h"
 #include "irq.h"
 #include "thread.h"
@@ -183,6 +184,41 @@ void sched_set_status(thread_t *process, unsigned int status)
     process->status = status;
 }
 
+void sched_change_priority(thread_t *thread, uint8_t priority)
+{
+    assert(priority < SCHED_PRIO_LEVELS);
+
+    unsigned irqstate = irq_disable();
+
+    if (thread->priority == priority) {
+        irq_restore(irqstate);
+        return;
+    }
+
+    DEBUG("sched_change_priority: thread %" PRIkernel_pid " from %" PRIu16
+          " to %" PRIu16 ".\n", thread->pid, (uint16_t)thread->priority,
+          (uint16_t)priority);
+
+    if (thread->status >= STATUS_ON_RUNQUEUE) {
+        /* unlike sched_set_status(), the thread may be anywhere in its run
+         * queue */
+        clist_remove(&sched_runqueues[thread->priority], &thread->rq_entry);
+        if (!sched_runqueues[thread->priority].next) {
+            runqueue_bitcache &= ~(1 << thread->priority);
+        }
+        if (thread == sched_active_thread) {
+            clist_lpush(&sched_runqueues[priority], &thread->rq_entry);
+        }
+        else {
+            clist_rpush(&sched_runqueues[priority], &thread->rq_entry);
+        }
+        runqueue_bitcache |= 1 << priority;
+    }
+    thread->priority = priority;
+
+    irq_restore(irqstate);
+}
+
 void sched_switch(uint16_t other_prio)
 {
     thread_t *active_thread = (thread_t *) sched_active_thread;
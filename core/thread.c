@@ -146,7 +146,7 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
         return -EINVAL;
     }
 
-#ifdef DEVELHELP
+#if defined(DEVELHELP) || defined(MODULE_STACKMON)
     int total_stacksize = stacksize;
 #else
     (void) name;
@@ -172,7 +172,12 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
     /* allocate our thread control block at the top of our stackspace */
     thread_t *cb = (thread_t *) (stack + stacksize);
 
-#if defined(DEVELHELP) || defined(SCHED_TEST_STACK)
+#ifdef MODULE_STACKMON
+    /* the stack monitor measures every thread */
+    flags |= THREAD_CREATE_STACKTEST;
+#endif
+
+#if defined(DEVELHELP) || defined(SCHED_TEST_STACK) || defined(MODULE_STACKMON)
     if (flags & THREAD_CREATE_STACKTEST) {
         /* assign each int of the stack the value of it's address */
         uintptr_t *stackmax = (uintptr_t *) (stack + stacksize);
@@ -211,11 +216,12 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
     cb->pid = pid;
     cb->sp = thread_stack_init(function, arg, stack, stacksize);
 
-#if defined(DEVELHELP) || defined(SCHED_TEST_STACK) || defined(MODULE_MPU_STACK_GUARD)
+#if defined(DEVELHELP) || defined(SCHED_TEST_STACK) || \
+    defined(MODULE_MPU_STACK_GUARD) || defined(MODULE_STACKMON)
     cb->stack_start = stack;
 #endif
 
-#ifdef DEVELHELP
+#if defined(DEVELHELP) || defined(MODULE_STACKMON)
     cb->stack_size = total_stacksize;
     cb->name = name;
 #endif
@@ -232,6 +238,11 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
     cb->msg_array = NULL;
 #endif
 
+#ifdef MODULE_CORE_MUTEX_PRIORITY_INHERITANCE
+    cb->held_mutexes = NULL;
+    cb->base_priority = priority;
+#endif
+
     sched_num_threads++;
 
     DEBUG("Created thread %s. PID: %" PRIkernel_pid ". Priority: %u.\n", name, cb->pid, priority);
@@ -20,16 +20,38 @@
 #ifndef MTD_NATIVE_H
 #define MTD_NATIVE_H
 
+#include <stdint.h>
+
+#include "mtd.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#include "mtd.h"
-
-/** mtd native descriptor */
+/**
+ * @brief   mtd native descriptor
+ *
+ * The backing file is mapped into memory on init and stays mapped, so
+ * accesses don't involve any system calls. Powering the device down writes
+ * the mapping back to the file and unmaps it, powering it up maps it again.
+ *
+ * Optionally, the timing of a real flash can be modelled: each program
+ * operation sleeps for mtd_native_dev::page_program_time per page written,
+ * each erase for mtd_native_dev::sector_erase_time per sector (requires the
+ * `xtimer` module). With mtd_native_dev::erase_count set, the number of
+ * erase cycles of each sector is counted.
+ */
 typedef struct mtd_native_dev {
-    mtd_dev_t dev;      /**< mtd generic device */
-    const char *fname;  /**< filename to use for memory emulation */
+    mtd_dev_t dev;                  /**< mtd generic device */
+    const char *fname;              /**< filename to use for memory emulation */
+    uint8_t *map;                   /**< mapped backing file, set by init */
+    uint32_t page_program_time;     /**< time to program a page in us */
+    uint32_t sector_erase_time;     /**< time to erase a sector in us */
+    /**
+     * @brief   Erase counter for each sector (mtd_dev_t::sector_count entries).
+     *          May be NULL.
+     */
+    uint32_t *erase_count;
 } mtd_native_dev_t;
 
 /**
@@ -19,36 +19,75 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
 
 #include "mtd.h"
 #include "mtd_native.h"
+#ifdef MODULE_XTIMER
+#include "xtimer.h"
+#endif
 
 #include "native_internal.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+static inline size_t _mtd_size(const mtd_dev_t *dev)
+{
+    return dev->sector_count * dev->pages_per_sector * dev->page_size;
+}
+
+static void _delay(uint32_t us)
+{
+#ifdef MODULE_XTIMER
+    if (us > 0) {
+        xtimer_usleep(us);
+    }
+#else
+    (void)us;
+#endif
+}
+
 static int _init(mtd_dev_t *dev)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
+    size_t size = _mtd_size(dev);
 
     DEBUG("mtd_native: init, filename=%s\n", _dev->fname);
 
-    FILE *f = real_fopen(_dev->fname, "r");
-
-    if (!f) {
-        DEBUG("mtd_native: init: creating file %s\n", name);
-        f = real_fopen(_dev->fname, "w+");
-        if (!f) {
-            return -EIO;
-        }
-        size_t size = dev->sector_count * dev->pages_per_sector * dev->page_size;
-        for (size_t i = 0; i < size; i++) {
-            real_fputc(0xff, f);
-        }
+    if (_dev->map != NULL) {
+        return 0;
     }
 
-    real_fclose(f);
+    _native_syscall_enter();
+    int fd = real_open(_dev->fname, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        _native_syscall_leave();
+        return -EIO;
+    }
+    off_t file_size = real_lseek(fd, 0, SEEK_END);
+    if ((file_size < 0) ||
+        (((size_t)file_size < size) && (real_ftruncate(fd, size) < 0))) {
+        real_close(fd);
+        _native_syscall_leave();
+        return -EIO;
+    }
+    uint8_t *map = real_mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                             fd, 0);
+    /* the mapping stays valid without the file descriptor */
+    real_close(fd);
+    _native_syscall_leave();
+    if (map == MAP_FAILED) {
+        return -EIO;
+    }
+    if ((size_t)file_size < size) {
+        DEBUG("mtd_native: init: initializing file %s\n", _dev->fname);
+        /* ftruncate() fills with 0, but erased flash reads 0xff */
+        memset(map + file_size, 0xff, size - file_size);
+    }
+    _dev->map = map;
 
     return 0;
 }
@@ -56,51 +95,70 @@ static int _init(mtd_dev_t *dev)
 static int _read(mtd_dev_t *dev, void *buff, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
 
     DEBUG("mtd_native: read from page %" PRIu32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if (addr + size > _mtd_size(dev)) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r");
-    if (!f) {
+    if (_dev->map == NULL) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
-    size = real_fread(buff, 1, size, f);
-    real_fclose(f);
+    memcpy(buff, _dev->map + addr, size);
 
     return size;
 }
 
+/**
+ * @brief   Programs @p size bytes, emulating NOR flash AND semantics
+ *
+ * Works on machine words where the flash address is aligned, byte-wise for
+ * the head and tail.
+ */
+static void _program(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    while ((size > 0) && ((uintptr_t)dst % sizeof(uintptr_t))) {
+        *(dst++) &= *(src++);
+        size--;
+    }
+    while (size >= sizeof(uintptr_t)) {
+        uintptr_t word;
+
+        /* src may be unaligned */
+        memcpy(&word, src, sizeof(word));
+        *((uintptr_t *)dst) &= word;
+        dst += sizeof(uintptr_t);
+        src += sizeof(uintptr_t);
+        size -= sizeof(uintptr_t);
+    }
+    while (size > 0) {
+        *(dst++) &= *(src++);
+        size--;
+    }
+}
+
 static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
     size_t sector_size = dev->pages_per_sector * dev->page_size;
 
     DEBUG("mtd_native: write from page %" PRIu32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if (addr + size > _mtd_size(dev)) {
         return -EOVERFLOW;
     }
     if (((addr % sector_size) + size) > sector_size) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r+");
-    if (!f) {
+    if (_dev->map == NULL) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
-    for (size_t i = 0; i < size; i++) {
-        uint8_t c = real_fgetc(f);
-        real_fseek(f, -1, SEEK_CUR);
-        real_fputc(c & ((uint8_t*)buff)[i], f);
+    _program(_dev->map + addr, buff, size);
+    if ((_dev->page_program_time > 0) && (size > 0)) {
+        uint32_t pages = ((addr + size - 1) / dev->page_size) -
+                         (addr / dev->page_size) + 1;
+        _delay(pages * _dev->page_program_time);
     }
-    real_fclose(f);
 
     return size;
 }
@@ -108,35 +166,58 @@ static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr, uint32_t size
 static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
     size_t sector_size = dev->pages_per_sector * dev->page_size;
 
     DEBUG("mtd_native: erase from sector %" PRIu32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if (addr + size > _mtd_size(dev)) {
         return -EOVERFLOW;
     }
     if (((addr % sector_size) != 0) || ((size % sector_size) != 0)) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r+");
-    if (!f) {
+    if (_dev->map == NULL) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
-    for (size_t i = 0; i < size; i++) {
-        real_fputc(0xff, f);
+    memset(_dev->map + addr, 0xff, size);
+    if (_dev->erase_count != NULL) {
+        for (uint32_t sector = addr / sector_size;
+             sector < (addr + size) / sector_size; sector++) {
+            _dev->erase_count[sector]++;
+        }
     }
-    real_fclose(f);
+    _delay((size / sector_size) * _dev->sector_erase_time);
 
     return 0;
 }
 
 static int _power(mtd_dev_t *dev, enum mtd_power_state power)
 {
-    (void) dev;
-    (void) power;
+    mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
+    size_t size = _mtd_size(dev);
+    int res;
+
+    switch (power) {
+        case MTD_POWER_UP:
+            /* maps the backing file again, if it was unmapped */
+            return _init(dev);
+        case MTD_POWER_DOWN:
+            if (_dev->map == NULL) {
+                return 0;
+            }
+            DEBUG("mtd_native: power down, unmapping %s\n", _dev->fname);
+            _native_syscall_enter();
+            res = real_msync(_dev->map, size, MS_SYNC);
+            if (res == 0) {
+                res = real_munmap(_dev->map, size);
+            }
+            _native_syscall_leave();
+            if (res < 0) {
+                return -EIO;
+            }
+            _dev->map = NULL;
+            return 0;
+    }
 
     return -ENOTSUP;
 }
@@ -96,6 +96,12 @@ int (*real_fputc)(int c, FILE *stream);
 int (*real_fgetc)(FILE *stream);
 mode_t (*real_umask)(mode_t cmask);
 ssize_t (*real_writev)(int fildes, const struct iovec *iov, int iovcnt);
+off_t (*real_lseek)(int fd, off_t offset, int whence);
+int (*real_ftruncate)(int fd, off_t length);
+void* (*real_mmap)(void *addr, size_t length, int prot, int flags,
+                   int fd, off_t offset);
+int (*real_munmap)(void *addr, size_t length);
+int (*real_msync)(void *addr, size_t length, int flags);
 
 #ifdef __MACH__
 #else
@@ -139,8 +145,10 @@ void _native_syscall_leave(void)
 
 /* make use of TLSF if it is included, except when building with valgrind
  * support, where one probably wants to make use of valgrind's memory leak
- * detection abilities*/
-#if !(defined MODULE_TLSF) || (defined(HAVE_VALGRIND_H))
+ * detection abilities. The tlsf_malloc module replaces the system allocator,
+ * so it always provides these functions. */
+#if !defined(MODULE_TLSF_MALLOC) && \
+    (!(defined MODULE_TLSF) || (defined(HAVE_VALGRIND_H)))
 int _native_in_malloc = 0;
 void *malloc(size_t size)
 {
@@ -211,7 +219,7 @@ void *realloc(void *ptr, size_t size)
     _native_syscall_leave();
     return r;
 }
-#endif /* !(defined MODULE_TLSF) || (defined(HAVE_VALGRIND_H)) */
+#endif /* !MODULE_TLSF_MALLOC && (!MODULE_TLSF || HAVE_VALGRIND_H) */
 
 ssize_t _native_read(int fd, void *buf, size_t count)
 {
@@ -482,6 +490,11 @@ void _native_init_syscalls(void)
     *(void **)(&real_fseek) = dlsym(RTLD_NEXT, "fseek");
     *(void **)(&real_fputc) = dlsym(RTLD_NEXT, "fputc");
     *(void **)(&real_fgetc) = dlsym(RTLD_NEXT, "fgetc");
+    *(void **)(&real_lseek) = dlsym(RTLD_NEXT, "lseek");
+    *(void **)(&real_ftruncate) = dlsym(RTLD_NEXT, "ftruncate");
+    *(void **)(&real_mmap) = dlsym(RTLD_NEXT, "mmap");
+    *(void **)(&real_munmap) = dlsym(RTLD_NEXT, "munmap");
+    *(void **)(&real_msync) = dlsym(RTLD_NEXT, "msync");
 #ifdef __MACH__
 #else
     *(void **)(&real_clock_gettime) = dlsym(RTLD_NEXT, "clock_gettime");
@@ -75,6 +75,19 @@ extern "C" {
 #if defined(CPU_FAM_STM32F1) || defined(CPU_FAM_STM32F2) \
     || defined(CPU_FAM_STM32F4) || defined(DOXYGEN)
 #define PM_NUM_MODES    (2U)
+
+/**
+ * @brief   Wake-up latency and minimum residency of the low power modes, in us
+ *
+ * Waking up from standby (0) resets the CPU, so the idle thread never uses
+ * it. Waking up from stop (1) is dominated by stmclk_init_sysclk() waiting
+ * for the HSE to start, 2 ms typically. As the CPU draws full power while
+ * the clocks restart, stop pays off only if it lasts about as long again.
+ * @{
+ */
+#define PM_MODE_LATENCY_US      { 0, 2000 }
+#define PM_MODE_RESIDENCY_US    { UINT32_MAX, 2000 }
+/** @} */
 #endif
 
 /**
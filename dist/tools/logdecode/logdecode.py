@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+"""Decode the output of the log_deferred module
+
+Reads the output of an application using log_deferred from a file or stdin,
+formats the log frames with the format strings from the application's ELF
+file and passes all other output through.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MARKER = 0xf5
+HDR_SIZE = 4
+ID_DROPPED = 0xffff
+
+LEVELS = ["NONE", "ERROR", "WARNING", "INFO", "DEBUG", "ALL"]
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?"
+                  r"(hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgGaA%])")
+
+
+class Elf:
+    """Minimal ELF reader, just enough to find sections and strings"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+        self.is64 = data[4] == 2
+        self.endian = "<" if data[5] == 1 else ">"
+        self.ptr_size = 8 if self.is64 else 4
+        self.data = data
+
+        if self.is64:
+            shoff, = struct.unpack_from(self.endian + "Q", data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                self.endian + "HHH", data, 0x3a)
+            shfmt = self.endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(self.endian + "I", data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                self.endian + "HHH", data, 0x2e)
+            shfmt = self.endian + "IIIIII"
+
+        sections = []
+        for i in range(shnum):
+            sections.append(struct.unpack_from(shfmt, data,
+                                               shoff + i * shentsize))
+        strtab = sections[shstrndx]
+        self.sections = {}
+        self.loaded = []
+        for name, type_, flags, addr, offset, size in sections:
+            end = data.index(b"\0", strtab[4] + name)
+            name = data[strtab[4] + name:end].decode()
+            self.sections[name] = (addr, offset, size)
+            if (flags & SHF_ALLOC) and type_ != SHT_NOBITS and addr:
+                self.loaded.append((addr, offset, size))
+
+    def section(self, name):
+        addr, offset, size = self.sections[name]
+        return self.data[offset:offset + size]
+
+    def string_at(self, addr):
+        for start, offset, size in self.loaded:
+            if start <= addr < start + size:
+                pos = offset + addr - start
+                end = self.data.find(b"\0", pos, offset + size)
+                if end < 0:
+                    return None
+                return self.data[pos:end].decode(errors="replace")
+        return None
+
+
+class Decoder:
+    def __init__(self, elf, int_size=4):
+        self.elf = elf
+        self.int_size = int_size
+        # the 16-bit targets (AVR, MSP430) also have 16-bit pointers and
+        # size_t, although their ELF files are 32-bit
+        self.ptr_size = elf.ptr_size if int_size >= 4 else 2
+        self.long_size = 8 if elf.is64 else 4
+        try:
+            self.fmts = elf.section("log_fmt")
+        except KeyError:
+            raise ValueError("no log_fmt section, is log_deferred used?")
+
+    def fmt_at(self, offset):
+        end = self.fmts.find(b"\0", offset)
+        if offset >= len(self.fmts) or end < 0:
+            return None
+        return self.fmts[offset:end].decode(errors="replace")
+
+    def _arg(self, args, pos, size, kind):
+        endian = self.elf.endian
+        if pos + size > len(args):
+            raise ValueError("arguments too short")
+        if kind == "f":
+            return struct.unpack_from(endian + "d", args, pos)[0]
+        code = {2: "h", 4: "i", 8: "q"}[size]
+        if kind == "u":
+            code = code.upper()
+        return struct.unpack_from(endian + code, args, pos)[0]
+
+    def format(self, fmt, args):
+        ptr = self.ptr_size
+        int_size = self.int_size
+        out = []
+        pos = 0
+        last = 0
+        for m in SPEC.finditer(fmt):
+            out.append(fmt[last:m.start()])
+            last = m.end()
+            flags, width, prec, length, conv = m.groups()
+            if conv == "%":
+                out.append("%")
+                continue
+            if width == "*":
+                width = str(self._arg(args, pos, int_size, "i"))
+                pos += int_size
+            if prec == "*":
+                prec = str(self._arg(args, pos, int_size, "i"))
+                pos += int_size
+            spec = "%" + flags + (width or "") + \
+                ("." + prec if prec is not None else "")
+
+            if conv in "fFeEgGaA":
+                value = self._arg(args, pos, 8, "f")
+                pos += 8
+                if conv in "aA":
+                    out.append(value.hex())
+                else:
+                    out.append((spec + conv) % value)
+                continue
+            if conv in "sp":
+                value = self._arg(args, pos, ptr, "u")
+                pos += ptr
+                if conv == "p":
+                    out.append((spec + "s") % ("0x%x" % value))
+                else:
+                    string = self.elf.string_at(value)
+                    if string is None:
+                        string = "<0x%x>" % value
+                    out.append((spec + "s") % string)
+                continue
+
+            if length in ("ll", "j"):
+                size = 8
+            elif length == "l":
+                size = self.long_size
+            elif length in ("z", "t"):
+                size = ptr
+            else:
+                size = int_size
+            value = self._arg(args, pos, size, "i" if conv in "di" else "u")
+            pos += size
+            if length in ("h", "hh"):
+                bits = 16 if length == "h" else 8
+                value &= (1 << bits) - 1
+                if conv in "di" and value >= 1 << (bits - 1):
+                    value -= 1 << bits
+            if conv == "c":
+                out.append((spec + "c") % chr(value & 0xff))
+            elif conv == "u":
+                out.append((spec + "d") % value)
+            else:
+                out.append((spec + conv) % value)
+        out.append(fmt[last:])
+        if pos != len(args):
+            raise ValueError("%d bytes of arguments left" % (len(args) - pos))
+        return "".join(out)
+
+    def decode(self, level, id_, args):
+        if id_ == ID_DROPPED:
+            count, = struct.unpack_from(self.elf.endian + "I", args)
+            return "[log_deferred: %u records dropped]\n" % count, level
+        fmt = self.fmt_at(id_)
+        if fmt is None:
+            return "[log_deferred: unknown format string %u]\n" % id_, level
+        try:
+            return self.format(fmt, args), level
+        except (ValueError, KeyError, struct.error) as e:
+            return "[log_deferred: %r: %s]\n" % (fmt, e), level
+
+
+def read_exact(stream, n):
+    data = b""
+    while len(data) < n:
+        chunk = stream.read(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="ELF file of the application")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="file or tty to read from, default: stdin")
+    parser.add_argument("-l", "--level", type=int, default=len(LEVELS) - 1,
+                        help="only show messages up to this level")
+    parser.add_argument("-p", "--prefix", action="store_true",
+                        help="prefix messages with their level")
+    parser.add_argument("-i", "--int-size", type=int, choices=(2, 4),
+                        default=4,
+                        help="size of int on the target in bytes, default: 4")
+    args = parser.parse_args()
+
+    try:
+        decoder = Decoder(Elf(args.elf), args.int_size)
+    except (OSError, ValueError) as e:
+        sys.exit("logdecode: %s" % e)
+
+    if args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb", buffering=0)
+    out = sys.stdout
+
+    text = b""
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+        if byte[0] != MARKER:
+            text += byte
+            if byte == b"\n":
+                out.write(text.decode(errors="replace"))
+                out.flush()
+                text = b""
+            continue
+
+        hdr = read_exact(stream, HDR_SIZE)
+        if hdr is None:
+            break
+        id_ = hdr[0] | (hdr[1] << 8)
+        level = hdr[2]
+        payload = read_exact(stream, hdr[3])
+        if payload is None:
+            break
+        msg, level = decoder.decode(level, id_, payload)
+        if level > args.level:
+            continue
+        if args.prefix and level < len(LEVELS):
+            msg = "%s: %s" % (LEVELS[level], msg)
+        out.write(text.decode(errors="replace") + msg)
+        out.flush()
+        text = b""
+    out.write(text.decode(errors="replace"))
+
+
+if __name__ == "__main__":
+    main()
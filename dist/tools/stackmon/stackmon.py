@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+"""Recommend stack sizes from the output of the stackmon module
+
+Reads the reports printed by stackmon_print(), e.g. by the `stackmon` or `ps`
+shell commands, from one or more logs, takes the highest peak of each thread
+over all reports and prints the stack size to configure for it.
+"""
+
+import argparse
+import re
+import sys
+
+HEADER = re.compile(r"pid name\s+size\s+peak\s+recommended\s*$")
+ENTRY = re.compile(r"(\d+) (\S+)\s+(\d+)\s+(\d+)\s+(\d+)\s*$")
+END = re.compile(r"reclaimable: \d+\s*$")
+
+# thread name -> macro setting the size of its stack
+MACROS = {
+    "idle": "THREAD_STACKSIZE_IDLE",
+    "main": "THREAD_STACKSIZE_MAIN",
+    "6lo": "GNRC_SIXLOWPAN_STACK_SIZE",
+    "ipv6": "GNRC_IPV6_STACK_SIZE",
+    "udp": "GNRC_UDP_STACK_SIZE",
+    "gnrc_tcp": "TCP_EVENTLOOP_STACK_SIZE",
+    "RPL": "GNRC_RPL_STACK_SIZE",
+    "pktdump": "GNRC_PKTDUMP_STACKSIZE",
+    "coap": "GCOAP_STACK_SIZE",
+    "coap_worker": "GCOAP_WORKER_STACK_SIZE",
+    "gnrc_netdev_tap": "TAP_MAC_STACKSIZE",
+}
+
+
+def parse(lines, threads):
+    """Add the entries of all reports in lines to threads
+
+    threads maps a thread name to [size, peak]
+    """
+    in_report = False
+    for line in lines:
+        if HEADER.search(line):
+            in_report = True
+        elif in_report and END.search(line):
+            in_report = False
+        elif in_report:
+            m = ENTRY.search(line)
+            if not m:
+                continue
+            name, size, peak = m.group(2), int(m.group(3)), int(m.group(4))
+            entry = threads.setdefault(name, [size, peak])
+            entry[0] = max(entry[0], size)
+            entry[1] = max(entry[1], peak)
+
+
+def recommend(peak, margin):
+    """Peak plus margin percent, rounded up to 8 bytes, as on the device"""
+    return (peak + peak * margin // 100 + 7) & ~7
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="*", default=["-"],
+                        help="output of the application, default: stdin")
+    parser.add_argument("-m", "--margin", type=int, default=25,
+                        help="margin added to the peaks in percent, "
+                             "default: %(default)s")
+    args = parser.parse_args()
+
+    threads = {}
+    for path in args.logs:
+        try:
+            if path == "-":
+                parse(sys.stdin, threads)
+            else:
+                with open(path, errors="replace") as f:
+                    parse(f, threads)
+        except OSError as e:
+            sys.exit("stackmon: %s" % e)
+    if not threads:
+        sys.exit("stackmon: no report found")
+
+    # threads using the same macro get the largest recommendation
+    cflags = {}
+    total = 0
+    print("%-20s %6s %6s %12s" % ("name", "size", "peak", "recommended"))
+    for name, (size, peak) in sorted(threads.items()):
+        rec = recommend(peak, args.margin)
+        if rec < size:
+            total += size - rec
+        print("%-20s %6u %6u %12u" % (name, size, peak, rec))
+        macro = MACROS.get(name)
+        if macro:
+            cflags[macro] = max(cflags.get(macro, 0), rec)
+    print("saved: %d bytes" % total)
+
+    print()
+    for macro, rec in sorted(cflags.items()):
+        print("CFLAGS += -D%s=%u" % (macro, rec))
+    for name in sorted(set(threads) - set(MACROS)):
+        print("# %s: stack size not known to this script, use %u" %
+              (name, recommend(threads[name][1], args.margin)))
+
+
+if __name__ == "__main__":
+    main()
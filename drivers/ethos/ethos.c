@@ -62,10 +62,7 @@ void ethos_setup(ethos_t *dev, const ethos_params_t *params)
     tsrb_init(&dev->inbuf, (char*)params->buf, params->bufsize);
     mutex_init(&dev->out_mutex);
 
-    uint32_t a = random_uint32();
-    memcpy(dev->mac_addr, (char*)&a, 4);
-    a = random_uint32();
-    memcpy(dev->mac_addr+4, (char*)&a, 2);
+    random_bytes(dev->mac_addr, sizeof(dev->mac_addr));
 
     dev->mac_addr[0] &= (0x2);      /* unset globally unique bit */
     dev->mac_addr[0] &= ~(0x1);     /* set unicast bit*/
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_cache mtd page cache
+ * @ingroup     drivers_storage
+ * @brief       Write-back page cache that can be stacked on any mtd device
+ *
+ * `mtd_cache` is an mtd device itself, so file systems (e.g. spiffs or
+ * FatFs) can use it in place of the device it wraps. Pages are kept in a
+ * small number of cache lines that are replaced in least-recently-used
+ * order:
+ *
+ * - A read miss loads a whole line, which is mtd_cache_t::line_pages pages
+ *   long, so sequential reads are served from RAM after the first access
+ *   (read-ahead). Reads covering whole, uncached lines bypass the cache and
+ *   are issued to the backing device as one transaction.
+ * - Writes are only applied to the cache. The dirty range of a line is
+ *   written back when the line is evicted, when mtd_cache_sync() is called,
+ *   or before the device is powered down. Consecutive small writes to the
+ *   same line (e.g. appending to a log) are thereby merged into one page
+ *   program operation.
+ *
+ * @warning Write-back does not preserve the order of writes. A file system
+ *          that relies on it for consistency has to call mtd_cache_sync()
+ *          at its commit points.
+ *
+ * The counters in mtd_cache_t::stats allow to compare the number of
+ * transactions on the backing device with the number of accesses.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for the mtd page cache
+ */
+
+#ifndef MTD_CACHE_H
+#define MTD_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum number of cache lines per cache
+ *
+ * The actual number of lines is determined by mtd_cache_t::buf_size.
+ */
+#ifndef MTD_CACHE_LINES_MAX
+#define MTD_CACHE_LINES_MAX     (8U)
+#endif
+
+/**
+ * @brief   Cache line descriptor
+ */
+typedef struct {
+    uint32_t addr;          /**< address of the line on the backing device */
+    uint32_t last_use;      /**< use counter value at the last access */
+    uint32_t dirty_start;   /**< start of the dirty range within the line */
+    uint32_t dirty_end;     /**< end of the dirty range, 0 if clean */
+    bool valid;             /**< line holds data */
+} mtd_cache_line_t;
+
+/**
+ * @brief   Cache statistics
+ */
+typedef struct {
+    uint32_t read_hits;     /**< reads served from the cache */
+    uint32_t read_misses;   /**< reads that required a bus transaction */
+    uint32_t write_hits;    /**< writes to a cached line */
+    uint32_t write_misses;  /**< writes that required to load a line */
+    uint32_t bus_reads;     /**< read transactions on the backing device */
+    uint32_t bus_writes;    /**< write transactions on the backing device */
+    uint32_t bus_erases;    /**< erase transactions on the backing device */
+} mtd_cache_stats_t;
+
+/**
+ * @brief   Device descriptor for mtd_cache device
+ *
+ * This is an extension of the @c mtd_dev_t struct. mtd_cache_t::mtd,
+ * mtd_cache_t::buf, mtd_cache_t::buf_size, mtd_cache_t::line_pages and
+ * mtd_cache_t::nor_flash are to be set by the user, all other members are
+ * initialized by mtd_init().
+ */
+typedef struct {
+    mtd_dev_t base;             /**< inherit from mtd_dev_t object */
+    mtd_dev_t *mtd;             /**< backing device */
+    uint8_t *buf;               /**< memory for the cache lines */
+    size_t buf_size;            /**< size of mtd_cache_t::buf */
+    uint32_t line_pages;        /**< pages per cache line (0 is handled as 1) */
+    /**
+     * @brief   Backing device has NOR flash semantics
+     *
+     * If set, writes only clear bits (the cached data is AND-ed with the
+     * written data) and erased lines are kept in the cache set to 0xff.
+     * Otherwise writes replace the cached data and erased lines are dropped
+     * from the cache.
+     */
+    bool nor_flash;
+    mtd_cache_line_t lines[MTD_CACHE_LINES_MAX];    /**< cache lines */
+    unsigned lines_numof;       /**< number of usable cache lines */
+    uint32_t line_size;         /**< size of a cache line in bytes */
+    uint32_t use_count;         /**< access counter for LRU replacement */
+    mutex_t lock;               /**< serializes accesses */
+    mtd_cache_stats_t stats;    /**< cache statistics */
+} mtd_cache_t;
+
+/**
+ * @brief   mtd_cache device operations table for mtd
+ */
+extern const mtd_desc_t mtd_cache_driver;
+
+/**
+ * @brief   Writes all dirty cache lines back to the backing device
+ *
+ * @param[in] dev   cache device
+ *
+ * @return  0 on success
+ * @return  < 0 value on error of the backing device
+ */
+int mtd_cache_sync(mtd_cache_t *dev);
+
+/**
+ * @brief   Writes all dirty cache lines back and drops all lines
+ *
+ * Use this when the backing device was modified without going through the
+ * cache.
+ *
+ * @param[in] dev   cache device
+ *
+ * @return  0 on success
+ * @return  < 0 value on error of the backing device
+ */
+int mtd_cache_invalidate(mtd_cache_t *dev);
+
+/**
+ * @brief   Resets the statistics of a cache
+ *
+ * @param[in] dev   cache device
+ */
+void mtd_cache_stats_reset(mtd_cache_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_CACHE_H */
+/** @} */
@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_cache
+ * @{
+ *
+ * @file
+ * @brief       Write-back page cache for mtd devices
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mtd.h"
+#include "mtd_cache.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static int mtd_cache_init(mtd_dev_t *mtd);
+static int mtd_cache_read(mtd_dev_t *mtd, void *dest, uint32_t addr,
+                          uint32_t size);
+static int mtd_cache_write(mtd_dev_t *mtd, const void *src, uint32_t addr,
+                           uint32_t size);
+static int mtd_cache_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size);
+static int mtd_cache_power(mtd_dev_t *mtd, enum mtd_power_state power);
+
+const mtd_desc_t mtd_cache_driver = {
+    .init = mtd_cache_init,
+    .read = mtd_cache_read,
+    .write = mtd_cache_write,
+    .erase = mtd_cache_erase,
+    .power = mtd_cache_power,
+};
+
+static inline uint32_t _dev_size(const mtd_cache_t *dev)
+{
+    return dev->base.sector_count * dev->base.pages_per_sector *
+           dev->base.page_size;
+}
+
+static inline uint8_t *_line_buf(const mtd_cache_t *dev,
+                                 const mtd_cache_line_t *line)
+{
+    return dev->buf + ((line - dev->lines) * dev->line_size);
+}
+
+/* the last line may be cut short by the end of the device */
+static inline uint32_t _line_len(const mtd_cache_t *dev, uint32_t line_addr)
+{
+    uint32_t left = _dev_size(dev) - line_addr;
+
+    return (left < dev->line_size) ? left : dev->line_size;
+}
+
+static inline void _touch(mtd_cache_t *dev, mtd_cache_line_t *line)
+{
+    line->last_use = ++dev->use_count;
+}
+
+static inline bool _is_dirty(const mtd_cache_line_t *line)
+{
+    return line->dirty_end > line->dirty_start;
+}
+
+static mtd_cache_line_t *_find(mtd_cache_t *dev, uint32_t line_addr)
+{
+    for (unsigned i = 0; i < dev->lines_numof; i++) {
+        if (dev->lines[i].valid && (dev->lines[i].addr == line_addr)) {
+            return &dev->lines[i];
+        }
+    }
+    return NULL;
+}
+
+static int _writeback(mtd_cache_t *dev, mtd_cache_line_t *line)
+{
+    uint32_t page_size = dev->base.page_size;
+    /* write back whole pages so devices without NOR semantics (e.g. SD cards)
+     * do not have to read-modify-write */
+    uint32_t off = line->dirty_start - (line->dirty_start % page_size);
+    uint32_t end = line->dirty_end;
+
+    if (!_is_dirty(line)) {
+        return 0;
+    }
+    end += (page_size - (end % page_size)) % page_size;
+    if (end > _line_len(dev, line->addr)) {
+        end = _line_len(dev, line->addr);
+    }
+    DEBUG("mtd_cache: write back 0x%" PRIx32 " - 0x%" PRIx32 "\n",
+          line->addr + off, line->addr + end);
+    while (off < end) {
+        int res = mtd_write(dev->mtd, _line_buf(dev, line) + off,
+                            line->addr + off, page_size);
+
+        dev->stats.bus_writes++;
+        if (res < 0) {
+            return res;
+        }
+        off += page_size;
+    }
+    line->dirty_start = 0;
+    line->dirty_end = 0;
+    return 0;
+}
+
+static mtd_cache_line_t *_victim(mtd_cache_t *dev)
+{
+    mtd_cache_line_t *victim = &dev->lines[0];
+
+    for (unsigned i = 0; i < dev->lines_numof; i++) {
+        mtd_cache_line_t *line = &dev->lines[i];
+
+        if (!line->valid) {
+            return line;
+        }
+        /* difference is robust to overflows of use_count */
+        if ((uint32_t)(dev->use_count - line->last_use) >
+            (uint32_t)(dev->use_count - victim->last_use)) {
+            victim = line;
+        }
+    }
+    return victim;
+}
+
+/* assigns a line to line_addr and fills it if fill is set */
+static int _alloc(mtd_cache_t *dev, uint32_t line_addr, bool fill,
+                  mtd_cache_line_t **out)
+{
+    mtd_cache_line_t *line = _victim(dev);
+    int res;
+
+    if (line->valid && ((res = _writeback(dev, line)) < 0)) {
+        return res;
+    }
+    line->valid = false;
+    if (fill) {
+        res = mtd_read(dev->mtd, _line_buf(dev, line), line_addr,
+                       _line_len(dev, line_addr));
+        dev->stats.bus_reads++;
+        if (res < 0) {
+            return res;
+        }
+    }
+    line->addr = line_addr;
+    line->dirty_start = 0;
+    line->dirty_end = 0;
+    line->valid = true;
+    *out = line;
+    return 0;
+}
+
+static int mtd_cache_init(mtd_dev_t *mtd)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    int res = mtd_init(dev->mtd);
+
+    DEBUG("mtd_cache_init\n");
+    if (res < 0) {
+        return res;
+    }
+    mtd->sector_count = dev->mtd->sector_count;
+    mtd->pages_per_sector = dev->mtd->pages_per_sector;
+    mtd->page_size = dev->mtd->page_size;
+    if (dev->line_pages == 0) {
+        dev->line_pages = 1;
+    }
+    dev->line_size = dev->line_pages * mtd->page_size;
+    dev->lines_numof = (dev->line_size == 0) ? 0 : dev->buf_size / dev->line_size;
+    if (dev->lines_numof > MTD_CACHE_LINES_MAX) {
+        dev->lines_numof = MTD_CACHE_LINES_MAX;
+    }
+    if (dev->lines_numof == 0) {
+        return -ENOMEM;
+    }
+    memset(dev->lines, 0, sizeof(dev->lines));
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->use_count = 0;
+    mutex_init(&dev->lock);
+    return 0;
+}
+
+static int mtd_cache_read(mtd_dev_t *mtd, void *dest, uint32_t addr,
+                          uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    uint8_t *out = dest;
+    uint32_t total = size;
+    int res = 0;
+
+    DEBUG("mtd_cache_read: addr:0x%" PRIx32 " size:%" PRIu32 "\n", addr, size);
+    if ((addr + size) > _dev_size(dev)) {
+        return -EOVERFLOW;
+    }
+    mutex_lock(&dev->lock);
+    while (size > 0) {
+        uint32_t off = addr % dev->line_size;
+        uint32_t line_addr = addr - off;
+        uint32_t line_len = _line_len(dev, line_addr);
+        uint32_t len = line_len - off;
+        mtd_cache_line_t *line = _find(dev, line_addr);
+
+        if (len > size) {
+            len = size;
+        }
+        if (line) {
+            dev->stats.read_hits++;
+        }
+        else if (len == line_len) {
+            /* read whole uncached lines directly and in one go, it would only
+             * evict lines that are more likely to be used again */
+            while ((len < size) && (_find(dev, addr + len) == NULL) &&
+                   ((size - len) >= _line_len(dev, addr + len))) {
+                len += _line_len(dev, addr + len);
+            }
+            dev->stats.read_misses++;
+            dev->stats.bus_reads++;
+            if ((res = mtd_read(dev->mtd, out, addr, len)) < 0) {
+                break;
+            }
+            out += len;
+            addr += len;
+            size -= len;
+            continue;
+        }
+        else {
+            dev->stats.read_misses++;
+            if ((res = _alloc(dev, line_addr, true, &line)) < 0) {
+                break;
+            }
+        }
+        memcpy(out, _line_buf(dev, line) + off, len);
+        _touch(dev, line);
+        out += len;
+        addr += len;
+        size -= len;
+    }
+    mutex_unlock(&dev->lock);
+    return (res < 0) ? res : (int)total;
+}
+
+static int mtd_cache_write(mtd_dev_t *mtd, const void *src, uint32_t addr,
+                           uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    const uint8_t *in = src;
+    uint32_t total = size;
+    int res = 0;
+
+    DEBUG("mtd_cache_write: addr:0x%" PRIx32 " size:%" PRIu32 "\n", addr, size);
+    if ((addr + size) > _dev_size(dev)) {
+        return -EOVERFLOW;
+    }
+    mutex_lock(&dev->lock);
+    while (size > 0) {
+        uint32_t off = addr % dev->line_size;
+        uint32_t line_addr = addr - off;
+        uint32_t len = _line_len(dev, line_addr) - off;
+        mtd_cache_line_t *line = _find(dev, line_addr);
+        uint8_t *buf;
+
+        if (len > size) {
+            len = size;
+        }
+        if (line) {
+            dev->stats.write_hits++;
+        }
+        else {
+            /* old content is only needed if the line is not overwritten
+             * completely or if the written data is combined with it */
+            bool fill = dev->nor_flash || (len != _line_len(dev, line_addr));
+
+            dev->stats.write_misses++;
+            if ((res = _alloc(dev, line_addr, fill, &line)) < 0) {
+                break;
+            }
+        }
+        buf = _line_buf(dev, line) + off;
+        if (dev->nor_flash) {
+            for (uint32_t i = 0; i < len; i++) {
+                buf[i] &= in[i];
+            }
+        }
+        else {
+            memcpy(buf, in, len);
+        }
+        if (!_is_dirty(line)) {
+            line->dirty_start = off;
+            line->dirty_end = off + len;
+        }
+        else {
+            if (off < line->dirty_start) {
+                line->dirty_start = off;
+            }
+            if ((off + len) > line->dirty_end) {
+                line->dirty_end = off + len;
+            }
+        }
+        _touch(dev, line);
+        in += len;
+        addr += len;
+        size -= len;
+    }
+    mutex_unlock(&dev->lock);
+    return (res < 0) ? res : (int)total;
+}
+
+static int mtd_cache_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    int res = 0;
+
+    DEBUG("mtd_cache_erase: addr:0x%" PRIx32 " size:%" PRIu32 "\n", addr, size);
+    mutex_lock(&dev->lock);
+    for (unsigned i = 0; i < dev->lines_numof; i++) {
+        mtd_cache_line_t *line = &dev->lines[i];
+
+        if (!line->valid || (line->addr >= (addr + size)) ||
+            ((line->addr + dev->line_size) <= addr)) {
+            continue;
+        }
+        if (((line->addr + line->dirty_start) >= addr) &&
+            ((line->addr + line->dirty_end) <= (addr + size))) {
+            /* pending data would be erased anyway */
+            line->dirty_start = 0;
+            line->dirty_end = 0;
+        }
+        else if ((res = _writeback(dev, line)) < 0) {
+            goto out;
+        }
+        if (dev->nor_flash) {
+            uint32_t start = (addr > line->addr) ? addr - line->addr : 0;
+            uint32_t end = (addr + size) - line->addr;
+
+            if (end > dev->line_size) {
+                end = dev->line_size;
+            }
+            memset(_line_buf(dev, line) + start, 0xff, end - start);
+        }
+        else {
+            line->valid = false;
+        }
+    }
+    dev->stats.bus_erases++;
+    res = mtd_erase(dev->mtd, addr, size);
+    if ((res < 0) && dev->nor_flash) {
+        /* state of the erased range is unknown now */
+        for (unsigned i = 0; i < dev->lines_numof; i++) {
+            mtd_cache_line_t *line = &dev->lines[i];
+
+            if ((line->addr < (addr + size)) &&
+                ((line->addr + dev->line_size) > addr)) {
+                line->valid = false;
+            }
+        }
+    }
+
+out:
+    mutex_unlock(&dev->lock);
+    return res;
+}
+
+static int mtd_cache_power(mtd_dev_t *mtd, enum mtd_power_state power)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+
+    if (power == MTD_POWER_DOWN) {
+        int res = mtd_cache_sync(dev);
+
+        if (res < 0) {
+            return res;
+        }
+    }
+    return mtd_power(dev->mtd, power);
+}
+
+int mtd_cache_sync(mtd_cache_t *dev)
+{
+    int res = 0;
+
+    mutex_lock(&dev->lock);
+    for (unsigned i = 0; i < dev->lines_numof; i++) {
+        if (dev->lines[i].valid &&
+            ((res = _writeback(dev, &dev->lines[i])) < 0)) {
+            break;
+        }
+    }
+    mutex_unlock(&dev->lock);
+    return res;
+}
+
+int mtd_cache_invalidate(mtd_cache_t *dev)
+{
+    int res = mtd_cache_sync(dev);
+
+    if (res == 0) {
+        mutex_lock(&dev->lock);
+        for (unsigned i = 0; i < dev->lines_numof; i++) {
+            dev->lines[i].valid = false;
+        }
+        mutex_unlock(&dev->lock);
+    }
+    return res;
+}
+
+void mtd_cache_stats_reset(mtd_cache_t *dev)
+{
+    mutex_lock(&dev->lock);
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    mutex_unlock(&dev->lock);
+}
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     pkg_tlsf_malloc
+ * @{
+ *
+ * @file
+ * @brief       TLSF system allocator implementation
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "irq.h"
+#include "sched.h"
+#include "tlsf.h"
+#include "tlsf_malloc.h"
+
+#ifdef MODULE_NEWLIB
+#include <reent.h>
+#endif
+
+/* TLSF keeps the size of a block in the word in front of the payload, the
+ * two lowest bits of it are flags */
+#define BLOCK_SIZE_MASK     (~(size_t)0x3)
+
+/* TLSF expects the control structure and pools to be word aligned */
+#define POOL_ALIGN          (sizeof(uint32_t))
+
+static tlsf_malloc_stats_t _stats;
+static uint8_t _initialized;
+
+#ifndef MODULE_NEWLIB_SYSCALLS_DEFAULT
+static uint32_t _heap[TLSF_MALLOC_HEAP_SIZE / sizeof(uint32_t)];
+#endif
+
+#ifdef MODULE_TLSF_MALLOC_CACHE
+#define CACHE_MAX           (TLSF_MALLOC_CACHE_CLASSES * TLSF_MALLOC_CACHE_GRANULE)
+
+typedef struct {
+    void *head[TLSF_MALLOC_CACHE_CLASSES];
+    uint8_t num[TLSF_MALLOC_CACHE_CLASSES];
+} _cache_t;
+
+static _cache_t _caches[MAXTHREADS];
+#endif
+
+static inline size_t _block_size(void *ptr)
+{
+    return ((size_t *)ptr)[-1] & BLOCK_SIZE_MASK;
+}
+
+/* must be called with interrupts disabled */
+static void _init(void)
+{
+#ifdef MODULE_NEWLIB_SYSCALLS_DEFAULT
+    /* take everything sbrk() did not hand out yet */
+    extern char *heap_top;
+    extern char _eheap;
+    uintptr_t start = ((uintptr_t)heap_top + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+    void *mem = (void *)start;
+    size_t size = ((uintptr_t)&_eheap - start) & ~(POOL_ALIGN - 1);
+
+    heap_top = &_eheap;
+#else
+    void *mem = _heap;
+    size_t size = sizeof(_heap);
+#endif
+
+    tlsf_create_with_pool(mem, size);
+    _stats.size = size;
+    _initialized = 1;
+}
+
+/* must be called with interrupts disabled */
+static void _count_alloc(void *ptr, size_t size)
+{
+    if (ptr) {
+        _stats.used += _block_size(ptr);
+        if (_stats.used > _stats.max_used) {
+            _stats.max_used = _stats.used;
+        }
+        _stats.allocs++;
+    }
+    else if (size) {
+        _stats.failed++;
+    }
+}
+
+static void *_heap_alloc(size_t align, size_t size)
+{
+    unsigned state = irq_disable();
+
+    if (!_initialized) {
+        _init();
+    }
+    void *ptr = align ? tlsf_memalign(align, size) : tlsf_malloc(size);
+    _count_alloc(ptr, size);
+    irq_restore(state);
+    return ptr;
+}
+
+static void _heap_free(void *ptr)
+{
+    unsigned state = irq_disable();
+
+    _stats.used -= _block_size(ptr);
+    _stats.frees++;
+    tlsf_free(ptr);
+    irq_restore(state);
+}
+
+#ifdef MODULE_TLSF_MALLOC_CACHE
+static _cache_t *_cache(void)
+{
+    kernel_pid_t pid = sched_active_pid;
+
+    if (irq_is_in() || !pid_is_valid(pid)) {
+        return NULL;
+    }
+    return &_caches[pid - KERNEL_PID_FIRST];
+}
+
+/* only the owning thread changes a cache, so popping and pushing need no
+ * lock. Both leave the list intact at every step, so _cached() can walk it
+ * with interrupts disabled. */
+static void *_cache_alloc(_cache_t *cache, size_t size)
+{
+    unsigned cls = (size - 1) / TLSF_MALLOC_CACHE_GRANULE;
+    void *ptr = cache->head[cls];
+
+    if (ptr) {
+        cache->head[cls] = *(void **)ptr;
+        cache->num[cls]--;
+        return ptr;
+    }
+    size = (cls + 1) * TLSF_MALLOC_CACHE_GRANULE;
+    ptr = _heap_alloc(0, size);
+    if (!ptr) {
+        /* the blocks kept back by this thread may be what is missing */
+        tlsf_malloc_cache_flush();
+        ptr = _heap_alloc(0, size);
+    }
+    return ptr;
+}
+
+static int _cache_free(_cache_t *cache, void *ptr)
+{
+    size_t size = _block_size(ptr);
+
+    if ((size < TLSF_MALLOC_CACHE_GRANULE) ||
+        (size >= CACHE_MAX + TLSF_MALLOC_CACHE_GRANULE)) {
+        return 0;
+    }
+    /* a block goes to the largest class it can serve */
+    unsigned cls = size / TLSF_MALLOC_CACHE_GRANULE - 1;
+    if (cache->num[cls] >= TLSF_MALLOC_CACHE_DEPTH) {
+        return 0;
+    }
+    *(void **)ptr = cache->head[cls];
+    cache->head[cls] = ptr;
+    cache->num[cls]++;
+    return 1;
+}
+
+static size_t _cached(void)
+{
+    size_t bytes = 0;
+    unsigned state = irq_disable();
+
+    for (unsigned i = 0; i < MAXTHREADS; i++) {
+        for (unsigned cls = 0; cls < TLSF_MALLOC_CACHE_CLASSES; cls++) {
+            for (void *ptr = _caches[i].head[cls]; ptr; ptr = *(void **)ptr) {
+                bytes += _block_size(ptr);
+            }
+        }
+    }
+    irq_restore(state);
+    return bytes;
+}
+#endif
+
+void tlsf_malloc_cache_flush(void)
+{
+#ifdef MODULE_TLSF_MALLOC_CACHE
+    _cache_t *cache = _cache();
+
+    if (!cache) {
+        return;
+    }
+    for (unsigned cls = 0; cls < TLSF_MALLOC_CACHE_CLASSES; cls++) {
+        while (cache->head[cls]) {
+            void *ptr = cache->head[cls];
+            cache->head[cls] = *(void **)ptr;
+            cache->num[cls]--;
+            _heap_free(ptr);
+        }
+    }
+#endif
+}
+
+int tlsf_malloc_add_pool(void *mem, size_t size)
+{
+    unsigned state = irq_disable();
+
+    if (!_initialized) {
+        _init();
+    }
+    int res = tlsf_add_pool(mem, size);
+    if (res) {
+        _stats.size += size;
+    }
+    irq_restore(state);
+    return res ? 0 : -1;
+}
+
+void tlsf_malloc_get_stats(tlsf_malloc_stats_t *stats)
+{
+    unsigned state = irq_disable();
+
+    *stats = _stats;
+    irq_restore(state);
+#ifdef MODULE_TLSF_MALLOC_CACHE
+    stats->cached = _cached();
+#endif
+}
+
+void tlsf_malloc_print_stats(void)
+{
+    tlsf_malloc_stats_t stats;
+
+    tlsf_malloc_get_stats(&stats);
+    printf("%8s %8s %8s %8s %8s %8s %6s\n",
+           "size", "used", "max", "cached", "allocs", "frees", "failed");
+    printf("%8u %8u %8u %8u %8u %8u %6u\n",
+           (unsigned)stats.size, (unsigned)stats.used,
+           (unsigned)stats.max_used, (unsigned)stats.cached,
+           stats.allocs, stats.frees, stats.failed);
+}
+
+void *malloc(size_t size)
+{
+    void *ptr;
+
+#ifdef MODULE_TLSF_MALLOC_CACHE
+    _cache_t *cache;
+    if (size && (size <= CACHE_MAX) && (cache = _cache())) {
+        ptr = _cache_alloc(cache, size);
+    }
+    else
+#endif
+    {
+        ptr = _heap_alloc(0, size);
+    }
+    if (!ptr && size) {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void *memalign(size_t align, size_t size)
+{
+    void *ptr = _heap_alloc(align, size);
+
+    if (!ptr && size) {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    if (size && (count > SIZE_MAX / size)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *ptr = malloc(count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+#ifdef MODULE_TLSF_MALLOC_CACHE
+    _cache_t *cache = _cache();
+    if (cache && _cache_free(cache, ptr)) {
+        return;
+    }
+#endif
+    _heap_free(ptr);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return malloc(size);
+    }
+    if (!size) {
+        free(ptr);
+        return NULL;
+    }
+
+    unsigned state = irq_disable();
+    size_t old_size = _block_size(ptr);
+    void *res = tlsf_realloc(ptr, size);
+    if (res) {
+        _stats.used -= old_size;
+        _stats.allocs--;
+        _count_alloc(res, size);
+    }
+    else {
+        _stats.failed++;
+    }
+    irq_restore(state);
+
+    if (!res) {
+        errno = ENOMEM;
+    }
+    return res;
+}
+
+#ifdef MODULE_NEWLIB
+/* newlib calls these internally, e.g. for the buffers of stdio */
+void *_malloc_r(struct _reent *r, size_t size)
+{
+    (void)r;
+    return malloc(size);
+}
+
+void *_memalign_r(struct _reent *r, size_t align, size_t size)
+{
+    (void)r;
+    return memalign(align, size);
+}
+
+void *_calloc_r(struct _reent *r, size_t count, size_t size)
+{
+    (void)r;
+    return calloc(count, size);
+}
+
+void _free_r(struct _reent *r, void *ptr)
+{
+    (void)r;
+    free(ptr);
+}
+
+void *_realloc_r(struct _reent *r, void *ptr, size_t size)
+{
+    (void)r;
+    return realloc(ptr, size);
+}
+#endif
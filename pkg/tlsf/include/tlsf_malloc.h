@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    pkg_tlsf_malloc TLSF system allocator
+ * @ingroup     pkg
+ * @brief       malloc() and friends on top of the TLSF allocator
+ *
+ * The `tlsf_malloc` module replaces the allocator of the C library by the
+ * two-level segregated fit allocator of the `tlsf` package. Allocation and
+ * release take constant time, and memory is returned to the heap when it is
+ * freed, unlike with @ref oneway_malloc.
+ *
+ * malloc(), calloc(), realloc(), memalign() and free() are provided, with
+ * newlib also their reentrant variants, so the allocations of the C library
+ * itself are served from the same heap. The heap is set up on the first
+ * allocation: with the default newlib system calls it takes the memory that
+ * sbrk() did not hand out yet, otherwise a static array of
+ * @ref TLSF_MALLOC_HEAP_SIZE bytes. More memory can be added with
+ * tlsf_malloc_add_pool(). Do not call tlsf_create_with_pool() when using this
+ * module.
+ *
+ * The heap is locked by disabling interrupts. As TLSF needs a bounded number
+ * of steps for each operation, the time interrupts are disabled is bounded
+ * as well, and the functions can be called from interrupt context.
+ *
+ * With the `tlsf_malloc_cache` module, every thread keeps up to
+ * @ref TLSF_MALLOC_CACHE_DEPTH freed blocks of each of
+ * @ref TLSF_MALLOC_CACHE_CLASSES small size classes. A thread takes small
+ * blocks from its own cache without locking the heap and without searching,
+ * splitting and merging blocks. Only the owning thread touches a cache,
+ * interrupt handlers always use the heap. The caches take
+ * `MAXTHREADS * TLSF_MALLOC_CACHE_CLASSES * (sizeof(void *) + 1)` bytes of
+ * RAM, and hold back memory from other threads: call
+ * tlsf_malloc_cache_flush() when a thread is done allocating.
+ *
+ * @{
+ *
+ * @file
+ * @brief       TLSF system allocator interface
+ */
+
+#ifndef TLSF_MALLOC_H
+#define TLSF_MALLOC_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Size of the static heap in bytes, used when the platform does not
+ *          provide a heap via sbrk()
+ */
+#ifndef TLSF_MALLOC_HEAP_SIZE
+#define TLSF_MALLOC_HEAP_SIZE       (8192U)
+#endif
+
+/**
+ * @brief   Size difference of two cache size classes in bytes
+ */
+#ifndef TLSF_MALLOC_CACHE_GRANULE
+#define TLSF_MALLOC_CACHE_GRANULE   (16U)
+#endif
+
+/**
+ * @brief   Number of cache size classes
+ *
+ * Requests up to `TLSF_MALLOC_CACHE_CLASSES * TLSF_MALLOC_CACHE_GRANULE`
+ * bytes are served from the per-thread caches.
+ */
+#ifndef TLSF_MALLOC_CACHE_CLASSES
+#define TLSF_MALLOC_CACHE_CLASSES   (4U)
+#endif
+
+/**
+ * @brief   Maximum number of blocks a thread caches per size class
+ */
+#ifndef TLSF_MALLOC_CACHE_DEPTH
+#define TLSF_MALLOC_CACHE_DEPTH     (4U)
+#endif
+
+/**
+ * @brief   Heap statistics
+ */
+typedef struct {
+    size_t size;        /**< heap size in bytes, including TLSF structures */
+    size_t used;        /**< bytes in allocated blocks, including cached ones */
+    size_t max_used;    /**< maximum of @p used */
+    size_t cached;      /**< bytes in the per-thread caches */
+    unsigned allocs;    /**< blocks taken from the heap */
+    unsigned frees;     /**< blocks returned to the heap */
+    unsigned failed;    /**< failed allocations */
+} tlsf_malloc_stats_t;
+
+/**
+ * @brief   Add memory to the heap
+ *
+ * @param[in] mem       memory to add, aligned to 4 bytes
+ * @param[in] size      size of @p mem in bytes
+ *
+ * @return  0 on success
+ * @return  -1 if @p size is too small or too large for a TLSF pool
+ */
+int tlsf_malloc_add_pool(void *mem, size_t size);
+
+/**
+ * @brief   Get the heap statistics
+ *
+ * @param[out] stats    statistics
+ */
+void tlsf_malloc_get_stats(tlsf_malloc_stats_t *stats);
+
+/**
+ * @brief   Print the heap statistics
+ */
+void tlsf_malloc_print_stats(void);
+
+/**
+ * @brief   Return the blocks in the cache of the calling thread to the heap
+ *
+ * Does nothing without the `tlsf_malloc_cache` module or when called from
+ * interrupt context.
+ */
+void tlsf_malloc_cache_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TLSF_MALLOC_H */
+/** @} */
@@ -15,15 +15,11 @@
 
 void randombytes(uint8_t *target, uint64_t n)
 {
-    uint32_t random;
-    uint8_t *random_pos = (uint8_t*)&random;
-    unsigned _n = 0;
+    while (n) {
+        size_t chunk = (n > SIZE_MAX) ? SIZE_MAX : (size_t)n;
 
-    while (n--) {
-        if (! (_n++ & 0x3)) {
-            random = random_uint32();
-            random_pos = (uint8_t *) &random;
-        }
-        *target++ = *random_pos++;
+        random_bytes(target, chunk);
+        target += chunk;
+        n -= chunk;
     }
 }
@@ -32,6 +32,18 @@
 #include "xtimer.h"
 #endif
 
+#ifdef MODULE_LOG_DEFERRED
+#include "log.h"
+#endif
+
+#ifdef MODULE_EVENT_THREAD
+#include "event/thread.h"
+#endif
+
+#ifdef MODULE_WORKQ
+#include "workq.h"
+#endif
+
 #ifdef MODULE_RTC
 #include "periph/rtc.h"
 #endif
@@ -105,6 +117,18 @@ void auto_init(void)
     DEBUG("Auto init xtimer module.\n");
     xtimer_init();
 #endif
+#ifdef MODULE_LOG_DEFERRED
+    DEBUG("Auto init log_deferred module.\n");
+    log_deferred_init();
+#endif
+#ifdef MODULE_EVENT_THREAD
+    DEBUG("Auto init event_thread module.\n");
+    event_thread_init();
+#endif
+#ifdef MODULE_WORKQ
+    DEBUG("Auto init workq module.\n");
+    workq_init();
+#endif
 #ifdef MODULE_RTC
     DEBUG("Auto init rtc module.\n");
     rtc_init();
@@ -28,7 +28,9 @@
 #include "net/gnrc/netdev/eth.h"
 #endif
 
+#ifndef TAP_MAC_STACKSIZE
 #define TAP_MAC_STACKSIZE           (THREAD_STACKSIZE_DEFAULT + DEBUG_EXTRA_STACKSIZE)
+#endif
 #ifdef MODULE_GNRC_NETIF2
 #define TAP_MAC_PRIO                (GNRC_NETIF2_PRIO)
 #else
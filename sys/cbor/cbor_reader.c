@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_cbor
+ * @{
+ *
+ * @file
+ * @brief       Streaming CBOR reader
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include "cbor.h"
+
+/* major types */
+#define MT_UINT         (0U)
+#define MT_NEGINT       (1U)
+#define MT_BYTES        (2U)
+#define MT_TEXT         (3U)
+#define MT_ARRAY        (4U)
+#define MT_MAP          (5U)
+#define MT_TAG          (6U)
+#define MT_7            (7U)
+
+#define AI_MASK         (0x1fU)
+#define AI_FLOAT16      (25U)
+#define AI_FLOAT64      (27U)
+#define AI_INDEFINITE   (31U)
+
+#define IB_FLOAT16      (0xf9U)
+#define IB_FLOAT32      (0xfaU)
+#define IB_FLOAT64      (0xfbU)
+#define IB_BREAK        (0xffU)
+
+static const cbor_item_type_t _types[] = {
+    CBOR_ITEM_UINT, CBOR_ITEM_NEGINT, CBOR_ITEM_BYTES, CBOR_ITEM_TEXT,
+    CBOR_ITEM_ARRAY, CBOR_ITEM_MAP, CBOR_ITEM_TAG, CBOR_ITEM_SIMPLE,
+};
+
+void cbor_reader_init(cbor_reader_t *reader)
+{
+    memset(reader, 0, sizeof(*reader));
+}
+
+void cbor_reader_feed(cbor_reader_t *reader, const void *buf, size_t len)
+{
+    reader->buf = buf;
+    reader->len = len;
+    reader->pos = 0;
+}
+
+/**
+ * Returns the number of bytes following the initial byte, -1 if the
+ * additional info @p ai is reserved
+ */
+static int _follow(unsigned ai)
+{
+    if (ai < 24) {
+        return 0;
+    }
+    if (ai <= AI_FLOAT64) {
+        return 1 << (ai - 24);
+    }
+    return (ai == AI_INDEFINITE) ? 0 : -1;
+}
+
+/**
+ * Parses the item head at the read position without consuming it
+ *
+ * A head that is cut by the end of the chunk is moved to reader->head and
+ * completed from the next chunk.
+ *
+ * @return number of bytes of the chunk to consume with _consume()
+ */
+static int _peek(cbor_reader_t *r, uint8_t *ib, uint64_t *arg)
+{
+    size_t avail = r->len - r->pos;
+    unsigned have = r->head_len;
+    const uint8_t *p;
+    unsigned need;
+    int follow;
+
+    if (have) {
+        p = r->head;
+    }
+    else if (avail) {
+        p = &r->buf[r->pos];
+    }
+    else {
+        return -EAGAIN;
+    }
+    if ((follow = _follow(p[0] & AI_MASK)) < 0) {
+        return -EBADMSG;
+    }
+    need = 1 + follow;
+    if (have + avail < need) {
+        memcpy(&r->head[have], &r->buf[r->pos], avail);
+        r->head_len += avail;
+        r->pos = r->len;
+        return -EAGAIN;
+    }
+    if (have) {
+        memcpy(&r->head[have], &r->buf[r->pos], need - have);
+    }
+    *ib = p[0];
+    if (follow) {
+        uint64_t val = 0;
+        for (unsigned i = 1; i < need; i++) {
+            val = (val << 8) | p[i];
+        }
+        *arg = val;
+    }
+    else {
+        *arg = p[0] & AI_MASK;
+    }
+    return need - have;
+}
+
+static inline void _consume(cbor_reader_t *r, unsigned n)
+{
+    r->pos += n;
+    r->head_len = 0;
+}
+
+/**
+ * Skips unread string data
+ */
+static int _skip_data(cbor_reader_t *r)
+{
+    while (r->data_left) {
+        size_t n = r->len - r->pos;
+        if (!n) {
+            return -EAGAIN;
+        }
+        if (n > r->data_left) {
+            n = r->data_left;
+        }
+        r->pos += n;
+        r->data_left -= n;
+    }
+    return 0;
+}
+
+/**
+ * Skips unread string data and leaves finished definite length levels
+ */
+static int _drain(cbor_reader_t *r)
+{
+    int res = _skip_data(r);
+
+    if (res < 0) {
+        return res;
+    }
+    while (r->depth && !r->remaining[r->depth - 1]) {
+        r->depth--;
+    }
+    return 0;
+}
+
+/**
+ * Counts an item of the current level
+ */
+static inline void _count(cbor_reader_t *r)
+{
+    if (r->depth && (r->remaining[r->depth - 1] != CBOR_READER_INDEFINITE)) {
+        r->remaining[r->depth - 1]--;
+    }
+}
+
+int cbor_reader_next(cbor_reader_t *reader, cbor_item_t *item)
+{
+    uint8_t ib;
+    uint64_t arg;
+    unsigned mt;
+    bool indefinite, push;
+    int res;
+
+    if (((res = _drain(reader)) < 0) ||
+        ((res = _peek(reader, &ib, &arg)) < 0)) {
+        return res;
+    }
+    memset(item, 0, sizeof(*item));
+    if (ib == IB_BREAK) {
+        if (!reader->depth ||
+            (reader->remaining[reader->depth - 1] != CBOR_READER_INDEFINITE)) {
+            return -EBADMSG;
+        }
+        _consume(reader, res);
+        reader->depth--;
+        reader->last_depth = reader->depth;
+        item->type = CBOR_ITEM_BREAK;
+        item->depth = reader->depth;
+        return 0;
+    }
+
+    mt = ib >> 5;
+    indefinite = ((ib & AI_MASK) == AI_INDEFINITE);
+    if (indefinite && ((mt < MT_BYTES) || (mt > MT_MAP))) {
+        return -EBADMSG;
+    }
+    /* chunks of an indefinite length string are definite strings of the
+     * same type */
+    if (reader->depth && (reader->types[reader->depth - 1] <= MT_TEXT) &&
+        ((reader->types[reader->depth - 1] != mt) || indefinite)) {
+        return -EBADMSG;
+    }
+    if (((mt == MT_ARRAY) || (mt == MT_MAP)) && !indefinite &&
+        (arg > INT32_MAX)) {
+        return -EBADMSG;
+    }
+    push = indefinite || (mt == MT_ARRAY) || (mt == MT_MAP);
+    if (push && (reader->depth == CBOR_READER_DEPTH_MAX)) {
+        return -EOVERFLOW;
+    }
+
+    _consume(reader, res);
+    if (mt != MT_TAG) {
+        _count(reader);
+    }
+    item->type = _types[mt];
+    item->depth = reader->depth;
+    item->indefinite = indefinite;
+    item->val = indefinite ? 0 : arg;
+    reader->last_depth = reader->depth;
+    if ((mt == MT_7) && ((ib & AI_MASK) >= AI_FLOAT16)) {
+        item->type = CBOR_ITEM_FLOAT;
+        item->size = _follow(ib & AI_MASK);
+    }
+
+    if (push) {
+        reader->types[reader->depth] = mt;
+        if (indefinite) {
+            reader->remaining[reader->depth] = CBOR_READER_INDEFINITE;
+        }
+        else {
+            reader->remaining[reader->depth] = (mt == MT_MAP) ? 2 * arg : arg;
+        }
+        reader->depth++;
+    }
+    else if ((mt == MT_BYTES) || (mt == MT_TEXT)) {
+        reader->data_left = arg;
+    }
+    return 0;
+}
+
+int cbor_reader_data(cbor_reader_t *reader, const uint8_t **data)
+{
+    size_t n = reader->len - reader->pos;
+
+    if (!reader->data_left) {
+        return 0;
+    }
+    if (!n) {
+        return -EAGAIN;
+    }
+    if (n > reader->data_left) {
+        n = reader->data_left;
+    }
+    if (n > INT_MAX) {
+        n = INT_MAX;
+    }
+    *data = &reader->buf[reader->pos];
+    reader->pos += n;
+    reader->data_left -= n;
+    return n;
+}
+
+int cbor_reader_skip(cbor_reader_t *reader)
+{
+    uint8_t depth = reader->last_depth;
+    cbor_item_t item;
+    int res;
+
+    while (((res = _drain(reader)) == 0) && (reader->depth > depth)) {
+        if ((res = cbor_reader_next(reader, &item)) < 0) {
+            break;
+        }
+    }
+    /* keep the target depth for the next call after -EAGAIN */
+    reader->last_depth = depth;
+    return res;
+}
+
+/**
+ * Decodes integers of up to 32 bit that are completely in the chunk
+ *
+ * Anything else is left to the generic path.
+ */
+static size_t _int32_fast(cbor_reader_t *r, int32_t *vals, size_t n)
+{
+    const uint8_t *p = &r->buf[r->pos];
+    const uint8_t *end = &r->buf[r->len];
+    size_t count = 0;
+
+    if (r->head_len) {
+        return 0;
+    }
+    if (r->depth && (r->remaining[r->depth - 1] < n)) {
+        n = r->remaining[r->depth - 1];
+    }
+    while ((count < n) && (p < end)) {
+        uint8_t ib = *p;
+        unsigned ai = ib & AI_MASK;
+        uint32_t u = ai;
+
+        /* only major types 0 and 1 with up to four bytes following */
+        if ((ib & 0xc0) || (ai > 26)) {
+            break;
+        }
+        if (ai >= 24) {
+            unsigned follow = 1 << (ai - 24);
+            if ((size_t)(end - p) <= follow) {
+                break;
+            }
+            u = p[1];
+            for (unsigned i = 2; i <= follow; i++) {
+                u = (u << 8) | p[i];
+            }
+            if (u > INT32_MAX) {
+                break;
+            }
+            p += follow;
+        }
+        p++;
+        vals[count++] = (ib & 0x20) ? -1 - (int32_t)u : (int32_t)u;
+    }
+    r->pos = p - r->buf;
+    if (r->depth && (r->remaining[r->depth - 1] != CBOR_READER_INDEFINITE)) {
+        r->remaining[r->depth - 1] -= count;
+    }
+    return count;
+}
+
+int cbor_reader_int32_array(cbor_reader_t *reader, int32_t *vals, size_t n)
+{
+    size_t count = 0;
+    uint8_t ib;
+    uint64_t arg;
+    int res;
+
+    /* finished levels are kept to report the end of the container */
+    if ((res = _skip_data(reader)) < 0) {
+        return res;
+    }
+    while (count < n) {
+        count += _int32_fast(reader, &vals[count], n - count);
+        if (count == n) {
+            break;
+        }
+        if (reader->depth && !reader->remaining[reader->depth - 1]) {
+            res = 0;
+            break;
+        }
+        if ((res = _peek(reader, &ib, &arg)) < 0) {
+            break;
+        }
+        if (ib == IB_BREAK) {
+            res = 0;
+            break;
+        }
+        if (((ib >> 5) > MT_NEGINT) || ((ib & AI_MASK) == AI_INDEFINITE)) {
+            res = -EINVAL;
+            break;
+        }
+        if (arg > INT32_MAX) {
+            res = -ERANGE;
+            break;
+        }
+        _consume(reader, res);
+        _count(reader);
+        vals[count++] = ((ib >> 5) == MT_UINT) ? (int32_t)arg : -1 - (int32_t)arg;
+    }
+    reader->last_depth = reader->depth;
+    return count ? (int)count : res;
+}
+
+#ifdef MODULE_CBOR_FLOAT
+static float _half(uint16_t half)
+{
+    unsigned exp = (half >> 10) & 0x1f;
+    unsigned mant = half & 0x3ff;
+    float val;
+
+    if (exp == 0) {
+        val = ldexpf(mant, -24);
+    }
+    else if (exp != 31) {
+        val = ldexpf(mant + 1024, exp - 25);
+    }
+    else {
+        val = mant ? NAN : INFINITY;
+    }
+    return (half & 0x8000) ? -val : val;
+}
+
+static float _single(uint32_t bits)
+{
+    union {
+        uint32_t i;
+        float f;
+    } u = { .i = bits };
+    return u.f;
+}
+
+static double _double(uint64_t bits)
+{
+    union {
+        uint64_t i;
+        double d;
+    } u = { .i = bits };
+    return u.d;
+}
+
+double cbor_item_double(const cbor_item_t *item)
+{
+    switch (item->size) {
+        case 2:
+            return _half(item->val);
+        case 4:
+            return _single(item->val);
+        default:
+            return _double(item->val);
+    }
+}
+
+int cbor_reader_float_array(cbor_reader_t *reader, float *vals, size_t n)
+{
+    size_t count = 0;
+    uint8_t ib;
+    uint64_t arg;
+    int res;
+
+    if ((res = _skip_data(reader)) < 0) {
+        return res;
+    }
+    while (count < n) {
+        if (reader->depth && !reader->remaining[reader->depth - 1]) {
+            res = 0;
+            break;
+        }
+        if ((res = _peek(reader, &ib, &arg)) < 0) {
+            break;
+        }
+        if (ib == IB_BREAK) {
+            res = 0;
+            break;
+        }
+        if ((ib < IB_FLOAT16) || (ib > IB_FLOAT64)) {
+            res = -EINVAL;
+            break;
+        }
+        _consume(reader, res);
+        _count(reader);
+        if (ib == IB_FLOAT32) {
+            vals[count++] = _single(arg);
+        }
+        else if (ib == IB_FLOAT16) {
+            vals[count++] = _half(arg);
+        }
+        else {
+            vals[count++] = _double(arg);
+        }
+    }
+    reader->last_depth = reader->depth;
+    return count ? (int)count : res;
+}
+#endif /* MODULE_CBOR_FLOAT */
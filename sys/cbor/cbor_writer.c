@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_cbor
+ * @{
+ *
+ * @file
+ * @brief       Streaming CBOR writer
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "cbor.h"
+
+/* major types, shifted into place */
+#define MT_UINT         (0x00U)
+#define MT_NEGINT       (0x20U)
+#define MT_BYTES        (0x40U)
+#define MT_TEXT         (0x60U)
+#define MT_ARRAY        (0x80U)
+#define MT_MAP          (0xa0U)
+#define MT_TAG          (0xc0U)
+
+#define AI_UINT8        (24U)
+#define AI_INDEFINITE   (31U)
+
+#define IB_FALSE        (0xf4U)
+#define IB_TRUE         (0xf5U)
+#define IB_NULL         (0xf6U)
+#define IB_FLOAT32      (0xfaU)
+#define IB_FLOAT64      (0xfbU)
+#define IB_BREAK        (0xffU)
+
+void cbor_writer_init(cbor_writer_t *writer, void *buf, size_t size,
+                      cbor_writer_sink_t sink, void *arg)
+{
+    writer->buf = buf;
+    writer->size = size;
+    writer->pos = 0;
+    writer->total = 0;
+    writer->sink = sink;
+    writer->arg = arg;
+    writer->err = 0;
+}
+
+static int _flush(cbor_writer_t *w)
+{
+    int res;
+
+    if (w->pos) {
+        if ((res = w->sink(w->arg, w->buf, w->pos)) < 0) {
+            return w->err = res;
+        }
+        w->total += w->pos;
+        w->pos = 0;
+    }
+    return 0;
+}
+
+/**
+ * Makes room for @p n bytes in the buffer
+ */
+static int _reserve(cbor_writer_t *w, size_t n)
+{
+    if (w->err) {
+        return w->err;
+    }
+    if ((w->size - w->pos) >= n) {
+        return 0;
+    }
+    if (!w->sink || (n > w->size)) {
+        return w->err = -ENOBUFS;
+    }
+    return _flush(w);
+}
+
+static void _put_be(uint8_t *p, uint64_t val, unsigned n)
+{
+    while (n--) {
+        *p++ = val >> (8 * n);
+    }
+}
+
+static int _byte(cbor_writer_t *w, uint8_t b)
+{
+    int res;
+
+    if ((res = _reserve(w, 1)) < 0) {
+        return res;
+    }
+    w->buf[w->pos++] = b;
+    return 0;
+}
+
+static int _head(cbor_writer_t *w, uint8_t mt, uint64_t val)
+{
+    unsigned follow;
+    uint8_t ai;
+    int res;
+
+    if (val < AI_UINT8) {
+        ai = val;
+        follow = 0;
+    }
+    else if (val <= 0xff) {
+        ai = AI_UINT8;
+        follow = 1;
+    }
+    else if (val <= 0xffff) {
+        ai = AI_UINT8 + 1;
+        follow = 2;
+    }
+    else if (val <= 0xffffffff) {
+        ai = AI_UINT8 + 2;
+        follow = 4;
+    }
+    else {
+        ai = AI_UINT8 + 3;
+        follow = 8;
+    }
+    if ((res = _reserve(w, 1 + follow)) < 0) {
+        return res;
+    }
+    w->buf[w->pos] = mt | ai;
+    _put_be(&w->buf[w->pos + 1], val, follow);
+    w->pos += 1 + follow;
+    return 0;
+}
+
+static int _string(cbor_writer_t *w, uint8_t mt, const void *data, size_t len)
+{
+    int res;
+
+    if ((res = _head(w, mt, len)) < 0) {
+        return res;
+    }
+    if ((w->size - w->pos) >= len) {
+        memcpy(&w->buf[w->pos], data, len);
+        w->pos += len;
+        return 0;
+    }
+    if (!w->sink) {
+        return w->err = -ENOBUFS;
+    }
+    /* hand the data to the sink without copying it */
+    if ((res = _flush(w)) < 0) {
+        return res;
+    }
+    if ((res = w->sink(w->arg, data, len)) < 0) {
+        return w->err = res;
+    }
+    w->total += len;
+    return 0;
+}
+
+int cbor_writer_finish(cbor_writer_t *writer)
+{
+    if (writer->err) {
+        return writer->err;
+    }
+    if (!writer->sink) {
+        return writer->pos;
+    }
+    if (_flush(writer) < 0) {
+        return writer->err;
+    }
+    return writer->total;
+}
+
+int cbor_writer_uint(cbor_writer_t *writer, uint64_t val)
+{
+    return _head(writer, MT_UINT, val);
+}
+
+int cbor_writer_int(cbor_writer_t *writer, int64_t val)
+{
+    if (val < 0) {
+        return _head(writer, MT_NEGINT, -1 - val);
+    }
+    return _head(writer, MT_UINT, val);
+}
+
+int cbor_writer_bytes(cbor_writer_t *writer, const void *data, size_t len)
+{
+    return _string(writer, MT_BYTES, data, len);
+}
+
+int cbor_writer_text(cbor_writer_t *writer, const char *str, size_t len)
+{
+    return _string(writer, MT_TEXT, str, len);
+}
+
+int cbor_writer_array(cbor_writer_t *writer, size_t len)
+{
+    return _head(writer, MT_ARRAY, len);
+}
+
+int cbor_writer_array_indefinite(cbor_writer_t *writer)
+{
+    return _byte(writer, MT_ARRAY | AI_INDEFINITE);
+}
+
+int cbor_writer_map(cbor_writer_t *writer, size_t len)
+{
+    return _head(writer, MT_MAP, len);
+}
+
+int cbor_writer_map_indefinite(cbor_writer_t *writer)
+{
+    return _byte(writer, MT_MAP | AI_INDEFINITE);
+}
+
+int cbor_writer_break(cbor_writer_t *writer)
+{
+    return _byte(writer, IB_BREAK);
+}
+
+int cbor_writer_tag(cbor_writer_t *writer, uint64_t tag)
+{
+    return _head(writer, MT_TAG, tag);
+}
+
+int cbor_writer_bool(cbor_writer_t *writer, bool val)
+{
+    return _byte(writer, val ? IB_TRUE : IB_FALSE);
+}
+
+int cbor_writer_null(cbor_writer_t *writer)
+{
+    return _byte(writer, IB_NULL);
+}
+
+int cbor_writer_int32_array(cbor_writer_t *writer, const int32_t *vals,
+                            size_t n)
+{
+    int res = _head(writer, MT_ARRAY, n);
+
+    for (size_t i = 0; (res == 0) && (i < n); i++) {
+        /* an int32_t takes at most 5 bytes, so one check covers all cases */
+        if ((res = _reserve(writer, 5)) < 0) {
+            break;
+        }
+        uint8_t *p = &writer->buf[writer->pos];
+        uint8_t mt = MT_UINT;
+        uint32_t u = vals[i];
+        if (vals[i] < 0) {
+            mt = MT_NEGINT;
+            u = -1 - vals[i];
+        }
+        if (u < AI_UINT8) {
+            p[0] = mt | u;
+            writer->pos += 1;
+        }
+        else if (u <= 0xff) {
+            p[0] = mt | AI_UINT8;
+            p[1] = u;
+            writer->pos += 2;
+        }
+        else if (u <= 0xffff) {
+            p[0] = mt | (AI_UINT8 + 1);
+            _put_be(&p[1], u, 2);
+            writer->pos += 3;
+        }
+        else {
+            p[0] = mt | (AI_UINT8 + 2);
+            _put_be(&p[1], u, 4);
+            writer->pos += 5;
+        }
+    }
+    return res;
+}
+
+#ifdef MODULE_CBOR_FLOAT
+static uint32_t _single_bits(float val)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u = { .f = val };
+    return u.i;
+}
+
+int cbor_writer_float(cbor_writer_t *writer, float val)
+{
+    int res;
+
+    if ((res = _reserve(writer, 5)) < 0) {
+        return res;
+    }
+    writer->buf[writer->pos] = IB_FLOAT32;
+    _put_be(&writer->buf[writer->pos + 1], _single_bits(val), 4);
+    writer->pos += 5;
+    return 0;
+}
+
+int cbor_writer_double(cbor_writer_t *writer, double val)
+{
+    union {
+        double d;
+        uint64_t i;
+    } u = { .d = val };
+    int res;
+
+    if ((res = _reserve(writer, 9)) < 0) {
+        return res;
+    }
+    writer->buf[writer->pos] = IB_FLOAT64;
+    _put_be(&writer->buf[writer->pos + 1], u.i, 8);
+    writer->pos += 9;
+    return 0;
+}
+
+int cbor_writer_float_array(cbor_writer_t *writer, const float *vals,
+                            size_t n)
+{
+    int res = _head(writer, MT_ARRAY, n);
+
+    for (size_t i = 0; (res == 0) && (i < n); i++) {
+        res = cbor_writer_float(writer, vals[i]);
+    }
+    return res;
+}
+#endif /* MODULE_CBOR_FLOAT */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_event
+ * @{
+ *
+ * @file
+ * @brief       Event queue implementation
+ *
+ * @}
+ */
+
+#include "assert.h"
+#include "event.h"
+#include "irq.h"
+
+void event_queue_init(event_queue_t *queue)
+{
+    assert(queue);
+    queue->event_list.next = NULL;
+    queue->waiter = (thread_t *)sched_active_thread;
+}
+
+void event_queue_init_detached(event_queue_t *queue)
+{
+    assert(queue);
+    queue->event_list.next = NULL;
+    queue->waiter = NULL;
+}
+
+void event_queue_claim(event_queue_t *queue)
+{
+    assert(queue && (queue->waiter == NULL));
+    queue->waiter = (thread_t *)sched_active_thread;
+}
+
+void event_post(event_queue_t *queue, event_t *event)
+{
+    assert(queue && event && event->handler);
+
+    unsigned state = irq_disable();
+    if (event->list_node.next) {
+        /* queued already, its handler will run anyway */
+        irq_restore(state);
+        return;
+    }
+    clist_rpush(&queue->event_list, &event->list_node);
+    thread_t *waiter = queue->waiter;
+    irq_restore(state);
+
+    if (waiter) {
+        thread_flags_set(waiter, THREAD_FLAG_EVENT);
+    }
+}
+
+void event_cancel(event_queue_t *queue, event_t *event)
+{
+    assert(queue && event);
+
+    unsigned state = irq_disable();
+    if (event->list_node.next) {
+        clist_remove(&queue->event_list, &event->list_node);
+        event->list_node.next = NULL;
+    }
+    irq_restore(state);
+}
+
+event_t *event_get(event_queue_t *queue)
+{
+    assert(queue);
+
+    unsigned state = irq_disable();
+    event_t *event = (event_t *)clist_lpop(&queue->event_list);
+    if (event) {
+        /* cleared before interrupts are enabled again, so a post from an ISR
+         * cannot mistake the event for still being queued */
+        event->list_node.next = NULL;
+    }
+    irq_restore(state);
+    return event;
+}
+
+event_t *event_wait(event_queue_t *queue)
+{
+    assert(queue && (queue->waiter == sched_active_thread));
+
+    event_t *event;
+    while (!(event = event_get(queue))) {
+        thread_flags_wait_any(THREAD_FLAG_EVENT);
+    }
+    return event;
+}
@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_flashlog
+ * @{
+ *
+ * @file
+ * @brief       Flash record log implementation
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "flashlog.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define SECTOR_MAGIC    (0x474c4652U)   /* "RFLG" */
+#define LEN_ERASED      (0xffffU)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t erase_count;
+    uint32_t first_ts;
+} _sector_hdr_t;
+
+typedef struct {
+    uint16_t len;
+    uint16_t crc;       /* over len, ts and the payload */
+    uint32_t ts;
+} _rec_hdr_t;
+
+static inline uint32_t _rec_size(uint32_t len)
+{
+    return sizeof(_rec_hdr_t) + ((len + 3) & ~3U);
+}
+
+static inline uint32_t _sector_addr(const flashlog_t *log, uint32_t sector)
+{
+    return sector * log->sector_size;
+}
+
+static inline bool _page_dirty(const flashlog_t *log)
+{
+    return log->dirty_end > log->dirty_start;
+}
+
+static uint16_t _hdr_crc(const _rec_hdr_t *hdr)
+{
+    uint16_t crc = crc16_ccitt_calc((const uint8_t *)&hdr->len,
+                                    sizeof(hdr->len));
+
+    return crc16_ccitt_update(crc, (const uint8_t *)&hdr->ts, sizeof(hdr->ts));
+}
+
+static bool _is_erased(const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* programs the bytes added to the page buffer since the last call */
+static int _program(flashlog_t *log)
+{
+    int res;
+
+    if (!_page_dirty(log)) {
+        return 0;
+    }
+    DEBUG("flashlog: program 0x%" PRIx32 " - 0x%" PRIx32 "\n",
+          log->page_addr + log->dirty_start, log->page_addr + log->dirty_end);
+    res = mtd_write(log->mtd, log->page_buf + log->dirty_start,
+                    log->page_addr + log->dirty_start,
+                    log->dirty_end - log->dirty_start);
+    log->stats.page_programs++;
+    log->stats.bytes_programmed += log->dirty_end - log->dirty_start;
+    if (res < 0) {
+        return res;
+    }
+    log->dirty_start = 0;
+    log->dirty_end = 0;
+    return 0;
+}
+
+/* appends data at the write position through the page buffer */
+static int _put(flashlog_t *log, const void *data, uint32_t len)
+{
+    uint32_t page_size = log->mtd->page_size;
+    const uint8_t *in = data;
+
+    while (len > 0) {
+        uint32_t addr = _sector_addr(log, log->head) + log->offset;
+        uint32_t off = addr % page_size;
+        uint32_t n = page_size - off;
+        int res;
+
+        if ((addr - off) != log->page_addr) {
+            if ((res = _program(log)) < 0) {
+                return res;
+            }
+            /* writes are sequential, so a new page is always erased */
+            log->page_addr = addr - off;
+            memset(log->page_buf, 0xff, page_size);
+        }
+        if (n > len) {
+            n = len;
+        }
+        if (in) {
+            memcpy(log->page_buf + off, in, n);
+            if (!_page_dirty(log)) {
+                log->dirty_start = off;
+            }
+            log->dirty_end = off + n;
+            in += n;
+        }
+        log->offset += n;
+        len -= n;
+        if (((off + n) == page_size) && ((res = _program(log)) < 0)) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+/* reads from the device, with data that is not programmed yet taken from
+ * the page buffer */
+static int _read(flashlog_t *log, uint32_t addr, void *dest, uint32_t len)
+{
+    uint32_t page_end = log->page_addr + log->mtd->page_size;
+    uint8_t *out = dest;
+
+    if ((addr >= log->page_addr) && ((addr + len) <= page_end)) {
+        memcpy(out, log->page_buf + (addr - log->page_addr), len);
+        return 0;
+    }
+    int res = mtd_read(log->mtd, out, addr, len);
+    if (res < 0) {
+        return res;
+    }
+    if (_page_dirty(log) && (addr < page_end) &&
+        ((addr + len) > log->page_addr)) {
+        uint32_t start = (addr > log->page_addr) ? addr : log->page_addr;
+        uint32_t end = ((addr + len) < page_end) ? (addr + len) : page_end;
+
+        memcpy(out + (start - addr), log->page_buf + (start - log->page_addr),
+               end - start);
+    }
+    return 0;
+}
+
+/* erases the sector following the head and makes it the new head */
+static int _open_sector(flashlog_t *log, uint32_t ts)
+{
+    uint32_t next = log->empty ? 0 : (log->head + 1) % log->mtd->sector_count;
+    flashlog_sector_t *sector = &log->sectors[next];
+    _sector_hdr_t hdr;
+    int res;
+
+    if ((res = _program(log)) < 0) {
+        return res;
+    }
+    DEBUG("flashlog: open sector %" PRIu32 "\n", next);
+    sector->used = false;
+    res = mtd_erase(log->mtd, _sector_addr(log, next), log->sector_size);
+    log->stats.sector_erases++;
+    sector->erase_count++;
+    if (res < 0) {
+        return res;
+    }
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = ++log->seq;
+    hdr.erase_count = sector->erase_count;
+    hdr.first_ts = ts;
+    log->head = next;
+    log->offset = 0;
+    log->empty = false;
+    if ((res = _put(log, &hdr, sizeof(hdr))) < 0) {
+        return res;
+    }
+    sector->seq = hdr.seq;
+    sector->first_ts = ts;
+    sector->used = true;
+    return 0;
+}
+
+/* finds the end of the records in the head sector */
+static int _scan_head(flashlog_t *log)
+{
+    uint32_t base = _sector_addr(log, log->head);
+    uint32_t page_size = log->mtd->page_size;
+    uint32_t offset = sizeof(_sector_hdr_t);
+    int res;
+
+    log->last_ts = log->sectors[log->head].first_ts;
+    while ((offset + sizeof(_rec_hdr_t)) <= log->sector_size) {
+        _rec_hdr_t hdr;
+
+        if ((res = mtd_read(log->mtd, &hdr, base + offset, sizeof(hdr))) < 0) {
+            return res;
+        }
+        if (_is_erased(&hdr, sizeof(hdr))) {
+            break;
+        }
+        if ((hdr.len == LEN_ERASED) ||
+            ((offset + _rec_size(hdr.len)) > log->sector_size)) {
+            /* a record header was cut by a power failure, do not append to
+             * this sector anymore */
+            DEBUG("flashlog: damaged record at 0x%" PRIx32 "\n", base + offset);
+            offset = log->sector_size;
+            break;
+        }
+        uint16_t crc = _hdr_crc(&hdr);
+        for (uint32_t pos = 0; pos < hdr.len; ) {
+            uint32_t n = hdr.len - pos;
+
+            if (n > page_size) {
+                n = page_size;
+            }
+            res = mtd_read(log->mtd, log->page_buf,
+                           base + offset + sizeof(hdr) + pos, n);
+            if (res < 0) {
+                return res;
+            }
+            crc = crc16_ccitt_update(crc, log->page_buf, n);
+            pos += n;
+        }
+        if (crc == hdr.crc) {
+            log->last_ts = hdr.ts;
+        }
+        offset += _rec_size(hdr.len);
+    }
+    log->offset = offset;
+    return 0;
+}
+
+int flashlog_mount(flashlog_t *log)
+{
+    mtd_dev_t *mtd = log->mtd;
+    uint32_t page_size = mtd->page_size;
+    int res;
+
+    mutex_init(&log->lock);
+    memset(&log->stats, 0, sizeof(log->stats));
+    log->sector_size = mtd->pages_per_sector * page_size;
+    if ((mtd->sector_count < 2) || (page_size == 0) ||
+        (log->sector_size < (sizeof(_sector_hdr_t) + sizeof(_rec_hdr_t)))) {
+        return -EINVAL;
+    }
+
+    log->empty = true;
+    log->seq = 0;
+    for (uint32_t i = 0; i < mtd->sector_count; i++) {
+        flashlog_sector_t *sector = &log->sectors[i];
+        _sector_hdr_t hdr;
+
+        if ((res = mtd_read(mtd, &hdr, _sector_addr(log, i), sizeof(hdr))) < 0) {
+            return res;
+        }
+        sector->used = (hdr.magic == SECTOR_MAGIC);
+        if (!sector->used) {
+            /* erased, or the header was cut by a power failure */
+            sector->erase_count = 0;
+            continue;
+        }
+        sector->seq = hdr.seq;
+        sector->erase_count = hdr.erase_count;
+        sector->first_ts = hdr.first_ts;
+        if (log->empty || (hdr.seq > log->seq)) {
+            log->seq = hdr.seq;
+            log->head = i;
+            log->empty = false;
+        }
+    }
+
+    log->dirty_start = 0;
+    log->dirty_end = 0;
+    if (log->empty) {
+        log->head = 0;
+        log->offset = log->sector_size;
+        log->last_ts = 0;
+        log->page_addr = 0;
+        memset(log->page_buf, 0xff, page_size);
+        return 0;
+    }
+    if ((res = _scan_head(log)) < 0) {
+        return res;
+    }
+    DEBUG("flashlog: head %" PRIu32 ", offset %" PRIu32 "\n", log->head,
+          log->offset);
+    /* load the page at the write position, or the last one of a full sector,
+     * the buffer must mirror the device */
+    uint32_t addr = _sector_addr(log, log->head) + log->offset;
+    if (log->offset >= log->sector_size) {
+        addr--;
+    }
+    log->page_addr = addr - (addr % page_size);
+    if (addr == log->page_addr) {
+        memset(log->page_buf, 0xff, page_size);
+        return 0;
+    }
+    res = mtd_read(mtd, log->page_buf, log->page_addr, page_size);
+    return (res < 0) ? res : 0;
+}
+
+int flashlog_format(flashlog_t *log)
+{
+    int res = 0;
+
+    mutex_lock(&log->lock);
+    for (uint32_t i = 0; i < log->mtd->sector_count; i++) {
+        res = mtd_erase(log->mtd, _sector_addr(log, i), log->sector_size);
+        log->stats.sector_erases++;
+        log->sectors[i].erase_count++;
+        log->sectors[i].used = false;
+        if (res < 0) {
+            break;
+        }
+    }
+    log->empty = true;
+    log->head = 0;
+    log->offset = log->sector_size;
+    log->last_ts = 0;
+    log->dirty_start = 0;
+    log->dirty_end = 0;
+    memset(log->page_buf, 0xff, log->mtd->page_size);
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+int flashlog_append(flashlog_t *log, uint32_t ts, const void *data, size_t len)
+{
+    _rec_hdr_t hdr;
+    uint32_t size;
+    int res;
+
+    if ((len > FLASHLOG_RECORD_MAX) ||
+        (_rec_size(len) > (log->sector_size - sizeof(_sector_hdr_t)))) {
+        return -EMSGSIZE;
+    }
+    size = _rec_size(len);
+    hdr.len = len;
+    hdr.ts = ts;
+    hdr.crc = crc16_ccitt_update(_hdr_crc(&hdr), data, len);
+
+    mutex_lock(&log->lock);
+    if (log->empty || ((log->offset + size) > log->sector_size)) {
+        if ((res = _open_sector(log, ts)) < 0) {
+            goto out;
+        }
+    }
+    if (((res = _put(log, &hdr, sizeof(hdr))) < 0) ||
+        ((res = _put(log, data, len)) < 0) ||
+        /* padding stays erased */
+        ((res = _put(log, NULL, size - sizeof(hdr) - len)) < 0)) {
+        goto out;
+    }
+    log->last_ts = ts;
+    log->stats.appends++;
+    log->stats.bytes_appended += len;
+
+out:
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+int flashlog_flush(flashlog_t *log)
+{
+    mutex_lock(&log->lock);
+    int res = _program(log);
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+void flashlog_iter_init(flashlog_t *log, flashlog_iter_t *iter,
+                        uint32_t from_ts, uint32_t to_ts)
+{
+    uint32_t count = log->mtd->sector_count;
+    bool found = false;
+
+    iter->from_ts = from_ts;
+    iter->to_ts = to_ts;
+    iter->offset = sizeof(_sector_hdr_t);
+    iter->sector = count;
+    mutex_lock(&log->lock);
+    if (!log->empty) {
+        /* sectors are used round-robin, so the one after the head is the
+         * oldest: start in the newest sector that begins before the range */
+        for (uint32_t i = 1; i <= count; i++) {
+            uint32_t s = (log->head + i) % count;
+
+            if (!log->sectors[s].used) {
+                continue;
+            }
+            if (!found || (log->sectors[s].first_ts <= from_ts)) {
+                iter->sector = s;
+                iter->seq = log->sectors[s].seq;
+                found = true;
+            }
+        }
+    }
+    mutex_unlock(&log->lock);
+}
+
+/* moves the iterator to the next sector, returns false at the head */
+static bool _iter_next_sector(flashlog_t *log, flashlog_iter_t *iter)
+{
+    uint32_t next;
+
+    if (iter->sector == log->head) {
+        return false;
+    }
+    next = (iter->sector + 1) % log->mtd->sector_count;
+    if (!log->sectors[next].used || (log->sectors[next].seq <= iter->seq) ||
+        (log->sectors[next].first_ts > iter->to_ts)) {
+        return false;
+    }
+    iter->sector = next;
+    iter->seq = log->sectors[next].seq;
+    iter->offset = sizeof(_sector_hdr_t);
+    return true;
+}
+
+int flashlog_iter_next(flashlog_t *log, flashlog_iter_t *iter, uint32_t *ts,
+                       void *buf, size_t len)
+{
+    int res = -ENOENT;
+
+    if (iter->sector >= log->mtd->sector_count) {
+        return -ENOENT;
+    }
+    mutex_lock(&log->lock);
+    while (1) {
+        uint32_t base = _sector_addr(log, iter->sector);
+        uint32_t end = (iter->sector == log->head) ? log->offset
+                                                   : log->sector_size;
+        _rec_hdr_t hdr;
+
+        if (!log->sectors[iter->sector].used ||
+            (log->sectors[iter->sector].seq != iter->seq)) {
+            res = -EAGAIN;
+            break;
+        }
+        if ((iter->offset + sizeof(hdr)) > end) {
+            if (!_iter_next_sector(log, iter)) {
+                res = -ENOENT;
+                break;
+            }
+            continue;
+        }
+        if ((res = _read(log, base + iter->offset, &hdr, sizeof(hdr))) < 0) {
+            break;
+        }
+        if ((hdr.len == LEN_ERASED) ||
+            ((iter->offset + _rec_size(hdr.len)) > end)) {
+            /* end of the records in this sector */
+            iter->offset = log->sector_size;
+            continue;
+        }
+        if (hdr.ts > iter->to_ts) {
+            res = -ENOENT;
+            break;
+        }
+        if (hdr.ts < iter->from_ts) {
+            iter->offset += _rec_size(hdr.len);
+            continue;
+        }
+        if (hdr.len > len) {
+            iter->offset += _rec_size(hdr.len);
+            res = -ENOBUFS;
+            break;
+        }
+        res = _read(log, base + iter->offset + sizeof(hdr), buf, hdr.len);
+        if (res < 0) {
+            break;
+        }
+        iter->offset += _rec_size(hdr.len);
+        if (crc16_ccitt_update(_hdr_crc(&hdr), buf, hdr.len) != hdr.crc) {
+            DEBUG("flashlog: skipping record with CRC mismatch\n");
+            continue;
+        }
+        if (ts) {
+            *ts = hdr.ts;
+        }
+        res = hdr.len;
+        break;
+    }
+    mutex_unlock(&log->lock);
+    return res;
+}
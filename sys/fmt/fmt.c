@@ -48,11 +48,81 @@ static const uint32_t _tenmap[] = {
 
 #define TENMAP_SIZE  (sizeof(_tenmap) / sizeof(_tenmap[0]))
 
+/* smallest number of each length from two to ten decimal digits */
+static const uint32_t _dec_min[] = {
+    10LU,
+    100LU,
+    1000LU,
+    10000LU,
+    100000LU,
+    1000000LU,
+    10000000LU,
+    100000000LU,
+    1000000000LU,
+};
+
+/* "00" to "99", so two digits are emitted at once */
+static const char _pairs[200] = {
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899"
+};
+
 static inline int _is_digit(char c)
 {
     return (c >= '0' && c <= '9');
 }
 
+/* Divisions by constants, done by multiplying with the reciprocal. Most of
+ * the supported MCUs have no divider, where a division goes through the
+ * slow software division of libgcc. */
+
+/* exact for all 32-bit values */
+static inline uint32_t _div10000(uint32_t val)
+{
+    return ((uint64_t)val * 0xD1B71759LU) >> 45;
+}
+
+/* exact for val < 43699 */
+static inline uint32_t _div100(uint32_t val)
+{
+    return (val * 5243LU) >> 19;
+}
+
+static inline void _fmt_pair(char *out, uint32_t val)
+{
+    out[0] = _pairs[2 * val];
+    out[1] = _pairs[2 * val + 1];
+}
+
+/* writes exactly four digits, val < 10000 */
+static inline void _fmt_4digits(char *out, uint32_t val)
+{
+    uint32_t hi = _div100(val);
+
+    _fmt_pair(out, hi);
+    _fmt_pair(out + 2, val - hi * 100);
+}
+
+static inline int _hex_digit(char c)
+{
+    if (_is_digit(c)) {
+        return c - '0';
+    }
+    c |= 0x20;  /* lower case */
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
 size_t fmt_byte_hex(char *out, uint8_t byte)
 {
     if (out) {
@@ -107,9 +177,15 @@ size_t fmt_u64_hex(char *out, uint64_t val)
 
 size_t fmt_u64_dec(char *out, uint64_t val)
 {
+    if (val <= UINT32_MAX) {
+        return fmt_u32_dec(out, val);
+    }
+
+    /* split into base 10000 digits using 32 bit arithmetic only:
+     * 2^16 = 6 * 10000 + 5536, 2^32 = 42 * 10000^2 + 9496 * 10000 + 7296,
+     * 2^48 = 281 * 10000^3 + 4749 * 10000^2 + 7671 * 10000 + 656 */
     uint32_t d[5];
     uint32_t q;
-    size_t len = 0;
 
     d[0] = val       & 0xFFFF;
     d[1] = (val>>16) & 0xFFFF;
@@ -117,41 +193,37 @@ size_t fmt_u64_dec(char *out, uint64_t val)
     d[3] = (val>>48) & 0xFFFF;
 
     d[0] = 656 * d[3] + 7296 * d[2] + 5536 * d[1] + d[0];
-    q = d[0] / 10000;
-    d[0] = d[0] % 10000;
+    q = _div10000(d[0]);
+    d[0] -= q * 10000;
 
     d[1] = q + 7671 * d[3] + 9496 * d[2] + 6 * d[1];
-    q = d[1] / 10000;
-    d[1] = d[1] % 10000;
+    q = _div10000(d[1]);
+    d[1] -= q * 10000;
 
     d[2] = q + 4749 * d[3] + 42 * d[2];
-    q = d[2] / 10000;
-    d[2] = d[2] % 10000;
+    q = _div10000(d[2]);
+    d[2] -= q * 10000;
 
     d[3] = q + 281 * d[3];
-    q = d[3] / 10000;
-    d[3] = d[3] % 10000;
+    q = _div10000(d[3]);
+    d[3] -= q * 10000;
 
     d[4] = q;
 
+    /* val > UINT32_MAX has at least ten digits */
     int first = 4;
 
-    while (!d[first] && first) {
+    while (!d[first]) {
         first--;
     }
 
-    len = fmt_u32_dec(out, d[first]);
-    int total_len = len + (first * 4);
+    size_t len = fmt_u32_dec(out, d[first]);
+    size_t total_len = len + (first * 4);
 
     if (out) {
         out += len;
-        memset(out, '0', total_len - len);
-        while(first) {
-            first--;
-            if (d[first]) {
-                size_t tmp = fmt_u32_dec(NULL, d[first]);
-                fmt_u32_dec(out+(4-tmp), d[first]);
-            }
+        while (first--) {
+            _fmt_4digits(out, d[first]);
             out += 4;
         }
     }
@@ -164,15 +236,32 @@ size_t fmt_u32_dec(char *out, uint32_t val)
     size_t len = 1;
 
     /* count needed characters */
-    for (uint32_t tmp = 10; tmp <= val; len++) {
-        tmp *= 10;
+    while ((len <= (sizeof(_dec_min) / sizeof(_dec_min[0]))) &&
+           (val >= _dec_min[len - 1])) {
+        len++;
     }
 
     if (out) {
         char *ptr = out + len;
-        do {
-            *--ptr = (val % 10) + '0';
-        } while ((val /= 10));
+
+        while (val >= 10000) {
+            uint32_t q = _div10000(val);
+            ptr -= 4;
+            _fmt_4digits(ptr, val - q * 10000);
+            val = q;
+        }
+        while (val >= 100) {
+            uint32_t q = _div100(val);
+            ptr -= 2;
+            _fmt_pair(ptr, val - q * 100);
+            val = q;
+        }
+        if (val >= 10) {
+            _fmt_pair(ptr - 2, val);
+        }
+        else {
+            ptr[-1] = val + '0';
+        }
     }
 
     return len;
@@ -186,13 +275,13 @@ size_t fmt_u16_dec(char *out, uint16_t val)
 size_t fmt_s32_dec(char *out, int32_t val)
 {
     unsigned negative = (val < 0);
-    if (negative) {
-        if (out) {
-            *out++ = '-';
-        }
-        val = -val;
+    /* negating in unsigned arithmetic also works for INT32_MIN */
+    uint32_t absolute = negative ? -(uint32_t)val : (uint32_t)val;
+
+    if (negative && out) {
+        *out++ = '-';
     }
-    return fmt_u32_dec(out, val) + negative;
+    return fmt_u32_dec(out, absolute) + negative;
 }
 
 size_t fmt_s16_dec(char *out, int16_t val)
@@ -209,42 +298,31 @@ size_t fmt_s32_dfp(char *out, int32_t val, unsigned fp_digits)
 {
     assert(fp_digits < TENMAP_SIZE);
 
-    int32_t absolute, divider;
-    unsigned div_len, len, pos = 0;
-    char tmp[9];
-
     if (fp_digits == 0) {
         return fmt_s32_dec(out, val);
     }
-    if (val < 0) {
-        if (out) {
-            out[pos++] = '-';
-        }
-        val = -val;
-    }
-
-    uint32_t e = _tenmap[fp_digits];
-    absolute = (val / e);
-    divider = val - (absolute * e);
 
-    pos += fmt_s32_dec(&out[pos], absolute);
-
-    if (!out) {
-        return pos + 1 + fp_digits;     /* abs len + decimal point + divider */
-    }
+    unsigned negative = (val < 0);
+    uint32_t absolute = negative ? -(uint32_t)val : (uint32_t)val;
+    size_t digits = fmt_u32_dec(NULL, absolute);
+    /* zero padded to have at least one digit in front of the decimal point */
+    size_t padded = (digits > fp_digits) ? digits : (fp_digits + 1);
 
-    out[pos++] = '.';
-    len = pos + fp_digits;
-    div_len = fmt_s32_dec(tmp, divider);
+    if (out) {
+        /* format all digits in one go, as splitting off the fraction would
+         * take a division, and insert the decimal point afterwards */
+        char *integer_end = out + negative + padded - fp_digits;
 
-    while (pos < (len - div_len)) {
-        out[pos++] = '0';
-    }
-    for (size_t i = 0; i < div_len; i++) {
-        out[pos++] = tmp[i];
+        if (negative) {
+            *out++ = '-';
+        }
+        memset(out, '0', padded - digits);
+        fmt_u32_dec(out + padded - digits, absolute);
+        memmove(integer_end + 1, integer_end, fp_digits);
+        *integer_end = '.';
     }
 
-    return pos;
+    return negative + padded + 1;
 }
 
 /* this is very probably not the most efficient implementation, as it at least
@@ -332,6 +410,60 @@ uint32_t scn_u32_dec(const char *str, size_t n)
     return res;
 }
 
+uint64_t scn_u64_dec(const char *str, size_t n)
+{
+    uint64_t res = 0;
+
+    /* up to nine digits fit into 32 bit, so only every ninth digit takes a
+     * 64 bit multiplication */
+    while (n) {
+        uint32_t chunk = 0;
+        unsigned digits = 0;
+
+        while (n && (digits < 9) && _is_digit(*str)) {
+            chunk = chunk * 10 + (*str++ - '0');
+            digits++;
+            n--;
+        }
+        if (!digits) {
+            break;
+        }
+        res = res * _dec_min[digits - 1] + chunk;
+        if (digits < 9) {
+            break;
+        }
+    }
+    return res;
+}
+
+int32_t scn_s32_dec(const char *str, size_t n)
+{
+    unsigned negative = 0;
+
+    if (n && ((*str == '-') || (*str == '+'))) {
+        negative = (*str == '-');
+        str++;
+        n--;
+    }
+
+    uint32_t res = scn_u32_dec(str, n);
+    return negative ? -res : res;
+}
+
+uint32_t scn_u32_hex(const char *str, size_t n)
+{
+    uint32_t res = 0;
+
+    while (n--) {
+        int digit = _hex_digit(*str++);
+        if (digit < 0) {
+            break;
+        }
+        res = (res << 4) | digit;
+    }
+    return res;
+}
+
 void print(const char *s, size_t n)
 {
 #ifdef __WITH_AVRLIBC__
@@ -385,7 +517,7 @@ void print_u64_hex(uint64_t val)
 
 void print_u64_dec(uint64_t val)
 {
-    char buf[18];
+    char buf[20];
     size_t len = fmt_u64_dec(buf, val);
     print(buf, len);
 }
@@ -46,6 +46,7 @@ static off_t constfs_lseek(vfs_file_t *filp, off_t off, int whence);
 static int constfs_open(vfs_file_t *filp, const char *name, int flags, mode_t mode, const char *abs_path);
 static ssize_t constfs_read(vfs_file_t *filp, void *dest, size_t nbytes);
 static ssize_t constfs_write(vfs_file_t *filp, const void *src, size_t nbytes);
+static ssize_t constfs_map(vfs_file_t *filp, const void **ptr, size_t nbytes);
 
 /* Directory operations */
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname, const char *abs_path);
@@ -67,6 +68,7 @@ static const vfs_file_ops_t constfs_file_ops = {
     .open  = constfs_open,
     .read  = constfs_read,
     .write = constfs_write,
+    .map   = constfs_map,
 };
 
 static const vfs_dir_ops_t constfs_dir_ops = {
@@ -258,6 +260,24 @@ static ssize_t constfs_write(vfs_file_t *filp, const void *src, size_t nbytes)
     return -EBADF;
 }
 
+static ssize_t constfs_map(vfs_file_t *filp, const void **ptr, size_t nbytes)
+{
+    constfs_file_t *fp = filp->private_data.ptr;
+    DEBUG("constfs_map: %p, %lu\n", (void *)filp, (unsigned long)nbytes);
+    if ((size_t)filp->pos >= fp->size) {
+        /* Current offset is at or beyond end of file */
+        return 0;
+    }
+
+    if (nbytes > (fp->size - filp->pos)) {
+        nbytes = fp->size - filp->pos;
+    }
+    /* the file contents are constant, so callers can use them in place */
+    *ptr = fp->data + filp->pos;
+    filp->pos += nbytes;
+    return nbytes;
+}
+
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname, const char *abs_path)
 {
     (void) abs_path;
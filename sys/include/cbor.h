@@ -100,6 +100,43 @@
  *
  * @todo API for Indefinite-Length Byte Strings and Text Strings
  *       (see https://tools.ietf.org/html/rfc7049#section-2.2.2)
+ *
+ * # Streaming API
+ *
+ * The functions above need the complete message in one buffer. The reader
+ * (@ref cbor_reader_t) and the writer (@ref cbor_writer_t) process a message
+ * in chunks instead, e.g. the snips of a packet or the blocks of a block-wise
+ * CoAP transfer, and never allocate or copy string data.
+ *
+ * The reader is a pull parser: the user feeds it a chunk of input and calls
+ * cbor_reader_next() to get one item at a time, until it returns -EAGAIN
+ * and wants the next chunk. Items whose head is split between two chunks
+ * are handled transparently, string data is handed out in place with
+ * cbor_reader_data(). The reader keeps track of the nesting of arrays and
+ * maps, so every item carries its depth and cbor_reader_skip() can step over
+ * a whole container.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * cbor_reader_t reader;
+ * cbor_item_t item;
+ *
+ * cbor_reader_init(&reader);
+ * for (snip = pkt; snip; snip = snip->next) {
+ *     cbor_reader_feed(&reader, snip->data, snip->size);
+ *     while (cbor_reader_next(&reader, &item) == 0) {
+ *         // (...)
+ *     }
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The writer encodes into a small buffer and hands it to a sink function
+ * whenever it is full, so messages of any size can be produced. Without a
+ * sink it encodes into the buffer only. Errors are sticky: after the first
+ * failure all further calls fail, so it is enough to check the result of
+ * cbor_writer_finish().
+ *
+ * Arrays of integers and floats, e.g. sensor readings, have bulk functions on
+ * both sides that avoid the per-item overhead.
  * @{
  */
 
@@ -117,6 +154,7 @@
 #define CBOR_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -700,6 +738,412 @@ bool cbor_at_break(const cbor_stream_t *stream, size_t offset);
  */
 bool cbor_at_end(const cbor_stream_t *stream, size_t offset);
 
+/**
+ * @name Streaming reader
+ * @{
+ */
+
+/**
+ * @brief Maximum nesting of arrays, maps and indefinite length strings
+ */
+#ifndef CBOR_READER_DEPTH_MAX
+#define CBOR_READER_DEPTH_MAX   (8U)
+#endif
+
+/**
+ * @brief Remaining item count of an indefinite length level
+ */
+#define CBOR_READER_INDEFINITE  (UINT32_MAX)
+
+/**
+ * @brief Types of items returned by cbor_reader_next()
+ */
+typedef enum {
+    CBOR_ITEM_UINT,         /**< unsigned integer cbor_item_t::val */
+    CBOR_ITEM_NEGINT,       /**< negative integer -1 - cbor_item_t::val */
+    CBOR_ITEM_BYTES,        /**< byte string of cbor_item_t::val bytes */
+    CBOR_ITEM_TEXT,         /**< text string of cbor_item_t::val bytes */
+    CBOR_ITEM_ARRAY,        /**< array of cbor_item_t::val items */
+    CBOR_ITEM_MAP,          /**< map of cbor_item_t::val pairs */
+    CBOR_ITEM_TAG,          /**< tag cbor_item_t::val of the next item */
+    CBOR_ITEM_SIMPLE,       /**< simple value cbor_item_t::val, e.g. 21 (true) */
+    CBOR_ITEM_FLOAT,        /**< float, bits in cbor_item_t::val */
+    CBOR_ITEM_BREAK,        /**< end of an indefinite length item */
+} cbor_item_type_t;
+
+/**
+ * @brief A decoded item head
+ */
+typedef struct {
+    uint64_t val;           /**< value, length or count, depending on type */
+    cbor_item_type_t type;  /**< type of the item */
+    uint8_t depth;          /**< nesting level, 0 for top level items */
+    uint8_t size;           /**< size of a float in bytes (2, 4 or 8) */
+    bool indefinite;        /**< string, array or map of indefinite length */
+} cbor_item_t;
+
+/**
+ * @brief Streaming CBOR reader
+ *
+ * All members are private.
+ */
+typedef struct {
+    const uint8_t *buf;     /**< current input chunk */
+    size_t len;             /**< size of the current chunk */
+    size_t pos;             /**< read position in the current chunk */
+    uint64_t data_left;     /**< bytes of the current string not yet read */
+    uint32_t remaining[CBOR_READER_DEPTH_MAX];  /**< items left per level */
+    uint8_t types[CBOR_READER_DEPTH_MAX];       /**< major type per level */
+    uint8_t depth;          /**< current nesting level */
+    uint8_t last_depth;     /**< depth of the last returned item */
+    uint8_t head[9];        /**< head split between two chunks */
+    uint8_t head_len;       /**< bytes in cbor_reader_t::head */
+} cbor_reader_t;
+
+/**
+ * @brief Initialize a reader for a new message
+ *
+ * @param[out] reader   The reader to initialize
+ */
+void cbor_reader_init(cbor_reader_t *reader);
+
+/**
+ * @brief Hand the next chunk of input to a reader
+ *
+ * The previous chunk has to be used up, i.e. a read function must have
+ * returned -EAGAIN. @p buf must stay valid until then.
+ *
+ * @param[in, out] reader   The reader
+ * @param[in] buf           The chunk
+ * @param[in] len           Size of @p buf
+ */
+void cbor_reader_feed(cbor_reader_t *reader, const void *buf, size_t len);
+
+/**
+ * @brief Read the next item
+ *
+ * Data of a string that was not read with cbor_reader_data() is skipped.
+ * Arrays and maps of more than 2^31 - 1 items are rejected.
+ *
+ * @param[in, out] reader   The reader
+ * @param[out] item         The item
+ *
+ * @return 0 on success
+ * @return -EAGAIN if the chunk is used up, feed the next one and call again
+ * @return -EBADMSG if the input is not well-formed CBOR
+ * @return -EOVERFLOW if the nesting exceeds @ref CBOR_READER_DEPTH_MAX
+ */
+int cbor_reader_next(cbor_reader_t *reader, cbor_item_t *item);
+
+/**
+ * @brief Read data of the current string in place
+ *
+ * @param[in, out] reader   The reader
+ * @param[out] data         Start of the data in the current chunk
+ *
+ * @return number of bytes at @p data, at most the rest of the string
+ * @return 0 if the string is read completely
+ * @return -EAGAIN if the chunk is used up, feed the next one and call again
+ */
+int cbor_reader_data(cbor_reader_t *reader, const uint8_t **data);
+
+/**
+ * @brief Skip the contents of the last item, i.e. all items of an array or
+ *        map or the data of a string
+ *
+ * @param[in, out] reader   The reader
+ *
+ * @return 0 on success
+ * @return -EAGAIN if the chunk is used up, feed the next one and call again
+ * @return other errors like cbor_reader_next()
+ */
+int cbor_reader_skip(cbor_reader_t *reader);
+
+/**
+ * @brief Read consecutive integers of the current container
+ *
+ * Stops at the end of the chunk or container or at an item that is not an
+ * integer fitting into an int32_t.
+ *
+ * @param[in, out] reader   The reader
+ * @param[out] vals         The integers
+ * @param[in] n             Maximum number of integers to read
+ *
+ * @return number of integers read
+ * @return 0 at the end of the container
+ * @return -EAGAIN if the chunk is used up, feed the next one and call again
+ * @return -EINVAL if the next item is not an integer
+ * @return -ERANGE if the next integer does not fit into an int32_t
+ */
+int cbor_reader_int32_array(cbor_reader_t *reader, int32_t *vals, size_t n);
+
+#ifdef MODULE_CBOR_FLOAT
+/**
+ * @brief Read consecutive floats of the current container
+ *
+ * Half, single and double precision values are accepted.
+ *
+ * @param[in, out] reader   The reader
+ * @param[out] vals         The floats
+ * @param[in] n             Maximum number of floats to read
+ *
+ * @return number of floats read
+ * @return 0 at the end of the container
+ * @return -EAGAIN if the chunk is used up, feed the next one and call again
+ * @return -EINVAL if the next item is not a float
+ */
+int cbor_reader_float_array(cbor_reader_t *reader, float *vals, size_t n);
+
+/**
+ * @brief Convert a @ref CBOR_ITEM_FLOAT item to a double
+ *
+ * @param[in] item  The item
+ *
+ * @return the value of @p item
+ */
+double cbor_item_double(const cbor_item_t *item);
+#endif /* MODULE_CBOR_FLOAT */
+/** @} */
+
+/**
+ * @name Streaming writer
+ * @{
+ */
+
+/**
+ * @brief Sink for encoded data
+ *
+ * @param[in] arg   Argument given to cbor_writer_init()
+ * @param[in] data  Encoded data
+ * @param[in] len   Size of @p data
+ *
+ * @return 0 on success
+ * @return < 0 on error, it is returned by all further writer calls
+ */
+typedef int (*cbor_writer_sink_t)(void *arg, const void *data, size_t len);
+
+/**
+ * @brief Streaming CBOR writer
+ *
+ * All members are private.
+ */
+typedef struct {
+    uint8_t *buf;               /**< encoding buffer */
+    size_t size;                /**< size of the buffer */
+    size_t pos;                 /**< bytes in the buffer */
+    size_t total;               /**< bytes handed to the sink */
+    cbor_writer_sink_t sink;    /**< sink, may be NULL */
+    void *arg;                  /**< argument of the sink */
+    int err;                    /**< first error */
+} cbor_writer_t;
+
+/**
+ * @brief Initialize a writer
+ *
+ * @param[out] writer   The writer to initialize
+ * @param[in] buf       Encoding buffer, at least 9 bytes if @p sink is set
+ * @param[in] size      Size of @p buf
+ * @param[in] sink      Function the encoded data is handed to whenever
+ *                      @p buf is full, or NULL to encode into @p buf only
+ * @param[in] arg       Argument of @p sink
+ */
+void cbor_writer_init(cbor_writer_t *writer, void *buf, size_t size,
+                      cbor_writer_sink_t sink, void *arg);
+
+/**
+ * @brief Hand the rest of the encoded data to the sink
+ *
+ * @param[in, out] writer   The writer
+ *
+ * @return size of the encoded message in bytes
+ * @return -ENOBUFS if the buffer was too small and no sink was given
+ * @return < 0 on errors of the sink
+ */
+int cbor_writer_finish(cbor_writer_t *writer);
+
+/**
+ * @brief Write an unsigned integer
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] val           The value
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_uint(cbor_writer_t *writer, uint64_t val);
+
+/**
+ * @brief Write a signed integer
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] val           The value
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_int(cbor_writer_t *writer, int64_t val);
+
+/**
+ * @brief Write a byte string
+ *
+ * Data that does not fit into the buffer is passed to the sink directly.
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] data          The string
+ * @param[in] len           Length of @p data
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_bytes(cbor_writer_t *writer, const void *data, size_t len);
+
+/**
+ * @brief Write a text string
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] str           The string, UTF-8 encoded
+ * @param[in] len           Length of @p str in bytes
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_text(cbor_writer_t *writer, const char *str, size_t len);
+
+/**
+ * @brief Start an array of @p len items
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] len           Number of items that follow
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_array(cbor_writer_t *writer, size_t len);
+
+/**
+ * @brief Start an array of indefinite length, ended by cbor_writer_break()
+ *
+ * @param[in, out] writer   The writer
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_array_indefinite(cbor_writer_t *writer);
+
+/**
+ * @brief Start a map of @p len pairs
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] len           Number of key-value pairs that follow
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_map(cbor_writer_t *writer, size_t len);
+
+/**
+ * @brief Start a map of indefinite length, ended by cbor_writer_break()
+ *
+ * @param[in, out] writer   The writer
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_map_indefinite(cbor_writer_t *writer);
+
+/**
+ * @brief End an indefinite length item
+ *
+ * @param[in, out] writer   The writer
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_break(cbor_writer_t *writer);
+
+/**
+ * @brief Write a tag for the next item
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] tag           The tag
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_tag(cbor_writer_t *writer, uint64_t tag);
+
+/**
+ * @brief Write a boolean
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] val           The value
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_bool(cbor_writer_t *writer, bool val);
+
+/**
+ * @brief Write null
+ *
+ * @param[in, out] writer   The writer
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_null(cbor_writer_t *writer);
+
+/**
+ * @brief Write an array of integers
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] vals          The integers
+ * @param[in] n             Number of integers
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_int32_array(cbor_writer_t *writer, const int32_t *vals,
+                            size_t n);
+
+#ifdef MODULE_CBOR_FLOAT
+/**
+ * @brief Write a single precision float
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] val           The value
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_float(cbor_writer_t *writer, float val);
+
+/**
+ * @brief Write a double precision float
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] val           The value
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_double(cbor_writer_t *writer, double val);
+
+/**
+ * @brief Write an array of single precision floats
+ *
+ * @param[in, out] writer   The writer
+ * @param[in] vals          The floats
+ * @param[in] n             Number of floats
+ *
+ * @return 0 on success
+ * @return < 0 on error, see cbor_writer_finish()
+ */
+int cbor_writer_float_array(cbor_writer_t *writer, const float *vals,
+                            size_t n);
+#endif /* MODULE_CBOR_FLOAT */
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_event Event Queue
+ * @ingroup     sys
+ * @brief       Allocation-free event queues
+ *
+ * An event is a handler function plus a list node, usually embedded in a
+ * larger structure that carries the event's context. Events are posted to an
+ * event queue, which belongs to one thread. That thread waits for events and
+ * runs their handlers, see event_loop():
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * static void _handler(event_t *event)
+ * {
+ *     ...
+ * }
+ *
+ * static event_t _event = { .handler = _handler };
+ *
+ * static void *_thread(void *arg)
+ * {
+ *     event_queue_t queue;
+ *
+ *     event_queue_init(&queue);
+ *     ...
+ *     event_loop(&queue);
+ * }
+ *
+ * (in an ISR or another thread:)
+ * event_post(&queue, &_event);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Compared to sending a message:
+ *
+ * - posting cannot fail and needs no message queue, the event is linked into
+ *   the event queue itself
+ * - an event that is still queued is not queued again, so posting the same
+ *   event several times before it is handled runs its handler once
+ * - posting from an ISR takes a list push and setting a thread flag
+ * - several subsystems can put their events into the same queue and so share
+ *   one thread and its stack, see @ref sys_event_thread
+ *
+ * An event must not be changed or reused for another queue while it is
+ * queued. The handler runs after the event was taken from the queue, so the
+ * handler may post the event again.
+ *
+ * The waiting thread is woken up with @ref THREAD_FLAG_EVENT, so it can wait
+ * for events, messages and other thread flags at the same time.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Event queue API
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+#include "clist.h"
+#include "thread.h"
+#include "thread_flags.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Thread flag set when an event was posted to a thread's queue
+ */
+#ifndef THREAD_FLAG_EVENT
+#define THREAD_FLAG_EVENT   (0x1 << 12)
+#endif
+
+/**
+ * @brief   Event structure forward declaration
+ */
+typedef struct event event_t;
+
+/**
+ * @brief   Event handler type
+ *
+ * @param[in] event     the event, to be cast to the structure it is
+ *                      embedded in
+ */
+typedef void (*event_handler_t)(event_t *event);
+
+/**
+ * @brief   Event structure
+ */
+struct event {
+    clist_node_t list_node;     /**< event queue list entry, NULL when the
+                                     event is not queued */
+    event_handler_t handler;    /**< handler, run by the queue's thread */
+};
+
+/**
+ * @brief   Event queue structure
+ */
+typedef struct {
+    clist_node_t event_list;    /**< queued events */
+    thread_t *waiter;           /**< thread handling the events, NULL if not
+                                     claimed yet */
+} event_queue_t;
+
+/**
+ * @brief   Static initializer for an event queue that is not claimed yet
+ */
+#define EVENT_QUEUE_INIT_DETACHED   { { NULL }, NULL }
+
+/**
+ * @brief   Initialize an event queue owned by the calling thread
+ *
+ * @param[out] queue    event queue to initialize
+ */
+void event_queue_init(event_queue_t *queue);
+
+/**
+ * @brief   Initialize an event queue that is not owned by a thread yet
+ *
+ * Events can be posted to the queue already, they are handled once a thread
+ * claimed it with event_queue_claim().
+ *
+ * @param[out] queue    event queue to initialize
+ */
+void event_queue_init_detached(event_queue_t *queue);
+
+/**
+ * @brief   Make the calling thread the owner of a detached event queue
+ *
+ * @param[in,out] queue event queue to claim
+ */
+void event_queue_claim(event_queue_t *queue);
+
+/**
+ * @brief   Post an event to a queue
+ *
+ * Does nothing if @p event is queued already. Can be called from interrupt
+ * context.
+ *
+ * @param[in,out] queue event queue to post to
+ * @param[in,out] event event to post
+ */
+void event_post(event_queue_t *queue, event_t *event);
+
+/**
+ * @brief   Remove an event from a queue
+ *
+ * Does nothing if @p event is not queued. Can be called from interrupt
+ * context.
+ *
+ * @param[in,out] queue event queue to remove @p event from
+ * @param[in,out] event event to remove
+ */
+void event_cancel(event_queue_t *queue, event_t *event);
+
+/**
+ * @brief   Take the next event from a queue, non-blocking
+ *
+ * @param[in,out] queue event queue to take the event from
+ *
+ * @return  the next event
+ * @return  NULL if the queue is empty
+ */
+event_t *event_get(event_queue_t *queue);
+
+/**
+ * @brief   Take the next event from a queue, blocking
+ *
+ * Must only be called by the thread owning @p queue.
+ *
+ * @param[in,out] queue event queue to take the event from
+ *
+ * @return  the next event
+ */
+event_t *event_wait(event_queue_t *queue);
+
+/**
+ * @brief   Handle the events of a queue forever
+ *
+ * Must only be called by the thread owning @p queue.
+ *
+ * @param[in,out] queue event queue to handle
+ */
+static inline void event_loop(event_queue_t *queue)
+{
+    while (1) {
+        event_t *event = event_wait(queue);
+        event->handler(event);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_H */
+/** @} */
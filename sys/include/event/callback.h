@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_event_callback Callback Event
+ * @ingroup     sys_event
+ * @brief       Events that call a function with an argument
+ *
+ * For code that already has a callback and an argument, e.g. the callbacks
+ * of peripheral drivers, and wants them to run in thread context.
+ *
+ * Enable with `USEMODULE += event_callback`.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Callback event API
+ */
+
+#ifndef EVENT_CALLBACK_H
+#define EVENT_CALLBACK_H
+
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Callback event structure
+ */
+typedef struct {
+    event_t super;              /**< event structure that gets extended */
+    void (*callback)(void *);   /**< callback function */
+    void *arg;                  /**< callback function argument */
+} event_callback_t;
+
+/**
+ * @brief   Event handler of callback events
+ *
+ * @internal
+ */
+void _event_callback_handler(event_t *event);
+
+/**
+ * @brief   Static initializer for a callback event
+ *
+ * @param[in] _cb       callback function
+ * @param[in] _arg      callback function argument
+ */
+#define EVENT_CALLBACK_INIT(_cb, _arg) \
+    { { { NULL }, _event_callback_handler }, (_cb), (_arg) }
+
+/**
+ * @brief   Initialize a callback event
+ *
+ * @param[out] event_callback   event to initialize
+ * @param[in] callback          callback function
+ * @param[in] arg               callback function argument
+ */
+void event_callback_init(event_callback_t *event_callback,
+                         void (*callback)(void *), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_CALLBACK_H */
+/** @} */
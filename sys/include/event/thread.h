@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_event_thread Shared Event Thread
+ * @ingroup     sys_event
+ * @brief       One thread handling the events of several subsystems
+ *
+ * Subsystems that post their deferred work to @ref event_thread_queue
+ * instead of running a thread of their own share the stack of the event
+ * thread. Handlers must not block for long, as they delay the events of all
+ * other subsystems.
+ *
+ * Enable with `USEMODULE += event_thread`, the thread is started by
+ * auto_init. Events can be posted before the thread runs.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Shared event thread API
+ */
+
+#ifndef EVENT_THREAD_H
+#define EVENT_THREAD_H
+
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Stack size of the event thread
+ */
+#ifndef EVENT_THREAD_STACKSIZE
+#define EVENT_THREAD_STACKSIZE  (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Priority of the event thread
+ */
+#ifndef EVENT_THREAD_PRIO
+#define EVENT_THREAD_PRIO       (THREAD_PRIORITY_MAIN - 1)
+#endif
+
+/**
+ * @brief   Queue handled by the event thread
+ */
+extern event_queue_t event_thread_queue;
+
+/**
+ * @brief   Start the event thread
+ *
+ * Called by auto_init.
+ */
+void event_thread_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_THREAD_H */
+/** @} */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_event_timeout Event Timeout
+ * @ingroup     sys_event
+ * @brief       Post events after a timeout
+ *
+ * An event timeout posts an event to a queue when an xtimer expires. This
+ * replaces the combination of evtimer_msg or xtimer_set_msg() and a message
+ * loop for events handled with @ref sys_event.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * event_timeout_t timeout;
+ *
+ * event_timeout_init(&timeout, &queue, &event);
+ * event_timeout_set(&timeout, 100 * US_PER_MS);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Enable with `USEMODULE += event_timeout`.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Event timeout API
+ */
+
+#ifndef EVENT_TIMEOUT_H
+#define EVENT_TIMEOUT_H
+
+#include "event.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Event timeout structure
+ */
+typedef struct {
+    xtimer_t timer;             /**< timer posting the event */
+    event_queue_t *queue;       /**< queue to post the event to */
+    event_t *event;             /**< event to post */
+} event_timeout_t;
+
+/**
+ * @brief   Initialize an event timeout
+ *
+ * @param[out] event_timeout    event timeout to initialize
+ * @param[in] queue             queue to post @p event to
+ * @param[in] event             event to post
+ */
+void event_timeout_init(event_timeout_t *event_timeout, event_queue_t *queue,
+                        event_t *event);
+
+/**
+ * @brief   Post the event after @p timeout microseconds
+ *
+ * A pending timeout is restarted.
+ *
+ * @param[in,out] event_timeout event timeout to set
+ * @param[in] timeout           timeout in microseconds
+ */
+void event_timeout_set(event_timeout_t *event_timeout, uint32_t timeout);
+
+/**
+ * @brief   Stop a pending timeout
+ *
+ * Does not remove the event if it was posted already, use event_cancel() for
+ * that.
+ *
+ * @param[in,out] event_timeout event timeout to stop
+ */
+void event_timeout_clear(event_timeout_t *event_timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_TIMEOUT_H */
+/** @} */
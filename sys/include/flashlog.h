@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_flashlog Flash record log
+ * @ingroup     sys
+ * @brief       Append-only store for timestamped records on an mtd device
+ *
+ * flashlog stores small records with a timestamp in a ring of flash sectors,
+ * without any file system in between. Appending a record only writes the
+ * record itself, there is no metadata to update.
+ *
+ * # Layout
+ *
+ * Every sector starts with a header that holds a sequence number, the
+ * number of times the sector was erased and the timestamp of its first
+ * record. Records follow back to back, each with a length, a CRC16 and the
+ * timestamp, aligned to 4 bytes. Records do not span sectors.
+ *
+ * When the current sector is full the next one is erased and used, so the
+ * oldest records get dropped and all sectors are erased equally often.
+ *
+ * # Write batching
+ *
+ * Appended records are collected in a page buffer in RAM. The page is
+ * programmed when it is full or when flashlog_flush() is called, so many
+ * small records cost a single page program. Records that are not flushed
+ * are lost on reset, call flashlog_flush() when they must be persistent.
+ *
+ * @note    A flush only programs the bytes appended since the last one, so
+ *          a page may be programmed several times in parts. The backing
+ *          device has to support this (e.g. NOR flash).
+ *
+ * # Reading
+ *
+ * The timestamp of the first record of each sector is kept in RAM. A time
+ * range query starts in the last sector that begins before the range, so
+ * only a sector's worth of unrelated records needs to be skipped.
+ *
+ * flashlog_mount() reads all sector headers and scans only the newest
+ * sector for the end of the log.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Flash record log interface
+ */
+
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum size of a record's payload
+ *
+ * A record has to fit into a sector together with the sector header and
+ * its record header.
+ */
+#define FLASHLOG_RECORD_MAX     (0xfffeU)
+
+/**
+ * @brief   Timestamp to pass as end of a range to read up to the newest record
+ */
+#define FLASHLOG_TS_MAX         (UINT32_MAX)
+
+/**
+ * @brief   In-RAM index entry of a sector
+ */
+typedef struct {
+    uint32_t seq;           /**< sequence number of the sector */
+    uint32_t erase_count;   /**< number of erases of the sector */
+    uint32_t first_ts;      /**< timestamp of the first record */
+    bool used;              /**< sector holds records */
+} flashlog_sector_t;
+
+/**
+ * @brief   Statistics of a flashlog
+ */
+typedef struct {
+    uint32_t appends;           /**< number of appended records */
+    uint32_t bytes_appended;    /**< sum of the appended payload sizes */
+    uint32_t bytes_programmed;  /**< number of bytes written to the device */
+    uint32_t page_programs;     /**< number of page write operations */
+    uint32_t sector_erases;     /**< number of sector erase operations */
+} flashlog_stats_t;
+
+/**
+ * @brief   Flash record log descriptor
+ *
+ * flashlog_t::mtd, flashlog_t::page_buf and flashlog_t::sectors are to be
+ * set by the user, all other members are initialized by flashlog_mount().
+ */
+typedef struct {
+    mtd_dev_t *mtd;             /**< backing device, initialized */
+    uint8_t *page_buf;          /**< buffer of mtd_dev_t::page_size bytes */
+    flashlog_sector_t *sectors; /**< index of mtd_dev_t::sector_count entries */
+    uint32_t sector_size;       /**< size of a sector in bytes */
+    uint32_t head;              /**< sector currently appended to */
+    uint32_t offset;            /**< write position in flashlog_t::head */
+    uint32_t page_addr;         /**< address of the page in the page buffer */
+    uint32_t seq;               /**< sequence number of flashlog_t::head */
+    uint32_t last_ts;           /**< timestamp of the newest record */
+    uint32_t dirty_start;       /**< start of unwritten data in the page */
+    uint32_t dirty_end;         /**< end of unwritten data, 0 if clean */
+    bool empty;                 /**< no sector holds records */
+    mutex_t lock;               /**< serializes accesses */
+    flashlog_stats_t stats;     /**< statistics since flashlog_mount() */
+} flashlog_t;
+
+/**
+ * @brief   Iterator over the records of a time range
+ */
+typedef struct {
+    uint32_t seq;       /**< sequence number of the current sector */
+    uint32_t sector;    /**< current sector */
+    uint32_t offset;    /**< offset of the next record in the sector */
+    uint32_t from_ts;   /**< start of the range */
+    uint32_t to_ts;     /**< end of the range (inclusive) */
+} flashlog_iter_t;
+
+/**
+ * @brief   Mounts a flashlog on its mtd device
+ *
+ * Reads the sector headers to rebuild the index and finds the end of the
+ * log in the newest sector. An erased device is an empty log.
+ *
+ * @param[in,out] log   log to mount, with mtd, page_buf and sectors set
+ *
+ * @return  0 on success
+ * @return  -EINVAL if the device geometry is not supported
+ * @return  < 0 on errors of the backing device
+ */
+int flashlog_mount(flashlog_t *log);
+
+/**
+ * @brief   Erases all sectors, dropping all records
+ *
+ * @param[in] log   mounted log
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the backing device
+ */
+int flashlog_format(flashlog_t *log);
+
+/**
+ * @brief   Appends a record
+ *
+ * The record is buffered in RAM until its page is full or flashlog_flush()
+ * is called. Timestamps are expected to not decrease.
+ *
+ * @param[in] log   mounted log
+ * @param[in] ts    timestamp of the record
+ * @param[in] data  payload of the record
+ * @param[in] len   length of @p data
+ *
+ * @return  0 on success
+ * @return  -EMSGSIZE if the record does not fit into a sector
+ * @return  < 0 on errors of the backing device
+ */
+int flashlog_append(flashlog_t *log, uint32_t ts, const void *data, size_t len);
+
+/**
+ * @brief   Writes buffered records to the device
+ *
+ * @param[in] log   mounted log
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the backing device
+ */
+int flashlog_flush(flashlog_t *log);
+
+/**
+ * @brief   Prepares to iterate over the records with a timestamp in a range
+ *
+ * @param[in] log       mounted log
+ * @param[out] iter     iterator to initialize
+ * @param[in] from_ts   first timestamp of the range
+ * @param[in] to_ts     last timestamp of the range, @ref FLASHLOG_TS_MAX for
+ *                      all records from @p from_ts on
+ */
+void flashlog_iter_init(flashlog_t *log, flashlog_iter_t *iter,
+                        uint32_t from_ts, uint32_t to_ts);
+
+/**
+ * @brief   Reads the next record of a range
+ *
+ * Buffered records are returned, too. Records with a CRC mismatch, e.g.
+ * after a power failure while programming them, are skipped.
+ *
+ * @param[in] log       mounted log
+ * @param[in,out] iter  iterator initialized with flashlog_iter_init()
+ * @param[out] ts       timestamp of the record, may be NULL
+ * @param[out] buf      buffer for the payload
+ * @param[in] len       size of @p buf
+ *
+ * @return  length of the payload
+ * @return  -ENOENT if there are no more records in the range
+ * @return  -ENOBUFS if @p buf is too small, the record is skipped
+ * @return  -EAGAIN if the sector was overwritten, reinitialize @p iter
+ * @return  < 0 on errors of the backing device
+ */
+int flashlog_iter_next(flashlog_t *log, flashlog_iter_t *iter, uint32_t *ts,
+                       void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASHLOG_H */
+/** @} */
@@ -18,6 +18,12 @@
  * integers, even when the C library was built without support for 64 bit
  * formatting (newlib-nano).
  *
+ * The decimal conversions do not divide: digits are split off by multiplying
+ * with reciprocals and emitted in pairs from a lookup table. This keeps them
+ * fast on MCUs without a hardware divider, where every division, and even
+ * more so every 64 bit division, is a call into the software division of the
+ * compiler's runtime library.
+ *
  * \note The print functions in this library do not buffer any output.
  * Mixing calls to standard @c printf from stdio.h with the @c print_xxx
  * functions in fmt, especially on the same output line, may cause garbled
@@ -289,6 +295,43 @@ size_t fmt_str(char *out, const char *str);
  */
 uint32_t scn_u32_dec(const char *str, size_t n);
 
+/**
+ * @brief Convert digits to uint64
+ *
+ * Will convert up to @p n digits. Stops at any non-digit or '\0' character.
+ *
+ * @param[in]   str  Pointer to string to read from
+ * @param[in]   n    Maximum nr of characters to consider
+ *
+ * @return      converted uint64_t value
+ */
+uint64_t scn_u64_dec(const char *str, size_t n);
+
+/**
+ * @brief Convert digits with an optional leading sign to int32
+ *
+ * Accepts a leading '-' or '+', then behaves like scn_u32_dec().
+ *
+ * @param[in]   str  Pointer to string to read from
+ * @param[in]   n    Maximum nr of characters to consider, including the sign
+ *
+ * @return      converted int32_t value
+ */
+int32_t scn_s32_dec(const char *str, size_t n);
+
+/**
+ * @brief Convert hexadecimal digits to uint32
+ *
+ * Will convert up to @p n digits, upper and lower case. Stops at any
+ * non-hex-digit or '\0' character. A "0x" prefix is not accepted.
+ *
+ * @param[in]   str  Pointer to string to read from
+ * @param[in]   n    Maximum nr of characters to consider
+ *
+ * @return      converted uint32_t value
+ */
+uint32_t scn_u32_hex(const char *str, size_t n);
+
 /**
  * @brief Print string to stdout
  *
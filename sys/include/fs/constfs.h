@@ -15,6 +15,9 @@
  * RIOT VFS layer. The implementation uses an array of @c constfs_file_t objects
  * as its storage back-end.
  *
+ * Since the file contents stay in place, vfs_map() and vfs_sendfile() can use
+ * them without copying them to an intermediate buffer first.
+ *
  * @{
  * @file
  * @brief   ConstFS public API
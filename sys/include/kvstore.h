@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_kvstore Key-value store
+ * @ingroup     sys
+ * @brief       Persistent key-value store on an mtd device
+ *
+ * kvstore keeps small values, e.g. configuration settings, under string keys
+ * on flash. Values are never updated in place: a put appends a new version
+ * of the entry to a log that spans the sectors of the device, a delete
+ * appends a tombstone.
+ *
+ * # Index
+ *
+ * A hash table in RAM maps each key to the location of its newest entry.
+ * A slot only holds the hash of the key and the entry's address, keys are
+ * compared on flash. The table is supplied by the user and should have
+ * about twice as many slots as keys are expected; it has to be a power of
+ * two.
+ *
+ * The index is not stored on flash. kvstore_mount() only reads the sector
+ * headers and finds the end of the log, the index is rebuilt from the
+ * entries on the first access. This reads every entry once, to verify its
+ * CRC.
+ *
+ * # Garbage collection and wear
+ *
+ * Sectors are filled in a ring. One sector is always kept free: when the
+ * last but one free sector is opened, the oldest sector is collected by
+ * copying its live entries to the newly opened sector and erasing it.
+ * Tombstones in the oldest sector are dropped, as no older version of
+ * their key can exist. Hence every sector is erased equally often; the
+ * erase count is kept in each sector's header.
+ *
+ * A put with the value that is already stored does not write anything.
+ *
+ * # Commits
+ *
+ * Entries are collected in a page buffer in RAM and programmed when the
+ * page is full or on kvstore_commit(), so a burst of updates costs a page
+ * program per page instead of one per entry. Entries that were not
+ * committed are lost on reset. An entry that was cut by a power failure is
+ * detected by its CRC and ignored.
+ *
+ * @note    A commit only programs the bytes appended since the previous one,
+ *          so a page may be programmed several times in parts. The backing
+ *          device has to support this (e.g. NOR flash).
+ *
+ * @{
+ *
+ * @file
+ * @brief       Key-value store interface
+ */
+
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum length of a key, without the terminating zero
+ */
+#ifndef KVSTORE_KEY_MAX
+#define KVSTORE_KEY_MAX     (32U)
+#endif
+
+/**
+ * @brief   Index slot
+ */
+typedef struct {
+    uint32_t addr;          /**< address of the entry, 0 if the slot is free */
+    uint32_t hash;          /**< hash of the key */
+} kvstore_slot_t;
+
+/**
+ * @brief   Statistics of a key-value store
+ */
+typedef struct {
+    uint32_t puts;              /**< number of puts that appended an entry */
+    uint32_t puts_unchanged;    /**< number of puts that were skipped */
+    uint32_t gets;              /**< number of gets */
+    uint32_t deletes;           /**< number of deletes */
+    uint32_t bytes_programmed;  /**< number of bytes written to the device */
+    uint32_t page_programs;     /**< number of write operations */
+    uint32_t sector_erases;     /**< number of sector erase operations */
+    uint32_t gc_runs;           /**< number of collected sectors */
+    uint32_t gc_bytes_copied;   /**< bytes of live entries copied by the GC */
+} kvstore_stats_t;
+
+/**
+ * @brief   Key-value store descriptor
+ *
+ * kvstore_t::mtd, kvstore_t::page_buf, kvstore_t::index and
+ * kvstore_t::index_size are to be set by the user, all other members are
+ * initialized by kvstore_mount().
+ */
+typedef struct {
+    mtd_dev_t *mtd;             /**< backing device, initialized */
+    uint8_t *page_buf;          /**< buffer of mtd_dev_t::page_size bytes */
+    kvstore_slot_t *index;      /**< hash index */
+    unsigned index_size;        /**< number of index slots, a power of two */
+    unsigned index_used;        /**< number of keys in the index */
+    bool index_valid;           /**< index was built */
+    uint32_t sector_size;       /**< size of a sector in bytes */
+    uint32_t head;              /**< sector entries are appended to */
+    uint32_t tail;              /**< oldest sector in use */
+    uint32_t used;              /**< number of sectors in use */
+    uint32_t offset;            /**< write position in kvstore_t::head */
+    uint32_t seq;               /**< sequence number of kvstore_t::head */
+    uint32_t page_addr;         /**< address of the page in the page buffer */
+    uint32_t dirty_start;       /**< start of unwritten data in the page */
+    uint32_t dirty_end;         /**< end of unwritten data, 0 if clean */
+    mutex_t lock;               /**< serializes accesses */
+    kvstore_stats_t stats;      /**< statistics since kvstore_mount() */
+} kvstore_t;
+
+/**
+ * @brief   Mounts a key-value store on its mtd device
+ *
+ * An erased device is an empty store.
+ *
+ * @param[in,out] kv    store to mount, with mtd, page_buf and the index set
+ *
+ * @return  0 on success
+ * @return  -EINVAL if the device geometry or index size is not supported
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_mount(kvstore_t *kv);
+
+/**
+ * @brief   Erases all sectors, dropping all entries
+ *
+ * @param[in] kv    mounted store
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_format(kvstore_t *kv);
+
+/**
+ * @brief   Reads the value of a key
+ *
+ * @param[in] kv    mounted store
+ * @param[in] key   zero terminated key
+ * @param[out] buf  buffer for the value
+ * @param[in] len   size of @p buf
+ *
+ * @return  length of the value
+ * @return  -ENOENT if the key does not exist
+ * @return  -ENOBUFS if @p buf is too small
+ * @return  -ENOMEM if the index is too small for the stored keys
+ * @return  -EIO if the stored value is corrupted
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_get(kvstore_t *kv, const char *key, void *buf, size_t len);
+
+/**
+ * @brief   Sets the value of a key
+ *
+ * The entry is programmed with the next kvstore_commit() at the latest.
+ *
+ * @param[in] kv    mounted store
+ * @param[in] key   zero terminated key
+ * @param[in] val   value
+ * @param[in] len   length of @p val
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p key is empty or longer than @ref KVSTORE_KEY_MAX
+ * @return  -EMSGSIZE if the entry does not fit into a sector
+ * @return  -ENOMEM if the index is full
+ * @return  -ENOSPC if the device is full of live entries
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_put(kvstore_t *kv, const char *key, const void *val, size_t len);
+
+/**
+ * @brief   Deletes a key
+ *
+ * A delete always succeeds on a full store, the space of the deleted entry
+ * is reclaimed if needed.
+ *
+ * @param[in] kv    mounted store
+ * @param[in] key   zero terminated key
+ *
+ * @return  0 on success
+ * @return  -ENOENT if the key does not exist
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_delete(kvstore_t *kv, const char *key);
+
+/**
+ * @brief   Programs all buffered entries
+ *
+ * @param[in] kv    mounted store
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the backing device
+ */
+int kvstore_commit(kvstore_t *kv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KVSTORE_H */
+/** @} */
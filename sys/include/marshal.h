@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_marshal Schema-compiled marshalling
+ * @ingroup     sys
+ * @brief       Specialized CBOR and UBJSON encoders and decoders for C
+ *              structs, generated at compile time from a schema
+ *
+ * The generic @ref sys_cbor and @ref sys_ubjson APIs need one call per
+ * field and leave the bookkeeping of keys and offsets to the user. Here
+ * the fields of a record are described once, as a list of
+ * `FIELD(kind, member, key, size)` entries:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * #define SENSOR_FIELDS(FIELD)              \
+ *     FIELD(TEXT,   name,  "n",  16)        \
+ *     FIELD(INT32,  time,  "t",  0)         \
+ *     FIELD(FLOAT,  value, "v",  0)         \
+ *     FIELD(BOOL,   valid, "vb", 0)
+ *
+ * MARSHAL_STRUCT(sensor_t, SENSOR_FIELDS);
+ * MARSHAL_CBOR(sensor, sensor_t, SENSOR_FIELDS)
+ * MARSHAL_UBJSON(sensor, sensor_t, SENSOR_FIELDS)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * This defines the struct `sensor_t` and the functions sensor_cbor_encode(),
+ * sensor_cbor_decode(), sensor_cbor_encode_array(),
+ * sensor_cbor_decode_array() and their `ubjson` counterparts. A record is
+ * encoded as a map (object) from the keys to the member values, an array
+ * of records as an array of maps.
+ *
+ * Supported kinds are `INT32`, `UINT32`, `FLOAT`, `BOOL` and `TEXT`; `size`
+ * is the size of the char array of a `TEXT` member, including the
+ * terminating zero, and ignored otherwise. Keys must be shorter than 24
+ * bytes and a record can have up to 23 fields.
+ *
+ * The generated code differs from the generic APIs in that
+ * - keys are written from constants and matched with a single comparison,
+ * - the maximum encoded size of a record is known at compile time, so
+ *   there is only one bounds check per record, or per array if the worst
+ *   case fits into the buffer,
+ * - there are no callbacks or indirect calls per field.
+ *
+ * Decoders accept the fields in any order and skip unknown keys with scalar
+ * or string values. Members that are missing in the input are zero. `FLOAT`
+ * members are encoded in single precision and decoded from half, single or
+ * double precision.
+ *
+ * MARSHAL_CBOR() and MARSHAL_UBJSON() define functions and belong into one
+ * C file; declare them elsewhere with MARSHAL_CBOR_DECLARE() and
+ * MARSHAL_UBJSON_DECLARE().
+ *
+ * @{
+ *
+ * @file
+ * @brief       Schema-compiled marshalling definitions
+ */
+
+#ifndef MARSHAL_H
+#define MARSHAL_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Defines the struct @p type with the members of @p FIELDS
+ */
+#define MARSHAL_STRUCT(type, FIELDS) \
+    typedef struct { FIELDS(_MARSHAL_MEMBER) } type
+
+/**
+ * @brief   Number of fields of a schema
+ */
+#define MARSHAL_FIELD_COUNT(FIELDS)     (0 FIELDS(_MARSHAL_ONE))
+
+/**
+ * @brief   Maximum size of a record in CBOR
+ */
+#define MARSHAL_CBOR_MAX(FIELDS)        (1 FIELDS(_MARSHAL_CBOR_FIELD_MAX))
+
+/**
+ * @brief   Maximum size of a record in UBJSON
+ */
+#define MARSHAL_UBJSON_MAX(FIELDS)      (2 FIELDS(_MARSHAL_UBJSON_FIELD_MAX))
+
+/**
+ * @brief   Declares the CBOR functions of a schema
+ *
+ * - `int <name>_cbor_encode(const type *rec, void *buf, size_t len)`
+ *   returns the size of the encoding or -ENOBUFS
+ * - `int <name>_cbor_decode(type *rec, const void *buf, size_t len)`
+ *   returns the number of bytes read, -EBADMSG on malformed input,
+ *   -ERANGE if a number does not fit into its member or -EMSGSIZE if a
+ *   text does not
+ * - `int <name>_cbor_encode_array(const type *recs, size_t n, void *buf,
+ *   size_t len)` encodes @p n records as an array
+ * - `int <name>_cbor_decode_array(type *recs, size_t *n, const void *buf,
+ *   size_t len)` decodes an array of at most `*n` records, sets `*n` to the
+ *   number of records and returns -ENOBUFS if there are more
+ */
+#define MARSHAL_CBOR_DECLARE(name, type) \
+    _MARSHAL_DECLARE(name, type, cbor)
+
+/**
+ * @brief   Declares the UBJSON functions of a schema, like
+ *          MARSHAL_CBOR_DECLARE()
+ */
+#define MARSHAL_UBJSON_DECLARE(name, type) \
+    _MARSHAL_DECLARE(name, type, ubjson)
+
+/**
+ * @brief   Defines the CBOR functions of a schema
+ */
+#define MARSHAL_CBOR(name, type, FIELDS)                                       \
+    static size_t _##name##_cbor_put(const type *rec, uint8_t *p)              \
+    {                                                                          \
+        uint8_t *start = p;                                                    \
+        _MARSHAL_CHECK(MARSHAL_FIELD_COUNT(FIELDS) < 24);                      \
+        *p++ = MARSHAL_CBOR_MAP | MARSHAL_FIELD_COUNT(FIELDS);                 \
+        FIELDS(_MARSHAL_CBOR_PUT)                                              \
+        return p - start;                                                      \
+    }                                                                          \
+    int name##_cbor_encode(const type *rec, void *buf, size_t len)             \
+    {                                                                          \
+        uint8_t tmp[MARSHAL_CBOR_MAX(FIELDS)];                                 \
+        size_t n;                                                              \
+        if (len >= sizeof(tmp)) {                                              \
+            return _##name##_cbor_put(rec, buf);                               \
+        }                                                                      \
+        if ((n = _##name##_cbor_put(rec, tmp)) > len) {                        \
+            return -ENOBUFS;                                                   \
+        }                                                                      \
+        memcpy(buf, tmp, n);                                                   \
+        return n;                                                              \
+    }                                                                          \
+    int name##_cbor_decode(type *rec, const void *buf, size_t len)             \
+    {                                                                          \
+        const uint8_t *p = buf, *end = p + len;                                \
+        uint64_t pairs;                                                        \
+        int res;                                                               \
+        memset(rec, 0, sizeof(*rec));                                          \
+        if ((res = marshal_cbor_get_head(p, end, MARSHAL_CBOR_MAP,             \
+                                         &pairs)) < 0) {                       \
+            return res;                                                        \
+        }                                                                      \
+        p += res;                                                              \
+        while (pairs--) {                                                      \
+            FIELDS(_MARSHAL_CBOR_GET)                                          \
+            if ((res = marshal_cbor_skip(p, end, 2)) < 0) {                    \
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+        }                                                                      \
+        return p - (const uint8_t *)buf;                                       \
+    }                                                                          \
+    int name##_cbor_encode_array(const type *recs, size_t n, void *buf,       \
+                                 size_t len)                                   \
+    {                                                                          \
+        uint8_t *p = buf, *end = p + len;                                      \
+        int res;                                                               \
+        if ((res = marshal_cbor_put_head(p, end, MARSHAL_CBOR_ARRAY, n)) < 0) {\
+            return res;                                                        \
+        }                                                                      \
+        p += res;                                                              \
+        if ((size_t)(end - p) / MARSHAL_CBOR_MAX(FIELDS) >= n) {               \
+            /* the worst case fits, no checks per record */                    \
+            for (size_t i = 0; i < n; i++) {                                   \
+                p += _##name##_cbor_put(&recs[i], p);                          \
+            }                                                                  \
+            return p - (uint8_t *)buf;                                         \
+        }                                                                      \
+        for (size_t i = 0; i < n; i++) {                                       \
+            if ((res = name##_cbor_encode(&recs[i], p, end - p)) < 0) {        \
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+        }                                                                      \
+        return p - (uint8_t *)buf;                                             \
+    }                                                                          \
+    int name##_cbor_decode_array(type *recs, size_t *n, const void *buf,      \
+                                 size_t len)                                   \
+    {                                                                          \
+        const uint8_t *p = buf, *end = p + len;                                \
+        uint64_t count;                                                        \
+        int res;                                                               \
+        if ((res = marshal_cbor_get_head(p, end, MARSHAL_CBOR_ARRAY,           \
+                                         &count)) < 0) {                       \
+            return res;                                                        \
+        }                                                                      \
+        if (count > *n) {                                                      \
+            return -ENOBUFS;                                                   \
+        }                                                                      \
+        p += res;                                                              \
+        for (size_t i = 0; i < count; i++) {                                   \
+            if ((res = name##_cbor_decode(&recs[i], p, end - p)) < 0) {        \
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+        }                                                                      \
+        *n = count;                                                            \
+        return p - (const uint8_t *)buf;                                       \
+    }
+
+/**
+ * @brief   Defines the UBJSON functions of a schema
+ */
+#define MARSHAL_UBJSON(name, type, FIELDS)                                     \
+    static size_t _##name##_ubjson_put(const type *rec, uint8_t *p)            \
+    {                                                                          \
+        uint8_t *start = p;                                                    \
+        *p++ = '{';                                                            \
+        FIELDS(_MARSHAL_UBJSON_PUT)                                            \
+        *p++ = '}';                                                            \
+        return p - start;                                                      \
+    }                                                                          \
+    int name##_ubjson_encode(const type *rec, void *buf, size_t len)           \
+    {                                                                          \
+        uint8_t tmp[MARSHAL_UBJSON_MAX(FIELDS)];                               \
+        size_t n;                                                              \
+        if (len >= sizeof(tmp)) {                                              \
+            return _##name##_ubjson_put(rec, buf);                             \
+        }                                                                      \
+        if ((n = _##name##_ubjson_put(rec, tmp)) > len) {                      \
+            return -ENOBUFS;                                                   \
+        }                                                                      \
+        memcpy(buf, tmp, n);                                                   \
+        return n;                                                              \
+    }                                                                          \
+    int name##_ubjson_decode(type *rec, const void *buf, size_t len)           \
+    {                                                                          \
+        const uint8_t *p = buf, *end = p + len;                                \
+        size_t klen;                                                           \
+        int res;                                                               \
+        memset(rec, 0, sizeof(*rec));                                          \
+        if ((p == end) || (*p++ != '{')) {                                     \
+            return -EBADMSG;                                                   \
+        }                                                                      \
+        for (;;) {                                                             \
+            if ((res = marshal_ubjson_get_key(p, end, &klen)) < 0) {           \
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+            if (klen == SIZE_MAX) {                                            \
+                /* end of the object */                                        \
+                return p - (const uint8_t *)buf;                               \
+            }                                                                  \
+            FIELDS(_MARSHAL_UBJSON_GET)                                        \
+            p += klen;                                                         \
+            if ((res = marshal_ubjson_skip(p, end)) < 0) {                     \
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+        }                                                                      \
+    }                                                                          \
+    int name##_ubjson_encode_array(const type *recs, size_t n, void *buf,     \
+                                   size_t len)                                 \
+    {                                                                          \
+        uint8_t *p = buf, *end = p + len;                                      \
+        int res;                                                               \
+        if (len < 2) {                                                         \
+            return -ENOBUFS;                                                   \
+        }                                                                      \
+        *p++ = '[';                                                            \
+        end--;                                                                 \
+        if ((size_t)(end - p) / MARSHAL_UBJSON_MAX(FIELDS) >= n) {             \
+            /* the worst case fits, no checks per record */                    \
+            for (size_t i = 0; i < n; i++) {                                   \
+                p += _##name##_ubjson_put(&recs[i], p);                        \
+            }                                                                  \
+        }                                                                      \
+        else {                                                                 \
+            for (size_t i = 0; i < n; i++) {                                   \
+                if ((res = name##_ubjson_encode(&recs[i], p, end - p)) < 0) {  \
+                    return res;                                                \
+                }                                                              \
+                p += res;                                                      \
+            }                                                                  \
+        }                                                                      \
+        *p++ = ']';                                                            \
+        return p - (uint8_t *)buf;                                             \
+    }                                                                          \
+    int name##_ubjson_decode_array(type *recs, size_t *n, const void *buf,    \
+                                   size_t len)                                 \
+    {                                                                          \
+        const uint8_t *p = buf, *end = p + len;                                \
+        size_t count = 0;                                                      \
+        int res;                                                               \
+        if ((p == end) || (*p++ != '[')) {                                     \
+            return -EBADMSG;                                                   \
+        }                                                                      \
+        while ((p < end) && (*p != ']')) {                                     \
+            if (count == *n) {                                                 \
+                return -ENOBUFS;                                               \
+            }                                                                  \
+            if ((res = name##_ubjson_decode(&recs[count++], p, end - p)) < 0) {\
+                return res;                                                    \
+            }                                                                  \
+            p += res;                                                          \
+        }                                                                      \
+        if (p == end) {                                                        \
+            return -EBADMSG;                                                   \
+        }                                                                      \
+        *n = count;                                                            \
+        return (p + 1) - (const uint8_t *)buf;                                 \
+    }
+
+/**
+ * @name    CBOR initial bytes
+ * @{
+ */
+#define MARSHAL_CBOR_UINT       (0x00U)     /**< unsigned integer */
+#define MARSHAL_CBOR_NEGINT     (0x20U)     /**< negative integer */
+#define MARSHAL_CBOR_TEXT       (0x60U)     /**< text string */
+#define MARSHAL_CBOR_ARRAY      (0x80U)     /**< array */
+#define MARSHAL_CBOR_MAP        (0xa0U)     /**< map */
+#define MARSHAL_CBOR_FALSE      (0xf4U)     /**< false */
+#define MARSHAL_CBOR_TRUE       (0xf5U)     /**< true */
+#define MARSHAL_CBOR_FLOAT32    (0xfaU)     /**< single precision float */
+/** @} */
+
+/**
+ * @name    Helpers called by the generated code
+ * @{
+ */
+int marshal_cbor_put_head(uint8_t *p, const uint8_t *end, uint8_t mt,
+                          uint64_t val);
+int marshal_cbor_get_head(const uint8_t *p, const uint8_t *end, uint8_t mt,
+                          uint64_t *val);
+int marshal_cbor_skip(const uint8_t *p, const uint8_t *end, unsigned items);
+int marshal_cbor_get_int32(const uint8_t *p, const uint8_t *end, int32_t *val);
+int marshal_cbor_get_uint32(const uint8_t *p, const uint8_t *end, uint32_t *val);
+int marshal_cbor_get_float(const uint8_t *p, const uint8_t *end, float *val);
+int marshal_cbor_get_bool(const uint8_t *p, const uint8_t *end, bool *val);
+int marshal_cbor_get_text(const uint8_t *p, const uint8_t *end, char *val,
+                          size_t size);
+int marshal_ubjson_get_key(const uint8_t *p, const uint8_t *end, size_t *len);
+int marshal_ubjson_skip(const uint8_t *p, const uint8_t *end);
+int marshal_ubjson_get_int32(const uint8_t *p, const uint8_t *end,
+                             int32_t *val);
+int marshal_ubjson_get_uint32(const uint8_t *p, const uint8_t *end,
+                              uint32_t *val);
+int marshal_ubjson_get_float(const uint8_t *p, const uint8_t *end, float *val);
+int marshal_ubjson_get_bool(const uint8_t *p, const uint8_t *end, bool *val);
+int marshal_ubjson_get_text(const uint8_t *p, const uint8_t *end, char *val,
+                            size_t size);
+
+static inline uint8_t *marshal_put_be32(uint8_t *p, uint32_t val)
+{
+    p[0] = val >> 24;
+    p[1] = val >> 16;
+    p[2] = val >> 8;
+    p[3] = val;
+    return p + 4;
+}
+
+static inline uint32_t marshal_float_bits(float val)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u = { .f = val };
+    return u.i;
+}
+
+static inline uint8_t *marshal_cbor_put_uint(uint8_t *p, uint8_t mt,
+                                             uint32_t val)
+{
+    if (val < 24) {
+        *p++ = mt | val;
+    }
+    else if (val <= 0xff) {
+        *p++ = mt | 24;
+        *p++ = val;
+    }
+    else if (val <= 0xffff) {
+        *p++ = mt | 25;
+        *p++ = val >> 8;
+        *p++ = val;
+    }
+    else {
+        *p++ = mt | 26;
+        p = marshal_put_be32(p, val);
+    }
+    return p;
+}
+
+static inline uint8_t *marshal_cbor_put_int32(uint8_t *p, int32_t val)
+{
+    if (val < 0) {
+        return marshal_cbor_put_uint(p, MARSHAL_CBOR_NEGINT, -1 - val);
+    }
+    return marshal_cbor_put_uint(p, MARSHAL_CBOR_UINT, val);
+}
+
+static inline uint8_t *marshal_cbor_put_float(uint8_t *p, float val)
+{
+    *p++ = MARSHAL_CBOR_FLOAT32;
+    return marshal_put_be32(p, marshal_float_bits(val));
+}
+
+static inline uint8_t *marshal_cbor_put_text(uint8_t *p, const char *val,
+                                             size_t size)
+{
+    size_t len = strnlen(val, size - 1);
+
+    p = marshal_cbor_put_uint(p, MARSHAL_CBOR_TEXT, len);
+    memcpy(p, val, len);
+    return p + len;
+}
+
+static inline uint8_t *marshal_ubjson_put_int32(uint8_t *p, int32_t val)
+{
+    if ((val >= INT8_MIN) && (val <= INT8_MAX)) {
+        *p++ = 'i';
+        *p++ = val;
+    }
+    else if ((val >= 0) && (val <= UINT8_MAX)) {
+        *p++ = 'U';
+        *p++ = val;
+    }
+    else if ((val >= INT16_MIN) && (val <= INT16_MAX)) {
+        *p++ = 'I';
+        *p++ = (uint16_t)val >> 8;
+        *p++ = val;
+    }
+    else {
+        *p++ = 'l';
+        p = marshal_put_be32(p, val);
+    }
+    return p;
+}
+
+static inline uint8_t *marshal_ubjson_put_uint32(uint8_t *p, uint32_t val)
+{
+    if (val <= INT32_MAX) {
+        return marshal_ubjson_put_int32(p, val);
+    }
+    *p++ = 'L';
+    p = marshal_put_be32(p, 0);
+    return marshal_put_be32(p, val);
+}
+
+static inline uint8_t *marshal_ubjson_put_float(uint8_t *p, float val)
+{
+    *p++ = 'd';
+    return marshal_put_be32(p, marshal_float_bits(val));
+}
+
+static inline uint8_t *marshal_ubjson_put_text(uint8_t *p, const char *val,
+                                               size_t size)
+{
+    size_t len = strnlen(val, size - 1);
+
+    *p++ = 'S';
+    p = marshal_ubjson_put_int32(p, len);
+    memcpy(p, val, len);
+    return p + len;
+}
+/** @} */
+
+/**
+ * @cond INTERNAL
+ */
+#define _MARSHAL_CHECK(cond)    ((void)sizeof(char[(cond) ? 1 : -1]))
+#define _MARSHAL_ONE(kind, member, key, size) + 1
+
+#define _MARSHAL_DECLARE(name, type, fmt)                                      \
+    int name##_##fmt##_encode(const type *rec, void *buf, size_t len);         \
+    int name##_##fmt##_decode(type *rec, const void *buf, size_t len);         \
+    int name##_##fmt##_encode_array(const type *recs, size_t n, void *buf,    \
+                                    size_t len);                               \
+    int name##_##fmt##_decode_array(type *recs, size_t *n, const void *buf,   \
+                                    size_t len)
+
+#define _MARSHAL_MEMBER(kind, member, key, size) _MARSHAL_MEMBER_##kind(member, size);
+#define _MARSHAL_MEMBER_INT32(member, size)     int32_t member
+#define _MARSHAL_MEMBER_UINT32(member, size)    uint32_t member
+#define _MARSHAL_MEMBER_FLOAT(member, size)     float member
+#define _MARSHAL_MEMBER_BOOL(member, size)      bool member
+#define _MARSHAL_MEMBER_TEXT(member, size)      char member[size]
+
+/* encoded size of a value */
+#define _MARSHAL_CBOR_MAX_INT32(size)           (5)
+#define _MARSHAL_CBOR_MAX_UINT32(size)          (5)
+#define _MARSHAL_CBOR_MAX_FLOAT(size)           (5)
+#define _MARSHAL_CBOR_MAX_BOOL(size)            (1)
+#define _MARSHAL_CBOR_MAX_TEXT(size)            (3 + (size) - 1)
+#define _MARSHAL_UBJSON_MAX_INT32(size)         (5)
+#define _MARSHAL_UBJSON_MAX_UINT32(size)        (9)
+#define _MARSHAL_UBJSON_MAX_FLOAT(size)         (5)
+#define _MARSHAL_UBJSON_MAX_BOOL(size)          (1)
+#define _MARSHAL_UBJSON_MAX_TEXT(size)          (6 + (size) - 1)
+
+/* a key takes its length byte(s) and its characters */
+#define _MARSHAL_CBOR_FIELD_MAX(kind, member, key, size) \
+    + sizeof(key) + _MARSHAL_CBOR_MAX_##kind(size)
+#define _MARSHAL_UBJSON_FIELD_MAX(kind, member, key, size) \
+    + 1 + sizeof(key) + _MARSHAL_UBJSON_MAX_##kind(size)
+
+#define _MARSHAL_PUT_INT32(fmt, p, val, size)   marshal_##fmt##_put_int32(p, val)
+#define _MARSHAL_PUT_UINT32(fmt, p, val, size)  marshal_##fmt##_put_uint32(p, val)
+#define _MARSHAL_PUT_FLOAT(fmt, p, val, size)   marshal_##fmt##_put_float(p, val)
+#define _MARSHAL_PUT_BOOL(fmt, p, val, size)    marshal_##fmt##_put_bool(p, val)
+#define _MARSHAL_PUT_TEXT(fmt, p, val, size)    marshal_##fmt##_put_text(p, val, size)
+
+#define _MARSHAL_GET_INT32(fmt, p, end, val, size)  marshal_##fmt##_get_int32(p, end, &val)
+#define _MARSHAL_GET_UINT32(fmt, p, end, val, size) marshal_##fmt##_get_uint32(p, end, &val)
+#define _MARSHAL_GET_FLOAT(fmt, p, end, val, size)  marshal_##fmt##_get_float(p, end, &val)
+#define _MARSHAL_GET_BOOL(fmt, p, end, val, size)   marshal_##fmt##_get_bool(p, end, &val)
+#define _MARSHAL_GET_TEXT(fmt, p, end, val, size)   marshal_##fmt##_get_text(p, end, val, size)
+
+#define _MARSHAL_CBOR_PUT(kind, member, key, size)                             \
+    _MARSHAL_CHECK(sizeof(key) <= 24);                                         \
+    *p++ = MARSHAL_CBOR_TEXT | (sizeof(key) - 1);                              \
+    memcpy(p, key, sizeof(key) - 1);                                           \
+    p += sizeof(key) - 1;                                                      \
+    p = _MARSHAL_PUT_##kind(cbor, p, rec->member, size);
+
+#define _MARSHAL_CBOR_GET(kind, member, key, size)                             \
+    if (((size_t)(end - p) >= sizeof(key)) &&                                  \
+        (p[0] == (MARSHAL_CBOR_TEXT | (sizeof(key) - 1))) &&                   \
+        !memcmp(&p[1], key, sizeof(key) - 1)) {                                \
+        p += sizeof(key);                                                      \
+        if ((res = _MARSHAL_GET_##kind(cbor, p, end, rec->member, size)) < 0) {\
+            return res;                                                        \
+        }                                                                      \
+        p += res;                                                              \
+        continue;                                                              \
+    }
+
+#define _MARSHAL_UBJSON_PUT(kind, member, key, size)                           \
+    _MARSHAL_CHECK(sizeof(key) <= 128);                                        \
+    *p++ = 'i';                                                                \
+    *p++ = sizeof(key) - 1;                                                    \
+    memcpy(p, key, sizeof(key) - 1);                                           \
+    p += sizeof(key) - 1;                                                      \
+    p = _MARSHAL_PUT_##kind(ubjson, p, rec->member, size);
+
+#define _MARSHAL_UBJSON_GET(kind, member, key, size)                           \
+    if ((klen == sizeof(key) - 1) && !memcmp(p, key, klen)) {                  \
+        p += klen;                                                             \
+        if ((res = _MARSHAL_GET_##kind(ubjson, p, end, rec->member, size)) < 0) {\
+            return res;                                                        \
+        }                                                                      \
+        p += res;                                                              \
+        continue;                                                              \
+    }
+
+static inline uint8_t *marshal_cbor_put_uint32(uint8_t *p, uint32_t val)
+{
+    return marshal_cbor_put_uint(p, MARSHAL_CBOR_UINT, val);
+}
+
+static inline uint8_t *marshal_cbor_put_bool(uint8_t *p, bool val)
+{
+    *p = val ? MARSHAL_CBOR_TRUE : MARSHAL_CBOR_FALSE;
+    return p + 1;
+}
+
+static inline uint8_t *marshal_ubjson_put_bool(uint8_t *p, bool val)
+{
+    *p = val ? 'T' : 'F';
+    return p + 1;
+}
+/** @endcond */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MARSHAL_H */
+/** @} */
@@ -35,6 +35,8 @@
  * - Server Operation
  * - Client Operation
  * - Observe Server Operation
+ * - Block-wise Transfer
+ * - Worker Threads
  * - Implementation Notes
  * - Implementation Status
  *
@@ -159,6 +161,100 @@
  * the Observe option value set to 1. The server does not support cancellation
  * via a reset (RST) response to a non-confirmable notification.
  *
+ * ## Block-wise Transfer ##
+ *
+ * gcoap supports block-wise transfer (RFC 7959) for representations that do
+ * not fit in a single PDU. A block-wise transfer is a sequence of ordinary
+ * request/response exchanges, each carrying one block of the representation
+ * in the Block1 (request payload) or Block2 (response payload) option. gcoap
+ * never buffers the full representation; the application produces or
+ * consumes one block at a time.
+ *
+ * The block size is 2^(SZX + 4) bytes. gcoap never uses a block size larger
+ * than GCOAP_BLOCK_SZX_MAX, and accepts a smaller size proposed by the peer.
+ * The default keeps a block within a single IEEE 802.15.4 frame.
+ *
+ * ### Server: streaming a large response (Block2) ###
+ *
+ * Implement a gcoap_block_writer_t, which writes the part of the
+ * representation starting at a given offset, and call
+ * gcoap_block2_response() from the resource handler. gcoap reads the Block2
+ * option of the request, negotiates the block size, and adds a Block2 option
+ * to the response only if the representation does not fit in one block.
+ *
+ * ### Server: receiving a large request (Block1) ###
+ *
+ * Implement a gcoap_block_reader_t, which consumes the payload of a block at
+ * a given offset, and call gcoap_block1_response() from the resource handler.
+ * gcoap responds with 2.31 (Continue) until the final block has been
+ * consumed, and then with the code provided by the handler. The Block1 option
+ * of a response echoes the number of the block received; if the client's
+ * blocks are larger than GCOAP_BLOCK_SZX_MAX, its size exponent is lowered to
+ * propose the smaller size for the next blocks.
+ *
+ * ### Client ###
+ *
+ * A client uses gcoap_finish_block() instead of gcoap_finish() to add a Block1
+ * or Block2 option to a request. In the response handler, read the block
+ * option from the response with gcoap_get_block(), and use
+ * gcoap_block_advance() to determine the next block to send or to request.
+ *
+ * ## Worker Threads ##
+ *
+ * By default, the gcoap thread runs a resource handler itself, so a slow
+ * handler delays all other CoAP traffic. With the `gcoap_workers` module,
+ * the gcoap thread only receives and parses requests, and queues them for a
+ * pool of GCOAP_WORKERS_NUMOF handler threads. A resource handler then may
+ * block, e.g. to read a sensor, without delaying other resources.
+ *
+ * gcoap handles the message layer for queued requests:
+ *
+ * - A duplicate of a request that still is queued or being handled is
+ *   dropped.
+ * - A response to a confirmable request is piggybacked on the ACK if the
+ *   handler finishes within GCOAP_SEPARATE_RESP_DELAY. Otherwise gcoap
+ *   acknowledges the request with an empty ACK, and sends the response
+ *   later as a separate, non-confirmable message.
+ * - If the queue is full, gcoap responds with 5.03 (Service Unavailable).
+ *
+ * Resource handlers may run concurrently, so a handler must protect any state
+ * it shares with other handlers. The request and response buffer is private
+ * to the handler.
+ *
+ * ## Payload Compression ##
+ *
+ * Text payloads such as JSON or SenML are verbose, and on a slow link like
+ * IEEE 802.15.4 or LoRa every byte costs airtime. The `gcoap_heatshrink`
+ * module compresses payloads with the heatshrink LZSS codec. A compressed
+ * payload has the Content-Format GCOAP_FORMAT_HEATSHRINK and starts with the
+ * original Content-Format as a two byte, big endian value.
+ *
+ * A client asks for a compressed response with an Accept option, written by
+ * gcoap_finish_accept():
+ *
+ *     gcoap_req_init(&pdu, buf, len, COAP_METHOD_GET, "/sensors");
+ *     len = gcoap_finish_accept(&pdu, 0, COAP_FORMAT_NONE,
+ *                               GCOAP_FORMAT_HEATSHRINK);
+ *
+ * A server that does not know the format responds with 4.06 (Not
+ * Acceptable), so the client may repeat the request without the option. In
+ * the resource handler, check the request with gcoap_accepts_compressed()
+ * *before* gcoap_resp_init() overwrites it, and finish the response with
+ * gcoap_finish_compressed(). The payload is sent as is if compressing it
+ * does not save space. A client compresses a request payload the same way
+ * once it knows that the server supports the format, e.g. from a compressed
+ * response.
+ *
+ * Read a payload with gcoap_get_payload(), which decompresses it if needed,
+ * and returns the original Content-Format.
+ *
+ * The encoder and decoder state is taken from a pool of
+ * GCOAP_HEATSHRINK_POOL_SIZE entries, so there is no allocation per message.
+ * The pool is shared by all users of the gcoap socket; a thread waits if all
+ * entries are in use. gcoap_heatshrink_compress() and
+ * gcoap_heatshrink_uncompress() use the same pool for payloads sent with
+ * sock_udp directly.
+ *
  * ## Implementation Notes ##
  *
  * ### Building a packet ###
@@ -197,6 +293,11 @@
  *   in a user provided callback.
  * - Client generates token; length defined at compile time.
  * - Options: Supports Content-Format for payload.
+ * - Block-wise transfer: Supports Block1 and Block2 options for a server
+ *   and client. Does not support the Size1 and Size2 options.
+ * - Server optionally handles requests with a pool of worker threads, see
+ *   `gcoap_workers` above.
+ * - Payloads optionally are compressed, see `gcoap_heatshrink` above.
  *
  * @{
  *
@@ -212,6 +313,7 @@
 
 #include <stdint.h>
 #include <stdatomic.h>
+#include <stdbool.h>
 #include "net/sock/udp.h"
 #include "mutex.h"
 #include "nanocoap.h"
@@ -240,20 +342,27 @@ extern "C" {
 #define GCOAP_PDU_BUF_SIZE      (128)
 #endif
 
+/**
+ * @brief   Size of the buffer used to write a Block1 or Block2 option
+ *
+ * One byte option header, one byte extended delta, up to three value bytes.
+ */
+#define GCOAP_BLOCK_OPTIONS_BUF (5)
+
 /**
  * @brief   Size of the buffer used to write options, other than Uri-Path, in a
  *          request
  *
- * Accommodates Content-Format and Uri-Queries
+ * Accommodates Content-Format, Uri-Queries and a block option
  */
-#define GCOAP_REQ_OPTIONS_BUF   (40)
+#define GCOAP_REQ_OPTIONS_BUF   (40 + GCOAP_BLOCK_OPTIONS_BUF)
 
 /**
  * @brief   Size of the buffer used to write options in a response
  *
- * Accommodates Content-Format.
+ * Accommodates Content-Format and a block option.
  */
-#define GCOAP_RESP_OPTIONS_BUF  (8)
+#define GCOAP_RESP_OPTIONS_BUF  (8 + GCOAP_BLOCK_OPTIONS_BUF)
 
 /**
  * @brief   Size of the buffer used to write options in an Observe notification
@@ -331,6 +440,45 @@ extern "C" {
  */
 #define GCOAP_MSG_TYPE_INTR     (0x1502)
 
+/**
+ * @brief   Identifies expiry of the wait for a worker thread to finish a
+ *          confirmable request
+ */
+#define GCOAP_MSG_TYPE_ACK_DELAY    (0x1503)
+
+/**
+ * @brief   Number of worker threads for module `gcoap_workers`
+ */
+#ifndef GCOAP_WORKERS_NUMOF
+#define GCOAP_WORKERS_NUMOF     (2)
+#endif
+
+/**
+ * @brief   Maximum number of requests queued or in process for module
+ *          `gcoap_workers`; must be a power of two
+ */
+#ifndef GCOAP_WORKER_QUEUE_SIZE
+#define GCOAP_WORKER_QUEUE_SIZE (4)
+#endif
+
+/**
+ * @brief   Stack size for a worker thread
+ */
+#ifndef GCOAP_WORKER_STACK_SIZE
+#define GCOAP_WORKER_STACK_SIZE (THREAD_STACKSIZE_DEFAULT + DEBUG_EXTRA_STACKSIZE \
+                                 + GCOAP_PDU_BUF_SIZE)
+#endif
+
+/**
+ * @brief   Time to wait for a worker thread to finish a confirmable request
+ *          before acknowledging it with an empty ACK [in usec]
+ *
+ * Must be shorter than the ACK_TIMEOUT of the client, 2 sec by default.
+ */
+#ifndef GCOAP_SEPARATE_RESP_DELAY
+#define GCOAP_SEPARATE_RESP_DELAY   (1 * US_PER_SEC)
+#endif
+
 /**
  * @brief   Maximum number of Observe clients; use 2 if not defined
  */
@@ -398,6 +546,84 @@ extern "C" {
 #define GCOAP_OBS_INIT_UNUSED   (-2)
 /** @} */
 
+/**
+ * @name    Block-wise transfer option numbers and response codes (RFC 7959)
+ * @{
+ */
+#ifndef COAP_OPT_BLOCK2
+#define COAP_OPT_BLOCK2         (23)
+#endif
+#ifndef COAP_OPT_BLOCK1
+#define COAP_OPT_BLOCK1         (27)
+#endif
+#ifndef COAP_CODE_CONTINUE
+#define COAP_CODE_CONTINUE      ((2 << 5) | 31)
+#endif
+#ifndef COAP_CODE_BAD_OPTION
+#define COAP_CODE_BAD_OPTION    ((4 << 5) | 2)
+#endif
+#ifndef COAP_CODE_REQUEST_ENTITY_INCOMPLETE
+#define COAP_CODE_REQUEST_ENTITY_INCOMPLETE ((4 << 5) | 8)
+#endif
+#ifndef COAP_CODE_REQUEST_ENTITY_TOO_LARGE
+#define COAP_CODE_REQUEST_ENTITY_TOO_LARGE  ((4 << 5) | 13)
+#endif
+/** @} */
+
+/**
+ * @brief   Accept option number (RFC 7252)
+ */
+#ifndef COAP_OPT_ACCEPT
+#define COAP_OPT_ACCEPT         (17)
+#endif
+
+/**
+ * @brief   Content-Format of a payload compressed by module
+ *          `gcoap_heatshrink`
+ *
+ * Taken from the experimental range of the CoAP Content-Formats registry.
+ */
+#ifndef GCOAP_FORMAT_HEATSHRINK
+#define GCOAP_FORMAT_HEATSHRINK     (65001U)
+#endif
+
+/**
+ * @brief   Number of encoder/decoder states for module `gcoap_heatshrink`
+ *
+ * Each entry takes about 2 KiB with the default heatshrink configuration.
+ * Increase to compress in several threads at once, e.g. with
+ * `gcoap_workers`.
+ */
+#ifndef GCOAP_HEATSHRINK_POOL_SIZE
+#define GCOAP_HEATSHRINK_POOL_SIZE  (1)
+#endif
+
+/**
+ * @brief   Size of the largest payload module `gcoap_heatshrink` compresses
+ */
+#ifndef GCOAP_HEATSHRINK_BUF_SIZE
+#define GCOAP_HEATSHRINK_BUF_SIZE   (GCOAP_PDU_BUF_SIZE)
+#endif
+
+/**
+ * @brief   Payloads shorter than this are not worth compressing
+ */
+#ifndef GCOAP_HEATSHRINK_MIN
+#define GCOAP_HEATSHRINK_MIN        (24U)
+#endif
+
+/**
+ * @brief   Largest block size exponent (SZX) used for block-wise transfers
+ *
+ * The block size is 2^(SZX + 4) bytes. The default of 2 (64 bytes) leaves
+ * room for the CoAP, UDP and compressed IPv6 headers, so a block fits into a
+ * single IEEE 802.15.4 frame without 6LoWPAN fragmentation. Must be in the
+ * range 0 to 6.
+ */
+#ifndef GCOAP_BLOCK_SZX_MAX
+#define GCOAP_BLOCK_SZX_MAX     (2)
+#endif
+
 /**
  * @brief Stack size for module thread
  */
@@ -446,6 +672,49 @@ typedef struct {
     unsigned token_len;                 /**< Actual length of token attribute */
 } gcoap_observe_memo_t;
 
+/**
+ * @brief   Value of a Block1 or Block2 option
+ */
+typedef struct {
+    uint32_t num;                       /**< Block number */
+    uint8_t szx;                        /**< Size exponent; block size is
+                                             2^(szx + 4) bytes */
+    uint8_t more;                       /**< 1 if more blocks follow */
+} gcoap_block_t;
+
+/**
+ * @brief   Writes part of a representation for a Block2 response
+ *
+ * @param[in] offset    Offset of the first byte to write within the
+ *                      representation
+ * @param[out] buf      Buffer to write to
+ * @param[in] len       Length of @p buf; one byte more than the block size,
+ *                      so the writer reveals if more data follows
+ * @param[in] arg       Application context
+ *
+ * @return  number of bytes written, 0 if @p offset is past the end
+ * @return  < 0 on error
+ */
+typedef ssize_t (*gcoap_block_writer_t)(size_t offset, uint8_t *buf,
+                                        size_t len, void *arg);
+
+/**
+ * @brief   Consumes one block of a Block1 request payload
+ *
+ * @param[in] offset    Offset of @p buf within the representation
+ * @param[in] buf       Block payload
+ * @param[in] len       Length of @p buf
+ * @param[in] more      1 if more blocks follow, 0 for the final block
+ * @param[in] arg       Application context
+ *
+ * @return  0 on success
+ * @return  -EFBIG if the representation is too large for the application
+ * @return  other negative value if the block was not expected, e.g. out of
+ *          order
+ */
+typedef int (*gcoap_block_reader_t)(size_t offset, const uint8_t *buf,
+                                    size_t len, int more, void *arg);
+
 /**
  * @brief   Container for the state of gcoap itself
  */
@@ -513,6 +782,43 @@ int gcoap_req_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
  */
 ssize_t gcoap_finish(coap_pkt_t *pdu, size_t payload_len, unsigned format);
 
+/**
+ * @brief   Finishes formatting a CoAP PDU and adds a block option
+ *
+ * Same as gcoap_finish(), but also writes a Block1 or Block2 option.
+ *
+ * @param[in,out] pdu       Request or response metadata
+ * @param[in] payload_len   Length of the payload, or 0 if none
+ * @param[in] format        Format code for the payload; use COAP_FORMAT_NONE if
+ *                          not specified
+ * @param[in] blockopt      COAP_OPT_BLOCK1 or COAP_OPT_BLOCK2
+ * @param[in] block         Value for the block option
+ *
+ * @return  size of the PDU
+ * @return  < 0 on error
+ */
+ssize_t gcoap_finish_block(coap_pkt_t *pdu, size_t payload_len,
+                           unsigned format, unsigned blockopt,
+                           const gcoap_block_t *block);
+
+/**
+ * @brief   Finishes formatting a CoAP request and adds an Accept option
+ *
+ * Same as gcoap_finish(), but also tells the server which Content-Format the
+ * client wants in the response.
+ *
+ * @param[in,out] pdu       Request metadata
+ * @param[in] payload_len   Length of the payload, or 0 if none
+ * @param[in] format        Format code for the payload; use COAP_FORMAT_NONE if
+ *                          not specified
+ * @param[in] accept        Format code for the response
+ *
+ * @return  size of the PDU
+ * @return  < 0 on error
+ */
+ssize_t gcoap_finish_accept(coap_pkt_t *pdu, size_t payload_len,
+                            unsigned format, unsigned accept);
+
 /**
  * @brief   Writes a complete CoAP request PDU when there is not a payload
  *
@@ -633,6 +939,116 @@ int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 size_t gcoap_obs_send(const uint8_t *buf, size_t len,
                       const coap_resource_t *resource);
 
+/**
+ * @brief   Reads a Block1 or Block2 option from a received PDU
+ *
+ * If the option is not present, @p block is set to the first block with the
+ * largest block size gcoap supports.
+ *
+ * @pre     The options of @p pdu end at `pdu->payload`. This holds for any PDU
+ *          gcoap passes to a handler, and after coap_parse() for a PDU with
+ *          payload. Otherwise point `pdu->payload` at the end of the PDU.
+ *
+ * @param[in] pdu       Received request or response
+ * @param[in] blockopt  COAP_OPT_BLOCK1 or COAP_OPT_BLOCK2
+ * @param[out] block    Value of the option
+ *
+ * @return  1 if the option is present
+ * @return  0 if the option is not present
+ * @return  -EBADMSG if the option is malformed
+ */
+int gcoap_get_block(coap_pkt_t *pdu, unsigned blockopt, gcoap_block_t *block);
+
+/**
+ * @brief   Returns the size of a block in bytes
+ *
+ * @param[in] block     Block option value
+ *
+ * @return  block size
+ */
+static inline size_t gcoap_block_size(const gcoap_block_t *block)
+{
+    return (size_t)1 << (block->szx + 4);
+}
+
+/**
+ * @brief   Returns the offset of a block within the representation
+ *
+ * @param[in] block     Block option value
+ *
+ * @return  offset of the first byte of the block
+ */
+static inline size_t gcoap_block_offset(const gcoap_block_t *block)
+{
+    return (size_t)block->num << (block->szx + 4);
+}
+
+/**
+ * @brief   Advances to the block following @p block
+ *
+ * Also applies a smaller block size proposed by the peer. Use for the next
+ * Block1 request after a 2.31 (Continue) response, or for the next Block2
+ * request after a response with the 'more' flag set.
+ *
+ * @param[in,out] block Block to advance
+ * @param[in] szx       Size exponent proposed by the peer
+ */
+static inline void gcoap_block_advance(gcoap_block_t *block, unsigned szx)
+{
+    size_t next = gcoap_block_offset(block) + gcoap_block_size(block);
+
+    if (szx < block->szx) {
+        block->szx = szx;
+    }
+    block->num = next >> (block->szx + 4);
+}
+
+/**
+ * @brief   Writes a response with one block of a representation (Block2)
+ *
+ * Use from a resource handler. Reads the Block2 option from the request,
+ * negotiates the block size with the client and the space in @p buf, and
+ * calls @p writer for the requested block. Adds a Block2 option to the
+ * response unless the whole representation fits into a single block and the
+ * client did not ask for a block.
+ *
+ * @param[in,out] pdu   Request on input, response on output
+ * @param[in] buf       Buffer containing the PDU
+ * @param[in] len       Length of the buffer
+ * @param[in] format    Format code for the payload
+ * @param[in] writer    Writes the block payload
+ * @param[in] arg       Application context passed to @p writer
+ *
+ * @return  size of the response PDU
+ * @return  < 0 on error
+ */
+ssize_t gcoap_block2_response(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned format, gcoap_block_writer_t writer,
+                              void *arg);
+
+/**
+ * @brief   Consumes one block of a request payload and writes the response
+ *          (Block1)
+ *
+ * Use from a resource handler. Reads the Block1 option from the request and
+ * passes the payload to @p reader. A request without Block1 option is handled
+ * as a single, final block. Responds with 2.31 (Continue) while more blocks
+ * are expected, and with @p code after the final block.
+ *
+ * @param[in,out] pdu   Request on input, response on output
+ * @param[in] buf       Buffer containing the PDU
+ * @param[in] len       Length of the buffer
+ * @param[in] code      Response code after the final block
+ * @param[in] reader    Consumes the block payload
+ * @param[in] arg       Application context passed to @p reader
+ *
+ * @return  size of the response PDU
+ * @return  < 0 on error
+ */
+ssize_t gcoap_block1_response(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned code, gcoap_block_reader_t reader,
+                              void *arg);
+
 /**
  * @brief   Provides important operational statistics
  *
@@ -679,6 +1095,85 @@ int gcoap_get_resource_list(void *buf, size_t maxlen, uint8_t cf);
  */
 int gcoap_add_qstring(coap_pkt_t *pdu, const char *key, const char *val);
 
+#if defined(MODULE_GCOAP_HEATSHRINK) || defined(DOXYGEN)
+/**
+ * @brief   Finishes formatting a CoAP PDU with a compressed payload
+ *
+ * Same as gcoap_finish(), but compresses the payload first. Sends the
+ * payload as is if it is shorter than GCOAP_HEATSHRINK_MIN or
+ * GCOAP_HEATSHRINK_BUF_SIZE, or if compressing it does not save space.
+ *
+ * @param[in,out] pdu       Request or response metadata
+ * @param[in] payload_len   Length of the payload, or 0 if none
+ * @param[in] format        Format code for the payload
+ *
+ * @return  size of the PDU
+ * @return  < 0 on error
+ */
+ssize_t gcoap_finish_compressed(coap_pkt_t *pdu, size_t payload_len,
+                                unsigned format);
+
+/**
+ * @brief   Checks if a received request accepts a compressed response
+ *
+ * @pre     Called before the request is overwritten by gcoap_resp_init()
+ *
+ * @param[in] pdu       Received request
+ *
+ * @return  true if the request has an Accept option for
+ *          GCOAP_FORMAT_HEATSHRINK
+ */
+bool gcoap_accepts_compressed(coap_pkt_t *pdu);
+
+/**
+ * @brief   Reads the payload of a received PDU, decompressing it if needed
+ *
+ * @param[in] pdu       Received request or response
+ * @param[out] buf      Buffer for the payload; must not overlap the PDU
+ * @param[in] len       Length of @p buf
+ * @param[out] format   Content-Format of the payload, COAP_FORMAT_NONE if
+ *                      not specified
+ *
+ * @return  length of the payload
+ * @return  -ENOBUFS if the payload does not fit into @p buf
+ * @return  -EBADMSG if the PDU is malformed or the compressed payload is
+ *          truncated
+ * @return  -EINVAL if the decoder fails on the compressed payload
+ */
+ssize_t gcoap_get_payload(coap_pkt_t *pdu, void *buf, size_t len,
+                          unsigned *format);
+
+/**
+ * @brief   Compresses a buffer with a state from the pool
+ *
+ * @param[in] in        Data to compress
+ * @param[in] len       Length of @p in
+ * @param[out] out      Buffer for the compressed data
+ * @param[in] out_len   Length of @p out
+ *
+ * @return  length of the compressed data
+ * @return  -ENOBUFS if it does not fit into @p out
+ */
+ssize_t gcoap_heatshrink_compress(const void *in, size_t len, void *out,
+                                  size_t out_len);
+
+/**
+ * @brief   Decompresses a buffer with a state from the pool
+ *
+ * @param[in] in        Compressed data
+ * @param[in] len       Length of @p in
+ * @param[out] out      Buffer for the data
+ * @param[in] out_len   Length of @p out
+ *
+ * @return  length of the data
+ * @return  -ENOBUFS if it does not fit into @p out
+ * @return  -EBADMSG if @p in is truncated
+ * @return  -EINVAL if the decoder fails on @p in
+ */
+ssize_t gcoap_heatshrink_uncompress(const void *in, size_t len, void *out,
+                                    size_t out_len);
+#endif /* MODULE_GCOAP_HEATSHRINK */
+
 #ifdef __cplusplus
 }
 #endif
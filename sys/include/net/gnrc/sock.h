@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_sock
+ * @brief       GNRC-specific extensions to the sock API
+ *
+ * These functions expose GNRC internals, so applications using them are not
+ * portable to other network stacks.
+ *
+ * Asynchronous receive
+ * ====================
+ *
+ * With the `gnrc_sock_async` module, the stack can notify the application
+ * when a packet was queued for a sock instead of the application blocking in
+ * a receive function. Either register a callback with
+ * gnrc_sock_udp_set_cb() / gnrc_sock_ip_set_cb(), or let the stack send a
+ * @ref GNRC_SOCK_MSG_TYPE_RECV message to a thread with
+ * gnrc_sock_udp_set_notify() / gnrc_sock_ip_set_notify(). The latter allows
+ * a single thread to serve many socks from its message loop:
+ *
+ * ~~~~~~~~~~~~~~~~~~~ {.c}
+ * gnrc_sock_udp_set_notify(&dns_sock, thread_getpid());
+ * gnrc_sock_udp_set_notify(&sntp_sock, thread_getpid());
+ *
+ * while (1) {
+ *     msg_t msg;
+ *
+ *     msg_receive(&msg);
+ *     if (msg.type == GNRC_SOCK_MSG_TYPE_RECV) {
+ *         sock_udp_t *sock = msg.content.ptr;
+ *
+ *         while ((res = sock_udp_recv(sock, buf, sizeof(buf), 0, &remote)) >= 0) {
+ *             handle(sock, buf, res, &remote);
+ *         }
+ *     }
+ * }
+ * ~~~~~~~~~~~~~~~~~~~
+ *
+ * One notification is issued for every packet queued, so a receive with
+ * timeout 0 may still return -EAGAIN when earlier notifications already
+ * drained the queue.
+ *
+ * @{
+ *
+ * @file
+ * @brief       GNRC-specific sock extensions
+ */
+
+#ifndef NET_GNRC_SOCK_H
+#define NET_GNRC_SOCK_H
+
+#include "kernel_types.h"
+#include "msg.h"
+#include "net/gnrc/pkt.h"
+#include "net/sock/ip.h"
+#include "net/sock/udp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Receives a UDP message without copying its payload
+ *
+ * Like sock_udp_recv(), but hands out the packet itself instead of copying
+ * the payload. The first snip of @p pkt is the UDP payload; the headers
+ * follow in gnrc_pktsnip_t::next. The caller must release @p pkt with
+ * gnrc_pktbuf_release() when done.
+ *
+ * @pre `(sock != NULL) && (pkt != NULL)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[out] pkt      The received packet.
+ * @param[in] timeout   Timeout for receive in microseconds, as for
+ *                      sock_udp_recv().
+ * @param[out] remote   Remote end point of the received data. May be `NULL`.
+ *
+ * @return  The length of the payload on success.
+ * @return  The errors of sock_udp_recv(), except -ENOBUFS.
+ */
+ssize_t gnrc_sock_udp_recv_pkt(sock_udp_t *sock, gnrc_pktsnip_t **pkt,
+                               uint32_t timeout, sock_udp_ep_t *remote);
+
+/**
+ * @brief   Replaces the receive queue of a UDP sock object
+ *
+ * The receive queue holds @ref SOCK_MBOX_SIZE packets by default. A sock
+ * which receives bursts of datagrams may use a deeper queue, so packets are
+ * not dropped while the application is busy. Packets waiting in the current
+ * queue are dropped. The queue can't be replaced while a thread is blocked
+ * receiving from the sock; it is not moved to the new queue, the call fails
+ * instead.
+ *
+ * @pre `(sock != NULL) && (queue != NULL)`
+ * @pre @p queue_size is a power of two
+ *
+ * @param[in] sock          A UDP sock object with a local end point.
+ * @param[in] queue         Queue for the sock; must stay valid until the sock
+ *                          is closed.
+ * @param[in] queue_size    Number of messages in @p queue.
+ *
+ * @return  0 on success.
+ * @return  -EADDRNOTAVAIL, if local of @p sock is not given.
+ * @return  -EBUSY, if a thread is blocked receiving from @p sock.
+ */
+int gnrc_sock_udp_set_queue(sock_udp_t *sock, msg_t *queue,
+                            unsigned queue_size);
+
+/**
+ * @brief   Returns the number of packets queued for a UDP sock
+ *
+ * A receive call with timeout 0 will not return -EAGAIN when this is not 0.
+ *
+ * @pre `sock != NULL`
+ *
+ * @param[in] sock  A UDP sock object.
+ *
+ * @return  Number of packets waiting in the receive queue of @p sock.
+ * @return  0, if local of @p sock is not given.
+ */
+unsigned gnrc_sock_udp_avail(sock_udp_t *sock);
+
+/**
+ * @brief   Returns the number of packets queued for a raw IP sock
+ *
+ * @pre `sock != NULL`
+ *
+ * @param[in] sock  A raw IP sock object.
+ *
+ * @return  Number of packets waiting in the receive queue of @p sock.
+ */
+unsigned gnrc_sock_ip_avail(sock_ip_t *sock);
+
+#if defined(MODULE_GNRC_SOCK_ASYNC) || defined(DOXYGEN)
+/**
+ * @brief   Message type to notify a thread about a packet queued for a sock
+ *
+ * gnrc_sock_udp_set_notify() and gnrc_sock_ip_set_notify() make the stack
+ * send this message type. msg_t::content::ptr points to the sock.
+ *
+ * @note    Only available with the `gnrc_sock_async` module.
+ */
+#define GNRC_SOCK_MSG_TYPE_RECV         (0x0207)
+
+/**
+ * @brief   Receive callback for UDP socks
+ *
+ * @param[in] sock  The sock a packet was queued for.
+ * @param[in] arg   Argument given to gnrc_sock_udp_set_cb().
+ */
+typedef void (*gnrc_sock_udp_cb_t)(sock_udp_t *sock, void *arg);
+
+/**
+ * @brief   Receive callback for raw IP socks
+ *
+ * @param[in] sock  The sock a packet was queued for.
+ * @param[in] arg   Argument given to gnrc_sock_ip_set_cb().
+ */
+typedef void (*gnrc_sock_ip_cb_t)(sock_ip_t *sock, void *arg);
+
+/**
+ * @brief   Sets a callback that is called when a packet was queued for a
+ *          UDP sock
+ *
+ * The callback runs in the context of the UDP thread, so it must not block.
+ * It may fetch the packet with a receive function and a timeout of 0.
+ *
+ * @pre `sock != NULL`
+ *
+ * @note    Only available with the `gnrc_sock_async` module.
+ *
+ * @param[in] sock  A UDP sock object with a local end point.
+ * @param[in] cb    The callback. `NULL` removes a previously set callback.
+ * @param[in] arg   Argument for @p cb.
+ *
+ * @return  0 on success.
+ * @return  -EADDRNOTAVAIL, if local of @p sock is not given.
+ */
+int gnrc_sock_udp_set_cb(sock_udp_t *sock, gnrc_sock_udp_cb_t cb, void *arg);
+
+/**
+ * @brief   Sets a thread that gets a @ref GNRC_SOCK_MSG_TYPE_RECV message
+ *          when a packet was queued for a UDP sock
+ *
+ * The message is sent non-blocking, so the thread needs a message queue.
+ *
+ * @pre `sock != NULL`
+ *
+ * @note    Only available with the `gnrc_sock_async` module.
+ *
+ * @param[in] sock  A UDP sock object with a local end point.
+ * @param[in] pid   The thread to notify. KERNEL_PID_UNDEF disables the
+ *                  notification.
+ *
+ * @return  0 on success.
+ * @return  -EADDRNOTAVAIL, if local of @p sock is not given.
+ */
+int gnrc_sock_udp_set_notify(sock_udp_t *sock, kernel_pid_t pid);
+
+/**
+ * @brief   Sets a callback that is called when a packet was queued for a
+ *          raw IP sock
+ *
+ * The callback runs in the context of the IPv6 thread, so it must not block.
+ *
+ * @pre `sock != NULL`
+ *
+ * @note    Only available with the `gnrc_sock_async` module.
+ *
+ * @param[in] sock  A raw IP sock object.
+ * @param[in] cb    The callback. `NULL` removes a previously set callback.
+ * @param[in] arg   Argument for @p cb.
+ */
+void gnrc_sock_ip_set_cb(sock_ip_t *sock, gnrc_sock_ip_cb_t cb, void *arg);
+
+/**
+ * @brief   Sets a thread that gets a @ref GNRC_SOCK_MSG_TYPE_RECV message
+ *          when a packet was queued for a raw IP sock
+ *
+ * @pre `sock != NULL`
+ *
+ * @note    Only available with the `gnrc_sock_async` module.
+ *
+ * @param[in] sock  A raw IP sock object.
+ * @param[in] pid   The thread to notify. KERNEL_PID_UNDEF disables the
+ *                  notification.
+ */
+void gnrc_sock_ip_set_notify(sock_ip_t *sock, kernel_pid_t pid);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_SOCK_H */
+/** @} */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_vfs
+ * @brief       GNRC-specific extensions to the VFS
+ *
+ * Only available with the `gnrc_pktbuf` module.
+ *
+ * @{
+ *
+ * @file
+ * @brief       GNRC-specific VFS definitions
+ */
+#ifndef NET_GNRC_VFS_H
+#define NET_GNRC_VFS_H
+
+#include <sys/types.h>
+
+#include "net/gnrc/pktbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Read bytes from an open file into a new packet snip
+ *
+ * The file contents are read directly into the packet buffer, so no
+ * intermediate buffer is needed to send a file. Files on a file system that
+ * implements vfs_file_ops_t::map are copied only once.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  count    maximum number of bytes to read
+ * @param[in]  type     type of the new snip
+ * @param[out] pkt      the new snip, or NULL at the end of the file
+ *
+ * @return number of bytes read on success
+ * @return -ENOMEM if the packet buffer is full
+ * @return <0 on other errors
+ */
+ssize_t vfs_sendfile(int fd, size_t count, gnrc_nettype_t type,
+                     gnrc_pktsnip_t **pkt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_VFS_H */
+/** @} */
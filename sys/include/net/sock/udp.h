@@ -289,6 +289,18 @@ typedef struct _sock_tl_ep sock_udp_ep_t;   /**< An end point for a UDP sock obj
  */
 typedef struct sock_udp sock_udp_t;
 
+/**
+ * @brief   A UDP message for sock_udp_recv_many() and sock_udp_send_many()
+ */
+typedef struct {
+    void *data;             /**< Payload of the message */
+    size_t len;             /**< For sending: length of sock_udp_msg_t::data.
+                             *   For receiving: space available at
+                             *   sock_udp_msg_t::data on input, length of the
+                             *   received payload on output */
+    sock_udp_ep_t remote;   /**< Remote end point of the message */
+} sock_udp_msg_t;
+
 /**
  * @brief   Creates a new UDP sock object
  *
@@ -435,6 +447,56 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
 ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
                       const sock_udp_ep_t *remote);
 
+/**
+ * @brief   Receives multiple UDP messages from remote end points
+ *
+ * Waits like sock_udp_recv() for the first message, and then receives the
+ * messages already queued for @p sock without blocking, up to @p msgs_len.
+ * Saves one call per message for applications which handle many small
+ * datagrams.
+ *
+ * A message that does not fit into the space at sock_udp_msg_t::data, or
+ * that did not come from the remote end point of @p sock, is dropped.
+ *
+ * @note    Currently only provided by GNRC.
+ *
+ * @pre `(sock != NULL) && (msgs != NULL) && (msgs_len > 0)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[in,out] msgs  Messages to receive into. sock_udp_msg_t::len and
+ *                      sock_udp_msg_t::remote are set for each received
+ *                      message.
+ * @param[in] msgs_len  Number of entries in @p msgs.
+ * @param[in] timeout   Timeout for the first message in microseconds, as for
+ *                      sock_udp_recv().
+ *
+ * @return  The number of messages received on success.
+ * @return  The errors of sock_udp_recv(), if not even the first message was
+ *          received.
+ */
+int sock_udp_recv_many(sock_udp_t *sock, sock_udp_msg_t *msgs,
+                       unsigned msgs_len, uint32_t timeout);
+
+/**
+ * @brief   Sends multiple UDP messages to remote end points
+ *
+ * @note    Currently only provided by GNRC.
+ *
+ * @pre `(sock != NULL) && (msgs != NULL)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[in] msgs      Messages to send. sock_udp_msg_t::remote may have
+ *                      family AF_UNSPEC to send to the remote end point of
+ *                      @p sock.
+ * @param[in] msgs_len  Number of entries in @p msgs.
+ *
+ * @return  The number of messages sent; sending stops at the first error.
+ * @return  The errors of sock_udp_send(), if not even the first message was
+ *          sent.
+ */
+int sock_udp_send_many(sock_udp_t *sock, const sock_udp_msg_t *msgs,
+                       unsigned msgs_len);
+
 #include "sock_types.h"
 
 #ifdef __cplusplus
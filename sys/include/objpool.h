@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_objpool Object pools
+ * @ingroup     sys
+ * @brief       Pools of fixed-size objects with O(1) allocation
+ *
+ * An object pool hands out objects of one type from a static array. Free
+ * objects are kept in a free list that is stored inside the objects
+ * themselves, objects that were never allocated are taken from the end of
+ * the array. Both allocation and release take constant time and no memory
+ * besides the pool descriptor.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * OBJPOOL_DEFINE(_entries, entry_t, 8, OBJPOOL_UNLOCKED);
+ *
+ * entry_t *e = objpool_alloc(&_entries);
+ * ...
+ * objpool_free(&_entries, e);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A pool is accessed in one of three modes, chosen when it is defined:
+ *
+ * - @ref OBJPOOL_UNLOCKED: no synchronization, for pools used by a single
+ *   thread or under a lock of the caller
+ * - @ref OBJPOOL_IRQSAFE: interrupts are disabled during allocation and
+ *   release, so the pool can be shared between threads and interrupt
+ *   handlers
+ * - @ref OBJPOOL_LOCKFREE: the free list is updated with compare-and-swap,
+ *   so interrupts stay enabled. The free list head carries a tag against the
+ *   ABA problem. Limited to 65535 objects.
+ *
+ * Each pool counts the objects in use, the maximum number of objects in use
+ * and the failed allocations. A pool appears in objpool_print() and in the
+ * `pools` shell command after its first allocation.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Object pool interface
+ */
+
+#ifndef OBJPOOL_H
+#define OBJPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Pool access modes
+ * @{
+ */
+#define OBJPOOL_UNLOCKED    (0x0)   /**< no synchronization */
+#define OBJPOOL_IRQSAFE     (0x1)   /**< interrupts disabled during access */
+#define OBJPOOL_LOCKFREE    (0x2)   /**< compare-and-swap based */
+/** @} */
+
+/**
+ * @brief   Object pool descriptor
+ *
+ * All members are private, use @ref OBJPOOL_DEFINE or objpool_init().
+ */
+typedef struct objpool {
+    struct objpool *next;   /**< next pool in the list of all pools */
+    const char *name;       /**< name shown in statistics */
+    uint8_t *buf;           /**< storage of the objects */
+    uintptr_t free;         /**< free list head: pointer to the first free
+                                 object, or for lock-free pools the index
+                                 plus one and a tag in the upper 16 bit */
+    unsigned fresh;         /**< index of the first never allocated object */
+    uint16_t size;          /**< distance between two objects in bytes */
+    uint16_t num;           /**< number of objects */
+    uint16_t used;          /**< objects currently allocated */
+    uint16_t max_used;      /**< maximum of @p used */
+    uint16_t failed;        /**< failed allocations, saturating */
+    uint8_t mode;           /**< access mode */
+    uint8_t listed;         /**< pool is in the list of all pools */
+} objpool_t;
+
+/**
+ * @brief   Storage slot of an object of type @p type
+ *
+ * Large enough and aligned for an object or a free list link.
+ */
+#define OBJPOOL_SLOT(type)  union { type obj; uintptr_t link; }
+
+/**
+ * @brief   Evaluates to 0, fails to compile if @p cond is false
+ *
+ * @param[in] cond      condition known at compile time
+ */
+#define OBJPOOL_CHECK(cond)     (0 * sizeof(char[(cond) ? 1 : -1]))
+
+/**
+ * @brief   Static initializer for an object pool
+ *
+ * Fails to compile if the size or the number of the slots does not fit into
+ * the 16 bit fields of the pool.
+ *
+ * @param[in] name      name shown in statistics
+ * @param[in] slots     array of @ref OBJPOOL_SLOT
+ * @param[in] mode      access mode, one of OBJPOOL_UNLOCKED,
+ *                      OBJPOOL_IRQSAFE or OBJPOOL_LOCKFREE
+ */
+#define OBJPOOL_INIT(name, slots, mode) \
+    { NULL, (name), (uint8_t *)(slots), 0, 0, \
+      sizeof((slots)[0]) + \
+      OBJPOOL_CHECK(sizeof((slots)[0]) <= UINT16_MAX), \
+      sizeof(slots) / sizeof((slots)[0]) + \
+      OBJPOOL_CHECK(sizeof(slots) / sizeof((slots)[0]) <= UINT16_MAX), \
+      0, 0, 0, (mode), 0 }
+
+/**
+ * @brief   Define a static pool @p pool of @p num objects of type @p type
+ *
+ * @param[in] pool      name of the pool variable
+ * @param[in] type      type of the objects
+ * @param[in] num       number of objects
+ * @param[in] mode      access mode, one of OBJPOOL_UNLOCKED,
+ *                      OBJPOOL_IRQSAFE or OBJPOOL_LOCKFREE
+ */
+#define OBJPOOL_DEFINE(pool, type, num, mode) \
+    static OBJPOOL_SLOT(type) pool ## _slots[num]; \
+    static objpool_t pool = OBJPOOL_INIT(#pool, pool ## _slots, mode)
+
+/**
+ * @brief   Initialize an object pool at runtime
+ *
+ * Must not be called for a pool that was already allocated from.
+ *
+ * @param[out] pool     pool to initialize
+ * @param[in] name      name shown in statistics
+ * @param[in] buf       storage for the objects, aligned for uintptr_t
+ * @param[in] size      size of an object, at least sizeof(uintptr_t)
+ * @param[in] num       number of objects
+ * @param[in] mode      access mode
+ */
+void objpool_init(objpool_t *pool, const char *name, void *buf, size_t size,
+                  unsigned num, unsigned mode);
+
+/**
+ * @brief   Allocate an object
+ *
+ * @param[in,out] pool  pool to allocate from
+ *
+ * @return  pointer to the object, its content is undefined
+ * @return  NULL, if all objects are in use
+ */
+void *objpool_alloc(objpool_t *pool);
+
+/**
+ * @brief   Return an object to its pool
+ *
+ * @param[in,out] pool  pool @p obj was allocated from
+ * @param[in] obj       object to release, may be NULL
+ */
+void objpool_free(objpool_t *pool, void *obj);
+
+/**
+ * @brief   Get the number of objects currently in use
+ *
+ * @param[in] pool      pool to check
+ *
+ * @return  number of allocated objects
+ */
+static inline unsigned objpool_used(const objpool_t *pool)
+{
+    return pool->used;
+}
+
+/**
+ * @brief   Print the statistics of all pools that have been used
+ */
+void objpool_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OBJPOOL_H */
+/** @} */
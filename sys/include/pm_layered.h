@@ -25,6 +25,23 @@
  *
  * In order to use this module, you'll need to implement pm_set().
  *
+ * With the `pm_layered_governor` module, the idle thread also considers when
+ * xtimer needs the CPU next, see xtimer_next_event(). A mode is only entered
+ * if the time until then covers the mode's wake-up latency plus its minimum
+ * residency, otherwise the next higher mode is tried. The CPU defines both
+ * per mode in `periph_cpu.h`:
+ *
+ * - @ref PM_MODE_LATENCY_US: time from the wake-up interrupt until the CPU
+ *   runs again, e.g. to restart clocks
+ * - @ref PM_MODE_RESIDENCY_US: time the CPU must stay in the mode to use less
+ *   energy than in the next higher mode
+ *
+ * When a mode with a latency is entered, a timer wakes the CPU early enough
+ * for the next xtimer to be on time. The governor also records how often and
+ * how long each mode was used, see pm_layered_get_stats() and the `pm` shell
+ * command. Modes in which xtimer's timer stops still have to be blocked by
+ * the application.
+ *
  * @file
  * @brief       Layered low power mode infrastructure
  *
@@ -34,6 +51,8 @@
 #ifndef PM_LAYERED_H
 #define PM_LAYERED_H
 
+#include <stdint.h>
+
 #include "assert.h"
 #include "periph_cpu.h"
 
@@ -75,6 +94,58 @@ void pm_unblock(unsigned mode);
  */
 void pm_set(unsigned mode);
 
+#if defined(MODULE_PM_LAYERED_GOVERNOR) || defined(DOXYGEN)
+/**
+ * @brief   Wake-up latency of each mode in us, as array initializer
+ *
+ * Defaults to 0 for all modes.
+ */
+#ifndef PM_MODE_LATENCY_US
+#define PM_MODE_LATENCY_US      { 0 }
+#endif
+
+/**
+ * @brief   Minimum residency of each mode in us, as array initializer
+ *
+ * Defaults to 0 for all modes, so without values from the CPU every mode the
+ * blockers allow is used, as without the governor. UINT32_MAX keeps the idle
+ * thread from using a mode at all.
+ */
+#ifndef PM_MODE_RESIDENCY_US
+#define PM_MODE_RESIDENCY_US    { 0 }
+#endif
+
+/**
+ * @brief   Power mode usage statistics
+ *
+ * Index PM_NUM_MODES of the arrays is the idle mode.
+ */
+typedef struct {
+    uint32_t entries[PM_NUM_MODES + 1]; /**< times a mode was entered */
+    uint64_t time[PM_NUM_MODES + 1];    /**< time spent in a mode, in us */
+    uint32_t demoted;                   /**< times a higher mode than the
+                                             blockers allowed was used, as
+                                             the next timer was too close */
+} pm_layered_stats_t;
+
+/**
+ * @brief   Get the power mode usage statistics
+ *
+ * @param[out] stats    usage statistics since boot or the last reset
+ */
+void pm_layered_get_stats(pm_layered_stats_t *stats);
+
+/**
+ * @brief   Reset the power mode usage statistics
+ */
+void pm_layered_reset_stats(void);
+
+/**
+ * @brief   Print the power mode usage statistics
+ */
+void pm_layered_print_stats(void);
+#endif /* MODULE_PM_LAYERED_GOVERNOR */
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,12 +21,15 @@
  *  - Mersenne Twister
  *  - Simple Park-Miller PRNG
  *  - Musl C PRNG
+ *  - xoshiro128** (`prng_xoshiro`), the fastest one, especially for
+ *    random_bytes()
  */
 
 #ifndef RANDOM_H
 #define RANDOM_H
 
 #include <inttypes.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +73,11 @@ uint32_t random_uint32(void);
 /**
  * @brief   generates a random number r with a <= r < b.
  *
+ * Every number of the interval is equally likely. The function takes the
+ * upper bits of random_uint32() and draws again when they are out of range,
+ * so it needs neither a division nor a modulo, but calls random_uint32()
+ * less than two times on average.
+ *
  * @param[in] a minimum for random number
  * @param[in] b upper bound for random number
  *
@@ -77,10 +85,18 @@ uint32_t random_uint32(void);
  *
  * @return  a random number on [a,b)-interval
  */
-static inline uint32_t random_uint32_range(uint32_t a, uint32_t b)
-{
-    return (random_uint32() % (b - a)) + a;
-}
+uint32_t random_uint32_range(uint32_t a, uint32_t b);
+
+/**
+ * @brief   fills a buffer with random bytes
+ *
+ * Faster than calling random_uint32() for every four bytes, depending on
+ * the generator.
+ *
+ * @param[out] buf  buffer to fill
+ * @param[in] size  number of bytes to write to @p buf
+ */
+void random_bytes(uint8_t *buf, size_t size);
 
 #if PRNG_FLOAT
 /* These real versions are due to Isaku Wada, 2002/01/09 added */
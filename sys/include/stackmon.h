@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_stackmon Stack monitor
+ * @ingroup     sys
+ * @brief       Records the peak stack usage of all threads while they run
+ *
+ * With this module every stack is painted when its thread is created, also
+ * without @ref DEVELHELP and @ref THREAD_CREATE_STACKTEST. Each time the idle
+ * thread runs, it checks the unused part of one stack and records the lowest
+ * painted word that was overwritten. It does so in chunks of
+ * @ref STACKMON_SCAN_WORDS words, so any other thread that becomes runnable
+ * preempts it right away. An application can run its usual load and print
+ * the peaks at the end:
+ *
+ *     > stackmon
+ *       pid name                   size   peak  recommended
+ *         1 idle                   1024    236          296
+ *         2 main                   1536    708          888
+ *     ...
+ *     reclaimable: 1376
+ *
+ * The recommended size is the peak plus @ref STACKMON_MARGIN, see
+ * `dist/tools/stackmon` for a script that turns the output of several runs
+ * into stack size settings.
+ *
+ * Like thread_measure_stack_free(), this can miss usage of a stack: a
+ * function may reserve a buffer on the stack without writing all of it, and a
+ * peak between two checks is only seen if it overwrote painted words.
+ * Recorded peaks are lower bounds, which is why a margin is added.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Stack monitor API
+ */
+
+#ifndef STACKMON_H
+#define STACKMON_H
+
+#include "kernel_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of words checked at once, with interrupts disabled
+ */
+#ifndef STACKMON_SCAN_WORDS
+#define STACKMON_SCAN_WORDS     (32U)
+#endif
+
+/**
+ * @brief   Margin added to the peak usage for the recommended stack size, in
+ *          percent
+ */
+#ifndef STACKMON_MARGIN
+#define STACKMON_MARGIN         (25U)
+#endif
+
+/**
+ * @brief   Peak stack usage of a thread
+ */
+typedef struct {
+    const char *name;       /**< name of the thread */
+    unsigned size;          /**< size of the stack, in bytes */
+    unsigned peak;          /**< highest usage seen, in bytes */
+} stackmon_stats_t;
+
+/**
+ * @brief   Check the stack of the next thread
+ *
+ * Called by the idle thread each time before it puts the CPU to sleep.
+ */
+void stackmon_idle(void);
+
+/**
+ * @brief   Update the peak of a thread's stack right away
+ *
+ * Checks the whole unused part of the stack. Invalid PIDs are ignored.
+ *
+ * @param[in] pid       thread to check
+ */
+void stackmon_update(kernel_pid_t pid);
+
+/**
+ * @brief   Get the peak stack usage of a thread
+ *
+ * The record of a thread is kept after it exited, until another thread with
+ * another stack is started under its PID.
+ *
+ * @param[in] pid       thread to get the record of
+ * @param[out] stats    peak usage of the thread
+ *
+ * @return  0 on success
+ * @return  -1 if @p pid is invalid or no thread ran under it
+ */
+int stackmon_get(kernel_pid_t pid, stackmon_stats_t *stats);
+
+/**
+ * @brief   Recommended stack size for a peak usage
+ *
+ * @param[in] peak      peak usage, in bytes
+ *
+ * @return  @p peak plus @ref STACKMON_MARGIN, rounded up to 8 bytes
+ */
+static inline unsigned stackmon_recommend(unsigned peak)
+{
+    return (peak + (peak * STACKMON_MARGIN) / 100 + 7) & ~7U;
+}
+
+/**
+ * @brief   Print the peak stack usage of all threads
+ *
+ * Updates the peaks of all running threads first.
+ */
+void stackmon_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STACKMON_H */
+/** @} */
@@ -67,6 +67,7 @@ using std::atomic_int;
 #include <sys/stat.h> /* for struct stat */
 #include <sys/types.h> /* for off_t etc. */
 #include <sys/statvfs.h> /* for struct statvfs */
+#include <sys/uio.h> /* for struct iovec */
 
 #include "kernel_types.h"
 #include "clist.h"
@@ -174,6 +175,9 @@ struct vfs_mount_struct {
     const vfs_file_system_t *fs; /**< The file system driver for the mount point */
     const char *mount_point;     /**< Mount point, e.g. "/mnt/cdrom" */
     size_t mount_point_len;      /**< Length of mount_point string (set by vfs_mount) */
+    uint32_t mount_point_hash;   /**< Hash of mount_point string (set by vfs_mount) */
+    vfs_mount_t *mount_child;    /**< First mount below this mount point (set by vfs_mount) */
+    vfs_mount_t *mount_sibling;  /**< Next mount with the same parent (set by vfs_mount) */
     atomic_int open_files;       /**< Number of currently open files */
     void *private_data;          /**< File system driver private data, implementation defined */
 };
@@ -346,6 +350,51 @@ struct vfs_file_ops {
      * @return <0 on error
      */
     ssize_t (*write) (vfs_file_t *filp, const void *src, size_t nbytes);
+
+    /**
+     * @brief Read bytes from an open file into several buffers
+     *
+     * Optional, vfs_readv() calls vfs_file_ops_t::read for each buffer if not
+     * implemented.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iov      destination buffers
+     * @param[in]  iovcnt   number of elements in @p iov
+     *
+     * @return number of bytes read on success
+     * @return <0 on error
+     */
+    ssize_t (*readv) (vfs_file_t *filp, const struct iovec *iov, int iovcnt);
+
+    /**
+     * @brief Write bytes from several buffers to an open file
+     *
+     * Optional, vfs_writev() calls vfs_file_ops_t::write for each buffer if
+     * not implemented.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iov      source buffers
+     * @param[in]  iovcnt   number of elements in @p iov
+     *
+     * @return number of bytes written on success
+     * @return <0 on error
+     */
+    ssize_t (*writev) (vfs_file_t *filp, const struct iovec *iov, int iovcnt);
+
+    /**
+     * @brief Get a pointer to the file contents at the current position
+     *
+     * Optional, for file systems whose contents are memory mapped (e.g. in
+     * flash). Advances the file position like vfs_file_ops_t::read.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[out] ptr      pointer to the file contents
+     * @param[in]  nbytes   maximum number of bytes to map
+     *
+     * @return number of bytes available at @p ptr on success
+     * @return <0 on error
+     */
+    ssize_t (*map) (vfs_file_t *filp, const void **ptr, size_t nbytes);
 };
 
 /**
@@ -626,6 +675,50 @@ ssize_t vfs_read(int fd, void *dest, size_t count);
  */
 ssize_t vfs_write(int fd, const void *src, size_t count);
 
+/**
+ * @brief Read bytes from an open file into several buffers
+ *
+ * The buffers are filled in order. Reading stops early at the end of the
+ * file.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      destination buffers
+ * @param[in]  iovcnt   number of elements in @p iov
+ *
+ * @return number of bytes read on success
+ * @return <0 on error
+ */
+ssize_t vfs_readv(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Write bytes from several buffers to an open file
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      source buffers
+ * @param[in]  iovcnt   number of elements in @p iov
+ *
+ * @return number of bytes written on success
+ * @return <0 on error
+ */
+ssize_t vfs_writev(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Get a pointer to the contents of an open file without copying
+ *
+ * Only supported by file systems that implement vfs_file_ops_t::map, e.g.
+ * @ref sys_fs_constfs. The file position is advanced by the returned number
+ * of bytes.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[out] ptr      pointer to the file contents at the current position
+ * @param[in]  count    maximum number of bytes to map
+ *
+ * @return number of bytes available at @p ptr on success, 0 at end of file
+ * @return -ENOTSUP if the file system does not support mapping
+ * @return <0 on other errors
+ */
+ssize_t vfs_map(int fd, const void **ptr, size_t count);
+
 /**
  * @brief Open a directory for reading with readdir
  *
@@ -677,6 +770,9 @@ int vfs_closedir(vfs_DIR *dirp);
  * @p mountp should have been populated in advance with a file system driver,
  * a mount point, and private_data (if the file system driver uses one).
  *
+ * Mounts are kept in a tree ordered by their mount points, so resolving a path
+ * only compares it to the mount points along the way.
+ *
  * @param[in]  mountp    pointer to the mount structure of the file system to mount
  *
  * @return 0 on success
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_workq Work queue
+ * @ingroup     sys
+ * @brief       Run batches of independent jobs in parallel
+ *
+ * A job is a function and an argument. Jobs are submitted as part of a
+ * batch, and workq_wait() returns when all jobs of the batch have finished:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * workq_batch_t batch;
+ * workq_job_t jobs[NUMOF];
+ *
+ * workq_batch_init(&batch);
+ * for (unsigned i = 0; i < NUMOF; i++) {
+ *     workq_submit(&batch, &jobs[i], _hash_block, &blocks[i]);
+ * }
+ * workq_wait(&batch);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Every worker has a deque of jobs. Submitted jobs are spread over the
+ * deques, a worker takes the newest job from its own deque and, when it runs
+ * out of work, steals the oldest job from the deque of another worker. A
+ * thread in workq_wait() steals jobs as well instead of just blocking.
+ *
+ * On native, the @ref WORKQ_WORKERS workers are threads of the host, so jobs
+ * run in parallel on the cores of the host while RIOT keeps running. On
+ * other platforms there are no workers: the jobs are run by the threads
+ * calling workq_wait(), one after another.
+ *
+ * @warning On native, jobs run outside of RIOT. A job must only compute on
+ *          the memory it was given and must not call any function of RIOT,
+ *          including printf() and malloc().
+ *
+ * @{
+ *
+ * @file
+ * @brief       Work queue API
+ */
+
+#ifndef WORKQ_H
+#define WORKQ_H
+
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of worker threads
+ *
+ * Only supported on native, 0 everywhere else.
+ */
+#ifndef WORKQ_WORKERS
+#ifdef CPU_NATIVE
+#define WORKQ_WORKERS       (4U)
+#else
+#define WORKQ_WORKERS       (0U)
+#endif
+#endif
+
+/**
+ * @brief   Capacity of a worker's deque, must be a power of two
+ *
+ * A job submitted while all deques are full is run by the submitting thread
+ * right away.
+ */
+#ifndef WORKQ_DEQUE_SIZE
+#define WORKQ_DEQUE_SIZE    (32U)
+#endif
+
+/**
+ * @brief   Batch forward declaration
+ */
+typedef struct workq_batch workq_batch_t;
+
+/**
+ * @brief   Job structure, all members are private
+ */
+typedef struct {
+    void (*fn)(void *arg);      /**< job function */
+    void *arg;                  /**< argument of @p fn */
+    workq_batch_t *batch;       /**< batch the job belongs to */
+} workq_job_t;
+
+/**
+ * @brief   Batch structure, all members are private
+ */
+struct workq_batch {
+    unsigned pending;           /**< unfinished jobs, plus one until
+                                     workq_wait() was called */
+    mutex_t done;               /**< unlocked when the last job finished */
+};
+
+/**
+ * @brief   Start the workers
+ *
+ * Called by auto_init.
+ */
+void workq_init(void);
+
+/**
+ * @brief   Initialize a batch
+ *
+ * @param[out] batch    batch to initialize
+ */
+void workq_batch_init(workq_batch_t *batch);
+
+/**
+ * @brief   Submit a job
+ *
+ * Must not be called from interrupt context.
+ *
+ * @param[in,out] batch batch the job belongs to
+ * @param[out] job      job structure, must stay valid until the job ran
+ * @param[in] fn        job function
+ * @param[in] arg       argument of @p fn
+ */
+void workq_submit(workq_batch_t *batch, workq_job_t *job,
+                  void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief   Wait until all jobs of a batch finished
+ *
+ * Runs queued jobs, of this or other batches, while waiting. Must be called
+ * exactly once per batch, by the thread that initialized it.
+ *
+ * @param[in,out] batch batch to wait for
+ */
+void workq_wait(workq_batch_t *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORKQ_H */
+/** @} */
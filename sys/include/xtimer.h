@@ -300,6 +300,19 @@ static inline void xtimer_set(xtimer_t *timer, uint32_t offset);
  */
 void xtimer_remove(xtimer_t *timer);
 
+/**
+ * @brief get the time until xtimer's next interrupt
+ *
+ * This is either the next timer to expire or, if no timer is due in the
+ * current period of the low-level timer, the end of that period. The CPU
+ * must be awake again by then for timers to be on time.
+ *
+ * @note call with interrupts disabled for the result to stay valid
+ *
+ * @return  ticks until the next interrupt, 0 if it is overdue
+ */
+xtimer_ticks32_t xtimer_next_event(void);
+
 /**
  * @brief receive a message blocking but with timeout
  *
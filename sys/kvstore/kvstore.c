@@ -0,0 +1,803 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_kvstore
+ * @{
+ *
+ * @file
+ * @brief       Key-value store implementation
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "hashes.h"
+#include "kvstore.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define SECTOR_MAGIC    (0x53564b52U)   /* "RKVS" */
+#define SEQ_FREE        (0xffffffffU)   /* sector is erased and not in use */
+#define TYPE_PUT        (0x01U)
+#define TYPE_DEL        (0x02U)
+#define COPY_CHUNK      (32U)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t erase_count;
+    uint32_t reserved;
+} _sector_hdr_t;
+
+typedef struct {
+    uint32_t hash;
+    uint8_t key_len;
+    uint8_t type;
+    uint16_t val_len;
+    uint16_t crc;       /* over the fields above, the key and the value */
+    uint16_t reserved;
+} _entry_hdr_t;
+
+static inline uint32_t _sector_addr(const kvstore_t *kv, uint32_t sector)
+{
+    return sector * kv->sector_size;
+}
+
+static inline uint32_t _entry_size(uint32_t key_len, uint32_t val_len)
+{
+    return sizeof(_entry_hdr_t) + ((key_len + val_len + 3) & ~3U);
+}
+
+static inline bool _page_dirty(const kvstore_t *kv)
+{
+    return kv->dirty_end > kv->dirty_start;
+}
+
+static uint16_t _hdr_crc(const _entry_hdr_t *hdr)
+{
+    return crc16_ccitt_calc((const uint8_t *)hdr, offsetof(_entry_hdr_t, crc));
+}
+
+static bool _is_erased(const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool _hdr_valid(const kvstore_t *kv, const _entry_hdr_t *hdr,
+                       uint32_t offset)
+{
+    if ((hdr->key_len == 0) || (hdr->key_len > KVSTORE_KEY_MAX)) {
+        return false;
+    }
+    if ((hdr->type != TYPE_PUT) &&
+        ((hdr->type != TYPE_DEL) || (hdr->val_len != 0))) {
+        return false;
+    }
+    return (offset + _entry_size(hdr->key_len, hdr->val_len)) <= kv->sector_size;
+}
+
+/* programs the bytes added to the page buffer since the last call */
+static int _program(kvstore_t *kv)
+{
+    int res;
+
+    if (!_page_dirty(kv)) {
+        return 0;
+    }
+    res = mtd_write(kv->mtd, kv->page_buf + kv->dirty_start,
+                    kv->page_addr + kv->dirty_start,
+                    kv->dirty_end - kv->dirty_start);
+    kv->stats.page_programs++;
+    kv->stats.bytes_programmed += kv->dirty_end - kv->dirty_start;
+    if (res < 0) {
+        return res;
+    }
+    kv->dirty_start = 0;
+    kv->dirty_end = 0;
+    return 0;
+}
+
+/* appends data at the write position through the page buffer */
+static int _put(kvstore_t *kv, const void *data, uint32_t len)
+{
+    uint32_t page_size = kv->mtd->page_size;
+    const uint8_t *in = data;
+
+    while (len > 0) {
+        uint32_t addr = _sector_addr(kv, kv->head) + kv->offset;
+        uint32_t off = addr % page_size;
+        uint32_t n = page_size - off;
+        int res;
+
+        if ((addr - off) != kv->page_addr) {
+            if ((res = _program(kv)) < 0) {
+                return res;
+            }
+            /* writes are sequential, so a new page is always erased */
+            kv->page_addr = addr - off;
+            memset(kv->page_buf, 0xff, page_size);
+        }
+        if (n > len) {
+            n = len;
+        }
+        if (in) {
+            memcpy(kv->page_buf + off, in, n);
+            if (!_page_dirty(kv)) {
+                kv->dirty_start = off;
+            }
+            kv->dirty_end = off + n;
+            in += n;
+        }
+        kv->offset += n;
+        len -= n;
+        if (((off + n) == page_size) && ((res = _program(kv)) < 0)) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+/* reads from the device, with data that is not programmed yet taken from
+ * the page buffer */
+static int _read(kvstore_t *kv, uint32_t addr, void *dest, uint32_t len)
+{
+    uint32_t page_end = kv->page_addr + kv->mtd->page_size;
+    uint8_t *out = dest;
+
+    if ((addr >= kv->page_addr) && ((addr + len) <= page_end)) {
+        memcpy(out, kv->page_buf + (addr - kv->page_addr), len);
+        return 0;
+    }
+    int res = mtd_read(kv->mtd, out, addr, len);
+    if (res < 0) {
+        return res;
+    }
+    if (_page_dirty(kv) && (addr < page_end) && ((addr + len) > kv->page_addr)) {
+        uint32_t start = (addr > kv->page_addr) ? addr : kv->page_addr;
+        uint32_t end = ((addr + len) < page_end) ? (addr + len) : page_end;
+
+        memcpy(out + (start - addr), kv->page_buf + (start - kv->page_addr),
+               end - start);
+    }
+    return 0;
+}
+
+/* erases a sector and writes its header, keeping the erase count */
+static int _erase_sector(kvstore_t *kv, uint32_t sector, uint32_t seq)
+{
+    uint32_t addr = _sector_addr(kv, sector);
+    _sector_hdr_t hdr;
+    int res;
+
+    if ((res = mtd_read(kv->mtd, &hdr, addr, sizeof(hdr))) < 0) {
+        return res;
+    }
+    if (hdr.magic != SECTOR_MAGIC) {
+        /* never used, or the header was cut by a power failure */
+        hdr.erase_count = 0;
+    }
+    DEBUG("kvstore: erase sector %" PRIu32 "\n", sector);
+    res = mtd_erase(kv->mtd, addr, kv->sector_size);
+    kv->stats.sector_erases++;
+    if (res < 0) {
+        return res;
+    }
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = seq;
+    hdr.erase_count++;
+    hdr.reserved = 0xffffffff;
+    res = mtd_write(kv->mtd, &hdr, addr, sizeof(hdr));
+    kv->stats.page_programs++;
+    kv->stats.bytes_programmed += sizeof(hdr);
+    return (res < 0) ? res : 0;
+}
+
+/* makes the free sector after the head the new head */
+static int _open_sector(kvstore_t *kv)
+{
+    uint32_t next = (kv->head + 1) % kv->mtd->sector_count;
+    uint32_t addr = _sector_addr(kv, next);
+    _sector_hdr_t hdr;
+    int res;
+
+    if ((res = _program(kv)) < 0) {
+        return res;
+    }
+    if ((res = mtd_read(kv->mtd, &hdr, addr, sizeof(hdr))) < 0) {
+        return res;
+    }
+    if ((hdr.magic == SECTOR_MAGIC) && (hdr.seq == SEQ_FREE)) {
+        /* erased when it was collected, only the sequence number is missing */
+        hdr.seq = ++kv->seq;
+        res = mtd_write(kv->mtd, &hdr.seq, addr + offsetof(_sector_hdr_t, seq),
+                        sizeof(hdr.seq));
+        kv->stats.page_programs++;
+        kv->stats.bytes_programmed += sizeof(hdr.seq);
+    }
+    else {
+        res = _erase_sector(kv, next, ++kv->seq);
+    }
+    if (res < 0) {
+        return res;
+    }
+    DEBUG("kvstore: open sector %" PRIu32 "\n", next);
+    kv->head = next;
+    if (kv->used++ == 0) {
+        kv->tail = next;
+    }
+    kv->offset = sizeof(_sector_hdr_t);
+    kv->page_addr = addr;
+    res = mtd_read(kv->mtd, kv->page_buf, addr, kv->mtd->page_size);
+    return (res < 0) ? res : 0;
+}
+
+/* looks up a key, returns 1 and its slot if found, 0 and the slot to insert
+ * it otherwise */
+static int _find(kvstore_t *kv, uint32_t hash, const char *key, size_t key_len,
+                 kvstore_slot_t **slot, _entry_hdr_t *hdr)
+{
+    unsigned mask = kv->index_size - 1;
+    struct {
+        _entry_hdr_t hdr;
+        char key[KVSTORE_KEY_MAX];
+    } entry;
+
+    for (unsigned i = hash & mask; kv->index[i].addr != 0; i = (i + 1) & mask) {
+        kvstore_slot_t *s = &kv->index[i];
+        int res;
+
+        if (s->hash != hash) {
+            continue;
+        }
+        res = _read(kv, s->addr, &entry, sizeof(entry.hdr) + key_len);
+        if (res < 0) {
+            return res;
+        }
+        if ((entry.hdr.key_len == key_len) &&
+            (memcmp(entry.key, key, key_len) == 0)) {
+            *slot = s;
+            *hdr = entry.hdr;
+            return 1;
+        }
+    }
+    /* one slot is always kept free, so the probing above terminates */
+    *slot = ((kv->index_used + 2) > kv->index_size) ? NULL
+            : &kv->index[hash & mask];
+    while (*slot && (*slot)->addr != 0) {
+        *slot = &kv->index[((*slot - kv->index) + 1) & mask];
+    }
+    return 0;
+}
+
+/* returns the slot pointing to the entry at addr, if it is still live */
+static kvstore_slot_t *_live_slot(kvstore_t *kv, uint32_t hash, uint32_t addr)
+{
+    unsigned mask = kv->index_size - 1;
+
+    for (unsigned i = hash & mask; kv->index[i].addr != 0; i = (i + 1) & mask) {
+        if (kv->index[i].addr == addr) {
+            return &kv->index[i];
+        }
+    }
+    return NULL;
+}
+
+/* removes a slot, moving following slots back so no lookup has to skip
+ * over deleted slots */
+static void _remove_slot(kvstore_t *kv, kvstore_slot_t *slot)
+{
+    unsigned mask = kv->index_size - 1;
+    unsigned i = slot - kv->index;
+
+    for (unsigned j = (i + 1) & mask; kv->index[j].addr != 0;
+         j = (j + 1) & mask) {
+        unsigned home = kv->index[j].hash & mask;
+
+        /* move the slot if its home position is not in (i, j] */
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            kv->index[i] = kv->index[j];
+            i = j;
+        }
+    }
+    kv->index[i].addr = 0;
+    kv->index_used--;
+}
+
+/* computes the CRC over data on the device */
+static int _crc_update(kvstore_t *kv, uint16_t *crc, uint32_t addr,
+                       uint32_t len)
+{
+    uint8_t buf[COPY_CHUNK];
+
+    while (len > 0) {
+        uint32_t n = (len < sizeof(buf)) ? len : sizeof(buf);
+        int res = _read(kv, addr, buf, n);
+
+        if (res < 0) {
+            return res;
+        }
+        *crc = crc16_ccitt_update(*crc, buf, n);
+        addr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int _build_index(kvstore_t *kv)
+{
+    uint32_t count = kv->mtd->sector_count;
+    uint32_t sector = kv->tail;
+    int res;
+
+    if (kv->index_valid) {
+        return 0;
+    }
+    memset(kv->index, 0, kv->index_size * sizeof(kvstore_slot_t));
+    kv->index_used = 0;
+    for (uint32_t n = 0; n < kv->used; n++, sector = (sector + 1) % count) {
+        uint32_t base = _sector_addr(kv, sector);
+        uint32_t end = (sector == kv->head) ? kv->offset : kv->sector_size;
+        uint32_t offset = sizeof(_sector_hdr_t);
+
+        while ((offset + sizeof(_entry_hdr_t)) <= end) {
+            char key[KVSTORE_KEY_MAX];
+            kvstore_slot_t *slot;
+            _entry_hdr_t hdr, found;
+            uint32_t addr = base + offset;
+
+            if ((res = _read(kv, addr, &hdr, sizeof(hdr))) < 0) {
+                return res;
+            }
+            if (!_hdr_valid(kv, &hdr, offset)) {
+                break;
+            }
+            offset += _entry_size(hdr.key_len, hdr.val_len);
+            res = _read(kv, addr + sizeof(hdr), key, hdr.key_len);
+            if (res < 0) {
+                return res;
+            }
+            /* an entry cut by a power failure keeps its valid header, and
+             * appending continued behind it after the next mount, so any
+             * sector may hold one */
+            uint16_t crc = crc16_ccitt_update(_hdr_crc(&hdr), (uint8_t *)key,
+                                              hdr.key_len);
+
+            res = _crc_update(kv, &crc, addr + sizeof(hdr) + hdr.key_len,
+                              hdr.val_len);
+            if (res < 0) {
+                return res;
+            }
+            if (crc != hdr.crc) {
+                DEBUG("kvstore: CRC mismatch at 0x%" PRIx32 "\n", addr);
+                continue;
+            }
+            res = _find(kv, hdr.hash, key, hdr.key_len, &slot, &found);
+            if (res < 0) {
+                return res;
+            }
+            if (hdr.type == TYPE_DEL) {
+                if (res) {
+                    _remove_slot(kv, slot);
+                }
+                continue;
+            }
+            if (!res) {
+                if (!slot) {
+                    return -ENOMEM;
+                }
+                slot->hash = hdr.hash;
+                kv->index_used++;
+            }
+            slot->addr = addr;
+        }
+    }
+    kv->index_valid = true;
+    return 0;
+}
+
+/* copies the live entries of the oldest sector to the head and erases it */
+static int _gc(kvstore_t *kv)
+{
+    uint32_t base = _sector_addr(kv, kv->tail);
+    uint32_t offset = sizeof(_sector_hdr_t);
+    int res;
+
+    DEBUG("kvstore: collect sector %" PRIu32 "\n", kv->tail);
+    while ((offset + sizeof(_entry_hdr_t)) <= kv->sector_size) {
+        _entry_hdr_t hdr;
+        kvstore_slot_t *slot;
+        uint32_t size;
+
+        res = mtd_read(kv->mtd, &hdr, base + offset, sizeof(hdr));
+        if (res < 0) {
+            return res;
+        }
+        if (!_hdr_valid(kv, &hdr, offset)) {
+            break;
+        }
+        size = _entry_size(hdr.key_len, hdr.val_len);
+        /* entries with a bad CRC never made it into the index, so only
+         * verified entries are copied */
+        slot = (hdr.type == TYPE_PUT) ? _live_slot(kv, hdr.hash, base + offset)
+               : NULL;
+        if (slot) {
+            uint32_t addr = _sector_addr(kv, kv->head) + kv->offset;
+            uint8_t buf[COPY_CHUNK];
+
+            for (uint32_t pos = 0; pos < size; pos += sizeof(buf)) {
+                uint32_t n = ((size - pos) < sizeof(buf)) ? (size - pos)
+                             : sizeof(buf);
+
+                if (((res = mtd_read(kv->mtd, buf, base + offset + pos, n)) < 0) ||
+                    ((res = _put(kv, buf, n)) < 0)) {
+                    return res;
+                }
+            }
+            slot->addr = addr;
+            kv->stats.gc_bytes_copied += size;
+        }
+        offset += size;
+    }
+    /* the copies have to be on the device before the originals are gone */
+    if (((res = _program(kv)) < 0) ||
+        ((res = _erase_sector(kv, kv->tail, SEQ_FREE)) < 0)) {
+        return res;
+    }
+    kv->tail = (kv->tail + 1) % kv->mtd->sector_count;
+    kv->used--;
+    kv->stats.gc_runs++;
+    return 0;
+}
+
+static int _make_room(kvstore_t *kv, uint32_t size)
+{
+    uint32_t count = kv->mtd->sector_count;
+    int res;
+
+    for (uint32_t i = 0; (kv->offset + size) > kv->sector_size; i++) {
+        if (i >= count) {
+            /* every sector was collected without making enough room */
+            return -ENOSPC;
+        }
+        if ((res = _open_sector(kv)) < 0) {
+            return res;
+        }
+        if ((kv->used == count) && ((res = _gc(kv)) < 0)) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+/* finds the end of the entries in the head sector */
+static int _scan_head(kvstore_t *kv)
+{
+    uint32_t base = _sector_addr(kv, kv->head);
+    uint32_t offset = sizeof(_sector_hdr_t);
+    int res;
+
+    while ((offset + sizeof(_entry_hdr_t)) <= kv->sector_size) {
+        _entry_hdr_t hdr;
+
+        if ((res = mtd_read(kv->mtd, &hdr, base + offset, sizeof(hdr))) < 0) {
+            return res;
+        }
+        if (_is_erased(&hdr, sizeof(hdr))) {
+            break;
+        }
+        if (!_hdr_valid(kv, &hdr, offset)) {
+            /* an entry header was cut by a power failure, do not append to
+             * this sector anymore */
+            offset = kv->sector_size;
+            break;
+        }
+        offset += _entry_size(hdr.key_len, hdr.val_len);
+    }
+    kv->offset = offset;
+    return 0;
+}
+
+int kvstore_mount(kvstore_t *kv)
+{
+    mtd_dev_t *mtd = kv->mtd;
+    uint32_t page_size = mtd->page_size;
+    uint32_t oldest = 0;
+    int res;
+
+    mutex_init(&kv->lock);
+    memset(&kv->stats, 0, sizeof(kv->stats));
+    kv->sector_size = mtd->pages_per_sector * page_size;
+    if ((mtd->sector_count < 2) || (page_size == 0) ||
+        (kv->sector_size < (sizeof(_sector_hdr_t) + sizeof(_entry_hdr_t))) ||
+        (kv->index_size < 2) || (kv->index_size & (kv->index_size - 1))) {
+        return -EINVAL;
+    }
+
+    kv->used = 0;
+    kv->seq = 0;
+    for (uint32_t i = 0; i < mtd->sector_count; i++) {
+        _sector_hdr_t hdr;
+
+        if ((res = mtd_read(mtd, &hdr, _sector_addr(kv, i), sizeof(hdr))) < 0) {
+            return res;
+        }
+        if ((hdr.magic != SECTOR_MAGIC) || (hdr.seq == SEQ_FREE)) {
+            continue;
+        }
+        if ((kv->used == 0) || (hdr.seq > kv->seq)) {
+            kv->seq = hdr.seq;
+            kv->head = i;
+        }
+        if ((kv->used == 0) || (hdr.seq < oldest)) {
+            oldest = hdr.seq;
+            kv->tail = i;
+        }
+        kv->used++;
+    }
+
+    kv->index_valid = false;
+    kv->dirty_start = 0;
+    kv->dirty_end = 0;
+    kv->page_addr = 0;
+    memset(kv->page_buf, 0xff, page_size);
+    if (kv->used == mtd->sector_count) {
+        /* a collection was interrupted: the head only holds copies of
+         * entries that are still in the tail, so drop it */
+        DEBUG("kvstore: dropping unfinished collection\n");
+        if ((res = _erase_sector(kv, kv->head, SEQ_FREE)) < 0) {
+            return res;
+        }
+        kv->head = (kv->head + mtd->sector_count - 1) % mtd->sector_count;
+        kv->used--;
+    }
+    if (kv->used == 0) {
+        kv->head = mtd->sector_count - 1;
+        kv->tail = 0;
+        kv->offset = kv->sector_size;
+        return 0;
+    }
+    if ((res = _scan_head(kv)) < 0) {
+        return res;
+    }
+    DEBUG("kvstore: tail %" PRIu32 ", head %" PRIu32 ", offset %" PRIu32 "\n",
+          kv->tail, kv->head, kv->offset);
+    /* load the page at the write position, or the last one of a full sector,
+     * the buffer must mirror the device */
+    uint32_t addr = _sector_addr(kv, kv->head) + kv->offset;
+    if (kv->offset >= kv->sector_size) {
+        addr--;
+    }
+    kv->page_addr = addr - (addr % page_size);
+    if (addr == kv->page_addr) {
+        return 0;
+    }
+    res = mtd_read(mtd, kv->page_buf, kv->page_addr, page_size);
+    return (res < 0) ? res : 0;
+}
+
+int kvstore_format(kvstore_t *kv)
+{
+    int res = 0;
+
+    mutex_lock(&kv->lock);
+    for (uint32_t i = 0; i < kv->mtd->sector_count; i++) {
+        if ((res = _erase_sector(kv, i, SEQ_FREE)) < 0) {
+            break;
+        }
+    }
+    kv->used = 0;
+    kv->head = kv->mtd->sector_count - 1;
+    kv->tail = 0;
+    kv->offset = kv->sector_size;
+    kv->dirty_start = 0;
+    kv->dirty_end = 0;
+    memset(kv->page_buf, 0xff, kv->mtd->page_size);
+    memset(kv->index, 0, kv->index_size * sizeof(kvstore_slot_t));
+    kv->index_used = 0;
+    kv->index_valid = true;
+    mutex_unlock(&kv->lock);
+    return res;
+}
+
+int kvstore_get(kvstore_t *kv, const char *key, void *buf, size_t len)
+{
+    size_t key_len = strlen(key);
+    uint32_t hash = fnv_hash((const uint8_t *)key, key_len);
+    kvstore_slot_t *slot;
+    _entry_hdr_t hdr;
+    int res;
+
+    if ((key_len == 0) || (key_len > KVSTORE_KEY_MAX)) {
+        return -ENOENT;
+    }
+    mutex_lock(&kv->lock);
+    kv->stats.gets++;
+    if (((res = _build_index(kv)) < 0) ||
+        ((res = _find(kv, hash, key, key_len, &slot, &hdr)) < 0)) {
+        goto out;
+    }
+    if (res == 0) {
+        res = -ENOENT;
+        goto out;
+    }
+    if (hdr.val_len > len) {
+        res = -ENOBUFS;
+        goto out;
+    }
+    res = _read(kv, slot->addr + sizeof(hdr) + key_len, buf, hdr.val_len);
+    if (res < 0) {
+        goto out;
+    }
+    uint16_t crc = crc16_ccitt_update(_hdr_crc(&hdr), (const uint8_t *)key,
+                                      key_len);
+    res = (crc16_ccitt_update(crc, buf, hdr.val_len) == hdr.crc) ? hdr.val_len
+          : -EIO;
+
+out:
+    mutex_unlock(&kv->lock);
+    return res;
+}
+
+/* compares the value of an entry with val */
+static int _value_equals(kvstore_t *kv, uint32_t addr, const _entry_hdr_t *old,
+                         const _entry_hdr_t *hdr, const uint8_t *val)
+{
+    uint8_t buf[COPY_CHUNK];
+
+    if ((old->val_len != hdr->val_len) || (old->crc != hdr->crc)) {
+        return 0;
+    }
+    addr += sizeof(*old) + old->key_len;
+    for (uint32_t pos = 0; pos < hdr->val_len; pos += sizeof(buf)) {
+        uint32_t n = ((hdr->val_len - pos) < sizeof(buf)) ? (hdr->val_len - pos)
+                     : sizeof(buf);
+        int res = _read(kv, addr + pos, buf, n);
+
+        if (res < 0) {
+            return res;
+        }
+        if (memcmp(buf, val + pos, n) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int kvstore_put(kvstore_t *kv, const char *key, const void *val, size_t len)
+{
+    size_t key_len = strlen(key);
+    uint32_t size = _entry_size(key_len, len);
+    kvstore_slot_t *slot;
+    _entry_hdr_t hdr, old;
+    int res, found;
+
+    if ((key_len == 0) || (key_len > KVSTORE_KEY_MAX)) {
+        return -EINVAL;
+    }
+    if ((len > UINT16_MAX) ||
+        (size > (kv->sector_size - sizeof(_sector_hdr_t)))) {
+        return -EMSGSIZE;
+    }
+    hdr.hash = fnv_hash((const uint8_t *)key, key_len);
+    hdr.key_len = key_len;
+    hdr.type = TYPE_PUT;
+    hdr.val_len = len;
+    hdr.reserved = 0xffff;
+    hdr.crc = crc16_ccitt_update(_hdr_crc(&hdr), (const uint8_t *)key, key_len);
+    hdr.crc = crc16_ccitt_update(hdr.crc, val, len);
+
+    mutex_lock(&kv->lock);
+    if (((res = _build_index(kv)) < 0) ||
+        ((res = found = _find(kv, hdr.hash, key, key_len, &slot, &old)) < 0)) {
+        goto out;
+    }
+    if (found) {
+        if ((res = _value_equals(kv, slot->addr, &old, &hdr, val)) != 0) {
+            if (res > 0) {
+                kv->stats.puts_unchanged++;
+                res = 0;
+            }
+            goto out;
+        }
+    }
+    else if (!slot) {
+        res = -ENOMEM;
+        goto out;
+    }
+    /* the collection only moves entries, slots stay where they are */
+    if ((res = _make_room(kv, size)) < 0) {
+        goto out;
+    }
+    uint32_t addr = _sector_addr(kv, kv->head) + kv->offset;
+    if (((res = _put(kv, &hdr, sizeof(hdr))) < 0) ||
+        ((res = _put(kv, key, key_len)) < 0) ||
+        ((res = _put(kv, val, len)) < 0) ||
+        /* padding stays erased */
+        ((res = _put(kv, NULL, size - sizeof(hdr) - key_len - len)) < 0)) {
+        goto out;
+    }
+    if (!found) {
+        slot->hash = hdr.hash;
+        kv->index_used++;
+    }
+    slot->addr = addr;
+    kv->stats.puts++;
+
+out:
+    mutex_unlock(&kv->lock);
+    return res;
+}
+
+int kvstore_delete(kvstore_t *kv, const char *key)
+{
+    size_t key_len = strlen(key);
+    uint32_t size = _entry_size(key_len, 0);
+    kvstore_slot_t *slot;
+    _entry_hdr_t hdr, old;
+    int res;
+
+    if ((key_len == 0) || (key_len > KVSTORE_KEY_MAX)) {
+        return -ENOENT;
+    }
+    hdr.hash = fnv_hash((const uint8_t *)key, key_len);
+    hdr.key_len = key_len;
+    hdr.type = TYPE_DEL;
+    hdr.val_len = 0;
+    hdr.reserved = 0xffff;
+    hdr.crc = crc16_ccitt_update(_hdr_crc(&hdr), (const uint8_t *)key, key_len);
+
+    mutex_lock(&kv->lock);
+    if (((res = _build_index(kv)) < 0) ||
+        ((res = _find(kv, hdr.hash, key, key_len, &slot, &old)) < 0)) {
+        goto out;
+    }
+    if (res == 0) {
+        res = -ENOENT;
+        goto out;
+    }
+    /* drop the key from the index first, so the collection does not copy
+     * its entry: a full store always gets room for the tombstone this way,
+     * as it is not larger than the entry */
+    _remove_slot(kv, slot);
+    if (((res = _make_room(kv, size)) < 0) ||
+        ((res = _put(kv, &hdr, sizeof(hdr))) < 0) ||
+        ((res = _put(kv, key, key_len)) < 0) ||
+        ((res = _put(kv, NULL, size - sizeof(hdr) - key_len)) < 0)) {
+        /* the entry may still be on the device, or was dropped by the
+         * collection: rebuild the index from the device on the next call */
+        kv->index_valid = false;
+        goto out;
+    }
+    kv->stats.deletes++;
+
+out:
+    mutex_unlock(&kv->lock);
+    return res;
+}
+
+int kvstore_commit(kvstore_t *kv)
+{
+    mutex_lock(&kv->lock);
+    int res = _program(kv);
+    mutex_unlock(&kv->lock);
+    return res;
+}
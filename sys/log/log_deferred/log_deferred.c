@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_log_deferred
+ * @{
+ *
+ * @file
+ * @brief       Deferred binary logging implementation
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "irq.h"
+#include "log.h"
+#include "mutex.h"
+#include "thread.h"
+
+#if (LOG_DEFERRED_BUFSIZE & (LOG_DEFERRED_BUFSIZE - 1)) != 0
+#error "LOG_DEFERRED_BUFSIZE must be a power of two"
+#endif
+
+/* marker, header and at most 255 bytes of arguments */
+#define FRAME_MAX       (1U + LOG_DEFERRED_HDR_SIZE + UINT8_MAX)
+
+static uint8_t _buf[LOG_DEFERRED_BUFSIZE];
+/* free running indices, written by the producers resp. the consumer only */
+static volatile unsigned _writes;
+static volatile unsigned _reads;
+static volatile unsigned _dropped;
+
+/* unlocked by a producer when the ring buffer was empty */
+static mutex_t _wakeup = MUTEX_INIT_LOCKED;
+/* serializes the consumers, i.e. the drain thread and log_deferred_flush() */
+static mutex_t _drain_lock = MUTEX_INIT;
+
+static char _stack[LOG_DEFERRED_STACKSIZE];
+
+void log_deferred_write(unsigned level, const char *fmt, uint8_t *rec,
+                        size_t len)
+{
+    unsigned id = (unsigned)(fmt - __start_log_fmt);
+
+    rec[0] = (uint8_t)id;
+    rec[1] = (uint8_t)(id >> 8);
+    rec[2] = (uint8_t)level;
+    rec[3] = (uint8_t)(len - LOG_DEFERRED_HDR_SIZE);
+
+    unsigned state = irq_disable();
+    unsigned writes = _writes;
+    unsigned used = writes - _reads;
+
+    if (len > LOG_DEFERRED_BUFSIZE - used) {
+        _dropped++;
+        irq_restore(state);
+        return;
+    }
+    unsigned pos = writes & (LOG_DEFERRED_BUFSIZE - 1);
+    size_t tail = LOG_DEFERRED_BUFSIZE - pos;
+    if (len <= tail) {
+        memcpy(&_buf[pos], rec, len);
+    }
+    else {
+        memcpy(&_buf[pos], rec, tail);
+        memcpy(_buf, rec + tail, len - tail);
+    }
+    _writes = writes + len;
+    irq_restore(state);
+
+    if (used == 0) {
+        mutex_unlock(&_wakeup);
+    }
+}
+
+static void _read(uint8_t *dst, unsigned pos, size_t len)
+{
+    pos &= (LOG_DEFERRED_BUFSIZE - 1);
+    size_t tail = LOG_DEFERRED_BUFSIZE - pos;
+    if (len <= tail) {
+        memcpy(dst, &_buf[pos], len);
+    }
+    else {
+        memcpy(dst, &_buf[pos], tail);
+        memcpy(dst + tail, _buf, len - tail);
+    }
+}
+
+static void _write_frame(uint8_t *frame, size_t len)
+{
+    frame[0] = LOG_DEFERRED_MARKER;
+    fwrite(frame, 1, len, stdout);
+}
+
+static void _report_dropped(uint8_t *frame)
+{
+    unsigned dropped = _dropped;
+
+    if (!dropped) {
+        return;
+    }
+    /* _dropped is only ever incremented, so subtracting what is reported
+     * keeps drops that happen meanwhile */
+    unsigned state = irq_disable();
+    _dropped -= dropped;
+    irq_restore(state);
+
+    uint32_t count = dropped;
+    frame[1] = (uint8_t)LOG_DEFERRED_ID_DROPPED;
+    frame[2] = (uint8_t)(LOG_DEFERRED_ID_DROPPED >> 8);
+    frame[3] = 0;
+    frame[4] = sizeof(count);
+    memcpy(&frame[5], &count, sizeof(count));
+    _write_frame(frame, 1 + LOG_DEFERRED_HDR_SIZE + sizeof(count));
+}
+
+static void _drain(void)
+{
+    uint8_t frame[FRAME_MAX];
+
+    mutex_lock(&_drain_lock);
+    while (1) {
+        unsigned reads = _reads;
+        if (_writes == reads) {
+            _report_dropped(frame);
+            break;
+        }
+        /* the producers copy whole records while interrupts are disabled, so
+         * a record is complete once _writes was moved past it */
+        _read(&frame[1], reads, LOG_DEFERRED_HDR_SIZE);
+        size_t len = LOG_DEFERRED_HDR_SIZE + frame[1 + 3];
+        _read(&frame[1 + LOG_DEFERRED_HDR_SIZE],
+              reads + LOG_DEFERRED_HDR_SIZE, len - LOG_DEFERRED_HDR_SIZE);
+        _reads = reads + len;
+
+        _write_frame(frame, 1 + len);
+    }
+    fflush(stdout);
+    mutex_unlock(&_drain_lock);
+}
+
+void log_deferred_flush(void)
+{
+    _drain();
+}
+
+static void *_drain_thread(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        _drain();
+        mutex_lock(&_wakeup);
+    }
+    return NULL;
+}
+
+void log_deferred_init(void)
+{
+    thread_create(_stack, sizeof(_stack), LOG_DEFERRED_PRIO,
+                  THREAD_CREATE_STACKTEST, _drain_thread, NULL, "log_deferred");
+}
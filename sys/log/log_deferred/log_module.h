@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_log_deferred Deferred binary logging
+ * @ingroup     sys
+ * @brief       Log module that defers formatting to the host
+ *
+ * With this module, a LOG_*() call does not format anything on the device.
+ * The format string is placed into the `log_fmt` linker section, and the
+ * call site only stores the 16-bit offset of that string in the section, the
+ * log level and the raw values of the arguments into a ring buffer. A low
+ * priority thread drains the ring buffer to stdio (UART or RTT), and
+ * `dist/tools/logdecode/logdecode.py` reconstructs the messages on the host
+ * from the ELF file of the application.
+ *
+ * On the device, a call costs copying the arguments to the stack and into the
+ * ring buffer with interrupts disabled. When the ring buffer was empty, the
+ * drain thread is woken up in addition. If the ring buffer is full, the
+ * record is dropped and the drain thread reports the number of dropped
+ * records with the next frame it sends.
+ *
+ * Restrictions compared to printf-based logging:
+ *
+ * - the format string must be a string literal
+ * - at most 8 arguments per call
+ * - `%s` arguments are logged as pointers; the host tool can only resolve
+ *   strings that are part of the ELF file (e.g. string literals), strings in
+ *   RAM are shown as their address
+ * - `%n` and `long double` are not supported
+ * - C++ sources fall back to printf()
+ *
+ * Anything else written to stdout is passed through by the host tool. Each
+ * log frame starts with @ref LOG_DEFERRED_MARKER, a byte that does not occur
+ * in UTF-8 text, followed by the record:
+ *
+ * | offset | size | content                                         |
+ * |:-------|:-----|:------------------------------------------------|
+ * | 0      | 2    | offset of the format string, little endian      |
+ * | 2      | 1    | log level                                       |
+ * | 3      | 1    | length of the arguments in bytes                |
+ * | 4      | n    | arguments, after default argument promotion, in |
+ * |        |      | the byte order of the target                    |
+ *
+ * @{
+ *
+ * @file
+ * @brief       Deferred binary logging
+ */
+
+#ifndef LOG_MODULE_H
+#define LOG_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Size of the ring buffer in bytes, must be a power of two
+ */
+#ifndef LOG_DEFERRED_BUFSIZE
+#define LOG_DEFERRED_BUFSIZE        (512U)
+#endif
+
+/**
+ * @brief   Priority of the drain thread
+ */
+#ifndef LOG_DEFERRED_PRIO
+#define LOG_DEFERRED_PRIO           (THREAD_PRIORITY_MIN - 1)
+#endif
+
+/**
+ * @brief   Stack size of the drain thread
+ */
+#ifndef LOG_DEFERRED_STACKSIZE
+#define LOG_DEFERRED_STACKSIZE      (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   First byte of each frame written to stdio
+ */
+#define LOG_DEFERRED_MARKER         (0xf5)
+
+/**
+ * @brief   Size of the record header
+ */
+#define LOG_DEFERRED_HDR_SIZE       (4U)
+
+/**
+ * @brief   Format string offset of the frame reporting dropped records
+ *
+ * The frame carries the number of dropped records as a 32-bit argument.
+ */
+#define LOG_DEFERRED_ID_DROPPED     (0xffffU)
+
+/**
+ * @brief   Start of the format string section, provided by the linker
+ */
+extern const char __start_log_fmt[];
+
+/**
+ * @brief   Start the drain thread
+ *
+ * Called by auto_init. Records logged before are kept in the ring buffer.
+ */
+void log_deferred_init(void);
+
+/**
+ * @brief   Store a record in the ring buffer
+ *
+ * Used by log_write(), not meant to be called directly.
+ *
+ * @param[in] level     log level
+ * @param[in] fmt       format string, must be in the `log_fmt` section
+ * @param[in,out] rec   record, the first @ref LOG_DEFERRED_HDR_SIZE bytes are
+ *                      filled in by this function
+ * @param[in] len       length of @p rec including the header
+ */
+void log_deferred_write(unsigned level, const char *fmt, uint8_t *rec,
+                        size_t len);
+
+/**
+ * @brief   Write all records in the ring buffer to stdio
+ *
+ * Blocks until done. Use before a reboot or when the drain thread cannot run.
+ */
+void log_deferred_flush(void);
+
+#ifndef DOXYGEN
+#ifndef __cplusplus
+
+/* number of arguments after the format string */
+#define _LOG_DEFERRED_NARGS(...) \
+    _LOG_DEFERRED_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+#define _LOG_DEFERRED_NARGS_(f, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+
+#define _LOG_DEFERRED_CAT(a, b)     _LOG_DEFERRED_CAT_(a, b)
+#define _LOG_DEFERRED_CAT_(a, b)    a ## b
+
+/* arguments are stored after default argument promotion, as printf would
+ * read them: integers smaller than int as int, float as double. The
+ * conditional operator applies the integer promotions and lets arrays decay
+ * to pointers, without evaluating the argument. */
+#define _LOG_DEFERRED_TYPE(a)       __typeof__(1 ? (a) : (a))
+#define _LOG_DEFERRED_IS_FLOAT(a) \
+    __builtin_types_compatible_p(_LOG_DEFERRED_TYPE(a), float)
+#define _LOG_DEFERRED_SIZE(a) \
+    (_LOG_DEFERRED_IS_FLOAT(a) ? sizeof(double) : sizeof(_LOG_DEFERRED_TYPE(a)))
+
+#define _LOG_DEFERRED_ARG(a) \
+    { \
+        _LOG_DEFERRED_TYPE(a) _log_v = (a); \
+        if (_LOG_DEFERRED_IS_FLOAT(a)) { \
+            float _log_f; \
+            memcpy(&_log_f, &_log_v, sizeof(_log_f)); \
+            double _log_d = _log_f; \
+            memcpy(_log_p, &_log_d, sizeof(_log_d)); \
+            _log_p += sizeof(_log_d); \
+        } \
+        else { \
+            memcpy(_log_p, &_log_v, sizeof(_log_v)); \
+            _log_p += sizeof(_log_v); \
+        } \
+    }
+
+#define _LOG_DEFERRED_BEGIN(level, fmt, size) \
+    do { \
+        static const char _log_fmt[] \
+            __attribute__((section("log_fmt"), used)) = fmt; \
+        uint8_t _log_rec[LOG_DEFERRED_HDR_SIZE + (size)]; \
+        uint8_t *_log_p = _log_rec + LOG_DEFERRED_HDR_SIZE;
+
+#define _LOG_DEFERRED_END(level) \
+        log_deferred_write((level), _log_fmt, _log_rec, \
+                           (size_t)(_log_p - _log_rec)); \
+    } while (0)
+
+#define _LOG_DEFERRED_0(level, fmt) \
+    _LOG_DEFERRED_BEGIN(level, fmt, 0) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_1(level, fmt, a) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a)) \
+    _LOG_DEFERRED_ARG(a) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_2(level, fmt, a, b) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_3(level, fmt, a, b, c) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_4(level, fmt, a, b, c, d) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c) \
+                        + _LOG_DEFERRED_SIZE(d)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_ARG(d) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_5(level, fmt, a, b, c, d, e) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c) \
+                        + _LOG_DEFERRED_SIZE(d) + _LOG_DEFERRED_SIZE(e)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_ARG(d) _LOG_DEFERRED_ARG(e) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_6(level, fmt, a, b, c, d, e, f) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c) \
+                        + _LOG_DEFERRED_SIZE(d) + _LOG_DEFERRED_SIZE(e) \
+                        + _LOG_DEFERRED_SIZE(f)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_ARG(d) _LOG_DEFERRED_ARG(e) _LOG_DEFERRED_ARG(f) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_7(level, fmt, a, b, c, d, e, f, g) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c) \
+                        + _LOG_DEFERRED_SIZE(d) + _LOG_DEFERRED_SIZE(e) \
+                        + _LOG_DEFERRED_SIZE(f) + _LOG_DEFERRED_SIZE(g)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_ARG(d) _LOG_DEFERRED_ARG(e) _LOG_DEFERRED_ARG(f) \
+    _LOG_DEFERRED_ARG(g) \
+    _LOG_DEFERRED_END(level)
+#define _LOG_DEFERRED_8(level, fmt, a, b, c, d, e, f, g, h) \
+    _LOG_DEFERRED_BEGIN(level, fmt, _LOG_DEFERRED_SIZE(a) \
+                        + _LOG_DEFERRED_SIZE(b) + _LOG_DEFERRED_SIZE(c) \
+                        + _LOG_DEFERRED_SIZE(d) + _LOG_DEFERRED_SIZE(e) \
+                        + _LOG_DEFERRED_SIZE(f) + _LOG_DEFERRED_SIZE(g) \
+                        + _LOG_DEFERRED_SIZE(h)) \
+    _LOG_DEFERRED_ARG(a) _LOG_DEFERRED_ARG(b) _LOG_DEFERRED_ARG(c) \
+    _LOG_DEFERRED_ARG(d) _LOG_DEFERRED_ARG(e) _LOG_DEFERRED_ARG(f) \
+    _LOG_DEFERRED_ARG(g) _LOG_DEFERRED_ARG(h) \
+    _LOG_DEFERRED_END(level)
+
+#endif /* __cplusplus */
+#endif /* DOXYGEN */
+
+/**
+ * @brief   log_write overridden macro
+ *
+ * @param[in] level     log level
+ * @param[in] ...       format string literal and up to 8 arguments
+ */
+#ifdef __cplusplus
+#include <stdio.h>
+#define log_write(level, ...) printf(__VA_ARGS__)
+#else
+#define log_write(level, ...) \
+    _LOG_DEFERRED_CAT(_LOG_DEFERRED_, _LOG_DEFERRED_NARGS(__VA_ARGS__)) \
+        (level, __VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif /* LOG_MODULE_H */
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_marshal
+ * @{
+ *
+ * @file
+ * @brief       Helpers for the generated CBOR and UBJSON codecs
+ *
+ * @}
+ */
+
+#include "marshal.h"
+
+#define CBOR_MT_MASK        (0xe0U)
+#define CBOR_AI_MASK        (0x1fU)
+#define CBOR_AI_UINT8       (24U)
+#define CBOR_MT_BYTES       (0x40U)
+#define CBOR_MT_TAG         (0xc0U)
+#define CBOR_MT_SIMPLE      (0xe0U)
+#define CBOR_FLOAT16        (0xf9U)
+#define CBOR_FLOAT64        (0xfbU)
+
+static uint32_t _get_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static float _float(uint32_t bits)
+{
+    union {
+        uint32_t i;
+        float f;
+    } u = { .i = bits };
+    return u.f;
+}
+
+static float _half(uint16_t bits)
+{
+    uint32_t sign = (uint32_t)(bits & 0x8000) << 16;
+    unsigned exp = (bits >> 10) & 0x1f;
+    uint32_t mant = bits & 0x3ff;
+
+    if (exp == 0) {
+        /* subnormal, exact in single precision */
+        float val = (float)mant / (float)(1UL << 24);
+        return sign ? -val : val;
+    }
+    if (exp == 0x1f) {
+        /* infinity and NaN */
+        return _float(sign | 0x7f800000UL | (mant << 13));
+    }
+    return _float(sign | ((uint32_t)(exp + 127 - 15) << 23) | (mant << 13));
+}
+
+static float _double(uint64_t bits)
+{
+    union {
+        uint64_t i;
+        double d;
+    } u = { .i = bits };
+    return u.d;
+}
+
+int marshal_cbor_put_head(uint8_t *p, const uint8_t *end, uint8_t mt,
+                          uint64_t val)
+{
+    unsigned follow;
+    uint8_t ai;
+
+    if (val < CBOR_AI_UINT8) {
+        ai = val;
+        follow = 0;
+    }
+    else if (val <= 0xff) {
+        ai = CBOR_AI_UINT8;
+        follow = 1;
+    }
+    else if (val <= 0xffff) {
+        ai = CBOR_AI_UINT8 + 1;
+        follow = 2;
+    }
+    else if (val <= 0xffffffff) {
+        ai = CBOR_AI_UINT8 + 2;
+        follow = 4;
+    }
+    else {
+        ai = CBOR_AI_UINT8 + 3;
+        follow = 8;
+    }
+    if ((size_t)(end - p) < 1 + follow) {
+        return -ENOBUFS;
+    }
+    *p++ = mt | ai;
+    for (unsigned i = follow; i--;) {
+        *p++ = val >> (8 * i);
+    }
+    return 1 + follow;
+}
+
+/**
+ * Parses a head of any major type, returns its size
+ */
+static int _head(const uint8_t *p, const uint8_t *end, uint8_t *mt,
+                 uint64_t *val)
+{
+    unsigned follow;
+    uint8_t ai;
+
+    if (p == end) {
+        return -EBADMSG;
+    }
+    *mt = *p & CBOR_MT_MASK;
+    ai = *p & CBOR_AI_MASK;
+    if (ai < CBOR_AI_UINT8) {
+        *val = ai;
+        return 1;
+    }
+    if (ai > CBOR_AI_UINT8 + 3) {
+        /* indefinite lengths are not supported */
+        return -EBADMSG;
+    }
+    follow = 1U << (ai - CBOR_AI_UINT8);
+    if ((size_t)(end - p) < 1 + follow) {
+        return -EBADMSG;
+    }
+    *val = 0;
+    for (unsigned i = 1; i <= follow; i++) {
+        *val = (*val << 8) | p[i];
+    }
+    return 1 + follow;
+}
+
+int marshal_cbor_get_head(const uint8_t *p, const uint8_t *end, uint8_t mt,
+                          uint64_t *val)
+{
+    uint8_t type;
+    int res = _head(p, end, &type, val);
+
+    if ((res >= 0) && (type != mt)) {
+        return -EBADMSG;
+    }
+    return res;
+}
+
+int marshal_cbor_skip(const uint8_t *p, const uint8_t *end, unsigned items)
+{
+    const uint8_t *start = p;
+    uint64_t left = items;
+    uint64_t val;
+    uint8_t mt;
+    int res;
+
+    while (left--) {
+        if ((res = _head(p, end, &mt, &val)) < 0) {
+            return res;
+        }
+        p += res;
+        switch (mt) {
+            case CBOR_MT_BYTES:
+            case MARSHAL_CBOR_TEXT:
+                if (val > (uint64_t)(end - p)) {
+                    return -EBADMSG;
+                }
+                p += val;
+                break;
+            case MARSHAL_CBOR_ARRAY:
+                left += val;
+                break;
+            case MARSHAL_CBOR_MAP:
+                left += 2 * val;
+                break;
+            case CBOR_MT_TAG:
+                left++;
+                break;
+            default:
+                break;
+        }
+        /* every item takes at least one byte */
+        if (left > (uint64_t)(end - p)) {
+            return -EBADMSG;
+        }
+    }
+    return p - start;
+}
+
+int marshal_cbor_get_int32(const uint8_t *p, const uint8_t *end, int32_t *val)
+{
+    uint64_t u;
+    uint8_t mt;
+    int res = _head(p, end, &mt, &u);
+
+    if (res < 0) {
+        return res;
+    }
+    if (mt == MARSHAL_CBOR_UINT) {
+        if (u > INT32_MAX) {
+            return -ERANGE;
+        }
+        *val = u;
+    }
+    else if (mt == MARSHAL_CBOR_NEGINT) {
+        if (u > INT32_MAX) {
+            return -ERANGE;
+        }
+        *val = -1 - (int32_t)u;
+    }
+    else {
+        return -EBADMSG;
+    }
+    return res;
+}
+
+int marshal_cbor_get_uint32(const uint8_t *p, const uint8_t *end, uint32_t *val)
+{
+    uint64_t u;
+    int res = marshal_cbor_get_head(p, end, MARSHAL_CBOR_UINT, &u);
+
+    if (res < 0) {
+        return res;
+    }
+    if (u > UINT32_MAX) {
+        return -ERANGE;
+    }
+    *val = u;
+    return res;
+}
+
+int marshal_cbor_get_float(const uint8_t *p, const uint8_t *end, float *val)
+{
+    if ((end - p) >= 3 && (*p == CBOR_FLOAT16)) {
+        *val = _half(((uint16_t)p[1] << 8) | p[2]);
+        return 3;
+    }
+    if ((end - p) >= 5 && (*p == MARSHAL_CBOR_FLOAT32)) {
+        *val = _float(_get_be32(&p[1]));
+        return 5;
+    }
+    if ((end - p) >= 9 && (*p == CBOR_FLOAT64)) {
+        *val = _double(((uint64_t)_get_be32(&p[1]) << 32) | _get_be32(&p[5]));
+        return 9;
+    }
+    return -EBADMSG;
+}
+
+int marshal_cbor_get_bool(const uint8_t *p, const uint8_t *end, bool *val)
+{
+    if ((p == end) ||
+        ((*p != MARSHAL_CBOR_TRUE) && (*p != MARSHAL_CBOR_FALSE))) {
+        return -EBADMSG;
+    }
+    *val = (*p == MARSHAL_CBOR_TRUE);
+    return 1;
+}
+
+int marshal_cbor_get_text(const uint8_t *p, const uint8_t *end, char *val,
+                          size_t size)
+{
+    uint64_t len;
+    int res = marshal_cbor_get_head(p, end, MARSHAL_CBOR_TEXT, &len);
+
+    if (res < 0) {
+        return res;
+    }
+    if (len > (uint64_t)(end - p) - res) {
+        return -EBADMSG;
+    }
+    if (len >= size) {
+        return -EMSGSIZE;
+    }
+    memcpy(val, p + res, len);
+    val[len] = '\0';
+    return res + len;
+}
+
+/**
+ * Parses an integer value of any size, returns its size
+ */
+static int _ubjson_int(const uint8_t *p, const uint8_t *end, int64_t *val)
+{
+    unsigned size;
+
+    if (p == end) {
+        return -EBADMSG;
+    }
+    switch (*p) {
+        case 'i':
+        case 'U':
+            size = 1;
+            break;
+        case 'I':
+            size = 2;
+            break;
+        case 'l':
+            size = 4;
+            break;
+        case 'L':
+            size = 8;
+            break;
+        default:
+            return -EBADMSG;
+    }
+    if ((size_t)(end - p) < 1 + size) {
+        return -EBADMSG;
+    }
+    if (*p == 'U') {
+        *val = p[1];
+        return 2;
+    }
+    /* sign extend from the first byte */
+    *val = (int8_t)p[1];
+    for (unsigned i = 2; i <= size; i++) {
+        *val = (int64_t)((uint64_t)*val << 8) | p[i];
+    }
+    return 1 + size;
+}
+
+static int _ubjson_noops(const uint8_t *p, const uint8_t *end)
+{
+    const uint8_t *start = p;
+
+    while ((p < end) && (*p == 'N')) {
+        p++;
+    }
+    return p - start;
+}
+
+/**
+ * Parses the length of a string, returns the size of the length
+ */
+static int _ubjson_len(const uint8_t *p, const uint8_t *end, size_t *len)
+{
+    int64_t val;
+    int res = _ubjson_int(p, end, &val);
+
+    if (res < 0) {
+        return res;
+    }
+    if ((val < 0) || ((uint64_t)val > (uint64_t)(end - p) - res)) {
+        return -EBADMSG;
+    }
+    *len = val;
+    return res;
+}
+
+/* *len is SIZE_MAX at the end of the object; the return value then includes
+ * the end marker */
+int marshal_ubjson_get_key(const uint8_t *p, const uint8_t *end, size_t *len)
+{
+    int skip = _ubjson_noops(p, end);
+    int res;
+
+    p += skip;
+    if (p == end) {
+        return -EBADMSG;
+    }
+    if (*p == '}') {
+        *len = SIZE_MAX;
+        return skip + 1;
+    }
+    if ((res = _ubjson_len(p, end, len)) < 0) {
+        return res;
+    }
+    return skip + res;
+}
+
+int marshal_ubjson_skip(const uint8_t *p, const uint8_t *end)
+{
+    int skip = _ubjson_noops(p, end);
+    int64_t val;
+    size_t len;
+    int res;
+
+    p += skip;
+    if (p == end) {
+        return -EBADMSG;
+    }
+    switch (*p) {
+        case 'Z':
+        case 'T':
+        case 'F':
+            return skip + 1;
+        case 'C':
+            res = 2;
+            break;
+        case 'd':
+            res = 5;
+            break;
+        case 'D':
+            res = 9;
+            break;
+        case 'S':
+        case 'H':
+            if ((res = _ubjson_len(p + 1, end, &len)) < 0) {
+                return res;
+            }
+            return skip + 1 + res + len;
+        default:
+            /* integers, nested containers are not supported */
+            if ((res = _ubjson_int(p, end, &val)) < 0) {
+                return res;
+            }
+            return skip + res;
+    }
+    if ((end - p) < res) {
+        return -EBADMSG;
+    }
+    return skip + res;
+}
+
+int marshal_ubjson_get_int32(const uint8_t *p, const uint8_t *end,
+                             int32_t *val)
+{
+    int64_t v;
+    int res = _ubjson_int(p, end, &v);
+
+    if (res < 0) {
+        return res;
+    }
+    if ((v < INT32_MIN) || (v > INT32_MAX)) {
+        return -ERANGE;
+    }
+    *val = v;
+    return res;
+}
+
+int marshal_ubjson_get_uint32(const uint8_t *p, const uint8_t *end,
+                              uint32_t *val)
+{
+    int64_t v;
+    int res = _ubjson_int(p, end, &v);
+
+    if (res < 0) {
+        return res;
+    }
+    if ((v < 0) || (v > UINT32_MAX)) {
+        return -ERANGE;
+    }
+    *val = v;
+    return res;
+}
+
+int marshal_ubjson_get_float(const uint8_t *p, const uint8_t *end, float *val)
+{
+    if ((end - p) >= 5 && (*p == 'd')) {
+        *val = _float(_get_be32(&p[1]));
+        return 5;
+    }
+    if ((end - p) >= 9 && (*p == 'D')) {
+        *val = _double(((uint64_t)_get_be32(&p[1]) << 32) | _get_be32(&p[5]));
+        return 9;
+    }
+    return -EBADMSG;
+}
+
+int marshal_ubjson_get_bool(const uint8_t *p, const uint8_t *end, bool *val)
+{
+    if ((p == end) || ((*p != 'T') && (*p != 'F'))) {
+        return -EBADMSG;
+    }
+    *val = (*p == 'T');
+    return 1;
+}
+
+int marshal_ubjson_get_text(const uint8_t *p, const uint8_t *end, char *val,
+                            size_t size)
+{
+    size_t len;
+    int res;
+
+    if ((p == end) || (*p != 'S')) {
+        return -EBADMSG;
+    }
+    if ((res = _ubjson_len(p + 1, end, &len)) < 0) {
+        return res;
+    }
+    if (len >= size) {
+        return -EMSGSIZE;
+    }
+    memcpy(val, p + 1 + res, len);
+    val[len] = '\0';
+    return 1 + res + len;
+}
@@ -19,10 +19,16 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include "net/gcoap.h"
 #include "random.h"
 #include "thread.h"
 
+#ifdef MODULE_GCOAP_HEATSHRINK
+#include "heatshrink_decoder.h"
+#include "heatshrink_encoder.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -30,10 +36,21 @@
 static void *_event_loop(void *arg);
 static void _listen(sock_udp_t *sock);
 static ssize_t _well_known_core_handler(coap_pkt_t* pdu, uint8_t *buf, size_t len);
-static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned accept, unsigned blockopt,
+                              const gcoap_block_t *block);
 static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
                                                          sock_udp_ep_t *remote);
-static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                           unsigned accept, unsigned blockopt,
+                           const gcoap_block_t *block);
+static int _parse(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+static unsigned _decode_opt_ext(uint8_t **pos, unsigned nibble);
+static int _find_option(coap_pkt_t *pdu, unsigned optnum, uint8_t **value);
+static size_t _put_uint_option(uint8_t *buf, unsigned last_optnum,
+                               unsigned optnum, uint32_t val);
+static size_t _put_block_option(uint8_t *buf, unsigned last_optnum,
+                                unsigned blockopt, const gcoap_block_t *block);
 static void _expire_request(gcoap_request_memo_t *memo);
 static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *pdu,
                                                             uint8_t *buf, size_t len);
@@ -44,6 +61,15 @@ static int _find_obs_memo(gcoap_observe_memo_t **memo, sock_udp_ep_t *remote,
                                                        coap_pkt_t *pdu);
 static void _find_obs_memo_resource(gcoap_observe_memo_t **memo,
                                    const coap_resource_t *resource);
+#ifdef MODULE_GCOAP_WORKERS
+static void _enqueue_req(sock_udp_t *sock, uint8_t *buf, size_t len,
+                         sock_udp_ep_t *remote);
+static void *_worker_loop(void *arg);
+static void _ack_delay_cb(void *arg);
+static void _send_empty_ack(sock_udp_t *sock, uint16_t msgid,
+                            sock_udp_ep_t *remote);
+static void _expire_ack_delay(sock_udp_t *sock, uint32_t tag);
+#endif
 
 /* Internal variables */
 const coap_resource_t _default_resources[] = {
@@ -64,6 +90,39 @@ static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 static char _msg_stack[GCOAP_STACK_SIZE];
 static sock_udp_t _sock;
 
+#ifdef MODULE_GCOAP_WORKERS
+/**
+ * @name    States of a worker request slot
+ * @{
+ */
+#define GCOAP_SLOT_UNUSED       (0) /**< Slot is available */
+#define GCOAP_SLOT_QUEUED       (1) /**< Request queued or being handled */
+#define GCOAP_SLOT_SEPARATE     (2) /**< Empty ACK sent; response is separate */
+#define GCOAP_SLOT_SENDING      (3) /**< Response is being sent */
+/** @} */
+
+/* A request handed from the gcoap thread to a worker */
+typedef struct {
+    unsigned state;                     /* State of the slot, a GCOAP_SLOT... */
+    uint16_t gen;                       /* Counts uses of the slot */
+    uint16_t msgid;                     /* Message ID of the request */
+    uint8_t type;                       /* Message type of the request */
+    size_t len;                         /* Length of the request in buf */
+    sock_udp_ep_t remote;               /* Requesting endpoint */
+    xtimer_t ack_timer;                 /* Limits wait for a piggybacked ACK */
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];    /* Request, and then response */
+} gcoap_worker_req_t;
+
+static gcoap_worker_req_t _worker_reqs[GCOAP_WORKER_QUEUE_SIZE];
+static msg_t _worker_queue[GCOAP_WORKER_QUEUE_SIZE];
+/* mbox_init() requires a power of two; fails to compile otherwise */
+typedef char _worker_queue_size_check[
+    ((GCOAP_WORKER_QUEUE_SIZE & (GCOAP_WORKER_QUEUE_SIZE - 1)) == 0) ? 1 : -1];
+static mbox_t _worker_mbox;
+static mutex_t _worker_lock = MUTEX_INIT;
+static char _worker_stacks[GCOAP_WORKERS_NUMOF][GCOAP_WORKER_STACK_SIZE];
+#endif
+
 
 /* Event/Message loop for gcoap _pid thread. */
 static void *_event_loop(void *arg)
@@ -96,6 +155,11 @@ static void *_event_loop(void *arg)
                 case GCOAP_MSG_TYPE_INTR:
                     /* next _listen() timeout will account for open requests */
                     break;
+#ifdef MODULE_GCOAP_WORKERS
+                case GCOAP_MSG_TYPE_ACK_DELAY:
+                    _expire_ack_delay(&_sock, msg_rcvd.content.value);
+                    break;
+#endif
                 default:
                     break;
             }
@@ -128,7 +192,9 @@ static void _listen(sock_udp_t *sock)
         return;
     }
 
-    res = coap_parse(&pdu, buf, res);
+    size_t len = res;
+
+    res = _parse(&pdu, buf, len);
     if (res < 0) {
         DEBUG("gcoap: parse failure: %d\n", res);
         /* If a response, can't clear memo, but it will timeout later. */
@@ -143,10 +209,14 @@ static void _listen(sock_udp_t *sock)
     } else if (coap_get_code_class(&pdu) == COAP_CLASS_REQ) {
         if (coap_get_type(&pdu) == COAP_TYPE_NON
                 || coap_get_type(&pdu) == COAP_TYPE_CON) {
+#ifdef MODULE_GCOAP_WORKERS
+            _enqueue_req(sock, buf, len, &remote);
+#else
             size_t pdu_len = _handle_req(&pdu, buf, sizeof(buf), &remote);
             if (pdu_len > 0) {
                 sock_udp_send(sock, buf, pdu_len, &remote);
             }
+#endif
         }
         else {
             DEBUG("gcoap: illegal request type: %u\n", coap_get_type(&pdu));
@@ -186,10 +256,11 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
     if (resource == NULL) {
         return gcoap_response(pdu, buf, len, COAP_CODE_PATH_NOT_FOUND);
     }
-    else {
-        /* used below to ensure a memo not already recorded for the resource */
-        _find_obs_memo_resource(&resource_memo, resource);
-    }
+
+    /* worker threads may register observers concurrently */
+    mutex_lock(&_coap_state.lock);
+    /* used below to ensure a memo not already recorded for the resource */
+    _find_obs_memo_resource(&resource_memo, resource);
 
     if (coap_get_observe(pdu) == COAP_OBS_REGISTER) {
         int empty_slot = _find_obs_memo(&memo, remote, pdu);
@@ -248,9 +319,11 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 
     } else if (coap_has_observe(pdu)) {
         /* bogus request; don't respond */
+        mutex_unlock(&_coap_state.lock);
         DEBUG("gcoap: Observe value unexpected: %" PRIu32 "\n", coap_get_observe(pdu));
         return -1;
     }
+    mutex_unlock(&_coap_state.lock);
 
     ssize_t pdu_len = resource->handler(pdu, buf, len);
     if (pdu_len < 0) {
@@ -260,6 +333,159 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
     return pdu_len;
 }
 
+#ifdef MODULE_GCOAP_WORKERS
+/*
+ * Queues a received request for the worker threads, unless it is a duplicate
+ * of a request in process.
+ *
+ * buf -- Request buffer; reused for a 5.03 response if the queue is full
+ */
+static void _enqueue_req(sock_udp_t *sock, uint8_t *buf, size_t len,
+                         sock_udp_ep_t *remote)
+{
+    coap_hdr_t *hdr = (coap_hdr_t *)buf;
+    uint16_t msgid  = ntohs(hdr->id);
+    gcoap_worker_req_t *slot = NULL;
+
+    mutex_lock(&_worker_lock);
+    for (unsigned i = 0; i < GCOAP_WORKER_QUEUE_SIZE; i++) {
+        gcoap_worker_req_t *req = &_worker_reqs[i];
+
+        if (req->state == GCOAP_SLOT_UNUSED) {
+            if (slot == NULL) {
+                slot = req;
+            }
+        }
+        else if (req->msgid == msgid && req->remote.port == remote->port
+                 && memcmp(&req->remote.addr, &remote->addr,
+                           sizeof(remote->addr)) == 0) {
+            DEBUG("gcoap: duplicate request %u\n", (unsigned)msgid);
+            if (req->state == GCOAP_SLOT_SEPARATE) {
+                /* our empty ACK must have been lost */
+                _send_empty_ack(sock, msgid, remote);
+            }
+            mutex_unlock(&_worker_lock);
+            return;
+        }
+    }
+    if (slot != NULL) {
+        slot->state = GCOAP_SLOT_QUEUED;
+        slot->gen++;
+    }
+    mutex_unlock(&_worker_lock);
+
+    if (slot == NULL) {
+        coap_pkt_t pdu;
+
+        DEBUG("gcoap: worker queue full; dropping request\n");
+        _parse(&pdu, buf, len);
+        ssize_t pdu_len = gcoap_response(&pdu, buf, GCOAP_PDU_BUF_SIZE,
+                                         COAP_CODE_SERVICE_UNAVAILABLE);
+        if (pdu_len > 0) {
+            sock_udp_send(sock, buf, pdu_len, remote);
+        }
+        return;
+    }
+
+    slot->msgid = msgid;
+    slot->type  = (hdr->ver_t_tkl & 0x30) >> 4;
+    slot->len   = len;
+    memcpy(&slot->remote, remote, sizeof(sock_udp_ep_t));
+    memcpy(slot->buf, buf, len);
+
+    if (slot->type == COAP_TYPE_CON) {
+        slot->ack_timer.callback = _ack_delay_cb;
+        slot->ack_timer.arg      = slot;
+        xtimer_set(&slot->ack_timer, GCOAP_SEPARATE_RESP_DELAY);
+    }
+
+    msg_t msg = { .content = { .ptr = slot } };
+    /* cannot fail; there are as many queue entries as slots */
+    mbox_put(&_worker_mbox, &msg);
+}
+
+/* Handles queued requests, one at a time. */
+static void *_worker_loop(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        msg_t msg;
+        coap_pkt_t pdu;
+
+        mbox_get(&_worker_mbox, &msg);
+        gcoap_worker_req_t *slot = msg.content.ptr;
+
+        _parse(&pdu, slot->buf, slot->len);
+        ssize_t pdu_len = _handle_req(&pdu, slot->buf, sizeof(slot->buf),
+                                      &slot->remote);
+
+        if (slot->type == COAP_TYPE_CON) {
+            xtimer_remove(&slot->ack_timer);
+        }
+        mutex_lock(&_worker_lock);
+        if (slot->state == GCOAP_SLOT_SEPARATE) {
+            /* request already acknowledged; send as a new message */
+            uint16_t msgid = (uint16_t)atomic_fetch_add(&_coap_state.next_message_id, 1);
+            coap_hdr_set_type(pdu.hdr, COAP_TYPE_NON);
+            pdu.hdr->id = htons(msgid);
+        }
+        slot->state = GCOAP_SLOT_SENDING;
+        mutex_unlock(&_worker_lock);
+
+        if (pdu_len > 0) {
+            sock_udp_send(&_sock, slot->buf, pdu_len, &slot->remote);
+        }
+        mutex_lock(&_worker_lock);
+        slot->state = GCOAP_SLOT_UNUSED;
+        mutex_unlock(&_worker_lock);
+    }
+
+    return NULL;
+}
+
+/* Wakes the gcoap thread when a worker is late for a piggybacked response.
+ * The message names the slot by index and use, so it is ignored if it is
+ * handled only after the slot was reused. */
+static void _ack_delay_cb(void *arg)
+{
+    gcoap_worker_req_t *slot = arg;
+    msg_t msg = { .type = GCOAP_MSG_TYPE_ACK_DELAY };
+    msg_t intr = { .type = GCOAP_MSG_TYPE_INTR };
+
+    msg.content.value = ((uint32_t)slot->gen << 16) | (slot - _worker_reqs);
+
+    msg_send_int(&msg, _pid);
+    /* interrupt sock listening, so the message is handled now */
+    mbox_try_put(&_sock.reg.mbox, &intr);
+}
+
+/* Sends an empty ACK for a confirmable request. */
+static void _send_empty_ack(sock_udp_t *sock, uint16_t msgid,
+                            sock_udp_ep_t *remote)
+{
+    uint8_t buf[sizeof(coap_hdr_t)];
+
+    coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_ACK, NULL, 0, COAP_CODE_EMPTY,
+                   msgid);
+    sock_udp_send(sock, buf, sizeof(buf), remote);
+}
+
+/* Acknowledges a request if the worker still has not finished it. */
+static void _expire_ack_delay(sock_udp_t *sock, uint32_t tag)
+{
+    gcoap_worker_req_t *slot = &_worker_reqs[tag & 0xffff];
+
+    mutex_lock(&_worker_lock);
+    if ((slot->state == GCOAP_SLOT_QUEUED) && (slot->gen == (tag >> 16))) {
+        DEBUG("gcoap: separate response for %u\n", (unsigned)slot->msgid);
+        _send_empty_ack(sock, slot->msgid, &slot->remote);
+        slot->state = GCOAP_SLOT_SEPARATE;
+    }
+    mutex_unlock(&_worker_lock);
+}
+#endif
+
 /*
  * Searches listener registrations for the resource matching the path in a PDU.
  *
@@ -309,9 +535,11 @@ static void _find_resource(coap_pkt_t *pdu, coap_resource_t **resource_ptr,
  *
  * Returns the size of the PDU within the buffer, or < 0 on error.
  */
-static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+static ssize_t _finish_pdu(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                           unsigned accept, unsigned blockopt,
+                           const gcoap_block_t *block)
 {
-    ssize_t hdr_len = _write_options(pdu, buf, len);
+    ssize_t hdr_len = _write_options(pdu, buf, len, accept, blockopt, block);
     DEBUG("gcoap: header length: %i\n", (int)hdr_len);
 
     if (hdr_len > 0) {
@@ -407,9 +635,14 @@ static ssize_t _well_known_core_handler(coap_pkt_t* pdu, uint8_t *buf, size_t le
 /*
  * Creates CoAP options and sets payload marker, if any.
  *
+ * accept -- Format for an Accept option, or COAP_FORMAT_NONE if none
+ * blockopt -- COAP_OPT_BLOCK1 or COAP_OPT_BLOCK2 to write block, or 0 if none
+ *
  * Returns length of header + options, or -EINVAL on illegal path.
  */
-static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned accept, unsigned blockopt,
+                              const gcoap_block_t *block)
 {
     uint8_t last_optnum = 0;
     (void)len;
@@ -454,10 +687,25 @@ static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len)
 
     /* Uri-query for requests */
     if (coap_get_code_class(pdu) == COAP_CLASS_REQ) {
-        bufpos += coap_put_option_uri(bufpos, last_optnum, (char *)pdu->qs,
-                                      COAP_OPT_URI_QUERY);
+        size_t qs_len = coap_put_option_uri(bufpos, last_optnum, (char *)pdu->qs,
+                                            COAP_OPT_URI_QUERY);
+        if (qs_len) {
+            bufpos     += qs_len;
+            last_optnum = COAP_OPT_URI_QUERY;
+        }
+    }
+
+    /* Accept for requests */
+    if (accept != COAP_FORMAT_NONE) {
+        bufpos += _put_uint_option(bufpos, last_optnum, COAP_OPT_ACCEPT, accept);
+        last_optnum = COAP_OPT_ACCEPT;
+    }
+
+    /* Block1 or Block2 */
+    if (blockopt) {
+        bufpos += _put_block_option(bufpos, last_optnum, blockopt, block);
         /* uncomment when further options are added below ... */
-        /* last_optnum = COAP_OPT_URI_QUERY; */
+        /* last_optnum = blockopt; */
     }
 
     /* write payload marker */
@@ -467,6 +715,126 @@ static ssize_t _write_options(coap_pkt_t *pdu, uint8_t *buf, size_t len)
     return bufpos - buf;
 }
 
+/*
+ * Writes an option with an unsigned integer value of up to 3 bytes, with the
+ * minimal value length.
+ *
+ * Returns length of the option.
+ */
+static size_t _put_uint_option(uint8_t *buf, unsigned last_optnum,
+                               unsigned optnum, uint32_t val)
+{
+    uint8_t bytes[3];
+    unsigned len = 0;
+
+    /* big endian, leading zero bytes omitted */
+    for (int shift = 16; shift >= 0; shift -= 8) {
+        if (len || (val >> shift) & 0xFF) {
+            bytes[len++] = (val >> shift) & 0xFF;
+        }
+    }
+    return coap_put_option(buf, last_optnum, optnum, bytes, len);
+}
+
+/*
+ * Writes a Block1 or Block2 option.
+ *
+ * Returns length of the option.
+ */
+static size_t _put_block_option(uint8_t *buf, unsigned last_optnum,
+                                unsigned blockopt, const gcoap_block_t *block)
+{
+    uint32_t val = (block->num << 4) | (block->more ? 0x8 : 0) | block->szx;
+
+    return _put_uint_option(buf, last_optnum, blockopt, val);
+}
+
+/*
+ * Decodes the extended form of an option delta or length nibble.
+ *
+ * pos[in,out] -- Position of extended bytes, if any; moved past them
+ *
+ * return Decoded value, or UINT_MAX for the reserved nibble 15
+ */
+static unsigned _decode_opt_ext(uint8_t **pos, unsigned nibble)
+{
+    uint8_t *ext = *pos;
+
+    switch (nibble) {
+        case 13:
+            *pos += 1;
+            return 13 + ext[0];
+        case 14:
+            *pos += 2;
+            return 269 + ((ext[0] << 8) | ext[1]);
+        case 15:
+            return UINT_MAX;
+        default:
+            return nibble;
+    }
+}
+
+/*
+ * Parses a received PDU, like coap_parse().
+ *
+ * For a PDU without payload, also points the payload at the end of the PDU,
+ * so the options always end at pdu->payload; see _find_option().
+ */
+static int _parse(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    int res = coap_parse(pdu, buf, len);
+
+    if (res == 0 && pdu->payload_len == 0) {
+        pdu->payload = buf + len;
+    }
+    return res;
+}
+
+/*
+ * Finds the first instance of an option in a received PDU.
+ *
+ * Walks the options up to the payload marker, or up to pdu->payload for a PDU
+ * without payload, as set by _parse().
+ *
+ * value[out] -- Start of the option value
+ *
+ * return Length of the option value, -ENOENT if not found, or -EBADMSG if
+ *        the options are malformed
+ */
+static int _find_option(coap_pkt_t *pdu, unsigned optnum, uint8_t **value)
+{
+    uint8_t *pos = (uint8_t *)pdu->hdr + coap_get_total_hdr_len(pdu);
+    uint8_t *end = (pdu->payload_len) ? pdu->payload - 1 : pdu->payload;
+    unsigned last_optnum = 0;
+
+    while (pos < end) {
+        unsigned delta = *pos >> 4;
+        unsigned len   = *pos & 0xF;
+        pos++;
+
+        /* delta and length use the same extended encoding */
+        delta = _decode_opt_ext(&pos, delta);
+        len   = _decode_opt_ext(&pos, len);
+        if (delta == UINT_MAX || len == UINT_MAX) {
+            return -EBADMSG;
+        }
+
+        last_optnum += delta;
+        if (pos + len > end) {
+            return -EBADMSG;
+        }
+        if (last_optnum == optnum) {
+            *value = pos;
+            return len;
+        }
+        if (last_optnum > optnum) {
+            break;
+        }
+        pos += len;
+    }
+    return -ENOENT;
+}
+
 /*
  * Find registered observer for a remote address and port.
  *
@@ -581,6 +949,18 @@ kernel_pid_t gcoap_init(void)
     _pid = thread_create(_msg_stack, sizeof(_msg_stack), THREAD_PRIORITY_MAIN - 1,
                             THREAD_CREATE_STACKTEST, _event_loop, NULL, "coap");
 
+#ifdef MODULE_GCOAP_WORKERS
+    mbox_init(&_worker_mbox, _worker_queue, GCOAP_WORKER_QUEUE_SIZE);
+    memset(&_worker_reqs[0], 0, sizeof(_worker_reqs));
+    /* lower priority than the gcoap thread, so a handler does not delay
+     * receiving */
+    for (unsigned i = 0; i < GCOAP_WORKERS_NUMOF; i++) {
+        thread_create(_worker_stacks[i], sizeof(_worker_stacks[i]),
+                      THREAD_PRIORITY_MAIN, THREAD_CREATE_STACKTEST,
+                      _worker_loop, NULL, "coap_worker");
+    }
+#endif
+
     mutex_init(&_coap_state.lock);
     /* Blank lists so we know if an entry is available. */
     memset(&_coap_state.open_reqs[0], 0, sizeof(_coap_state.open_reqs));
@@ -615,12 +995,7 @@ int gcoap_req_init(coap_pkt_t *pdu, uint8_t *buf, size_t len, unsigned code,
     /* generate token */
 #if GCOAP_TOKENLEN
     uint8_t token[GCOAP_TOKENLEN];
-    for (size_t i = 0; i < GCOAP_TOKENLEN; i += 4) {
-        uint32_t rand = random_uint32();
-        memcpy(&token[i],
-               &rand,
-               (GCOAP_TOKENLEN - i >= 4) ? 4 : GCOAP_TOKENLEN - i);
-    }
+    random_bytes(token, GCOAP_TOKENLEN);
     uint16_t msgid = (uint16_t)atomic_fetch_add(&_coap_state.next_message_id, 1);
     ssize_t hdrlen = coap_build_hdr(pdu->hdr, COAP_TYPE_NON, &token[0], GCOAP_TOKENLEN,
                                     code, msgid);
@@ -655,7 +1030,35 @@ ssize_t gcoap_finish(coap_pkt_t *pdu, size_t payload_len, unsigned format)
 
     pdu->content_type = format;
     pdu->payload_len  = payload_len;
-    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len);
+    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len, COAP_FORMAT_NONE, 0,
+                       NULL);
+}
+
+ssize_t gcoap_finish_accept(coap_pkt_t *pdu, size_t payload_len,
+                            unsigned format, unsigned accept)
+{
+    /* reconstruct full PDU buffer length */
+    size_t len = pdu->payload_len + (pdu->payload - (uint8_t *)pdu->hdr);
+
+    pdu->content_type = format;
+    pdu->payload_len  = payload_len;
+    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len, accept, 0, NULL);
+}
+
+ssize_t gcoap_finish_block(coap_pkt_t *pdu, size_t payload_len,
+                           unsigned format, unsigned blockopt,
+                           const gcoap_block_t *block)
+{
+    assert((blockopt == COAP_OPT_BLOCK1) || (blockopt == COAP_OPT_BLOCK2));
+    assert(block->szx <= 6);
+
+    /* reconstruct full PDU buffer length */
+    size_t len = pdu->payload_len + (pdu->payload - (uint8_t *)pdu->hdr);
+
+    pdu->content_type = format;
+    pdu->payload_len  = payload_len;
+    return _finish_pdu(pdu, (uint8_t *)pdu->hdr, len, COAP_FORMAT_NONE,
+                       blockopt, block);
 }
 
 size_t gcoap_req_send(const uint8_t *buf, size_t len, const ipv6_addr_t *addr,
@@ -792,6 +1195,114 @@ size_t gcoap_obs_send(const uint8_t *buf, size_t len,
     }
 }
 
+int gcoap_get_block(coap_pkt_t *pdu, unsigned blockopt, gcoap_block_t *block)
+{
+    uint8_t *value;
+    int len = _find_option(pdu, blockopt, &value);
+
+    block->num  = 0;
+    block->szx  = GCOAP_BLOCK_SZX_MAX;
+    block->more = 0;
+
+    if (len == -ENOENT) {
+        return 0;
+    }
+    else if (len < 0 || len > 3) {
+        return -EBADMSG;
+    }
+
+    uint32_t val = 0;
+    for (int i = 0; i < len; i++) {
+        val = (val << 8) | value[i];
+    }
+    /* SZX 7 is reserved */
+    if ((val & 0x7) == 7) {
+        return -EBADMSG;
+    }
+    block->num  = val >> 4;
+    block->szx  = val & 0x7;
+    block->more = (val & 0x8) ? 1 : 0;
+    return 1;
+}
+
+ssize_t gcoap_block2_response(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned format, gcoap_block_writer_t writer,
+                              void *arg)
+{
+    gcoap_block_t block;
+    int has_block = gcoap_get_block(pdu, COAP_OPT_BLOCK2, &block);
+
+    if (has_block < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+    size_t offset = gcoap_block_offset(&block);
+
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    /* negotiate down to our limit and to the space left in the buffer; keep
+     * one byte to detect if more data follows the block */
+    while (block.szx > 0 && (block.szx > GCOAP_BLOCK_SZX_MAX
+                             || gcoap_block_size(&block) >= pdu->payload_len)) {
+        block.szx--;
+    }
+    if (gcoap_block_size(&block) >= pdu->payload_len) {
+        DEBUG("gcoap: no space for a block\n");
+        return -ENOSPC;
+    }
+    block.num = offset >> (block.szx + 4);
+
+    ssize_t plen = writer(offset, pdu->payload, gcoap_block_size(&block) + 1, arg);
+    if (plen < 0) {
+        return plen;
+    }
+    if (plen == 0 && offset > 0) {
+        DEBUG("gcoap: block %" PRIu32 " out of range\n", block.num);
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+
+    block.more = ((size_t)plen > gcoap_block_size(&block)) ? 1 : 0;
+    if (block.more) {
+        plen = gcoap_block_size(&block);
+    }
+    if (!has_block && !block.more) {
+        /* whole representation fits; no need for block-wise transfer */
+        return gcoap_finish(pdu, plen, format);
+    }
+    return gcoap_finish_block(pdu, plen, format, COAP_OPT_BLOCK2, &block);
+}
+
+ssize_t gcoap_block1_response(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              unsigned code, gcoap_block_reader_t reader,
+                              void *arg)
+{
+    gcoap_block_t block;
+    int has_block = gcoap_get_block(pdu, COAP_OPT_BLOCK1, &block);
+
+    if (has_block < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_BAD_OPTION);
+    }
+
+    int res = reader(gcoap_block_offset(&block), pdu->payload,
+                     pdu->payload_len, block.more, arg);
+    if (res == -EFBIG) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
+    }
+    else if (res < 0) {
+        return gcoap_response(pdu, buf, len, COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+    }
+
+    if (!has_block) {
+        return gcoap_response(pdu, buf, len, code);
+    }
+
+    /* echo the block received, proposing our limit for the next ones; see
+     * RFC 7959, sec. 2.3 */
+    if (block.szx > GCOAP_BLOCK_SZX_MAX) {
+        block.szx = GCOAP_BLOCK_SZX_MAX;
+    }
+    gcoap_resp_init(pdu, buf, len, block.more ? COAP_CODE_CONTINUE : code);
+    return gcoap_finish_block(pdu, 0, COAP_FORMAT_NONE, COAP_OPT_BLOCK1, &block);
+}
+
 uint8_t gcoap_op_state(void)
 {
     uint8_t count = 0;
@@ -872,4 +1383,269 @@ int gcoap_add_qstring(coap_pkt_t *pdu, const char *key, const char *val)
     return (int)qs_len;
 }
 
+#ifdef MODULE_GCOAP_HEATSHRINK
+/* Encoder and decoder state, and a buffer to compress a PDU payload in */
+typedef struct {
+    mutex_t lock;
+    heatshrink_encoder encoder;
+    heatshrink_decoder decoder;
+    uint8_t buf[GCOAP_HEATSHRINK_BUF_SIZE];
+} _hs_state_t;
+
+static _hs_state_t _hs_pool[GCOAP_HEATSHRINK_POOL_SIZE];
+
+static _hs_state_t *_hs_acquire(void)
+{
+    for (unsigned i = 0; i < GCOAP_HEATSHRINK_POOL_SIZE; i++) {
+        if (mutex_trylock(&_hs_pool[i].lock)) {
+            return &_hs_pool[i];
+        }
+    }
+    /* all in use; wait for one */
+    _hs_state_t *hs = &_hs_pool[thread_getpid() % GCOAP_HEATSHRINK_POOL_SIZE];
+    mutex_lock(&hs->lock);
+    return hs;
+}
+
+/*
+ * Makes room for encoder or decoder output.
+ *
+ * When the output buffer is full, the encoder and decoder cannot tell if they
+ * are done, so @p spare provides a byte to check that nothing is left.
+ *
+ * return Space for the output, or NULL if the output buffer is full
+ */
+static uint8_t *_hs_room(uint8_t *out, size_t pos, size_t out_len,
+                         size_t *room, uint8_t *spare)
+{
+    if (pos < out_len) {
+        *room = out_len - pos;
+        return out + pos;
+    }
+    *room = 1;
+    return spare;
+}
+
+/*
+ * Polls the encoder until it needs more input.
+ *
+ * return 0 on success, or -ENOBUFS if the output does not fit
+ */
+static int _hs_poll_encoder(heatshrink_encoder *hse, uint8_t *out,
+                            size_t out_len, size_t *pos)
+{
+    HSE_poll_res res;
+
+    do {
+        size_t room, n = 0;
+        uint8_t spare;
+        uint8_t *dst = _hs_room(out, *pos, out_len, &room, &spare);
+
+        res = heatshrink_encoder_poll(hse, dst, room, &n);
+        if (res < 0) {
+            return -EINVAL;
+        }
+        if (dst == &spare) {
+            if (n) {
+                return -ENOBUFS;
+            }
+        }
+        else {
+            *pos += n;
+        }
+    } while (res == HSER_POLL_MORE);
+    return 0;
+}
+
+static ssize_t _hs_compress(heatshrink_encoder *hse, const uint8_t *in,
+                            size_t len, uint8_t *out, size_t out_len)
+{
+    size_t done = 0, pos = 0;
+    int res;
+
+    heatshrink_encoder_reset(hse);
+    while (done < len) {
+        size_t n = 0;
+
+        if (heatshrink_encoder_sink(hse, (uint8_t *)&in[done], len - done,
+                                    &n) < 0) {
+            return -EINVAL;
+        }
+        done += n;
+        if ((res = _hs_poll_encoder(hse, out, out_len, &pos)) < 0) {
+            return res;
+        }
+    }
+    while (heatshrink_encoder_finish(hse) == HSER_FINISH_MORE) {
+        if ((res = _hs_poll_encoder(hse, out, out_len, &pos)) < 0) {
+            return res;
+        }
+    }
+    return pos;
+}
+
+/*
+ * Polls the decoder until it needs more input.
+ *
+ * return Number of bytes written, or -ENOBUFS if the output does not fit
+ */
+static ssize_t _hs_poll_decoder(heatshrink_decoder *hsd, uint8_t *out,
+                                size_t out_len, size_t *pos)
+{
+    size_t start = *pos;
+    HSD_poll_res res;
+
+    do {
+        size_t room, n = 0;
+        uint8_t spare;
+        uint8_t *dst = _hs_room(out, *pos, out_len, &room, &spare);
+
+        res = heatshrink_decoder_poll(hsd, dst, room, &n);
+        if (res < 0) {
+            return -EINVAL;
+        }
+        if (dst == &spare) {
+            if (n) {
+                return -ENOBUFS;
+            }
+        }
+        else {
+            *pos += n;
+        }
+    } while (res == HSDR_POLL_MORE);
+    return *pos - start;
+}
+
+static ssize_t _hs_uncompress(heatshrink_decoder *hsd, const uint8_t *in,
+                              size_t len, uint8_t *out, size_t out_len)
+{
+    size_t done = 0, pos = 0;
+    ssize_t res;
+
+    heatshrink_decoder_reset(hsd);
+    while (done < len) {
+        size_t n = 0;
+
+        if (heatshrink_decoder_sink(hsd, (uint8_t *)&in[done], len - done,
+                                    &n) < 0) {
+            return -EINVAL;
+        }
+        done += n;
+        if ((res = _hs_poll_decoder(hsd, out, out_len, &pos)) < 0) {
+            return res;
+        }
+    }
+    while (heatshrink_decoder_finish(hsd) == HSDR_FINISH_MORE) {
+        if ((res = _hs_poll_decoder(hsd, out, out_len, &pos)) < 0) {
+            return res;
+        }
+        if (res == 0) {
+            /* truncated input; the decoder makes no progress */
+            return -EBADMSG;
+        }
+    }
+    return pos;
+}
+
+ssize_t gcoap_heatshrink_compress(const void *in, size_t len, void *out,
+                                  size_t out_len)
+{
+    _hs_state_t *hs = _hs_acquire();
+    ssize_t res = _hs_compress(&hs->encoder, in, len, out, out_len);
+
+    mutex_unlock(&hs->lock);
+    return res;
+}
+
+ssize_t gcoap_heatshrink_uncompress(const void *in, size_t len, void *out,
+                                    size_t out_len)
+{
+    _hs_state_t *hs = _hs_acquire();
+    ssize_t res = _hs_uncompress(&hs->decoder, in, len, out, out_len);
+
+    mutex_unlock(&hs->lock);
+    return res;
+}
+
+ssize_t gcoap_finish_compressed(coap_pkt_t *pdu, size_t payload_len,
+                                unsigned format)
+{
+    if ((payload_len < GCOAP_HEATSHRINK_MIN)
+            || (payload_len > GCOAP_HEATSHRINK_BUF_SIZE)) {
+        return gcoap_finish(pdu, payload_len, format);
+    }
+
+    _hs_state_t *hs = _hs_acquire();
+    /* original format, then the compressed data, shorter than the payload */
+    ssize_t res = _hs_compress(&hs->encoder, pdu->payload, payload_len,
+                               &hs->buf[2], payload_len - 3);
+    if (res >= 0) {
+        hs->buf[0] = format >> 8;
+        hs->buf[1] = format & 0xFF;
+        payload_len = res + 2;
+        memcpy(pdu->payload, hs->buf, payload_len);
+        format = GCOAP_FORMAT_HEATSHRINK;
+    }
+    mutex_unlock(&hs->lock);
+    DEBUG("gcoap: compressed payload: %i\n", (int)res);
+
+    return gcoap_finish(pdu, payload_len, format);
+}
+
+/*
+ * Reads an option with an unsigned integer value of up to 2 bytes.
+ *
+ * return Value of the option, @p dflt if not present, or -EBADMSG
+ */
+static int _get_uint16_option(coap_pkt_t *pdu, unsigned optnum, int dflt)
+{
+    uint8_t *value;
+    int len = _find_option(pdu, optnum, &value);
+
+    if (len == -ENOENT) {
+        return dflt;
+    }
+    else if (len < 0 || len > 2) {
+        return -EBADMSG;
+    }
+
+    int val = 0;
+    for (int i = 0; i < len; i++) {
+        val = (val << 8) | value[i];
+    }
+    return val;
+}
+
+bool gcoap_accepts_compressed(coap_pkt_t *pdu)
+{
+    return _get_uint16_option(pdu, COAP_OPT_ACCEPT, COAP_FORMAT_NONE)
+                == GCOAP_FORMAT_HEATSHRINK;
+}
+
+ssize_t gcoap_get_payload(coap_pkt_t *pdu, void *buf, size_t len,
+                          unsigned *format)
+{
+    int ct = _get_uint16_option(pdu, COAP_OPT_CONTENT_FORMAT,
+                                COAP_FORMAT_NONE);
+
+    if (ct < 0) {
+        return ct;
+    }
+    if (ct != GCOAP_FORMAT_HEATSHRINK) {
+        if (pdu->payload_len > len) {
+            return -ENOBUFS;
+        }
+        memcpy(buf, pdu->payload, pdu->payload_len);
+        *format = ct;
+        return pdu->payload_len;
+    }
+    if (pdu->payload_len < 2) {
+        return -EBADMSG;
+    }
+    *format = (pdu->payload[0] << 8) | pdu->payload[1];
+    return gcoap_heatshrink_uncompress(pdu->payload + 2, pdu->payload_len - 2,
+                                       buf, len);
+}
+#endif /* MODULE_GCOAP_HEATSHRINK */
+
 /** @} */
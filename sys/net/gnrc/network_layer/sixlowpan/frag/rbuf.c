@@ -22,6 +22,7 @@
 #include "net/gnrc/sixlowpan.h"
 #include "net/gnrc/sixlowpan/frag.h"
 #include "net/sixlowpan.h"
+#include "objpool.h"
 #include "thread.h"
 #include "xtimer.h"
 #include "utlist.h"
@@ -42,7 +43,8 @@
 #define RBUF_INT_SIZE (DIV_CEIL(GNRC_IPV6_NETIF_DEFAULT_MTU, GNRC_SIXLOWPAN_FRAG_SIZE) * RBUF_SIZE)
 #endif
 
-static rbuf_int_t rbuf_int[RBUF_INT_SIZE];
+/* only accessed from the 6LoWPAN thread */
+OBJPOOL_DEFINE(rbuf_int, rbuf_int_t, RBUF_INT_SIZE, OBJPOOL_UNLOCKED);
 
 static rbuf_t rbuf[RBUF_SIZE];
 
@@ -55,8 +57,6 @@ static char l2addr_str[3 * RBUF_L2ADDR_MAX_LEN];
  * ------------------------------------*/
 /* checks whether start and end overlaps, but not identical to, given interval i */
 static inline bool _rbuf_int_overlap_partially(rbuf_int_t *i, uint16_t start, uint16_t end);
-/* gets a free entry from interval buffer */
-static rbuf_int_t *_rbuf_int_get_free(void);
 /* remove entry from reassembly buffer */
 static void _rbuf_rem(rbuf_t *entry);
 /* update interval buffer of entry */
@@ -196,25 +196,12 @@ static inline bool _rbuf_int_overlap_partially(rbuf_int_t *i, uint16_t start, ui
         ((start != i->start) || (end != i->end)); /* not identical */
 }
 
-static rbuf_int_t *_rbuf_int_get_free(void)
-{
-    for (unsigned int i = 0; i < RBUF_INT_SIZE; i++) {
-        if (rbuf_int[i].end == 0) { /* start must be smaller than end anyways*/
-            return rbuf_int + i;
-        }
-    }
-
-    return NULL;
-}
-
 static void _rbuf_rem(rbuf_t *entry)
 {
     while (entry->ints != NULL) {
         rbuf_int_t *next = entry->ints->next;
 
-        entry->ints->start = 0;
-        entry->ints->end = 0;
-        entry->ints->next = NULL;
+        objpool_free(&rbuf_int, entry->ints);
         entry->ints = next;
     }
 
@@ -226,7 +213,7 @@ static bool _rbuf_update_ints(rbuf_t *entry, uint16_t offset, size_t frag_size)
     rbuf_int_t *new;
     uint16_t end = (uint16_t)(offset + frag_size - 1);
 
-    new = _rbuf_int_get_free();
+    new = objpool_alloc(&rbuf_int);
 
     if (new == NULL) {
         DEBUG("6lo rfrag: no space left in rbuf interval buffer.\n");
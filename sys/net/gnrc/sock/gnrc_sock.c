@@ -19,6 +19,7 @@
 #include "net/ipv6/hdr.h"
 #include "net/gnrc/ipv6/hdr.h"
 #include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/sock.h"
 #include "net/gnrc/netreg.h"
 #include "net/udp.h"
 #include "utlist.h"
@@ -44,10 +45,41 @@ static void _callback_put(void *arg)
 }
 #endif
 
+#ifdef MODULE_GNRC_SOCK_ASYNC
+static void _netreg_cb(uint16_t cmd, gnrc_pktsnip_t *pkt, void *ctx)
+{
+    gnrc_sock_reg_t *reg = ctx;
+    msg_t msg = { .type = cmd, .content = { .ptr = pkt } };
+
+    if ((cmd != GNRC_NETAPI_MSG_TYPE_RCV) || !mbox_try_put(&reg->mbox, &msg)) {
+        /* netapi leaves packets passed to callbacks to the callee */
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (reg->async_notify != NULL) {
+        reg->async_notify(reg);
+    }
+    if (reg->async_pid != KERNEL_PID_UNDEF) {
+        msg_t notify = { .type = GNRC_SOCK_MSG_TYPE_RECV,
+                         .content = { .ptr = reg } };
+
+        msg_try_send(&notify, reg->async_pid);
+    }
+}
+#endif
+
 void gnrc_sock_create(gnrc_sock_reg_t *reg, gnrc_nettype_t type, uint32_t demux_ctx)
 {
     mbox_init(&reg->mbox, reg->mbox_queue, SOCK_MBOX_SIZE);
+#ifdef MODULE_GNRC_SOCK_ASYNC
+    reg->async_notify = NULL;
+    reg->async_pid = KERNEL_PID_UNDEF;
+    reg->netreg_cb.cb = _netreg_cb;
+    reg->netreg_cb.ctx = reg;
+    gnrc_netreg_entry_init_cb(&reg->entry, demux_ctx, &reg->netreg_cb);
+#else
     gnrc_netreg_entry_init_mbox(&reg->entry, demux_ctx, &reg->mbox);
+#endif
     gnrc_netreg_register(type, &reg->entry);
 }
 
@@ -57,7 +89,9 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt_out,
     gnrc_pktsnip_t *pkt, *ip, *netif;
     msg_t msg;
 
-    if (reg->mbox.cib.mask != (SOCK_MBOX_SIZE - 1)) {
+    /* queue size may be changed per sock, but is always a power of two */
+    if ((reg->mbox.msg_array == NULL) ||
+        ((reg->mbox.cib.mask + 1) & reg->mbox.cib.mask)) {
         return -EINVAL;
     }
 #ifdef MODULE_XTIMER
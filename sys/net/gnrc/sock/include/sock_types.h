@@ -51,6 +51,14 @@ typedef struct gnrc_sock_reg {
     gnrc_netreg_entry_t entry;          /**< @ref net_gnrc_netreg entry for mbox */
     mbox_t mbox;                        /**< @ref core_mbox target for the sock */
     msg_t mbox_queue[SOCK_MBOX_SIZE];   /**< queue for gnrc_sock_reg_t::mbox */
+#ifdef MODULE_GNRC_SOCK_ASYNC
+    gnrc_netreg_entry_cbd_t netreg_cb;  /**< netreg callback filling gnrc_sock_reg_t::mbox */
+    /**
+     * @brief   Called by the stack when a packet was queued for the sock
+     */
+    void (*async_notify)(struct gnrc_sock_reg *reg);
+    kernel_pid_t async_pid;             /**< thread to notify on new packets */
+#endif
 } gnrc_sock_reg_t;
 
 /**
@@ -62,6 +70,10 @@ struct sock_ip {
     sock_ip_ep_t local;                 /**< local end-point */
     sock_ip_ep_t remote;                /**< remote end-point */
     uint16_t flags;                     /**< option flags */
+#ifdef MODULE_GNRC_SOCK_ASYNC
+    void (*async_cb)(sock_ip_t *sock, void *arg);   /**< receive callback */
+    void *async_cb_arg;                 /**< argument for sock_ip::async_cb */
+#endif
 };
 
 /**
@@ -73,6 +85,10 @@ struct sock_udp {
     sock_udp_ep_t local;                /**< local end-point */
     sock_udp_ep_t remote;               /**< remote end-point */
     uint16_t flags;                     /**< option flags */
+#ifdef MODULE_GNRC_SOCK_ASYNC
+    void (*async_cb)(sock_udp_t *sock, void *arg);  /**< receive callback */
+    void *async_cb_arg;                 /**< argument for sock_udp::async_cb */
+#endif
 };
 
 #ifdef __cplusplus
@@ -18,9 +18,11 @@
 #include <errno.h>
 
 #include "byteorder.h"
+#include "irq.h"
 #include "net/af.h"
 #include "net/protnum.h"
 #include "net/gnrc/ipv6.h"
+#include "net/gnrc/sock.h"
 #include "net/sock/ip.h"
 #include "random.h"
 
@@ -65,6 +67,38 @@ void sock_ip_close(sock_ip_t *sock)
     gnrc_netreg_unregister(GNRC_NETTYPE_IPV6, &sock->reg.entry);
 }
 
+unsigned gnrc_sock_ip_avail(sock_ip_t *sock)
+{
+    assert(sock != NULL);
+    return cib_avail(&sock->reg.mbox.cib);
+}
+
+#ifdef MODULE_GNRC_SOCK_ASYNC
+static void _async_notify(gnrc_sock_reg_t *reg)
+{
+    sock_ip_t *sock = (sock_ip_t *)reg;
+
+    sock->async_cb(sock, sock->async_cb_arg);
+}
+
+void gnrc_sock_ip_set_cb(sock_ip_t *sock, gnrc_sock_ip_cb_t cb, void *arg)
+{
+    assert(sock != NULL);
+    /* the stack may call the hook from another thread */
+    unsigned state = irq_disable();
+    sock->async_cb = cb;
+    sock->async_cb_arg = arg;
+    sock->reg.async_notify = (cb != NULL) ? _async_notify : NULL;
+    irq_restore(state);
+}
+
+void gnrc_sock_ip_set_notify(sock_ip_t *sock, kernel_pid_t pid)
+{
+    assert(sock != NULL);
+    sock->reg.async_pid = pid;
+}
+#endif
+
 int sock_ip_get_local(sock_ip_t *sock, sock_ip_ep_t *local)
 {
     assert(sock && local);
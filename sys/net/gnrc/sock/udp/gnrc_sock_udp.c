@@ -18,9 +18,11 @@
 #include <errno.h>
 
 #include "byteorder.h"
+#include "irq.h"
 #include "net/af.h"
 #include "net/protnum.h"
 #include "net/gnrc/ipv6.h"
+#include "net/gnrc/sock.h"
 #include "net/gnrc/udp.h"
 #include "net/sock/udp.h"
 #include "net/udp.h"
@@ -165,15 +167,19 @@ int sock_udp_get_remote(sock_udp_t *sock, sock_udp_ep_t *remote)
     return 0;
 }
 
-ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
-                      uint32_t timeout, sock_udp_ep_t *remote)
+/**
+ * @brief   Receives a UDP packet and checks it against the remote of @p sock
+ *
+ * On success, @p pkt_out points to the UDP payload snip.
+ */
+static ssize_t _recv_pkt(sock_udp_t *sock, gnrc_pktsnip_t **pkt_out,
+                         uint32_t timeout, sock_udp_ep_t *remote)
 {
     gnrc_pktsnip_t *pkt, *udp;
     udp_hdr_t *hdr;
     sock_ip_ep_t tmp;
     int res;
 
-    assert((sock != NULL) && (data != NULL) && (max_len > 0));
     if (sock->local.family == AF_UNSPEC) {
         return -EADDRNOTAVAIL;
     }
@@ -182,10 +188,6 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
     if (res < 0) {
         return res;
     }
-    if (pkt->size > max_len) {
-        gnrc_pktbuf_release(pkt);
-        return -ENOBUFS;
-    }
     udp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
     assert(udp);
     hdr = udp->data;
@@ -204,11 +206,139 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
         gnrc_pktbuf_release(pkt);
         return -EPROTO;
     }
+    *pkt_out = pkt;
+    return (ssize_t)pkt->size;
+}
+
+ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
+                      uint32_t timeout, sock_udp_ep_t *remote)
+{
+    gnrc_pktsnip_t *pkt;
+    ssize_t res;
+
+    assert((sock != NULL) && (data != NULL) && (max_len > 0));
+    res = _recv_pkt(sock, &pkt, timeout, remote);
+    if (res < 0) {
+        return res;
+    }
+    if (pkt->size > max_len) {
+        gnrc_pktbuf_release(pkt);
+        return -ENOBUFS;
+    }
     memcpy(data, pkt->data, pkt->size);
     gnrc_pktbuf_release(pkt);
-    return (int)pkt->size;
+    return res;
+}
+
+int sock_udp_recv_many(sock_udp_t *sock, sock_udp_msg_t *msgs,
+                       unsigned msgs_len, uint32_t timeout)
+{
+    unsigned count = 0;
+
+    assert((sock != NULL) && (msgs != NULL) && (msgs_len > 0));
+    while (count < msgs_len) {
+        sock_udp_msg_t *msg = &msgs[count];
+        /* only wait for the first message */
+        ssize_t res = sock_udp_recv(sock, msg->data, msg->len,
+                                    (count == 0) ? timeout : 0, &msg->remote);
+
+        if (res >= 0) {
+            msg->len = res;
+            count++;
+        }
+        else if (count == 0) {
+            return res;
+        }
+        else if ((res != -ENOBUFS) && (res != -EPROTO)) {
+            /* queue drained; dropped messages above are skipped */
+            break;
+        }
+    }
+    return count;
+}
+
+ssize_t gnrc_sock_udp_recv_pkt(sock_udp_t *sock, gnrc_pktsnip_t **pkt,
+                               uint32_t timeout, sock_udp_ep_t *remote)
+{
+    assert((sock != NULL) && (pkt != NULL));
+    return _recv_pkt(sock, pkt, timeout, remote);
+}
+
+int gnrc_sock_udp_set_queue(sock_udp_t *sock, msg_t *queue,
+                            unsigned queue_size)
+{
+    mbox_t old;
+    msg_t msg;
+
+    assert((sock != NULL) && (queue != NULL));
+    if (sock->local.family == AF_UNSPEC) {
+        return -EADDRNOTAVAIL;
+    }
+    /* the stack may put a packet into the mbox from another thread, so swap
+     * the queues atomically */
+    unsigned state = irq_disable();
+    /* threads blocked on the old mbox would never be woken up */
+    if ((sock->reg.mbox.readers.next != NULL) ||
+        (sock->reg.mbox.writers.next != NULL)) {
+        irq_restore(state);
+        return -EBUSY;
+    }
+    old = sock->reg.mbox;
+    mbox_init(&sock->reg.mbox, queue, queue_size);
+    irq_restore(state);
+    /* releasing takes the packet buffer's mutex, so it must not happen with
+     * interrupts disabled */
+    while (mbox_try_get(&old, &msg)) {
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_RCV) {
+            gnrc_pktbuf_release(msg.content.ptr);
+        }
+    }
+    return 0;
 }
 
+unsigned gnrc_sock_udp_avail(sock_udp_t *sock)
+{
+    assert(sock != NULL);
+    if (sock->local.family == AF_UNSPEC) {
+        return 0;
+    }
+    return cib_avail(&sock->reg.mbox.cib);
+}
+
+#ifdef MODULE_GNRC_SOCK_ASYNC
+static void _async_notify(gnrc_sock_reg_t *reg)
+{
+    sock_udp_t *sock = (sock_udp_t *)reg;
+
+    sock->async_cb(sock, sock->async_cb_arg);
+}
+
+int gnrc_sock_udp_set_cb(sock_udp_t *sock, gnrc_sock_udp_cb_t cb, void *arg)
+{
+    assert(sock != NULL);
+    if (sock->local.family == AF_UNSPEC) {
+        return -EADDRNOTAVAIL;
+    }
+    /* the stack may call the hook from another thread */
+    unsigned state = irq_disable();
+    sock->async_cb = cb;
+    sock->async_cb_arg = arg;
+    sock->reg.async_notify = (cb != NULL) ? _async_notify : NULL;
+    irq_restore(state);
+    return 0;
+}
+
+int gnrc_sock_udp_set_notify(sock_udp_t *sock, kernel_pid_t pid)
+{
+    assert(sock != NULL);
+    if (sock->local.family == AF_UNSPEC) {
+        return -EADDRNOTAVAIL;
+    }
+    sock->reg.async_pid = pid;
+    return 0;
+}
+#endif
+
 ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
                       const sock_udp_ep_t *remote)
 {
@@ -304,4 +434,23 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
     return res;
 }
 
+int sock_udp_send_many(sock_udp_t *sock, const sock_udp_msg_t *msgs,
+                       unsigned msgs_len)
+{
+    unsigned count;
+
+    assert((sock != NULL) && (msgs != NULL));
+    for (count = 0; count < msgs_len; count++) {
+        const sock_udp_msg_t *msg = &msgs[count];
+        const sock_udp_ep_t *remote = (msg->remote.family == AF_UNSPEC) ?
+                                      NULL : &msg->remote;
+        ssize_t res = sock_udp_send(sock, msg->data, msg->len, remote);
+
+        if (res < 0) {
+            return (count == 0) ? res : (int)count;
+        }
+    }
+    return count;
+}
+
 /** @} */
@@ -57,7 +57,9 @@ extern "C" {
  */
 #define TCP_EVENTLOOP_MSG_QUEUE_SIZE (8U)
 #define TCP_EVENTLOOP_PRIO           (THREAD_PRIORITY_MAIN - 2U)
+#ifndef TCP_EVENTLOOP_STACK_SIZE
 #define TCP_EVENTLOOP_STACK_SIZE     (THREAD_STACKSIZE_DEFAULT)
+#endif
 /** @} */
 
 /**
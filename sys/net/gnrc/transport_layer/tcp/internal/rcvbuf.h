@@ -23,7 +23,6 @@
 #define RCVBUF_H
 
 #include <stdint.h>
-#include "mutex.h"
 #include "net/gnrc/tcp/config.h"
 #include "net/gnrc/tcp/tcb.h"
 
@@ -31,27 +30,6 @@
 extern "C" {
 #endif
 
-/**
- * @brief Receive buffer entry.
- */
-typedef struct rcvbuf_entry {
-    uint8_t used;                          /**< Flag: Is buffer in use? */
-    uint8_t buffer[GNRC_TCP_RCV_BUF_SIZE]; /**< Receive buffer storage */
-} rcvbuf_entry_t;
-
-/**
- * @brief   Stuct holding receive buffers.
- */
-typedef struct rcvbuf {
-    mutex_t lock;                                 /**< Lock for allocation synchronization */
-    rcvbuf_entry_t entries[GNRC_TCP_RCV_BUFFERS]; /**< Maintained receive buffers */
-} rcvbuf_t;
-
-/**
- * @brief   Initializes global receive buffer.
- */
-void _rcvbuf_init(void);
-
 /**
  * @brief Allocate receive buffer and assign it to TCB.
  *
@@ -65,7 +65,8 @@ static inline uint32_t choose_backoff_period(int be,
     }
     uint32_t max_backoff = ((1 << be) - 1) * CSMA_SENDER_BACKOFF_PERIOD_UNIT;
 
-    uint32_t period = random_uint32() % max_backoff;
+    /* a backoff exponent of 0 leaves nothing to choose from */
+    uint32_t period = max_backoff ? random_uint32_range(0, max_backoff) : 0;
     if (period < CSMA_SENDER_BACKOFF_PERIOD_UNIT) {
         period = CSMA_SENDER_BACKOFF_PERIOD_UNIT;
     }
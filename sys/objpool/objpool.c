@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_objpool
+ * @{
+ *
+ * @file
+ * @brief       Object pool implementation
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "assert.h"
+#include "irq.h"
+#include "objpool.h"
+
+/* lock-free free list head: index + 1 of the first free object in the lower,
+ * a tag that changes with every update in the upper 16 bit */
+#define HEAD_INDEX_MASK     (0xffffU)
+#define HEAD_TAG_INC        (0x10000U)
+
+static objpool_t *_pools;
+
+static void _list(objpool_t *pool)
+{
+    unsigned state = irq_disable();
+
+    if (!pool->listed) {
+        pool->listed = 1;
+        pool->next = _pools;
+        _pools = pool;
+    }
+    irq_restore(state);
+}
+
+void objpool_init(objpool_t *pool, const char *name, void *buf, size_t size,
+                  unsigned num, unsigned mode)
+{
+    assert((size >= sizeof(uintptr_t)) && (size <= UINT16_MAX));
+    assert((num <= UINT16_MAX) && (((uintptr_t)buf % sizeof(uintptr_t)) == 0));
+
+    pool->next = NULL;
+    pool->name = name;
+    pool->buf = buf;
+    pool->free = 0;
+    pool->fresh = 0;
+    pool->size = size;
+    pool->num = num;
+    pool->used = 0;
+    pool->max_used = 0;
+    pool->failed = 0;
+    pool->mode = mode;
+    pool->listed = 0;
+}
+
+static void _count_alloc(objpool_t *pool)
+{
+    if (++pool->used > pool->max_used) {
+        pool->max_used = pool->used;
+    }
+}
+
+static void _count_failed(objpool_t *pool)
+{
+    if (pool->failed < UINT16_MAX) {
+        pool->failed++;
+    }
+}
+
+static void *_alloc(objpool_t *pool)
+{
+    uintptr_t *obj = (uintptr_t *)pool->free;
+
+    if (obj) {
+        pool->free = *obj;
+    }
+    else if (pool->fresh < pool->num) {
+        obj = (uintptr_t *)(pool->buf + pool->fresh++ * pool->size);
+    }
+    else {
+        _count_failed(pool);
+        return NULL;
+    }
+    _count_alloc(pool);
+    return obj;
+}
+
+static void _free(objpool_t *pool, void *obj)
+{
+    *(uintptr_t *)obj = pool->free;
+    pool->free = (uintptr_t)obj;
+    pool->used--;
+}
+
+static void *_alloc_lockfree(objpool_t *pool)
+{
+    uintptr_t head = __atomic_load_n(&pool->free, __ATOMIC_ACQUIRE);
+    uint8_t *obj = NULL;
+
+    while (head & HEAD_INDEX_MASK) {
+        obj = pool->buf + ((head & HEAD_INDEX_MASK) - 1) * pool->size;
+        /* the object may be allocated and changed meanwhile, the tag makes
+         * the exchange fail then */
+        uintptr_t next = __atomic_load_n((uintptr_t *)obj, __ATOMIC_RELAXED);
+        uintptr_t new_head = ((head & ~(uintptr_t)HEAD_INDEX_MASK) + HEAD_TAG_INC)
+                             | (next & HEAD_INDEX_MASK);
+        if (__atomic_compare_exchange_n(&pool->free, &head, new_head, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        obj = NULL;
+    }
+    if (!obj) {
+        unsigned fresh = __atomic_fetch_add(&pool->fresh, 1, __ATOMIC_RELAXED);
+        if (fresh >= pool->num) {
+            /* keep pool->fresh from wrapping around */
+            __atomic_store_n(&pool->fresh, pool->num, __ATOMIC_RELAXED);
+            uint16_t failed = __atomic_load_n(&pool->failed, __ATOMIC_RELAXED);
+            while ((failed < UINT16_MAX) &&
+                   !__atomic_compare_exchange_n(&pool->failed, &failed,
+                                                failed + 1, 0,
+                                                __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED)) {}
+            return NULL;
+        }
+        obj = pool->buf + fresh * pool->size;
+    }
+
+    uint16_t used = __atomic_add_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+    uint16_t max_used = __atomic_load_n(&pool->max_used, __ATOMIC_RELAXED);
+    while ((used > max_used) &&
+           !__atomic_compare_exchange_n(&pool->max_used, &max_used, used, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    return obj;
+}
+
+static void _free_lockfree(objpool_t *pool, void *obj)
+{
+    uintptr_t index = ((uint8_t *)obj - pool->buf) / pool->size + 1;
+    uintptr_t head = __atomic_load_n(&pool->free, __ATOMIC_RELAXED);
+    uintptr_t new_head;
+
+    do {
+        __atomic_store_n((uintptr_t *)obj, head & HEAD_INDEX_MASK,
+                         __ATOMIC_RELAXED);
+        new_head = ((head & ~(uintptr_t)HEAD_INDEX_MASK) + HEAD_TAG_INC) | index;
+    } while (!__atomic_compare_exchange_n(&pool->free, &head, new_head, 0,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_sub_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+}
+
+void *objpool_alloc(objpool_t *pool)
+{
+    void *obj;
+
+    if (!pool->listed) {
+        _list(pool);
+    }
+
+    switch (pool->mode) {
+        case OBJPOOL_IRQSAFE: {
+            unsigned state = irq_disable();
+            obj = _alloc(pool);
+            irq_restore(state);
+            break;
+        }
+        case OBJPOOL_LOCKFREE:
+            obj = _alloc_lockfree(pool);
+            break;
+        default:
+            obj = _alloc(pool);
+            break;
+    }
+    return obj;
+}
+
+void objpool_free(objpool_t *pool, void *obj)
+{
+    if (obj == NULL) {
+        return;
+    }
+    assert(((uint8_t *)obj >= pool->buf) &&
+           ((uint8_t *)obj < pool->buf + pool->num * pool->size) &&
+           ((((uint8_t *)obj - pool->buf) % pool->size) == 0));
+
+    switch (pool->mode) {
+        case OBJPOOL_IRQSAFE: {
+            unsigned state = irq_disable();
+            _free(pool, obj);
+            irq_restore(state);
+            break;
+        }
+        case OBJPOOL_LOCKFREE:
+            _free_lockfree(pool, obj);
+            break;
+        default:
+            _free(pool, obj);
+            break;
+    }
+}
+
+void objpool_print(void)
+{
+    printf("%-16s %6s %5s %5s %5s %6s\n",
+           "pool", "size", "num", "used", "max", "failed");
+    for (objpool_t *pool = _pools; pool; pool = pool->next) {
+        printf("%-16s %6u %5u %5u %5u %6u\n", pool->name,
+               (unsigned)pool->size, (unsigned)pool->num,
+               (unsigned)pool->used, (unsigned)pool->max_used,
+               (unsigned)pool->failed);
+    }
+}
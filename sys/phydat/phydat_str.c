@@ -30,8 +30,12 @@ void phydat_dump(phydat_t *data, uint8_t dim)
         puts("Unable to display data object");
         return;
     }
-    printf("Data:");
+    fputs("Data:", stdout);
     for (uint8_t i = 0; i < dim; i++) {
+        /* the line is formatted by fmt and printed in one go, so it stays in
+         * order with the surrounding stdio output */
+        char line[32];
+        size_t len;
         char scale_str;
 
         switch (data->unit) {
@@ -49,25 +53,29 @@ void phydat_dump(phydat_t *data, uint8_t dim)
                 scale_str = phydat_scale_to_str(data->scale);
         }
 
-        printf("\t[%i] ", (int)i);
+        len = fmt_str(line, "\t[");
+        len += fmt_u16_dec(&line[len], i);
+        len += fmt_str(&line[len], "] ");
 
         if (scale_str) {
-            printf("%i%c", (int)data->val[i], scale_str);
+            len += fmt_s16_dec(&line[len], data->val[i]);
+            line[len++] = scale_str;
         }
         else if (data->scale == 0) {
-            printf("%i", (int)data->val[i]);
+            len += fmt_s16_dec(&line[len], data->val[i]);
         }
         else if ((data->scale > -5) && (data->scale < 0)) {
-            char num[8];
-            size_t len = fmt_s16_dfp(num, data->val[i], data->scale * -1);
-            num[len] = '\0';
-            printf("%s", num);
+            len += fmt_s16_dfp(&line[len], data->val[i], data->scale * -1);
         }
         else {
-            printf("%iE%i", (int)data->val[i], (int)data->scale);
+            len += fmt_s16_dec(&line[len], data->val[i]);
+            line[len++] = 'E';
+            len += fmt_s32_dec(&line[len], data->scale);
         }
 
-        printf("%s\n", phydat_unit_to_str(data->unit));
+        len += fmt_str(&line[len], phydat_unit_to_str(data->unit));
+        line[len] = '\0';
+        puts(line);
     }
 }
 
@@ -22,6 +22,15 @@
 #include "periph/pm.h"
 #include "pm_layered.h"
 
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "xtimer.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -46,9 +55,65 @@ typedef union {
  */
 volatile pm_blocker_t pm_blocker = PM_BLOCKER_INITIAL;
 
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+static const uint32_t _latency[PM_NUM_MODES] = PM_MODE_LATENCY_US;
+static const uint32_t _residency[PM_NUM_MODES] = PM_MODE_RESIDENCY_US;
+
+/* the times are counted in xtimer ticks and converted when read */
+static pm_layered_stats_t _stats;
+
+static void _wakeup_cb(void *arg)
+{
+    /* the interrupt alone wakes the CPU */
+    (void)arg;
+}
+
+static xtimer_t _wakeup = { .callback = _wakeup_cb };
+
+/* must be called with interrupts disabled */
+static void _set_governed(unsigned mode)
+{
+    bool demoted = false;
+    uint64_t left = xtimer_usec_from_ticks64(
+        xtimer_ticks64(xtimer_next_event().ticks32));
+
+    for (; mode < PM_NUM_MODES; mode++) {
+        /* UINT32_MAX marks modes the idle thread must not use at all */
+        if (_residency[mode] == UINT32_MAX) {
+            continue;
+        }
+        if (left >= (uint64_t)_latency[mode] + _residency[mode]) {
+            break;
+        }
+        demoted = true;
+    }
+    if (demoted) {
+        _stats.demoted++;
+    }
+    if ((mode < PM_NUM_MODES) && _latency[mode]) {
+        /* be awake again in time for the next timer */
+        uint64_t offset = left - _latency[mode];
+        xtimer_set(&_wakeup, (offset > UINT32_MAX) ? UINT32_MAX : offset);
+    }
+
+    DEBUG("pm: setting mode %u\n", mode);
+    xtimer_ticks32_t before = xtimer_now();
+    pm_set(mode);
+    xtimer_ticks32_t after = xtimer_now();
+    xtimer_remove(&_wakeup);
+
+    _stats.entries[mode]++;
+    /* xtimer_now() goes back if the low-level timer overflowed while
+     * interrupts were disabled, such a sample is dropped */
+    if (!xtimer_less(after, before)) {
+        _stats.time[mode] += xtimer_diff(after, before).ticks32;
+    }
+}
+#endif
+
 void pm_set_lowest(void)
 {
-    pm_blocker_t blocker = (pm_blocker_t) pm_blocker;
+    pm_blocker_t blocker = { .val_u32 = pm_blocker.val_u32 };
     unsigned mode = PM_NUM_MODES;
     while (mode) {
         if (blocker.val_u8[mode-1]) {
@@ -60,8 +125,12 @@ void pm_set_lowest(void)
     /* set lowest mode if blocker is still the same */
     unsigned state = irq_disable();
     if (blocker.val_u32 == pm_blocker.val_u32) {
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+        _set_governed(mode);
+#else
         DEBUG("pm: setting mode %u\n", mode);
         pm_set(mode);
+#endif
     }
     else {
         DEBUG("pm: mode block changed\n");
@@ -87,6 +156,51 @@ void pm_unblock(unsigned mode)
     irq_restore(state);
 }
 
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+void pm_layered_get_stats(pm_layered_stats_t *stats)
+{
+    unsigned state = irq_disable();
+
+    *stats = _stats;
+    irq_restore(state);
+    for (unsigned i = 0; i <= PM_NUM_MODES; i++) {
+        stats->time[i] = xtimer_usec_from_ticks64(xtimer_ticks64(stats->time[i]));
+    }
+}
+
+void pm_layered_reset_stats(void)
+{
+    unsigned state = irq_disable();
+
+    memset(&_stats, 0, sizeof(_stats));
+    irq_restore(state);
+}
+
+void pm_layered_print_stats(void)
+{
+    pm_layered_stats_t stats;
+    uint64_t total = 0;
+
+    pm_layered_get_stats(&stats);
+    for (unsigned i = 0; i <= PM_NUM_MODES; i++) {
+        total += stats.time[i];
+    }
+    printf("%4s %10s %10s %6s\n", "mode", "entries", "ms", "share");
+    for (unsigned i = 0; i <= PM_NUM_MODES; i++) {
+        unsigned permille = total ? (unsigned)(stats.time[i] * 1000 / total) : 0;
+        if (i < PM_NUM_MODES) {
+            printf("%4u", i);
+        }
+        else {
+            printf("%4s", "idle");
+        }
+        printf(" %10" PRIu32 " %10" PRIu32 " %3u.%u%%\n", stats.entries[i],
+               (uint32_t)(stats.time[i] / 1000), permille / 10, permille % 10);
+    }
+    printf("demoted: %" PRIu32 "\n", stats.demoted);
+}
+#endif
+
 #ifndef PROVIDES_PM_LAYERED_OFF
 void  pm_off(void)
 {
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  posix_sockets
+ * @{
+ */
+
+/**
+ * @file
+ * @brief   Input/output multiplexing
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/poll.h.html">
+ *              The Open Group Base Specifications Issue 7, <poll.h>
+ *          </a>
+ *
+ * Provided by the `posix_poll` module. A thread waiting in poll() sleeps on
+ * the thread flag @ref POSIX_POLL_THREAD_FLAG and is woken up by the network
+ * stack as soon as a packet is queued for one of the polled sockets, so no
+ * polling interval is involved.
+ *
+ * Readiness of sockets can only be tracked with the `gnrc_sock_async`
+ * module (pulled in automatically for GNRC). Other file descriptors of the
+ * @ref sys_vfs are always reported ready, as it is specified for regular
+ * files. Sockets whose readiness can't be tracked, such as `SOCK_STREAM`
+ * sockets, are reported with @ref POLLNVAL by poll() and make select() fail
+ * with `EBADF`.
+ *
+ * @note    A socket can only be waited for by one thread at a time.
+ */
+#ifndef POLL_H
+#define POLL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Thread flag used to wake up a thread waiting in poll() or select()
+ */
+#ifndef POSIX_POLL_THREAD_FLAG
+#define POSIX_POLL_THREAD_FLAG  (0x1 << 13)
+#endif
+
+/**
+ * @name    Event flags for struct pollfd
+ * @{
+ */
+#define POLLIN      (0x0001)    /**< data other than high-priority data may be read */
+#define POLLPRI     (0x0002)    /**< high-priority data may be read */
+#define POLLOUT     (0x0004)    /**< normal data may be written */
+#define POLLERR     (0x0008)    /**< an error has occurred (revents only) */
+#define POLLHUP     (0x0010)    /**< device has been disconnected (revents only) */
+#define POLLNVAL    (0x0020)    /**< invalid fd member (revents only) */
+#define POLLRDNORM  (POLLIN)    /**< normal data may be read */
+#define POLLWRNORM  (POLLOUT)   /**< equivalent to POLLOUT */
+/** @} */
+
+/**
+ * @brief   Type used for the number of file descriptors
+ */
+typedef unsigned int nfds_t;
+
+/**
+ * @brief   File descriptor to poll
+ */
+struct pollfd {
+    int fd;             /**< the file descriptor; negative fds are ignored */
+    short events;       /**< the events to wait for */
+    short revents;      /**< the events that occurred */
+};
+
+/**
+ * @brief   Waits for events on a set of file descriptors
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/functions/poll.html">
+ *              The Open Group Base Specification Issue 7, poll()
+ *          </a>
+ *
+ * @param[in,out] fds   The file descriptors to poll.
+ * @param[in] nfds      Number of elements in @p fds.
+ * @param[in] timeout   Timeout in milliseconds. -1 waits infinitely, 0
+ *                      returns immediately.
+ *
+ * @return  Number of elements of @p fds with a non-zero
+ *          pollfd::revents. pollfd::revents is @ref POLLNVAL for a socket
+ *          that can't be polled, e.g. a `SOCK_STREAM` socket.
+ * @return  0 on timeout.
+ * @return  -1 on error, errno is set accordingly.
+ */
+int poll(struct pollfd fds[], nfds_t nfds, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLL_H */
+/** @} */
@@ -496,6 +496,37 @@ int setsockopt(int socket, int level, int option_name, const void *option_value,
 
 /** @} */
 
+struct timeval;
+
+/**
+ * @brief   Synchronous I/O multiplexing
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/functions/select.html">
+ *              The Open Group Base Specification Issue 7, select()
+ *          </a>
+ *
+ * `fd_set` and its macros are taken from the C library, which usually also
+ * declares this function in `<sys/select.h>`. Only available with the
+ * `posix_poll` module, see @ref poll.h for the restrictions.
+ *
+ * @param[in] nfds          Highest-numbered file descriptor in any of the
+ *                          sets plus 1.
+ * @param[in,out] readfds   File descriptors to check for being ready to
+ *                          read. May be NULL.
+ * @param[in,out] writefds  File descriptors to check for being ready to
+ *                          write. May be NULL.
+ * @param[in,out] errorfds  File descriptors to check for pending error
+ *                          conditions. May be NULL.
+ * @param[in] timeout       Maximum time to wait. NULL waits infinitely.
+ *
+ * @return  Total number of bits set in the three sets.
+ * @return  0 on timeout.
+ * @return  -1 on error, errno is set accordingly. errno is `EBADF` if one
+ *          of the sets contains a socket that can't be polled, e.g. a
+ *          `SOCK_STREAM` socket.
+ */
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds,
+           struct timeval *timeout);
+
 #ifdef __cplusplus
 }
 #endif
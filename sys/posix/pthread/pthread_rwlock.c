@@ -28,6 +28,7 @@
  * @}
  */
 
+#include "irq.h"
 #include "pthread.h"
 #include "sched.h"
 #include "xtimer.h"
@@ -97,6 +98,58 @@ bool __pthread_rwlock_blocked_writingly(const pthread_rwlock_t *rwlock)
     return rwlock->readers != 0;
 }
 
+/* The fast paths take and release the lock without touching the mutex, if
+ * no other thread waits for the lock. With interrupts disabled and the mutex
+ * unlocked, no other thread is in the middle of a lock or unlock operation,
+ * and an empty queue means that no thread waits for the lock. */
+static inline bool _is_idle(const pthread_rwlock_t *rwlock)
+{
+    return (rwlock->mutex.queue.next == NULL) && (rwlock->queue.first == NULL);
+}
+
+static bool pthread_rwlock_fast_lock(pthread_rwlock_t *rwlock, bool is_writer)
+{
+    bool res;
+    unsigned state = irq_disable();
+
+    if (is_writer) {
+        res = _is_idle(rwlock) && (rwlock->readers == 0);
+        if (res) {
+            rwlock->readers = -1;
+        }
+    }
+    else {
+        res = _is_idle(rwlock) && (rwlock->readers >= 0);
+        if (res) {
+            ++rwlock->readers;
+        }
+    }
+    irq_restore(state);
+
+    return res;
+}
+
+static bool pthread_rwlock_fast_unlock(pthread_rwlock_t *rwlock)
+{
+    bool res = false;
+    unsigned state = irq_disable();
+
+    if (rwlock->mutex.queue.next == NULL) {
+        if (rwlock->readers > 1) {
+            /* not the last reader, so no one is to be woken up */
+            --rwlock->readers;
+            res = true;
+        }
+        else if ((rwlock->readers != 0) && (rwlock->queue.first == NULL)) {
+            rwlock->readers = 0;
+            res = true;
+        }
+    }
+    irq_restore(state);
+
+    return res;
+}
+
 static int pthread_rwlock_lock(pthread_rwlock_t *rwlock,
                                bool (*is_blocked)(const pthread_rwlock_t *rwlock),
                                bool is_writer,
@@ -109,6 +162,10 @@ static int pthread_rwlock_lock(pthread_rwlock_t *rwlock,
         return EINVAL;
     }
 
+    if (pthread_rwlock_fast_lock(rwlock, is_writer)) {
+        return 0;
+    }
+
     mutex_lock(&rwlock->mutex);
     if (!is_blocked(rwlock)) {
         DEBUG("Thread %" PRIkernel_pid ": pthread_rwlock_%s(): is_writer=%u, allow_spurious=%u %s\n",
@@ -165,6 +222,9 @@ static int pthread_rwlock_trylock(pthread_rwlock_t *rwlock,
         DEBUG("Thread %" PRIkernel_pid ": pthread_rwlock_%s(): rwlock=NULL supplied\n", thread_pid, "trylock");
         return EINVAL;
     }
+    else if (pthread_rwlock_fast_lock(rwlock, incr_when_held < 0)) {
+        return 0;
+    }
     else if (mutex_trylock(&rwlock->mutex) == 0) {
         return EBUSY;
     }
@@ -241,6 +301,10 @@ int pthread_rwlock_unlock(pthread_rwlock_t *rwlock)
         return EINVAL;
     }
 
+    if (pthread_rwlock_fast_unlock(rwlock)) {
+        return 0;
+    }
+
     mutex_lock(&rwlock->mutex);
     if (rwlock->readers == 0) {
         /* the lock is open */
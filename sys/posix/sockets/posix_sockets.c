@@ -36,11 +36,28 @@
 #include "net/sock/udp.h"
 #include "net/sock/tcp.h"
 
+#ifdef MODULE_POSIX_POLL
+#include <limits.h>
+#include <poll.h>
+#include <sys/time.h>
+
+#include "thread.h"
+#include "xtimer.h"
+#endif
+#ifdef MODULE_GNRC_SOCK_ASYNC
+#include "net/gnrc/sock.h"
+#endif
+
 /* enough to create sockets both with socket() and accept() */
 #define _ACTUAL_SOCKET_POOL_SIZE   (SOCKET_POOL_SIZE + \
                                     (SOCKET_POOL_SIZE * SOCKET_TCP_QUEUE_SIZE))
 #define SOCKET_BLKSIZE             (512)
 
+#ifdef MODULE_POSIX_POLL
+/* longest timeout in ms xtimer_set_timeout_flag() can handle at once */
+#define _POLL_TIMEOUT_MAX_MS       (UINT32_MAX / US_PER_MS)
+#endif
+
 /**
  * @brief   Unitfied connection type.
  */
@@ -79,6 +96,9 @@ typedef struct {
     unsigned queue_array_len;
 #endif
     sock_tcp_ep_t local;        /* to store bind before connect/listen */
+#ifdef MODULE_POSIX_POLL
+    thread_t *volatile poll_thread; /* thread waiting in poll() for socket */
+#endif
 } socket_t;
 
 static socket_t _socket_pool[_ACTUAL_SOCKET_POOL_SIZE];
@@ -361,6 +381,9 @@ int socket(int domain, int type, int protocol)
             }
             s->bound = false;
             s->sock = NULL;
+#ifdef MODULE_POSIX_POLL
+            s->poll_thread = NULL;
+#endif
 #ifdef POSIX_SETSOCKOPT
             s->recv_timeout = SOCK_NO_TIMEOUT;
 #endif
@@ -456,6 +479,9 @@ int accept(int socket, struct sockaddr *restrict address,
                 new_s->type = s->type;
                 new_s->protocol = s->protocol;
                 new_s->bound = true;
+#ifdef MODULE_POSIX_POLL
+                new_s->poll_thread = NULL;
+#endif
                 new_s->queue_array = NULL;
                 new_s->queue_array_len = 0;
                 memset(&s->local, 0, sizeof(sock_tcp_ep_t));
@@ -990,6 +1016,319 @@ ssize_t sendto(int socket, const void *buffer, size_t length, int flags,
     return res;
 }
 
+#ifdef MODULE_POSIX_POLL
+#ifdef MODULE_GNRC_SOCK_ASYNC
+static void _poll_wake(socket_t *s)
+{
+    thread_t *thread = s->poll_thread;
+
+    if (thread != NULL) {
+        thread_flags_set(thread, POSIX_POLL_THREAD_FLAG);
+    }
+}
+
+#ifdef MODULE_SOCK_UDP
+static void _poll_udp_cb(sock_udp_t *sock, void *arg)
+{
+    (void)sock;
+    _poll_wake(arg);
+}
+#endif
+
+#ifdef MODULE_SOCK_IP
+static void _poll_ip_cb(sock_ip_t *sock, void *arg)
+{
+    (void)sock;
+    _poll_wake(arg);
+}
+#endif
+#endif /* MODULE_GNRC_SOCK_ASYNC */
+
+/**
+ * @brief   Checks a socket for the events in @p events
+ *
+ * If @p waiter is not NULL, it is woken up by the stack when the socket
+ * becomes readable.
+ */
+static short _socket_poll(socket_t *s, short events, thread_t *waiter)
+{
+    short revents = 0;
+
+    if ((s->sock == NULL) && s->bound && (s->type != SOCK_STREAM)) {
+        /* bind() only stored the end point, so do the actual bind here to
+         * receive packets */
+        if (_bind_connect(s, NULL, 0) < 0) {
+            return POLLERR;
+        }
+    }
+    switch (s->type) {
+#if defined(MODULE_GNRC_SOCK_ASYNC) && defined(MODULE_SOCK_IP)
+        case SOCK_RAW:
+            /* sending never blocks */
+            revents = POLLOUT;
+            if (s->sock != NULL) {
+                s->poll_thread = waiter;
+                gnrc_sock_ip_set_cb(&s->sock->raw, _poll_ip_cb, s);
+                if (gnrc_sock_ip_avail(&s->sock->raw) > 0) {
+                    revents |= POLLIN;
+                }
+            }
+            break;
+#endif
+#if defined(MODULE_GNRC_SOCK_ASYNC) && defined(MODULE_SOCK_UDP)
+        case SOCK_DGRAM:
+            /* sending never blocks */
+            revents = POLLOUT;
+            if ((s->sock != NULL) &&
+                (gnrc_sock_udp_set_cb(&s->sock->udp, _poll_udp_cb, s) == 0)) {
+                s->poll_thread = waiter;
+                if (gnrc_sock_udp_avail(&s->sock->udp) > 0) {
+                    revents |= POLLIN;
+                }
+            }
+            break;
+#endif
+        default:
+            /* readiness of socket can't be tracked */
+            (void)waiter;
+            return POLLNVAL;
+    }
+    return revents & events;
+}
+
+/**
+ * @brief   Checks a file descriptor for the events in @p events
+ */
+static short _fd_poll(int fd, short events, thread_t *waiter)
+{
+    socket_t *s;
+    struct stat buf;
+
+    mutex_lock(&_socket_pool_mutex);
+    s = _get_socket(fd);
+    mutex_unlock(&_socket_pool_mutex);
+    if (s != NULL) {
+        return _socket_poll(s, events, waiter);
+    }
+    if (vfs_fstat(fd, &buf) < 0) {
+        return POLLNVAL;
+    }
+    /* regular files are always ready */
+    return events & (POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM);
+}
+
+static void _fd_unpoll(int fd)
+{
+    socket_t *s;
+
+    mutex_lock(&_socket_pool_mutex);
+    s = _get_socket(fd);
+    if ((s != NULL) && (s->poll_thread != NULL) && (s->sock != NULL)) {
+        /* the stack must not call back into a socket nobody polls */
+        switch (s->type) {
+#if defined(MODULE_GNRC_SOCK_ASYNC) && defined(MODULE_SOCK_IP)
+            case SOCK_RAW:
+                gnrc_sock_ip_set_cb(&s->sock->raw, NULL, NULL);
+                break;
+#endif
+#if defined(MODULE_GNRC_SOCK_ASYNC) && defined(MODULE_SOCK_UDP)
+            case SOCK_DGRAM:
+                gnrc_sock_udp_set_cb(&s->sock->udp, NULL, NULL);
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+    if (s != NULL) {
+        s->poll_thread = NULL;
+    }
+    mutex_unlock(&_socket_pool_mutex);
+}
+
+/**
+ * @brief   Checks all descriptors of a poll() or select() call
+ *
+ * @return  number of ready descriptors
+ */
+typedef int (*_poll_check_t)(void *ctx, thread_t *waiter);
+
+static void _poll_arm(xtimer_t *timer, uint32_t *timeout_ms)
+{
+    uint32_t timeout = (*timeout_ms > _POLL_TIMEOUT_MAX_MS) ?
+                       _POLL_TIMEOUT_MAX_MS : *timeout_ms;
+
+    *timeout_ms -= timeout;
+    xtimer_set_timeout_flag(timer, timeout * US_PER_MS);
+}
+
+/**
+ * @brief   Waits until @p check reports ready descriptors or @p timeout
+ *          milliseconds passed
+ */
+static int _poll_wait(_poll_check_t check, void *ctx, int timeout)
+{
+    thread_t *me = (thread_t *)sched_active_thread;
+    xtimer_t timer;
+    uint32_t remaining = (uint32_t)timeout;
+    int res;
+
+    thread_flags_clear(POSIX_POLL_THREAD_FLAG | THREAD_FLAG_TIMEOUT);
+    if (timeout > 0) {
+        _poll_arm(&timer, &remaining);
+    }
+    /* descriptors are registered with the waiter before they are checked, so
+     * the flag catches all packets coming in after the check */
+    while (((res = check(ctx, me)) == 0) && (timeout != 0)) {
+        thread_flags_t flags;
+
+        flags = thread_flags_wait_any(POSIX_POLL_THREAD_FLAG |
+                                      THREAD_FLAG_TIMEOUT);
+        if (flags & THREAD_FLAG_TIMEOUT) {
+            if (remaining == 0) {
+                res = check(ctx, NULL);
+                break;
+            }
+            _poll_arm(&timer, &remaining);
+        }
+    }
+    if (timeout > 0) {
+        xtimer_remove(&timer);
+    }
+    return res;
+}
+
+typedef struct {
+    struct pollfd *fds;
+    nfds_t nfds;
+} _poll_ctx_t;
+
+static int _poll_check(void *arg, thread_t *waiter)
+{
+    _poll_ctx_t *ctx = arg;
+    int res = 0;
+
+    for (nfds_t i = 0; i < ctx->nfds; i++) {
+        struct pollfd *pfd = &ctx->fds[i];
+
+        if (pfd->fd < 0) {
+            pfd->revents = 0;
+            continue;
+        }
+        pfd->revents = _fd_poll(pfd->fd, pfd->events, waiter);
+        if (pfd->revents != 0) {
+            res++;
+        }
+    }
+    return res;
+}
+
+int poll(struct pollfd fds[], nfds_t nfds, int timeout)
+{
+    _poll_ctx_t ctx = { .fds = fds, .nfds = nfds };
+    int res;
+
+    if ((fds == NULL) && (nfds > 0)) {
+        errno = EFAULT;
+        return -1;
+    }
+    res = _poll_wait(_poll_check, &ctx, timeout);
+    for (nfds_t i = 0; i < nfds; i++) {
+        if (fds[i].fd >= 0) {
+            _fd_unpoll(fds[i].fd);
+        }
+    }
+    return res;
+}
+
+typedef struct {
+    int nfds;
+    fd_set *sets[2];        /* read and write sets given by the user */
+    fd_set in[2];           /* copy of the sets given by the user */
+} _select_ctx_t;
+
+static int _select_check(void *arg, thread_t *waiter)
+{
+    static const short events[] = { POLLIN, POLLOUT };
+    _select_ctx_t *ctx = arg;
+    int res = 0;
+
+    for (int fd = 0; fd < ctx->nfds; fd++) {
+        short wanted = 0, revents;
+
+        for (unsigned i = 0; i < 2; i++) {
+            if ((ctx->sets[i] != NULL) && FD_ISSET(fd, &ctx->in[i])) {
+                wanted |= events[i];
+            }
+        }
+        if (wanted == 0) {
+            continue;
+        }
+        revents = _fd_poll(fd, wanted, waiter);
+        if (revents & POLLNVAL) {
+            return -EBADF;
+        }
+        for (unsigned i = 0; i < 2; i++) {
+            if ((ctx->sets[i] != NULL) && (revents & events[i])) {
+                FD_SET(fd, ctx->sets[i]);
+                res++;
+            }
+        }
+    }
+    return res;
+}
+
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds,
+           struct timeval *timeout)
+{
+    _select_ctx_t ctx = { .nfds = nfds, .sets = { readfds, writefds } };
+    int timeout_ms = -1;
+    int res;
+
+    if ((nfds < 0) || (nfds > FD_SETSIZE)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (timeout != NULL) {
+        if ((timeout->tv_sec < 0) || (timeout->tv_usec < 0) ||
+            (timeout->tv_usec >= (long)US_PER_SEC)) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (timeout->tv_sec >= (INT_MAX / (int)MS_PER_SEC)) {
+            timeout_ms = INT_MAX;
+        }
+        else {
+            /* round up to not return before the timeout passed */
+            timeout_ms = (int)((timeout->tv_sec * MS_PER_SEC) +
+                               ((timeout->tv_usec + US_PER_MS - 1) / US_PER_MS));
+        }
+    }
+    for (unsigned i = 0; i < 2; i++) {
+        if (ctx.sets[i] != NULL) {
+            ctx.in[i] = *ctx.sets[i];
+            FD_ZERO(ctx.sets[i]);
+        }
+    }
+    /* no exceptional conditions are supported */
+    if (errorfds != NULL) {
+        FD_ZERO(errorfds);
+    }
+    res = _poll_wait(_select_check, &ctx, timeout_ms);
+    for (int fd = 0; fd < nfds; fd++) {
+        if (((readfds != NULL) && FD_ISSET(fd, &ctx.in[0])) ||
+            ((writefds != NULL) && FD_ISSET(fd, &ctx.in[1]))) {
+            _fd_unpoll(fd);
+        }
+    }
+    if (res < 0) {
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+#endif /* MODULE_POSIX_POLL */
+
 /*
  * This is a partial implementation of setsockopt for changing the receive
  * timeout value of a socket.
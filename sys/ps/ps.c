@@ -30,6 +30,14 @@
 #include "tlsf.h"
 #endif
 
+#ifdef MODULE_TLSF_MALLOC
+#include "tlsf_malloc.h"
+#endif
+
+#ifdef MODULE_STACKMON
+#include "stackmon.h"
+#endif
+
 /* list of states copied from tcb.h */
 static const char *state_names[] = {
     [STATUS_RUNNING] = "running",
@@ -149,4 +157,14 @@ void ps(void)
     tlsf_walk_pool(NULL);
 #   endif
 #endif
+
+#ifdef MODULE_TLSF_MALLOC
+    puts("\nHeap statistics:");
+    tlsf_malloc_print_stats();
+#endif
+
+#ifdef MODULE_STACKMON
+    puts("\nStack peaks:");
+    stackmon_print();
+#endif
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+ /**
+ * @ingroup sys_random
+ * @{
+ * @file
+ *
+ * @brief   Functions common to all PRNGs
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "random.h"
+
+uint32_t random_uint32_range(uint32_t a, uint32_t b)
+{
+    uint32_t range = b - a;
+
+    assert(b > a);
+    if (range == 0) {
+        /* the mask below would cover all values, none of them in range */
+        return a;
+    }
+    /* use the fewest upper bits that cover the range, the lower bits of some
+     * of the generators are of poor quality */
+    unsigned shift = __builtin_clzl((unsigned long)((range - 1) | 1)) -
+                     (sizeof(unsigned long) * 8 - 32);
+    uint32_t res;
+
+    /* rejecting values out of range keeps the result unbiased. Less than
+     * half of the values are rejected, so it takes less than two tries on
+     * average. */
+    do {
+        res = random_uint32() >> shift;
+    } while (res >= range);
+
+    return res + a;
+}
+
+#ifndef MODULE_PRNG_XOSHIRO
+void random_bytes(uint8_t *buf, size_t size)
+{
+    while (size >= sizeof(uint32_t)) {
+        uint32_t r = random_uint32();
+        memcpy(buf, &r, sizeof(r));
+        buf += sizeof(r);
+        size -= sizeof(r);
+    }
+    if (size) {
+        uint32_t r = random_uint32();
+        memcpy(buf, &r, size);
+    }
+}
+#endif
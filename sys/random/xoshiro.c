@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * Algorithm by David Blackman and Sebastiano Vigna, see
+ * http://xoshiro.di.unimi.it/xoshiro128starstar.c
+ */
+
+ /**
+ * @ingroup sys_random
+ * @{
+ * @file
+ *
+ * @brief   xoshiro128** random number generator implementation
+ *
+ * Needs only 32 bit shifts, rotations and additions, and produces a 32 bit
+ * word in a handful of cycles on every platform. random_bytes() keeps the
+ * state in registers for the whole buffer. On native, it runs four
+ * generators side by side in the lanes of a vector.
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "random.h"
+
+#if defined(CPU_NATIVE) && (defined(__i386__) || defined(__x86_64__))
+#define XOSHIRO_VECTOR      (1)
+#else
+#define XOSHIRO_VECTOR      (0)
+#endif
+
+static uint32_t _state[4];
+
+static inline uint32_t _rotl(uint32_t x, unsigned k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t _next(uint32_t *s)
+{
+    /* the multiplications by 5 and 9 as shifts and additions are cheaper on
+     * cores with a slow multiplier */
+    uint32_t x = s[1] + (s[1] << 2);
+    uint32_t res = _rotl(x, 7);
+    uint32_t t = s[1] << 9;
+
+    res += res << 3;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = _rotl(s[3], 11);
+
+    return res;
+}
+
+/* SplitMix32 maps consecutive values to well mixed ones, and never maps four
+ * consecutive ones to zero, so the state is never all zero */
+static uint32_t _splitmix32(uint32_t *x)
+{
+    uint32_t z = (*x += 0x9e3779b9);
+
+    z = (z ^ (z >> 16)) * 0x85ebca6b;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35;
+    return z ^ (z >> 16);
+}
+
+#if XOSHIRO_VECTOR
+typedef uint32_t _vec_t __attribute__((vector_size(16)));
+
+/* the states of four generators, _lanes[i][j] is word i of generator j */
+static _vec_t _lanes[4];
+
+/* a macro, as passing vectors to functions compiled without SSE would change
+ * the ABI */
+#define VEC_ROTL(x, k)      (((x) << (k)) | ((x) >> (32 - (k))))
+
+__attribute__((target("sse2")))
+static void _fill_vec(uint8_t *buf, size_t blocks)
+{
+    _vec_t s0 = _lanes[0], s1 = _lanes[1], s2 = _lanes[2], s3 = _lanes[3];
+
+    while (blocks--) {
+        _vec_t res = VEC_ROTL(s1 + (s1 << 2), 7);
+        _vec_t t = s1 << 9;
+
+        res += res << 3;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = VEC_ROTL(s3, 11);
+
+        memcpy(buf, &res, sizeof(res));
+        buf += sizeof(res);
+    }
+    _lanes[0] = s0;
+    _lanes[1] = s1;
+    _lanes[2] = s2;
+    _lanes[3] = s3;
+}
+#endif
+
+static void _seed(uint32_t x)
+{
+    for (unsigned i = 0; i < 4; i++) {
+        _state[i] = _splitmix32(&x);
+    }
+#if XOSHIRO_VECTOR
+    for (unsigned i = 0; i < 4; i++) {
+        for (unsigned j = 0; j < 4; j++) {
+            _lanes[i][j] = _splitmix32(&x);
+        }
+    }
+#endif
+}
+
+void random_init(uint32_t seed)
+{
+    _seed(seed);
+}
+
+void random_init_by_array(uint32_t init_key[], int key_length)
+{
+    uint32_t x = 0;
+
+    for (int i = 0; i < key_length; i++) {
+        x = _splitmix32(&x) ^ init_key[i];
+    }
+    _seed(x);
+}
+
+uint32_t random_uint32(void)
+{
+    return _next(_state);
+}
+
+void random_bytes(uint8_t *buf, size_t size)
+{
+#if XOSHIRO_VECTOR
+    size_t blocks = size / sizeof(_vec_t);
+
+    _fill_vec(buf, blocks);
+    buf += blocks * sizeof(_vec_t);
+    size -= blocks * sizeof(_vec_t);
+#endif
+
+    uint32_t s[4] = { _state[0], _state[1], _state[2], _state[3] };
+
+    while (size >= sizeof(uint32_t)) {
+        uint32_t r = _next(s);
+        memcpy(buf, &r, sizeof(r));
+        buf += sizeof(r);
+        size -= sizeof(r);
+    }
+    if (size) {
+        uint32_t r = _next(s);
+        memcpy(buf, &r, size);
+    }
+    memcpy(_state, s, sizeof(_state));
+}
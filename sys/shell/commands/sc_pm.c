@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command to print power mode usage statistics
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pm_layered.h"
+
+int _pm_handler(int argc, char **argv)
+{
+    if (argc < 2) {
+        pm_layered_print_stats();
+    }
+    else if (strcmp(argv[1], "reset") == 0) {
+        pm_layered_reset_stats();
+    }
+    else {
+        printf("usage: %s [reset]\n", argv[0]);
+        return 1;
+    }
+
+    return 0;
+}
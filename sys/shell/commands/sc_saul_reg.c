@@ -21,8 +21,8 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h>
 
+#include "fmt.h"
 #include "saul_reg.h"
 
 /* this function does not check, if the given device is valid */
@@ -86,7 +86,7 @@ static void read(int argc, char **argv)
         return;
     }
     /* get device id */
-    num = atoi(argv[2]);
+    num = scn_s32_dec(argv[2], strlen(argv[2]));
     dev = saul_reg_find_nth(num);
     if (dev == NULL) {
         puts("error: undefined device id given");
@@ -106,7 +106,7 @@ static void write(int argc, char **argv)
                argv[0], argv[1]);
         return;
     }
-    num = atoi(argv[2]);
+    num = scn_s32_dec(argv[2], strlen(argv[2]));
     dev = saul_reg_find_nth(num);
     if (dev == NULL) {
         puts("error: undefined device given");
@@ -116,7 +116,7 @@ static void write(int argc, char **argv)
     memset(&data, 0, sizeof(data));
     dim = ((argc - 3) > (int)PHYDAT_DIM) ? (int)PHYDAT_DIM : (argc - 3);
     for (int i = 0; i < dim; i++) {
-        data.val[i] = atoi(argv[i + 3]);
+        data.val[i] = scn_s32_dec(argv[i + 3], strlen(argv[i + 3]));
     }
     /* print values before writing */
     printf("Writing to device #%i - %s\n", num, dev->name);
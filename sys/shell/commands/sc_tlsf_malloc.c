@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command to print heap usage statistics
+ *
+ * @}
+ */
+
+#include "tlsf_malloc.h"
+
+int _tlsf_malloc_handler(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    tlsf_malloc_print_stats();
+
+    return 0;
+}
@@ -31,12 +31,26 @@ extern int _id_handler(int argc, char **argv);
 
 #ifdef MODULE_LPC_COMMON
 extern int _heap_handler(int argc, char **argv);
+#elif defined(MODULE_TLSF_MALLOC)
+extern int _tlsf_malloc_handler(int argc, char **argv);
 #endif
 
 #ifdef MODULE_PS
 extern int _ps_handler(int argc, char **argv);
 #endif
 
+#ifdef MODULE_OBJPOOL
+extern int _objpool_handler(int argc, char **argv);
+#endif
+
+#ifdef MODULE_STACKMON
+extern int _stackmon_handler(int argc, char **argv);
+#endif
+
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+extern int _pm_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_SHT11
 extern int _get_temperature_handler(int argc, char **argv);
 extern int _get_humidity_handler(int argc, char **argv);
@@ -154,10 +168,21 @@ const shell_command_t _shell_command_list[] = {
 #endif
 #ifdef MODULE_LPC_COMMON
     {"heap", "Shows the heap state for the LPC2387 on the command shell.", _heap_handler},
+#elif defined(MODULE_TLSF_MALLOC)
+    {"heap", "Prints heap usage statistics", _tlsf_malloc_handler},
 #endif
 #ifdef MODULE_PS
     {"ps", "Prints information about running threads.", _ps_handler},
 #endif
+#ifdef MODULE_OBJPOOL
+    {"pools", "Prints usage statistics of object pools", _objpool_handler},
+#endif
+#ifdef MODULE_STACKMON
+    {"stackmon", "Prints the peak stack usage of all threads", _stackmon_handler},
+#endif
+#ifdef MODULE_PM_LAYERED_GOVERNOR
+    {"pm", "Prints or resets power mode usage statistics", _pm_handler},
+#endif
 #ifdef MODULE_SHT11
     {"temp", "Prints measured temperature.", _get_temperature_handler},
     {"hum", "Prints measured humidity.", _get_humidity_handler},
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_stackmon
+ * @{
+ *
+ * @file
+ * @brief       Stack monitor implementation
+ *
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "irq.h"
+#include "sched.h"
+#include "stackmon.h"
+#include "thread.h"
+
+typedef struct {
+    char *stack_start;      /* NULL if no thread ran under this PID yet */
+    const char *name;
+    unsigned size;
+    unsigned free;          /* painted bytes at the bottom of the stack */
+    unsigned pos;           /* offset of the next word to check */
+} _record_t;
+
+static _record_t _records[MAXTHREADS];
+/* thread the idle thread checks next */
+static kernel_pid_t _next = KERNEL_PID_FIRST;
+
+/* checks up to STACKMON_SCAN_WORDS words, returns true once the unused part of
+ * the stack was checked completely */
+static bool _check(kernel_pid_t pid)
+{
+    thread_t *thread = (thread_t *)sched_threads[pid];
+    _record_t *rec = &_records[pid - KERNEL_PID_FIRST];
+
+    if (!thread) {
+        return true;
+    }
+    if (rec->stack_start != thread->stack_start) {
+        rec->stack_start = thread->stack_start;
+        rec->name = thread->name;
+        rec->size = thread->stack_size;
+        /* the thread control block is at the top of the stack */
+        rec->free = (char *)thread - thread->stack_start;
+        rec->pos = 0;
+    }
+
+    /* the stack grows downwards, so the first overwritten word from the
+     * bottom marks the peak */
+    uintptr_t *stackp = (uintptr_t *)(rec->stack_start + rec->pos);
+    uintptr_t *end = (uintptr_t *)(rec->stack_start + rec->free);
+    for (unsigned i = 0; i < STACKMON_SCAN_WORDS; i++, stackp++) {
+        if (stackp >= end) {
+            rec->pos = 0;
+            return true;
+        }
+        if (*stackp != (uintptr_t)stackp) {
+            rec->free = (char *)stackp - rec->stack_start;
+            rec->pos = 0;
+            return true;
+        }
+    }
+    rec->pos = (char *)stackp - rec->stack_start;
+    return false;
+}
+
+static void _check_all(kernel_pid_t pid)
+{
+    bool done;
+
+    do {
+        unsigned state = irq_disable();
+        done = _check(pid);
+        irq_restore(state);
+    } while (!done);
+}
+
+void stackmon_idle(void)
+{
+    _check_all(_next);
+    _next = (_next < KERNEL_PID_LAST) ? _next + 1 : KERNEL_PID_FIRST;
+}
+
+void stackmon_update(kernel_pid_t pid)
+{
+    if (!pid_is_valid(pid)) {
+        return;
+    }
+
+    unsigned state = irq_disable();
+
+    /* the idle thread may have been preempted in the middle of this stack,
+     * a new pass covers what changed below its position */
+    _records[pid - KERNEL_PID_FIRST].pos = 0;
+    irq_restore(state);
+    _check_all(pid);
+}
+
+int stackmon_get(kernel_pid_t pid, stackmon_stats_t *stats)
+{
+    if (!pid_is_valid(pid)) {
+        return -1;
+    }
+
+    unsigned state = irq_disable();
+    const _record_t *rec = &_records[pid - KERNEL_PID_FIRST];
+    int res = -1;
+
+    if (rec->stack_start) {
+        stats->name = rec->name;
+        stats->size = rec->size;
+        stats->peak = rec->size - rec->free;
+        res = 0;
+    }
+    irq_restore(state);
+    return res;
+}
+
+void stackmon_print(void)
+{
+    unsigned reclaimable = 0;
+
+    printf("%5s %-20s %6s %6s %12s\n", "pid", "name", "size", "peak",
+           "recommended");
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++) {
+        stackmon_stats_t stats;
+
+        stackmon_update(pid);
+        if (stackmon_get(pid, &stats) < 0) {
+            continue;
+        }
+        unsigned rec_size = stackmon_recommend(stats.peak);
+        if (rec_size < stats.size) {
+            reclaimable += stats.size - rec_size;
+        }
+        printf("%5" PRIkernel_pid " %-20s %6u %6u %12u\n", pid,
+               stats.name ? stats.name : "-", stats.size, stats.peak,
+               rec_size);
+    }
+    printf("reclaimable: %u\n", reclaimable);
+}
@@ -15,8 +15,10 @@
  */
 
 #include <errno.h> /* for error codes */
-#include <string.h> /* for strncmp */
+#include <string.h> /* for strncmp, memcmp */
+#include <stdbool.h>
 #include <stddef.h> /* for NULL */
+#include <stdint.h> /* for SIZE_MAX */
 #include <sys/types.h> /* for off_t etc */
 #include <sys/stat.h> /* for struct stat */
 #include <sys/statvfs.h> /* for struct statvfs */
@@ -26,7 +28,11 @@
 #include "mutex.h"
 #include "thread.h"
 #include "kernel_types.h"
+#include "bitarithm.h"
 #include "clist.h"
+#ifdef MODULE_GNRC_PKTBUF
+#include "net/gnrc/vfs.h"
+#endif
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
@@ -58,6 +64,48 @@ static vfs_file_t _vfs_open_files[VFS_MAX_OPEN_FILES];
  */
 static clist_node_t _vfs_mounts_list;
 
+/**
+ * @internal
+ * @brief Number of bits in a word of _vfs_used_fds
+ */
+#define VFS_FD_WORD_BITS    (sizeof(unsigned) * 8)
+
+/**
+ * @internal
+ * @brief Bitmap of allocated entries in the _vfs_open_files array
+ *
+ * Allows to find a free fd without looking at each entry of the table.
+ */
+static unsigned _vfs_used_fds[(VFS_MAX_OPEN_FILES + VFS_FD_WORD_BITS - 1) /
+                              VFS_FD_WORD_BITS];
+
+/**
+ * @internal
+ * @brief Mount tree used to resolve paths
+ *
+ * Each mount is linked to the mounts directly below its mount point through
+ * vfs_mount_t::mount_child, mounts with the same parent are chained through
+ * vfs_mount_t::mount_sibling. This is the first mount on the top level.
+ * A mount on "/" is kept in _vfs_root_mount instead, since it matches all
+ * paths.
+ */
+static vfs_mount_t *_vfs_mount_tree;
+
+/**
+ * @internal
+ * @brief Mount on "/", if any
+ */
+static vfs_mount_t *_vfs_root_mount;
+
+/**
+ * @internal
+ * @brief Add a character to a mount point hash (djb2 with xor)
+ */
+static inline uint32_t _mount_hash(uint32_t hash, char c)
+{
+    return ((hash << 5) + hash) ^ (uint8_t)c;
+}
+
 /**
  * @internal
  * @brief Find an unused entry in the _vfs_open_files array and mark it as used
@@ -128,6 +176,39 @@ inline static int _find_mount(vfs_mount_t **mountpp, const char *name, const cha
  */
 inline static int _fd_is_valid(int fd);
 
+/**
+ * @internal
+ * @brief Find the deepest mount in the mount tree whose mount point is a
+ * prefix of @p name
+ *
+ * The mount on "/" is not considered. Must hold _mount_mutex.
+ *
+ * @param[in]  name      absolute path
+ * @param[in]  max_len   only consider mount points shorter than this
+ *
+ * @return the found mount
+ * @return NULL if no mount matches
+ */
+static vfs_mount_t *_mount_lookup(const char *name, size_t max_len);
+
+/**
+ * @internal
+ * @brief Insert @p mountp into the mount tree, must hold _mount_mutex
+ *
+ * Mounts already below vfs_mount_t::mount_child of @p mountp are kept.
+ *
+ * @param[in]  mountp    mount to insert
+ */
+static void _mount_tree_insert(vfs_mount_t *mountp);
+
+/**
+ * @internal
+ * @brief Remove @p mountp from the mount tree, must hold _mount_mutex
+ *
+ * @param[in]  mountp    mount to remove
+ */
+static void _mount_tree_remove(vfs_mount_t *mountp);
+
 static mutex_t _mount_mutex = MUTEX_INIT;
 static mutex_t _open_mutex = MUTEX_INIT;
 
@@ -332,6 +413,153 @@ ssize_t vfs_write(int fd, const void *src, size_t count)
     return filp->f_op->write(filp, src, count);
 }
 
+ssize_t vfs_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    DEBUG("vfs_readv: %d, %p, %d\n", fd, (void *)iov, iovcnt);
+    if ((iov == NULL) || (iovcnt < 0)) {
+        return -EINVAL;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_RDONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for reading */
+        return -EBADF;
+    }
+    if (filp->f_op->readv != NULL) {
+        return filp->f_op->readv(filp, iov, iovcnt);
+    }
+    if (filp->f_op->read == NULL) {
+        /* driver does not implement read() */
+        return -EINVAL;
+    }
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        ssize_t nbytes = filp->f_op->read(filp, iov[i].iov_base, iov[i].iov_len);
+        if (nbytes < 0) {
+            /* report the bytes already read, the error will show up again */
+            return (total > 0) ? total : nbytes;
+        }
+        total += nbytes;
+        if ((size_t)nbytes < iov[i].iov_len) {
+            /* end of file */
+            break;
+        }
+    }
+    return total;
+}
+
+ssize_t vfs_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    DEBUG_NOT_STDOUT(fd, "vfs_writev: %d, %p, %d\n", fd, (void *)iov, iovcnt);
+    if ((iov == NULL) || (iovcnt < 0)) {
+        return -EINVAL;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_WRONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for writing */
+        return -EBADF;
+    }
+    if (filp->f_op->writev != NULL) {
+        return filp->f_op->writev(filp, iov, iovcnt);
+    }
+    if (filp->f_op->write == NULL) {
+        /* driver does not implement write() */
+        return -EINVAL;
+    }
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        ssize_t nbytes = filp->f_op->write(filp, iov[i].iov_base, iov[i].iov_len);
+        if (nbytes < 0) {
+            return (total > 0) ? total : nbytes;
+        }
+        total += nbytes;
+        if ((size_t)nbytes < iov[i].iov_len) {
+            /* file system is full */
+            break;
+        }
+    }
+    return total;
+}
+
+ssize_t vfs_map(int fd, const void **ptr, size_t count)
+{
+    DEBUG("vfs_map: %d, %p, %lu\n", fd, (void *)ptr, (unsigned long)count);
+    if (ptr == NULL) {
+        return -EFAULT;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_RDONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for reading */
+        return -EBADF;
+    }
+    if (filp->f_op->map == NULL) {
+        /* contents are not memory mapped */
+        return -ENOTSUP;
+    }
+    return filp->f_op->map(filp, ptr, count);
+}
+
+#ifdef MODULE_GNRC_PKTBUF
+ssize_t vfs_sendfile(int fd, size_t count, gnrc_nettype_t type,
+                     gnrc_pktsnip_t **pkt)
+{
+    DEBUG("vfs_sendfile: %d, %lu\n", fd, (unsigned long)count);
+    if (pkt == NULL) {
+        return -EFAULT;
+    }
+    *pkt = NULL;
+    if (count == 0) {
+        return 0;
+    }
+    const void *ptr;
+    ssize_t res = vfs_map(fd, &ptr, count);
+    if (res > 0) {
+        /* copy straight from the file system's memory */
+        *pkt = gnrc_pktbuf_add(NULL, (void *)ptr, res, type);
+        if (*pkt == NULL) {
+            vfs_lseek(fd, -res, SEEK_CUR);
+            return -ENOMEM;
+        }
+        return res;
+    }
+    if (res != -ENOTSUP) {
+        return res;
+    }
+    gnrc_pktsnip_t *snip = gnrc_pktbuf_add(NULL, NULL, count, type);
+    if (snip == NULL) {
+        return -ENOMEM;
+    }
+    res = vfs_read(fd, snip->data, count);
+    if (res <= 0) {
+        gnrc_pktbuf_release(snip);
+        return res;
+    }
+    if ((size_t)res < count) {
+        /* shrinking never fails */
+        gnrc_pktbuf_realloc_data(snip, res);
+    }
+    *pkt = snip;
+    return res;
+}
+#endif
+
 int vfs_opendir(vfs_DIR *dirp, const char *dirname)
 {
     DEBUG("vfs_opendir: %p, \"%s\"\n", (void *)dirp, dirname);
@@ -419,6 +647,11 @@ int vfs_mount(vfs_mount_t *mountp)
         return -EINVAL;
     }
     mountp->mount_point_len = strlen(mountp->mount_point);
+    mountp->mount_point_hash = 0;
+    for (size_t i = 0; i < mountp->mount_point_len; i++) {
+        mountp->mount_point_hash = _mount_hash(mountp->mount_point_hash,
+                                               mountp->mount_point[i]);
+    }
     mutex_lock(&_mount_mutex);
     /* Check for the same mount in the list of mounts to avoid loops */
     clist_node_t *found = clist_find(&_vfs_mounts_list, &mountp->list_entry);
@@ -440,6 +673,8 @@ int vfs_mount(vfs_mount_t *mountp)
     }
     /* insert last in list */
     clist_rpush(&_vfs_mounts_list, &mountp->list_entry);
+    mountp->mount_child = NULL;
+    _mount_tree_insert(mountp);
     mutex_unlock(&_mount_mutex);
     DEBUG("vfs_mount: mount done\n");
     return 0;
@@ -452,33 +687,35 @@ int vfs_umount(vfs_mount_t *mountp)
     if ((mountp == NULL) || (mountp->mount_point == NULL)) {
         return -EINVAL;
     }
+    int res = 0;
     mutex_lock(&_mount_mutex);
     DEBUG("vfs_umount: -> \"%s\" open=%d\n", mountp->mount_point, atomic_load(&mountp->open_files));
     if (atomic_load(&mountp->open_files) > 0) {
-        mutex_unlock(&_mount_mutex);
-        return -EBUSY;
+        res = -EBUSY;
+        goto out;
+    }
+    if (clist_find(&_vfs_mounts_list, &mountp->list_entry) == NULL) {
+        /* not found */
+        DEBUG("vfs_umount: ERR not mounted!\n");
+        res = -EINVAL;
+        goto out;
     }
     if (mountp->fs->fs_op != NULL) {
         if (mountp->fs->fs_op->umount != NULL) {
-            int res = mountp->fs->fs_op->umount(mountp);
+            res = mountp->fs->fs_op->umount(mountp);
             if (res < 0) {
                 /* umount failed */
                 DEBUG("vfs_umount: ERR %d!\n", res);
-                mutex_unlock(&_mount_mutex);
-                return res;
+                goto out;
             }
         }
     }
-    /* find mountp in the list and remove it */
-    clist_node_t *node = clist_remove(&_vfs_mounts_list, &mountp->list_entry);
-    if (node == NULL) {
-        /* not found */
-        DEBUG("vfs_umount: ERR not mounted!\n");
-        mutex_unlock(&_mount_mutex);
-        return -EINVAL;
-    }
+    /* remove mountp from the list and the mount tree */
+    clist_remove(&_vfs_mounts_list, &mountp->list_entry);
+    _mount_tree_remove(mountp);
+out:
     mutex_unlock(&_mount_mutex);
-    return 0;
+    return res;
 }
 
 int vfs_rename(const char *from_path, const char *to_path)
@@ -813,12 +1050,13 @@ const vfs_mount_t *vfs_iterate_mounts(const vfs_mount_t *cur)
 inline static int _allocate_fd(int fd)
 {
     if (fd < 0) {
-        for (fd = 0; fd < VFS_MAX_OPEN_FILES; ++fd) {
-            if (_vfs_open_files[fd].pid == KERNEL_PID_UNDEF) {
+        for (unsigned i = 0; i < sizeof(_vfs_used_fds) / sizeof(_vfs_used_fds[0]); ++i) {
+            if (~_vfs_used_fds[i] != 0) {
+                fd = (i * VFS_FD_WORD_BITS) + bitarithm_lsb(~_vfs_used_fds[i]);
                 break;
             }
         }
-        if (fd >= VFS_MAX_OPEN_FILES) {
+        if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES)) {
             /* The _vfs_open_files array is full */
             return -ENFILE;
         }
@@ -833,6 +1071,7 @@ inline static int _allocate_fd(int fd)
          * been started. */
         pid = -1;
     }
+    _vfs_used_fds[fd / VFS_FD_WORD_BITS] |= (1U << (fd % VFS_FD_WORD_BITS));
     _vfs_open_files[fd].pid = pid;
     return fd;
 }
@@ -843,7 +1082,10 @@ inline static void _free_fd(int fd)
     if (_vfs_open_files[fd].mp != NULL) {
         atomic_fetch_sub(&_vfs_open_files[fd].mp->open_files, 1);
     }
+    mutex_lock(&_open_mutex);
     _vfs_open_files[fd].pid = KERNEL_PID_UNDEF;
+    _vfs_used_fds[fd / VFS_FD_WORD_BITS] &= ~(1U << (fd % VFS_FD_WORD_BITS));
+    mutex_unlock(&_open_mutex);
 }
 
 inline static int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *mountp, int flags, void *private_data)
@@ -861,55 +1103,140 @@ inline static int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *moun
     return fd;
 }
 
-inline static int _find_mount(vfs_mount_t **mountpp, const char *name, const char **rel_path)
+/* a mount point matches if it ends at a directory separator of the path */
+static inline bool _mount_matches(const vfs_mount_t *it, const char *name,
+                                  size_t len, uint32_t hash)
 {
-    size_t longest_match = 0;
-    size_t name_len = strlen(name);
-    mutex_lock(&_mount_mutex);
+    return (it->mount_point_len == len) && (it->mount_point_hash == hash) &&
+           (memcmp(it->mount_point, name, len) == 0);
+}
 
-    clist_node_t *node = _vfs_mounts_list.next;
-    if (node == NULL) {
-        /* list empty */
-        mutex_unlock(&_mount_mutex);
-        return -ENOENT;
-    }
-    vfs_mount_t *mountp = NULL;
-    do {
-        node = node->next;
-        vfs_mount_t *it = container_of(node, vfs_mount_t, list_entry);
-        size_t len = it->mount_point_len;
-        if (len < longest_match) {
-            /* Already found a longer prefix */
-            continue;
+static vfs_mount_t *_mount_lookup(const char *name, size_t max_len)
+{
+    vfs_mount_t *level = _vfs_mount_tree;
+    vfs_mount_t *found = NULL;
+    uint32_t hash = 0;
+
+    /* hash the path up to each directory separator and look for a mount with
+     * that exact mount point on the current level of the tree */
+    for (size_t i = 0; (i < max_len) && (level != NULL); i++) {
+        if ((i > 0) && ((name[i] == '/') || (name[i] == '\0'))) {
+            for (vfs_mount_t *it = level; it != NULL; it = it->mount_sibling) {
+                if (_mount_matches(it, name, i, hash)) {
+                    found = it;
+                    level = it->mount_child;
+                    break;
+                }
+            }
         }
-        if (len > name_len) {
-            /* path name is shorter than the mount point name */
-            continue;
+        if (name[i] == '\0') {
+            break;
         }
-        if ((len > 1) && (name[len] != '/') && (name[len] != '\0')) {
-            /* name does not have a directory separator where mount point name ends */
+        hash = _mount_hash(hash, name[i]);
+    }
+    return found;
+}
+
+/* other is below mountp if mountp's mount point is a path prefix of it */
+static inline bool _mount_is_below(const vfs_mount_t *other,
+                                   const vfs_mount_t *mountp)
+{
+    return (other->mount_point_len > mountp->mount_point_len) &&
+           (other->mount_point[mountp->mount_point_len] == '/') &&
+           (memcmp(other->mount_point, mountp->mount_point,
+                   mountp->mount_point_len) == 0);
+}
+
+static inline vfs_mount_t **_mount_tree_level(vfs_mount_t *mountp)
+{
+    vfs_mount_t *parent = _mount_lookup(mountp->mount_point,
+                                        mountp->mount_point_len);
+
+    return (parent != NULL) ? &parent->mount_child : &_vfs_mount_tree;
+}
+
+static void _mount_tree_insert(vfs_mount_t *mountp)
+{
+    mountp->mount_sibling = NULL;
+    if (mountp->mount_point_len == 1) {
+        /* "/" */
+        _vfs_root_mount = mountp;
+        return;
+    }
+    vfs_mount_t **level = _mount_tree_level(mountp);
+    vfs_mount_t **itp = level;
+    while (*itp != NULL) {
+        vfs_mount_t *it = *itp;
+        if (_mount_is_below(it, mountp)) {
+            /* move mounts below the new mount point down to it */
+            *itp = it->mount_sibling;
+            it->mount_sibling = mountp->mount_child;
+            mountp->mount_child = it;
             continue;
         }
-        if (strncmp(name, it->mount_point, len) == 0) {
-            /* mount_point is a prefix of name */
-            /* special check for mount_point == "/" */
-            if (len > 1) {
-                longest_match = len;
+        if (_mount_matches(it, mountp->mount_point, mountp->mount_point_len,
+                           mountp->mount_point_hash)) {
+            /* the new mount shadows one on the same mount point */
+            while (it->mount_child != NULL) {
+                vfs_mount_t *child = it->mount_child;
+                it->mount_child = child->mount_sibling;
+                child->mount_sibling = mountp->mount_child;
+                mountp->mount_child = child;
             }
-            mountp = it;
         }
-    } while (node != _vfs_mounts_list.next);
+        itp = &it->mount_sibling;
+    }
+    mountp->mount_sibling = *level;
+    *level = mountp;
+}
+
+static void _mount_tree_remove(vfs_mount_t *mountp)
+{
+    if (mountp == _vfs_root_mount) {
+        _vfs_root_mount = NULL;
+        return;
+    }
+    vfs_mount_t **level = _mount_tree_level(mountp);
+    for (vfs_mount_t **itp = level; *itp != NULL; itp = &(*itp)->mount_sibling) {
+        if (*itp == mountp) {
+            *itp = mountp->mount_sibling;
+            break;
+        }
+    }
+    /* reinsert the mounts below the removed mount point, they might belong
+     * to a mount it shadowed */
+    while (mountp->mount_child != NULL) {
+        vfs_mount_t *it = mountp->mount_child;
+        mountp->mount_child = it->mount_sibling;
+        _mount_tree_insert(it);
+    }
+}
+
+inline static int _find_mount(vfs_mount_t **mountpp, const char *name, const char **rel_path)
+{
+    bool root;
+    vfs_mount_t *mountp;
+
+    /* vfs_umount() checks open_files with _mount_mutex held, so a mount is
+     * either found and counted here or already gone from the tree */
+    mutex_lock(&_mount_mutex);
+    mountp = _mount_lookup(name, SIZE_MAX);
+    root = (mountp == NULL);
+    if (root) {
+        mountp = _vfs_root_mount;
+    }
+    if (mountp != NULL) {
+        /* Increment open files counter for this mount */
+        atomic_fetch_add(&mountp->open_files, 1);
+    }
+    mutex_unlock(&_mount_mutex);
     if (mountp == NULL) {
         /* not found */
-        mutex_unlock(&_mount_mutex);
         return -ENOENT;
     }
-    /* Increment open files counter for this mount */
-    atomic_fetch_add(&mountp->open_files, 1);
-    mutex_unlock(&_mount_mutex);
     *mountpp = mountp;
     if (rel_path != NULL) {
-        *rel_path = name + longest_match;
+        *rel_path = name + (root ? 0 : mountp->mount_point_len);
     }
     return 0;
 }
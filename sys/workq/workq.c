@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_workq
+ * @{
+ *
+ * @file
+ * @brief       Work queue implementation
+ *
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "irq.h"
+#include "workq.h"
+
+#if WORKQ_WORKERS
+#ifndef CPU_NATIVE
+#error "workq: worker threads are only supported on native"
+#endif
+#ifdef MODULE_PTHREAD
+#error "workq: the host threads of the workers conflict with the pthread module"
+#endif
+
+#include <err.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+
+#include "async_read.h"
+#include "native_internal.h"
+
+#define DEQUES              (WORKQ_WORKERS)
+#else
+#define DEQUES              (1U)
+#endif
+
+#if (WORKQ_DEQUE_SIZE & (WORKQ_DEQUE_SIZE - 1)) != 0
+#error "WORKQ_DEQUE_SIZE must be a power of two"
+#endif
+
+/* the owner takes jobs from the bottom, other workers steal from the top */
+typedef struct {
+    workq_job_t *jobs[WORKQ_DEQUE_SIZE];
+    unsigned top;
+    unsigned bottom;
+#if WORKQ_WORKERS
+    uint8_t lock;
+#endif
+} _deque_t;
+
+static _deque_t _deques[DEQUES];
+/* deque the next job is submitted to */
+static unsigned _next;
+
+#if WORKQ_WORKERS
+/* jobs in all deques, for idle workers */
+static unsigned _queued;
+static pthread_mutex_t _idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _idle_cond = PTHREAD_COND_INITIALIZER;
+/* workers report finished batches to RIOT through this pipe */
+static int _pipe[2];
+#endif
+
+/* RIOT threads disable interrupts in addition, so they are neither switched
+ * away from while holding the lock nor run RIOT code in a signal handler on
+ * top of it. Workers must not call into RIOT at all. */
+static unsigned _lock(_deque_t *deque, bool riot)
+{
+    unsigned state = riot ? irq_disable() : 0;
+
+#if WORKQ_WORKERS
+    while (__atomic_test_and_set(&deque->lock, __ATOMIC_ACQUIRE)) {}
+#else
+    (void)deque;
+#endif
+    return state;
+}
+
+static void _unlock(_deque_t *deque, bool riot, unsigned state)
+{
+#if WORKQ_WORKERS
+    __atomic_clear(&deque->lock, __ATOMIC_RELEASE);
+#else
+    (void)deque;
+#endif
+    if (riot) {
+        irq_restore(state);
+    }
+}
+
+static bool _push(_deque_t *deque, workq_job_t *job)
+{
+    bool res = false;
+    unsigned state = _lock(deque, true);
+
+    if (deque->bottom - deque->top < WORKQ_DEQUE_SIZE) {
+        deque->jobs[deque->bottom++ & (WORKQ_DEQUE_SIZE - 1)] = job;
+#if WORKQ_WORKERS
+        __atomic_add_fetch(&_queued, 1, __ATOMIC_RELEASE);
+#endif
+        res = true;
+    }
+    _unlock(deque, true, state);
+    return res;
+}
+
+static workq_job_t *_pop(_deque_t *deque, bool riot, bool steal)
+{
+    workq_job_t *job = NULL;
+    unsigned state = _lock(deque, riot);
+
+    if (deque->bottom != deque->top) {
+        if (steal) {
+            job = deque->jobs[deque->top++ & (WORKQ_DEQUE_SIZE - 1)];
+        }
+        else {
+            job = deque->jobs[--deque->bottom & (WORKQ_DEQUE_SIZE - 1)];
+        }
+#if WORKQ_WORKERS
+        __atomic_sub_fetch(&_queued, 1, __ATOMIC_RELAXED);
+#endif
+    }
+    _unlock(deque, riot, state);
+    return job;
+}
+
+/* takes a job from the deque of @p self, or steals one from the others */
+static workq_job_t *_take(unsigned self, bool riot)
+{
+    workq_job_t *job = NULL;
+
+    if (self < DEQUES) {
+        job = _pop(&_deques[self], riot, false);
+    }
+    for (unsigned i = 1; !job && (i <= DEQUES); i++) {
+        job = _pop(&_deques[(self + i) % DEQUES], riot, true);
+    }
+    return job;
+}
+
+static void _run(workq_job_t *job, bool riot)
+{
+    /* the job may be gone once the batch is finished */
+    workq_batch_t *batch = job->batch;
+
+    job->fn(job->arg);
+    if (__atomic_sub_fetch(&batch->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        if (riot) {
+            mutex_unlock(&batch->done);
+        }
+#if WORKQ_WORKERS
+        else if (real_write(_pipe[1], &batch, sizeof(batch)) != sizeof(batch)) {
+            err(EXIT_FAILURE, "workq: write");
+        }
+#endif
+    }
+}
+
+#if WORKQ_WORKERS
+static void _wake(void)
+{
+    unsigned state = irq_disable();
+
+    pthread_mutex_lock(&_idle_lock);
+    pthread_cond_signal(&_idle_cond);
+    pthread_mutex_unlock(&_idle_lock);
+    irq_restore(state);
+}
+
+static void _finished_isr(int fd, void *arg)
+{
+    workq_batch_t *batch;
+
+    (void)arg;
+    while (real_read(fd, &batch, sizeof(batch)) == sizeof(batch)) {
+        mutex_unlock(&batch->done);
+    }
+    native_async_read_continue(fd);
+}
+
+static void *_worker(void *arg)
+{
+    unsigned self = (uintptr_t)arg;
+
+    while (1) {
+        workq_job_t *job = _take(self, false);
+        if (job) {
+            _run(job, false);
+            continue;
+        }
+        pthread_mutex_lock(&_idle_lock);
+        while (!__atomic_load_n(&_queued, __ATOMIC_ACQUIRE)) {
+            pthread_cond_wait(&_idle_cond, &_idle_lock);
+        }
+        pthread_mutex_unlock(&_idle_lock);
+    }
+    return NULL;
+}
+#endif
+
+void workq_init(void)
+{
+#if WORKQ_WORKERS
+    if (real_pipe(_pipe) == -1) {
+        err(EXIT_FAILURE, "workq: pipe");
+    }
+    native_async_read_setup();
+    native_async_read_add_handler(_pipe[0], NULL, _finished_isr);
+
+    /* RIOT's interrupts are signals, which must only be handled by the
+     * thread running RIOT */
+    sigset_t all, old;
+    sigfillset(&all);
+    unsigned state = irq_disable();
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    for (unsigned i = 0; i < WORKQ_WORKERS; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, _worker, (void *)(uintptr_t)i)) {
+            err(EXIT_FAILURE, "workq: pthread_create");
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    irq_restore(state);
+#endif
+}
+
+void workq_batch_init(workq_batch_t *batch)
+{
+    batch->pending = 1;
+    batch->done = (mutex_t)MUTEX_INIT_LOCKED;
+}
+
+void workq_submit(workq_batch_t *batch, workq_job_t *job,
+                  void (*fn)(void *arg), void *arg)
+{
+    job->fn = fn;
+    job->arg = arg;
+    job->batch = batch;
+    __atomic_add_fetch(&batch->pending, 1, __ATOMIC_RELAXED);
+
+    for (unsigned i = 0; i < DEQUES; i++) {
+        if (_push(&_deques[_next++ % DEQUES], job)) {
+#if WORKQ_WORKERS
+            _wake();
+#endif
+            return;
+        }
+    }
+    /* all deques are full */
+    _run(job, true);
+}
+
+void workq_wait(workq_batch_t *batch)
+{
+    workq_job_t *job;
+
+    while ((__atomic_load_n(&batch->pending, __ATOMIC_ACQUIRE) > 1) &&
+           (job = _take(DEQUES, true))) {
+        _run(job, true);
+    }
+    if (__atomic_sub_fetch(&batch->pending, 1, __ATOMIC_ACQ_REL)) {
+        /* unlocked by whoever finishes the last job */
+        mutex_lock(&batch->done);
+    }
+}
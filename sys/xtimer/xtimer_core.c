@@ -286,6 +286,20 @@ void xtimer_remove(xtimer_t *timer)
     irq_restore(state);
 }
 
+xtimer_ticks32_t xtimer_next_event(void)
+{
+    unsigned state = irq_disable();
+    /* timers of later periods are in the overflow and long lists, they wait
+     * for the callback at the end of the current period */
+    uint32_t target = timer_list_head ?
+                      _xtimer_lltimer_mask(timer_list_head->target) :
+                      _xtimer_lltimer_mask(0xFFFFFFFF);
+    uint32_t left = _time_left(target, 0);
+
+    irq_restore(state);
+    return xtimer_ticks(left);
+}
+
 static uint32_t _time_left(uint32_t target, uint32_t reference)
 {
     uint32_t now = _xtimer_lltimer_now();
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Event queue test and latency benchmark
+ *
+ * Checks posting, coalescing, cancelling, callback events, timeouts and the
+ * shared event thread. Then compares the time to post an event to a waiting
+ * thread and have it handled with the time to send a message to a thread
+ * waiting in msg_receive().
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "event.h"
+#include "event/callback.h"
+#include "event/thread.h"
+#include "event/timeout.h"
+#include "msg.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define BENCH_LOOPS         (1000U)
+#define TIMEOUT_US          (10U * US_PER_MS)
+
+static char _stack[THREAD_STACKSIZE_MAIN];
+
+static event_queue_t _queue;
+static event_queue_t *_bench_queue;
+static unsigned _handled;
+static int _failed;
+
+static void _handler(event_t *event)
+{
+    (void)event;
+    _handled++;
+}
+
+static event_t _event = { .handler = _handler };
+static event_t _other = { .handler = _handler };
+
+static void _callback(void *arg)
+{
+    *(unsigned *)arg += 1;
+}
+
+static event_callback_t _event_callback = EVENT_CALLBACK_INIT(_callback,
+                                                              &_handled);
+
+static void _check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        _failed = 1;
+    }
+}
+
+static void _test_queue(void)
+{
+    event_queue_init(&_queue);
+
+    event_post(&_queue, &_event);
+    event_post(&_queue, &_other);
+    event_post(&_queue, &_event);
+    _check(event_get(&_queue) == &_event, "post");
+    _check(event_get(&_queue) == &_other, "order");
+    _check(event_get(&_queue) == NULL, "coalesce");
+
+    event_post(&_queue, &_event);
+    event_post(&_queue, &_other);
+    event_cancel(&_queue, &_event);
+    _check(event_get(&_queue) == &_other, "cancel");
+    _check(event_get(&_queue) == NULL, "cancel empty");
+    event_post(&_queue, &_event);
+    _check(event_get(&_queue) == &_event, "post after cancel");
+
+    _handled = 0;
+    event_post(&_queue, &_event_callback.super);
+    event_t *event = event_wait(&_queue);
+    event->handler(event);
+    _check(_handled == 1, "callback");
+}
+
+static void _test_timeout(void)
+{
+    event_timeout_t timeout;
+
+    event_timeout_init(&timeout, &_queue, &_event);
+    uint32_t start = xtimer_now_usec();
+    event_timeout_set(&timeout, TIMEOUT_US);
+    _check(event_wait(&_queue) == &_event, "timeout event");
+    uint32_t elapsed = xtimer_now_usec() - start;
+    _check(elapsed >= TIMEOUT_US, "timeout too early");
+
+    event_timeout_set(&timeout, TIMEOUT_US);
+    event_timeout_clear(&timeout);
+    xtimer_usleep(2 * TIMEOUT_US);
+    _check(event_get(&_queue) == NULL, "timeout clear");
+}
+
+static void _test_thread(void)
+{
+    /* the event thread has a higher priority, so the event is handled
+     * before event_post() returns */
+    _handled = 0;
+    event_post(&event_thread_queue, &_event);
+    _check(_handled == 1, "event thread");
+}
+
+static void *_bench_thread(void *arg)
+{
+    event_queue_t queue;
+
+    (void)arg;
+    event_queue_init(&queue);
+    _bench_queue = &queue;
+
+    while (1) {
+        /* handle events and messages alike */
+        thread_flags_t flags = thread_flags_wait_any(THREAD_FLAG_EVENT |
+                                                     THREAD_FLAG_MSG_WAITING);
+        if (flags & THREAD_FLAG_EVENT) {
+            event_t *event;
+            while ((event = event_get(&queue))) {
+                event->handler(event);
+            }
+        }
+        if (flags & THREAD_FLAG_MSG_WAITING) {
+            msg_t msg;
+            while (msg_try_receive(&msg) == 1) {
+                _handled++;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void _bench(void)
+{
+    kernel_pid_t pid = thread_create(_stack, sizeof(_stack),
+                                     THREAD_PRIORITY_MAIN - 1,
+                                     THREAD_CREATE_STACKTEST, _bench_thread,
+                                     NULL, "bench");
+    uint32_t start, event_time, msg_time;
+    msg_t msg;
+
+    _handled = 0;
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        event_post(_bench_queue, &_event);
+    }
+    event_time = xtimer_now_usec() - start;
+    _check(_handled == BENCH_LOOPS, "bench events");
+
+    _handled = 0;
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        msg_send(&msg, pid);
+    }
+    msg_time = xtimer_now_usec() - start;
+    _check(_handled == BENCH_LOOPS, "bench messages");
+
+    printf("event_post() and dispatch: %" PRIu32 " ns\n",
+           (uint32_t)((uint64_t)event_time * 1000 / BENCH_LOOPS));
+    printf("msg_send() and receive: %" PRIu32 " ns\n",
+           (uint32_t)((uint64_t)msg_time * 1000 / BENCH_LOOPS));
+}
+
+int main(void)
+{
+    puts("event test");
+
+    _test_queue();
+    _test_timeout();
+    _test_thread();
+    _bench();
+
+    puts(_failed ? "[FAILED]" : "[SUCCESS]");
+    return 0;
+}
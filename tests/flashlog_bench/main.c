@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compares appending records with flashlog and with spiffs
+ *
+ * Both write the same records to the same region of the native mtd device,
+ * persisting them every FLUSH_EVERY records. The number of bytes programmed
+ * and of erased sectors is counted by a wrapper device.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "board.h"
+#include "flashlog.h"
+#include "fs/spiffs_fs.h"
+#include "mtd.h"
+#include "vfs.h"
+#include "xtimer.h"
+
+/* part of MTD_0 that is used */
+#define BENCH_SECTORS   (64U)
+#define RECORDS         (4096U)
+#define RECORD_SIZE     (16U)
+#define FLUSH_EVERY     (16U)
+#define PAGE_SIZE_MAX   (256U)
+
+static struct {
+    uint32_t programmed;
+    uint32_t erases;
+} _count;
+
+static int _init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int _read(mtd_dev_t *dev, void *dest, uint32_t addr, uint32_t size)
+{
+    (void)dev;
+    return mtd_read(MTD_0, dest, addr, size);
+}
+
+static int _write(mtd_dev_t *dev, const void *src, uint32_t addr,
+                  uint32_t size)
+{
+    (void)dev;
+    _count.programmed += size;
+    return mtd_write(MTD_0, src, addr, size);
+}
+
+static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
+{
+    _count.erases += size / (dev->pages_per_sector * dev->page_size);
+    return mtd_erase(MTD_0, addr, size);
+}
+
+static const mtd_desc_t _count_driver = {
+    .init = _init,
+    .read = _read,
+    .write = _write,
+    .erase = _erase,
+};
+
+static mtd_dev_t _dev = {
+    .driver = &_count_driver,
+    .sector_count = BENCH_SECTORS,
+};
+
+static uint8_t _page_buf[PAGE_SIZE_MAX];
+static flashlog_sector_t _sectors[BENCH_SECTORS];
+static flashlog_t _log = {
+    .mtd = &_dev,
+    .page_buf = _page_buf,
+    .sectors = _sectors,
+};
+
+static struct spiffs_desc _spiffs_desc = {
+    .lock = MUTEX_INIT,
+};
+
+static vfs_mount_t _spiffs_mount = {
+    .fs = &spiffs_file_system,
+    .mount_point = "/bench",
+    .private_data = &_spiffs_desc,
+};
+
+static uint8_t _record[RECORD_SIZE];
+
+static void _reset(void)
+{
+    mtd_erase(&_dev, 0, BENCH_SECTORS * _dev.pages_per_sector * _dev.page_size);
+    memset(&_count, 0, sizeof(_count));
+}
+
+static void _print(const char *name, uint32_t time)
+{
+    printf("+ %s: %" PRIu32 " appends/s, %" PRIu32 " bytes programmed, "
+           "%" PRIu32 " erases\n", name,
+           (uint32_t)(((uint64_t)RECORDS * US_PER_SEC) / (time ? time : 1)),
+           _count.programmed, _count.erases);
+}
+
+static int _bench_flashlog(void)
+{
+    uint32_t start;
+    int res;
+
+    _reset();
+    if ((res = flashlog_mount(&_log)) < 0) {
+        return res;
+    }
+    start = xtimer_now_usec();
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        if ((res = flashlog_append(&_log, i, _record, sizeof(_record))) < 0) {
+            return res;
+        }
+        if (((i + 1) % FLUSH_EVERY) == 0) {
+            flashlog_flush(&_log);
+        }
+    }
+    _print("flashlog", xtimer_now_usec() - start);
+    return 0;
+}
+
+static int _bench_spiffs(void)
+{
+    uint32_t start;
+    int fd, res = 0;
+
+    _reset();
+    _spiffs_desc.dev = &_dev;
+    if ((res = vfs_mount(&_spiffs_mount)) < 0) {
+        return res;
+    }
+    start = xtimer_now_usec();
+    for (uint32_t i = 0; i < RECORDS; i += FLUSH_EVERY) {
+        /* spiffs writes its buffered data on close */
+        fd = vfs_open("/bench/log", O_CREAT | O_WRONLY | O_APPEND, 0);
+        if (fd < 0) {
+            res = fd;
+            break;
+        }
+        for (uint32_t j = i; j < i + FLUSH_EVERY; j++) {
+            /* same payload as a flashlog record: timestamp and data */
+            if (((res = vfs_write(fd, &j, sizeof(j))) < 0) ||
+                ((res = vfs_write(fd, _record, sizeof(_record))) < 0)) {
+                break;
+            }
+        }
+        vfs_close(fd);
+        if (res < 0) {
+            break;
+        }
+    }
+    if (res >= 0) {
+        _print("spiffs", xtimer_now_usec() - start);
+        res = 0;
+    }
+    vfs_umount(&_spiffs_mount);
+    return res;
+}
+
+int main(void)
+{
+    int res;
+
+    mtd_init(MTD_0);
+    _dev.pages_per_sector = MTD_0->pages_per_sector;
+    _dev.page_size = MTD_0->page_size;
+    if (_dev.page_size > sizeof(_page_buf)) {
+        puts("page size not supported");
+        return 1;
+    }
+    memset(_record, 0x5a, sizeof(_record));
+
+    printf("%u records of %u bytes, persisted every %u records\n", RECORDS,
+           RECORD_SIZE, FLUSH_EVERY);
+    puts("Start.");
+    if ((res = _bench_flashlog()) < 0) {
+        printf("flashlog failed: %d\n", res);
+    }
+    if ((res = _bench_spiffs()) < 0) {
+        printf("spiffs failed: %d\n", res);
+    }
+    puts("Done.");
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the decimal conversions of fmt against the C library
+ *
+ * Every conversion is run on the same pseudo random values, shifted to spread
+ * them over all lengths. The time per call is printed in ns and, on boards
+ * that define CLOCK_CORECLOCK, in CPU cycles.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fmt.h"
+#include "periph_conf.h"
+#include "xtimer.h"
+
+#define CALLS           (4096U)
+
+static uint32_t _vals[CALLS];
+static char _strs[CALLS][12];
+static char _buf[24];
+/* keeps the results alive */
+static volatile uint32_t _sink;
+
+static void _print(const char *name, uint32_t time)
+{
+    uint32_t ns = (uint32_t)(((uint64_t)time * 1000) / CALLS);
+
+#ifdef CLOCK_CORECLOCK
+    printf("+ %s: %" PRIu32 " ns, %" PRIu32 " cycles\n", name, ns,
+           (uint32_t)(((uint64_t)ns * (CLOCK_CORECLOCK / 1000)) / US_PER_SEC));
+#else
+    printf("+ %s: %" PRIu32 " ns\n", name, ns);
+#endif
+}
+
+int main(void)
+{
+    uint32_t state = 0x12345678;
+    uint32_t start;
+
+    for (unsigned i = 0; i < CALLS; i++) {
+        /* xorshift32 */
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        _vals[i] = state >> (state % 32);
+        _strs[i][fmt_u32_dec(_strs[i], _vals[i])] = '\0';
+    }
+
+    printf("time per call, average over %u values\n", CALLS);
+    puts("Start.");
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        _sink += fmt_u32_dec(_buf, _vals[i]);
+    }
+    _print("fmt_u32_dec", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        _sink += snprintf(_buf, sizeof(_buf), "%" PRIu32, _vals[i]);
+    }
+    _print("snprintf", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        /* a microsecond timestamp of a device that runs for days */
+        _sink += fmt_u64_dec(_buf, ((uint64_t)_vals[i] << 8) | i);
+    }
+    _print("fmt_u64_dec", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        _sink += fmt_s32_dfp(_buf, (int32_t)_vals[i], 3);
+    }
+    _print("fmt_s32_dfp", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        _sink += scn_u32_dec(_strs[i], sizeof(_strs[i]));
+    }
+    _print("scn_u32_dec", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < CALLS; i++) {
+        _sink += strtoul(_strs[i], NULL, 10);
+    }
+    _print("strtoul", xtimer_now_usec() - start);
+
+    puts("Done.");
+    return 0;
+}
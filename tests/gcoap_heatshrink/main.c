@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Airtime saved vs. CPU cost of gcoap payload compression
+ *
+ * Builds CoAP PDUs with typical JSON and SenML payloads, with and without
+ * compression, and reads them back. Prints the size of each PDU, the time
+ * to compress and decompress the payload, and the airtime saved on an
+ * IEEE 802.15.4 and on a LoRa link.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/gcoap.h"
+#include "xtimer.h"
+
+#define BENCH_LOOPS         (100U)
+
+/* SenML JSON, RFC 8428 */
+#define FORMAT_SENML_JSON   (110U)
+
+/* IEEE 802.15.4 O-QPSK at 250 kbit/s; sizes of the PHY header, the MAC
+ * header and FCS with short addresses, 6LoWPAN IPHC and UDP NHC, and the
+ * 6LoWPAN fragment header */
+#define IEEE802154_US_PER_BYTE  (32U)
+#define IEEE802154_FRAME_MAX    (127U)
+#define IEEE802154_PHY_HDR      (6U)
+#define IEEE802154_MAC_HDR      (13U)
+#define LOWPAN_HDR              (10U)
+#define LOWPAN_FRAG_HDR         (5U)
+
+/* LoRa SF9, 125 kHz, CR 4/5, 8 symbols preamble, explicit header, CRC */
+#define LORA_SF                 (9U)
+#define LORA_US_PER_SYMBOL      ((1U << LORA_SF) * 1000U / 125U)
+#define LORA_CR                 (1U)
+#define LORA_PREAMBLE           (8U)
+
+typedef struct {
+    const char *name;
+    unsigned format;
+    const char *payload;
+} _payload_t;
+
+static const _payload_t _payloads[] = {
+    { "senml", FORMAT_SENML_JSON,
+      "[{\"bn\":\"urn:dev:ow:10e2073a01080063:\",\"n\":\"temp\",\"u\":\"Cel\","
+      "\"v\":23.1,\"t\":1.276020076e+09}]" },
+    { "senml-pack", FORMAT_SENML_JSON,
+      "[{\"bn\":\"urn:dev:ow:10e2073a01080063:\",\"bt\":1.276020076e+09,"
+      "\"bu\":\"A\",\"bver\":5},{\"n\":\"voltage\",\"u\":\"V\",\"v\":120.1},"
+      "{\"n\":\"current\",\"t\":-5,\"v\":1.2},{\"n\":\"current\",\"t\":-4,"
+      "\"v\":1.3},{\"n\":\"current\",\"t\":-3,\"v\":1.4}]" },
+    { "status", COAP_FORMAT_JSON,
+      "{\"uptime\":86400,\"rssi\":-87,\"lqi\":212,\"battery\":3012,"
+      "\"fw\":\"2017.10\",\"neighbors\":[\"fe80::1\",\"fe80::2\","
+      "\"fe80::3\"]}" },
+    { "short", COAP_FORMAT_JSON, "{\"v\":21.5}" },
+};
+
+static uint8_t _pdu_buf[GCOAP_PDU_BUF_SIZE];
+static uint8_t _payload_buf[GCOAP_PDU_BUF_SIZE];
+
+/* airtime of a CoAP message, fragmented if needed */
+static uint32_t _airtime_802154(size_t len)
+{
+    unsigned frame_hdr = IEEE802154_PHY_HDR + IEEE802154_MAC_HDR;
+    size_t frames = 1;
+
+    len += LOWPAN_HDR;
+    if (len > IEEE802154_FRAME_MAX - IEEE802154_MAC_HDR) {
+        /* fragment payloads are a multiple of 8 bytes */
+        size_t frag = (IEEE802154_FRAME_MAX - IEEE802154_MAC_HDR
+                       - LOWPAN_FRAG_HDR) & ~0x7U;
+        frames = (len + frag - 1) / frag;
+        frame_hdr += LOWPAN_FRAG_HDR;
+    }
+    return (frames * frame_hdr + len) * IEEE802154_US_PER_BYTE;
+}
+
+/* same formula as sx127x_get_time_on_air() */
+static uint32_t _airtime_lora(size_t len)
+{
+    int bits = 8 * (len + LOWPAN_HDR) - 4 * LORA_SF + 28 + 16 - 20;
+    uint32_t symbols = 8;
+
+    if (bits > 0) {
+        symbols += (bits + 4 * LORA_SF - 1) / (4 * LORA_SF) * (LORA_CR + 4);
+    }
+    /* preamble takes 4.25 symbols more */
+    return (4 * LORA_PREAMBLE + 17) * LORA_US_PER_SYMBOL / 4
+           + symbols * LORA_US_PER_SYMBOL;
+}
+
+static ssize_t _build(const _payload_t *p, bool compress)
+{
+    coap_pkt_t pdu;
+    size_t len = strlen(p->payload);
+
+    gcoap_req_init(&pdu, _pdu_buf, sizeof(_pdu_buf), COAP_METHOD_POST, "/s");
+    memcpy(pdu.payload, p->payload, len);
+    if (compress) {
+        return gcoap_finish_compressed(&pdu, len, p->format);
+    }
+    return gcoap_finish(&pdu, len, p->format);
+}
+
+static int _bench(const _payload_t *p)
+{
+    uint32_t start, plain_time, compress_time, read_time, copy_time;
+    ssize_t plain_len = 0, len = 0;
+    unsigned format = COAP_FORMAT_NONE;
+    coap_pkt_t pdu;
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        plain_len = _build(p, false);
+    }
+    plain_time = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        len = _build(p, true);
+    }
+    compress_time = xtimer_now_usec() - start;
+
+    if (coap_parse(&pdu, _pdu_buf, len) < 0) {
+        printf("%s: cannot parse PDU\n", p->name);
+        return -1;
+    }
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        gcoap_get_payload(&pdu, _payload_buf, sizeof(_payload_buf), &format);
+    }
+    read_time = xtimer_now_usec() - start;
+
+    ssize_t payload_len = gcoap_get_payload(&pdu, _payload_buf,
+                                            sizeof(_payload_buf), &format);
+    if ((payload_len != (ssize_t)strlen(p->payload))
+            || memcmp(_payload_buf, p->payload, payload_len)
+            || (format != p->format)) {
+        printf("%s: payload differs\n", p->name);
+        return -1;
+    }
+
+    /* the uncompressed PDU, to subtract the cost of copying */
+    _build(p, false);
+    coap_parse(&pdu, _pdu_buf, plain_len);
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        gcoap_get_payload(&pdu, _payload_buf, sizeof(_payload_buf), &format);
+    }
+    copy_time = xtimer_now_usec() - start;
+
+    printf("%s: %i -> %i bytes, compress %" PRIi32 " us, "
+           "decompress %" PRIi32 " us, airtime saved: "
+           "802.15.4 %" PRIi32 " us, LoRa SF%u %" PRIi32 " us\n",
+           p->name, (int)plain_len, (int)len,
+           (int32_t)(compress_time - plain_time) / (int32_t)BENCH_LOOPS,
+           (int32_t)(read_time - copy_time) / (int32_t)BENCH_LOOPS,
+           (int32_t)(_airtime_802154(plain_len) - _airtime_802154(len)),
+           LORA_SF, (int32_t)(_airtime_lora(plain_len) - _airtime_lora(len)));
+    return 0;
+}
+
+int main(void)
+{
+    int res = 0;
+
+    puts("gcoap heatshrink benchmark");
+
+    for (unsigned i = 0; i < sizeof(_payloads) / sizeof(_payloads[0]); i++) {
+        res |= _bench(&_payloads[i]);
+    }
+    puts(res ? "[FAILED]" : "[SUCCESS]");
+    return 0;
+}
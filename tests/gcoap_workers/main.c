@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Latency test for gcoap with slow and fast resources
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "net/gcoap.h"
+#include "net/ipv6/addr.h"
+#include "xtimer.h"
+
+#define SLOW_DELAY          (500U * US_PER_MS)
+#define FAST_REQ_NUMOF      (3U)
+
+static ssize_t _slow_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+static ssize_t _fast_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len);
+
+/* resources must be in alphabetical order */
+static const coap_resource_t _resources[] = {
+    { "/fast", COAP_GET, _fast_handler },
+    { "/slow", COAP_GET, _slow_handler },
+};
+
+static gcoap_listener_t _listener = {
+    (coap_resource_t *)&_resources[0],
+    sizeof(_resources) / sizeof(_resources[0]),
+    NULL
+};
+
+static uint32_t _start;
+static uint32_t _slow_latency;
+static uint32_t _fast_latency_max;
+static unsigned _resp_count;
+static kernel_pid_t _main_pid;
+
+static ssize_t _respond(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                        const char *name)
+{
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    size_t payload_len = strlen(name);
+    memcpy(pdu->payload, name, payload_len);
+    return gcoap_finish(pdu, payload_len, COAP_FORMAT_TEXT);
+}
+
+static ssize_t _slow_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    /* e.g. a sensor read over a slow bus */
+    xtimer_usleep(SLOW_DELAY);
+    return _respond(pdu, buf, len, "slow");
+}
+
+static ssize_t _fast_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len)
+{
+    return _respond(pdu, buf, len, "fast");
+}
+
+static void _resp_handler(unsigned req_state, coap_pkt_t *pdu,
+                          sock_udp_ep_t *remote)
+{
+    (void)remote;
+    uint32_t latency = xtimer_now_usec() - _start;
+
+    if (req_state != GCOAP_MEMO_RESP) {
+        puts("error: no response");
+    }
+    else if (pdu->payload_len && pdu->payload[0] == 's') {
+        _slow_latency = latency;
+        printf("slow: %" PRIu32 " us\n", latency);
+    }
+    else {
+        if (latency > _fast_latency_max) {
+            _fast_latency_max = latency;
+        }
+        printf("fast: %" PRIu32 " us\n", latency);
+    }
+
+    if (++_resp_count == FAST_REQ_NUMOF + 1) {
+        thread_wakeup(_main_pid);
+    }
+}
+
+static void _send(const sock_udp_ep_t *remote, char *path)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+
+    ssize_t len = gcoap_request(&pdu, buf, sizeof(buf), COAP_METHOD_GET, path);
+    if (len <= 0 || gcoap_req_send2(buf, len, remote, _resp_handler) == 0) {
+        printf("error: cannot send request for %s\n", path);
+    }
+}
+
+int main(void)
+{
+    sock_udp_ep_t remote = { .family = AF_INET6, .netif = SOCK_ADDR_ANY_NETIF,
+                             .port = GCOAP_PORT };
+
+    puts("gcoap worker latency test");
+
+    _main_pid = thread_getpid();
+    ipv6_addr_set_loopback((ipv6_addr_t *)&remote.addr.ipv6);
+    gcoap_register_listener(&_listener);
+
+    _start = xtimer_now_usec();
+    _send(&remote, "/slow");
+    for (unsigned i = 0; i < FAST_REQ_NUMOF; i++) {
+        _send(&remote, "/fast");
+    }
+
+    thread_sleep();
+
+    if (_fast_latency_max < _slow_latency) {
+        puts("[SUCCESS]");
+    }
+    else {
+        puts("[FAILED] fast requests waited for the slow handler");
+    }
+    return 0;
+}
@@ -22,7 +22,10 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/sock.h"
 #include "net/sock/udp.h"
+#include "thread.h"
 #include "xtimer.h"
 
 #include "constants.h"
@@ -379,6 +382,170 @@ static void test_sock_udp_recv__non_blocking(void)
     assert(_check_net());
 }
 
+static void test_sock_udp_recv_many__EAGAIN(void)
+{
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    sock_udp_msg_t msgs[2] = { { .data = _test_buffer,
+                                 .len = sizeof(_test_buffer) } };
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(-EAGAIN == sock_udp_recv_many(&_sock, msgs, 2, 0));
+    assert(_check_net());
+}
+
+static void test_sock_udp_recv_many__multiple(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    static uint8_t buffers[4][8];
+    sock_udp_msg_t msgs[4];
+
+    for (unsigned i = 0; i < 4; i++) {
+        msgs[i].data = buffers[i];
+        msgs[i].len = sizeof(buffers[i]);
+    }
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    /* too large for its buffer; dropped */
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "0123456789", sizeof("0123456789"),
+                          _TEST_NETIF));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE + 1,
+                          _TEST_PORT_LOCAL, "EFG", sizeof("EFG"),
+                          _TEST_NETIF));
+    assert(2 == sock_udp_recv_many(&_sock, msgs, 4, SOCK_NO_TIMEOUT));
+    assert(sizeof("ABCD") == msgs[0].len);
+    assert(memcmp("ABCD", buffers[0], sizeof("ABCD")) == 0);
+    assert(_TEST_PORT_REMOTE == msgs[0].remote.port);
+    assert(sizeof("EFG") == msgs[1].len);
+    assert(memcmp("EFG", buffers[1], sizeof("EFG")) == 0);
+    assert((_TEST_PORT_REMOTE + 1) == msgs[1].remote.port);
+    assert(memcmp(&msgs[1].remote.addr, &src_addr, sizeof(src_addr)) == 0);
+    assert(_check_net());
+}
+
+static void test_sock_udp_recv_pkt__socketed(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    gnrc_pktsnip_t *pkt;
+    sock_udp_ep_t result;
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(sizeof("ABCD") == gnrc_sock_udp_recv_pkt(&_sock, &pkt,
+                                                    SOCK_NO_TIMEOUT, &result));
+    assert(memcmp("ABCD", pkt->data, sizeof("ABCD")) == 0);
+    assert(_TEST_PORT_REMOTE == result.port);
+    assert(!_check_net());  /* packet still held by the application */
+    gnrc_pktbuf_release(pkt);
+    assert(_check_net());
+}
+
+static void test_sock_udp_set_queue__deep(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    static msg_t queue[2 * SOCK_MBOX_SIZE];
+    sock_udp_msg_t msgs[2 * SOCK_MBOX_SIZE];
+
+    for (unsigned i = 0; i < (2 * SOCK_MBOX_SIZE); i++) {
+        msgs[i].data = _test_buffer;
+        msgs[i].len = sizeof(_test_buffer);
+    }
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(0 == gnrc_sock_udp_set_queue(&_sock, queue, 2 * SOCK_MBOX_SIZE));
+    for (unsigned i = 0; i < (SOCK_MBOX_SIZE + 1); i++) {
+        assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                              _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                              _TEST_NETIF));
+    }
+    assert((SOCK_MBOX_SIZE + 1) == sock_udp_recv_many(&_sock, msgs,
+                                                      2 * SOCK_MBOX_SIZE,
+                                                      SOCK_NO_TIMEOUT));
+    assert(_check_net());
+}
+
+#ifdef MODULE_GNRC_SOCK_ASYNC
+static unsigned _async_cb_calls;
+
+static void _async_cb(sock_udp_t *sock, void *arg)
+{
+    assert(sock == &_sock);
+    assert(arg == _test_buffer);
+    _async_cb_calls++;
+}
+
+static void test_sock_udp_set_cb__EADDRNOTAVAIL(void)
+{
+    assert(0 == sock_udp_create(&_sock, NULL, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(-EADDRNOTAVAIL == gnrc_sock_udp_set_cb(&_sock, _async_cb,
+                                                  _test_buffer));
+}
+
+static void test_sock_udp_set_cb__recv(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+
+    _async_cb_calls = 0;
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(0 == gnrc_sock_udp_set_cb(&_sock, _async_cb, _test_buffer));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(1 == _async_cb_calls);
+    assert(sizeof("ABCD") == sock_udp_recv(&_sock, _test_buffer,
+                                           sizeof(_test_buffer), 0, NULL));
+    assert(-EAGAIN == sock_udp_recv(&_sock, _test_buffer,
+                                    sizeof(_test_buffer), 0, NULL));
+    /* removed callback is not called anymore */
+    assert(0 == gnrc_sock_udp_set_cb(&_sock, NULL, NULL));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(1 == _async_cb_calls);
+    assert(sizeof("ABCD") == sock_udp_recv(&_sock, _test_buffer,
+                                           sizeof(_test_buffer), 0, NULL));
+    assert(_check_net());
+}
+
+static void test_sock_udp_set_notify__recv(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    msg_t msg;
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(0 == gnrc_sock_udp_set_notify(&_sock, thread_getpid()));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(1 == msg_try_receive(&msg));
+    assert(GNRC_SOCK_MSG_TYPE_RECV == msg.type);
+    assert(&_sock == msg.content.ptr);
+    assert(sizeof("ABCD") == sock_udp_recv(msg.content.ptr, _test_buffer,
+                                           sizeof(_test_buffer), 0, NULL));
+    assert(-1 == msg_try_receive(&msg));
+    assert(_check_net());
+}
+#endif
+
 static void test_sock_udp_send__EAFNOSUPPORT(void)
 {
     static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
@@ -540,6 +707,38 @@ static void test_sock_udp_send__socketed_other_remote(void)
     assert(_check_net());
 }
 
+static void test_sock_udp_send_many__socketed(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr2 = { .u8 = _TEST_ADDR_WRONG };
+    static const sock_udp_ep_t local = { .addr = { .ipv6 = _TEST_ADDR_LOCAL },
+                                         .family = AF_INET6,
+                                         .netif = _TEST_NETIF,
+                                         .port = _TEST_PORT_LOCAL };
+    static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
+                                          .family = AF_INET6,
+                                          .port = _TEST_PORT_REMOTE };
+    sock_udp_msg_t msgs[2] = {
+        { .data = "ABCD", .len = sizeof("ABCD") },
+        { .data = "EFG", .len = sizeof("EFG"),
+          .remote = { .addr = { .ipv6 = _TEST_ADDR_WRONG },
+                      .family = AF_INET6,
+                      .port = _TEST_PORT_REMOTE + 1 } },
+    };
+
+    assert(0 == sock_udp_create(&_sock, &local, &remote, SOCK_FLAGS_REUSE_EP));
+    assert(2 == sock_udp_send_many(&_sock, msgs, 2));
+    assert(_check_packet(&src_addr, &dst_addr, _TEST_PORT_LOCAL,
+                         _TEST_PORT_REMOTE, "ABCD", sizeof("ABCD"),
+                         _TEST_NETIF, false));
+    assert(_check_packet(&src_addr, &dst_addr2, _TEST_PORT_LOCAL,
+                         _TEST_PORT_REMOTE + 1, "EFG", sizeof("EFG"),
+                         _TEST_NETIF, false));
+    xtimer_usleep(1000);    /* let GNRC stack finish */
+    assert(_check_net());
+}
+
 static void test_sock_udp_send__unsocketed_no_local_no_netif(void)
 {
     static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_REMOTE };
@@ -680,6 +879,15 @@ int main(void)
     CALL(test_sock_udp_recv__unsocketed_with_remote());
     CALL(test_sock_udp_recv__with_timeout());
     CALL(test_sock_udp_recv__non_blocking());
+    CALL(test_sock_udp_recv_many__EAGAIN());
+    CALL(test_sock_udp_recv_many__multiple());
+    CALL(test_sock_udp_recv_pkt__socketed());
+    CALL(test_sock_udp_set_queue__deep());
+#ifdef MODULE_GNRC_SOCK_ASYNC
+    CALL(test_sock_udp_set_cb__EADDRNOTAVAIL());
+    CALL(test_sock_udp_set_cb__recv());
+    CALL(test_sock_udp_set_notify__recv());
+#endif
     _prepare_send_checks();
     CALL(test_sock_udp_send__EAFNOSUPPORT());
     CALL(test_sock_udp_send__EINVAL_addr());
@@ -691,6 +899,7 @@ int main(void)
     CALL(test_sock_udp_send__socketed_no_local());
     CALL(test_sock_udp_send__socketed());
     CALL(test_sock_udp_send__socketed_other_remote());
+    CALL(test_sock_udp_send_many__socketed());
     CALL(test_sock_udp_send__unsocketed_no_local_no_netif());
     CALL(test_sock_udp_send__unsocketed_no_netif());
     CALL(test_sock_udp_send__unsocketed_no_local());
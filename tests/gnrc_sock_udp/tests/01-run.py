@@ -37,6 +37,13 @@ def testfunc(child):
     child.expect_exact(u"Calling test_sock_udp_recv__unsocketed_with_remote()")
     child.expect_exact(u"Calling test_sock_udp_recv__with_timeout()")
     child.expect_exact(u"Calling test_sock_udp_recv__non_blocking()")
+    child.expect_exact(u"Calling test_sock_udp_recv_many__EAGAIN()")
+    child.expect_exact(u"Calling test_sock_udp_recv_many__multiple()")
+    child.expect_exact(u"Calling test_sock_udp_recv_pkt__socketed()")
+    child.expect_exact(u"Calling test_sock_udp_set_queue__deep()")
+    child.expect_exact(u"Calling test_sock_udp_set_cb__EADDRNOTAVAIL()")
+    child.expect_exact(u"Calling test_sock_udp_set_cb__recv()")
+    child.expect_exact(u"Calling test_sock_udp_set_notify__recv()")
     child.expect_exact(u"Calling test_sock_udp_send__EAFNOSUPPORT()")
     child.expect_exact(u"Calling test_sock_udp_send__EINVAL_addr()")
     child.expect_exact(u"Calling test_sock_udp_send__EINVAL_netif()")
@@ -47,6 +54,7 @@ def testfunc(child):
     child.expect_exact(u"Calling test_sock_udp_send__socketed_no_local()")
     child.expect_exact(u"Calling test_sock_udp_send__socketed()")
     child.expect_exact(u"Calling test_sock_udp_send__socketed_other_remote()")
+    child.expect_exact(u"Calling test_sock_udp_send_many__socketed()")
     child.expect_exact(u"Calling test_sock_udp_send__unsocketed_no_local_no_netif()")
     child.expect_exact(u"Calling test_sock_udp_send__unsocketed_no_netif()")
     child.expect_exact(u"Calling test_sock_udp_send__unsocketed_no_local()")
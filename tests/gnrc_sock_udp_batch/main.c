@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compares receiving UDP datagrams one at a time, in batches and
+ *              without copying
+ *
+ * Bursts of BATCH_SIZE small datagrams are sent to the loopback address and
+ * received with each API in turn. Only the time to receive is measured.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "net/gnrc/pktbuf.h"
+#include "net/ipv6/addr.h"
+#include "net/gnrc/sock.h"
+#include "net/sock/udp.h"
+#include "xtimer.h"
+
+#define BATCH_SIZE          (16U)
+#define ROUNDS              (200U)
+#define PAYLOAD_SIZE        (16U)
+#define PORT                (0x2c94)
+
+static sock_udp_t _sock;
+static msg_t _queue[BATCH_SIZE];
+static uint8_t _payload[PAYLOAD_SIZE];
+static uint8_t _bufs[BATCH_SIZE][PAYLOAD_SIZE];
+static sock_udp_msg_t _msgs[BATCH_SIZE];
+
+static unsigned _recv_single(void)
+{
+    unsigned count = 0;
+
+    while (sock_udp_recv(&_sock, _bufs[0], sizeof(_bufs[0]), 0, NULL) > 0) {
+        count++;
+    }
+    return count;
+}
+
+static unsigned _recv_many(void)
+{
+    for (unsigned i = 0; i < BATCH_SIZE; i++) {
+        _msgs[i].data = _bufs[i];
+        _msgs[i].len = sizeof(_bufs[i]);
+    }
+    int res = sock_udp_recv_many(&_sock, _msgs, BATCH_SIZE, 0);
+    return (res > 0) ? (unsigned)res : 0;
+}
+
+static unsigned _recv_pkt(void)
+{
+    gnrc_pktsnip_t *pkt;
+    unsigned count = 0;
+
+    while (gnrc_sock_udp_recv_pkt(&_sock, &pkt, 0, NULL) > 0) {
+        /* payload is consumed in place at pkt->data */
+        gnrc_pktbuf_release(pkt);
+        count++;
+    }
+    return count;
+}
+
+static void _run(const char *name, unsigned (*recv)(void))
+{
+    sock_udp_msg_t out[BATCH_SIZE];
+    uint32_t total = 0;
+    unsigned received = 0;
+
+    for (unsigned i = 0; i < BATCH_SIZE; i++) {
+        out[i].data = _payload;
+        out[i].len = sizeof(_payload);
+        out[i].remote.family = AF_UNSPEC;
+    }
+
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        /* the stack threads have higher priority, so all datagrams are
+         * queued at the sock when this returns */
+        sock_udp_send_many(&_sock, out, BATCH_SIZE);
+
+        uint32_t start = xtimer_now_usec();
+        received += recv();
+        total += xtimer_now_usec() - start;
+    }
+    printf("%s: %u datagrams in %" PRIu32 " us (%" PRIu32 " ns/datagram)\n",
+           name, received, total,
+           (uint32_t)(((uint64_t)total * 1000) / (received ? received : 1)));
+}
+
+int main(void)
+{
+    sock_udp_ep_t local = { .family = AF_INET6, .port = PORT };
+    sock_udp_ep_t remote = { .family = AF_INET6, .port = PORT };
+
+    puts("sock_udp batch receive benchmark");
+
+    ipv6_addr_set_loopback((ipv6_addr_t *)&remote.addr.ipv6);
+    if (sock_udp_create(&_sock, &local, &remote, 0) < 0) {
+        puts("error: cannot create sock");
+        return 1;
+    }
+    /* a whole batch must fit into the receive queue */
+    gnrc_sock_udp_set_queue(&_sock, _queue, BATCH_SIZE);
+
+    _run("sock_udp_recv", _recv_single);
+    _run("sock_udp_recv_many", _recv_many);
+    _run("gnrc_sock_udp_recv_pkt", _recv_pkt);
+
+    puts("[SUCCESS]");
+    return 0;
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+BATCH_SIZE = 16
+ROUNDS = 200
+
+
+def testfunc(child):
+    for name in ("sock_udp_recv", "sock_udp_recv_many", "gnrc_sock_udp_recv_pkt"):
+        child.expect(u"%s: (\d+) datagrams in \d+ us" % name)
+        assert(int(child.match.group(1)) == BATCH_SIZE * ROUNDS)
+    child.expect_exact(u"[SUCCESS]")
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc))
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Stress test and benchmark for kvstore
+ *
+ * Runs random puts, gets and deletes on a part of the native mtd device and
+ * checks every value against a copy in RAM, also after remounting. The
+ * latency of puts and gets and the erase count of every sector is reported.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "board.h"
+#include "kvstore.h"
+#include "mtd.h"
+#include "random.h"
+#include "xtimer.h"
+
+/* part of MTD_0 that is used */
+#define BENCH_SECTORS   (16U)
+#define PAGE_SIZE_MAX   (256U)
+#define KEYS            (48U)
+#define VALUE_MAX       (40U)
+#define INDEX_SIZE      (128U)   /* power of two, about twice KEYS */
+#define OPS             (20000U)
+#define COMMIT_EVERY    (8U)
+#define REMOUNT_EVERY   (2000U)
+
+static struct {
+    uint32_t programmed;
+    uint32_t erases[BENCH_SECTORS];
+} _count;
+
+static int _init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int _read(mtd_dev_t *dev, void *dest, uint32_t addr, uint32_t size)
+{
+    (void)dev;
+    return mtd_read(MTD_0, dest, addr, size);
+}
+
+static int _write(mtd_dev_t *dev, const void *src, uint32_t addr,
+                  uint32_t size)
+{
+    (void)dev;
+    _count.programmed += size;
+    return mtd_write(MTD_0, src, addr, size);
+}
+
+static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
+{
+    uint32_t sector_size = dev->pages_per_sector * dev->page_size;
+
+    for (uint32_t a = addr; a < addr + size; a += sector_size) {
+        _count.erases[a / sector_size]++;
+    }
+    return mtd_erase(MTD_0, addr, size);
+}
+
+static const mtd_desc_t _count_driver = {
+    .init = _init,
+    .read = _read,
+    .write = _write,
+    .erase = _erase,
+};
+
+static mtd_dev_t _dev = {
+    .driver = &_count_driver,
+    .sector_count = BENCH_SECTORS,
+};
+
+static uint8_t _page_buf[PAGE_SIZE_MAX];
+static kvstore_slot_t _index[INDEX_SIZE];
+static kvstore_t _kv;
+
+/* expected state */
+static struct {
+    uint8_t val[VALUE_MAX];
+    uint8_t len;
+    bool present;
+} _shadow[KEYS];
+
+typedef struct {
+    uint32_t count;
+    uint32_t total;
+    uint32_t max;
+} _time_t;
+
+static _time_t _put_time, _get_time;
+static uint32_t _value_bytes, _gc_runs;
+
+static void _key(char *buf, unsigned i)
+{
+    sprintf(buf, "cfg/%02u", i);
+}
+
+static void _account(uint32_t start, _time_t *t)
+{
+    uint32_t time = xtimer_now_usec() - start;
+
+    t->count++;
+    t->total += time;
+    if (time > t->max) {
+        t->max = time;
+    }
+}
+
+static int _mount(void)
+{
+    memset(&_kv, 0, sizeof(_kv));
+    _kv.mtd = &_dev;
+    _kv.page_buf = _page_buf;
+    _kv.index = _index;
+    _kv.index_size = sizeof(_index) / sizeof(_index[0]);
+    return kvstore_mount(&_kv);
+}
+
+static int _check(unsigned i)
+{
+    uint8_t buf[VALUE_MAX];
+    char key[8];
+    uint32_t start;
+    int res;
+
+    _key(key, i);
+    start = xtimer_now_usec();
+    res = kvstore_get(&_kv, key, buf, sizeof(buf));
+    _account(start, &_get_time);
+    if (!_shadow[i].present) {
+        return (res == -ENOENT) ? 0 : -1;
+    }
+    if ((res != _shadow[i].len) || memcmp(buf, _shadow[i].val, res)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int _check_all(void)
+{
+    for (unsigned i = 0; i < KEYS; i++) {
+        if (_check(i) < 0) {
+            printf("mismatch for key %u\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int _op(void)
+{
+    unsigned i = random_uint32_range(0, KEYS);
+    unsigned what = random_uint32_range(0, 10);
+    char key[8];
+    uint32_t start;
+    int res;
+
+    _key(key, i);
+    if (what < 7) {
+        _shadow[i].len = random_uint32_range(1, VALUE_MAX + 1);
+        for (unsigned j = 0; j < _shadow[i].len; j++) {
+            _shadow[i].val[j] = random_uint32();
+        }
+        _shadow[i].present = true;
+        _value_bytes += _shadow[i].len;
+        start = xtimer_now_usec();
+        res = kvstore_put(&_kv, key, _shadow[i].val, _shadow[i].len);
+        _account(start, &_put_time);
+        return res;
+    }
+    if (what < 9) {
+        return _check(i);
+    }
+    res = kvstore_delete(&_kv, key);
+    if (res == -ENOENT) {
+        res = _shadow[i].present ? -1 : 0;
+    }
+    _shadow[i].present = false;
+    return res;
+}
+
+int main(void)
+{
+    uint32_t min, max;
+
+    mtd_init(MTD_0);
+    _dev.pages_per_sector = MTD_0->pages_per_sector;
+    _dev.page_size = MTD_0->page_size;
+    if (_dev.page_size > sizeof(_page_buf)) {
+        puts("page size not supported");
+        return 1;
+    }
+    mtd_erase(&_dev, 0, BENCH_SECTORS * _dev.pages_per_sector * _dev.page_size);
+    memset(&_count, 0, sizeof(_count));
+    random_init(xtimer_now_usec());
+
+    printf("%u operations on %u keys, commit every %u, remount every %u\n",
+           OPS, KEYS, COMMIT_EVERY, REMOUNT_EVERY);
+    puts("Start.");
+    if (_mount() < 0) {
+        puts("mount failed");
+        return 1;
+    }
+    for (uint32_t n = 1; n <= OPS; n++) {
+        int res = _op();
+
+        if (res < 0) {
+            printf("operation %" PRIu32 " failed: %d\n", n, res);
+            return 1;
+        }
+        if ((n % COMMIT_EVERY) == 0) {
+            kvstore_commit(&_kv);
+        }
+        if ((n % REMOUNT_EVERY) == 0) {
+            _gc_runs += _kv.stats.gc_runs;
+            if ((_mount() < 0) || (_check_all() < 0)) {
+                puts("remount failed");
+                return 1;
+            }
+        }
+    }
+
+    min = max = _count.erases[0];
+    for (unsigned i = 1; i < BENCH_SECTORS; i++) {
+        min = (_count.erases[i] < min) ? _count.erases[i] : min;
+        max = (_count.erases[i] > max) ? _count.erases[i] : max;
+    }
+    printf("+ put: avg %" PRIu32 " us, max %" PRIu32 " us\n",
+           _put_time.total / _put_time.count, _put_time.max);
+    printf("+ get: avg %" PRIu32 " us, max %" PRIu32 " us\n",
+           _get_time.total / _get_time.count, _get_time.max);
+    printf("+ programmed %" PRIu32 " bytes for %" PRIu32 " bytes of values\n",
+           _count.programmed, _value_bytes);
+    printf("+ erases per sector: min %" PRIu32 ", max %" PRIu32 ", "
+           "%" PRIu32 " collections\n", min, max, _gc_runs + _kv.stats.gc_runs);
+    puts("Done.");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+def testfunc(child):
+    child.expect_exact("Start.")
+    child.expect('\+ put: avg \d+ us, max \d+ us')
+    child.expect('\+ get: avg \d+ us, max \d+ us')
+    child.expect('\+ programmed \d+ bytes for \d+ bytes of values')
+    child.expect('\+ erases per sector: min \d+, max \d+, \d+ collections')
+    child.expect_exact("Done.")
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc, timeout=120))
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test application for deferred binary logging
+ *
+ * Logs messages with all supported kinds of arguments, and compares the time
+ * a log call takes with the time snprintf() takes to format the same message.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "log.h"
+#include "xtimer.h"
+
+/* a batch of records fits into the ring buffer, so nothing is dropped while
+ * measuring */
+#define BATCH           (16U)
+#define BATCHES         (64U)
+
+static const char *_name = "log_deferred";
+
+static void _log_all_kinds(void)
+{
+    char c = 'R';
+    short s = -1000;
+    float f = 0.25f;
+    uint64_t u64 = 1ULL << 40;
+
+    LOG_INFO("no arguments\n");
+    LOG_ERROR("int %i, unsigned %u, hex 0x%04x\n", -42, 42U, 0xbeefU);
+    LOG_WARNING("char %c, short %hd, float %.3f, double %g\n", c, s, f, 1e-3);
+    LOG_INFO("uint64 %" PRIu64 ", size %u, string %s, pointer %p\n",
+             u64, (unsigned)sizeof(u64), _name, (void *)_name);
+    LOG_DEBUG("width %*d|%-8s|, percent 100%%\n", 6, 12, "left");
+    LOG_INFO("eight %d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8);
+}
+
+static uint32_t _bench_log(void)
+{
+    uint32_t total = 0;
+
+    for (unsigned i = 0; i < BATCHES; i++) {
+        uint32_t start = xtimer_now_usec();
+        for (unsigned j = 0; j < BATCH; j++) {
+            LOG_DEBUG("sensor %u: %" PRIi32 " mC\n", j, (int32_t)(21500 + j));
+        }
+        total += xtimer_now_usec() - start;
+        log_deferred_flush();
+    }
+    return total;
+}
+
+static uint32_t _bench_snprintf(void)
+{
+    char buf[32];
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned i = 0; i < BATCHES; i++) {
+        for (unsigned j = 0; j < BATCH; j++) {
+            snprintf(buf, sizeof(buf), "sensor %u: %" PRIi32 " mC\n", j,
+                     (int32_t)(21500 + j));
+        }
+    }
+    return xtimer_now_usec() - start;
+}
+
+int main(void)
+{
+    puts("log_deferred test");
+
+    _log_all_kinds();
+    log_deferred_flush();
+
+    uint32_t log_time = _bench_log();
+    uint32_t snprintf_time = _bench_snprintf();
+
+    printf("%u calls: LOG_DEBUG() %" PRIu32 " us, snprintf() %" PRIu32 " us\n",
+           BATCH * BATCHES, log_time, snprintf_time);
+    puts("[SUCCESS]");
+    return 0;
+}
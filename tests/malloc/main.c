@@ -13,18 +13,35 @@
  * @file
  * @brief   Simple malloc/free test
  *
+ * Measures the average time of malloc() and free() for random sizes and the
+ * fragmentation they leave, then allocates and frees the whole heap over and
+ * over again.
  *
  * @author  Benjamin Valentin <benpicco@zedat.fu-berlin.de>
  *
  * @}
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "xtimer.h"
+
+#ifdef MODULE_TLSF_MALLOC
+#include "tlsf_malloc.h"
+#endif
+
 #define CHUNK_SIZE 1024
 
+#define BENCH_ROUNDS        (200U)
+#define BENCH_SLOTS         (32U)
+#define BENCH_SIZE_MAX      (128U)
+/* upper bound when searching for the largest block, for allocators that
+ * never fail */
+#define LARGEST_MAX         (64U * 1024U)
+
 struct node {
     struct node *next;
     void *ptr;
@@ -68,8 +85,97 @@ void free_memory(struct node *head)
     }
 }
 
+static void *_slots[BENCH_SLOTS];
+static size_t _sizes[BENCH_SLOTS];
+static uint32_t _rand_state = 1;
+
+/* xorshift32, so every allocator sees the same sequence of requests */
+static uint32_t _rand(void)
+{
+    _rand_state ^= _rand_state << 13;
+    _rand_state ^= _rand_state >> 17;
+    _rand_state ^= _rand_state << 5;
+    return _rand_state;
+}
+
+static size_t _largest_block(void)
+{
+    size_t lo = 0, hi = LARGEST_MAX;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        void *ptr = malloc(mid);
+        if (ptr) {
+            free(ptr);
+            lo = mid;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+static void _bench(void)
+{
+    uint32_t start, alloc_time = 0, free_time = 0;
+    unsigned allocs = 0, frees = 0, failed = 0;
+    size_t largest = _largest_block();
+
+    for (unsigned round = 0; round < BENCH_ROUNDS; round++) {
+        for (unsigned i = 0; i < BENCH_SLOTS; i++) {
+            _sizes[i] = 1 + (_rand() % BENCH_SIZE_MAX);
+        }
+
+        start = xtimer_now_usec();
+        for (unsigned i = 0; i < BENCH_SLOTS; i++) {
+            if (!_slots[i]) {
+                _slots[i] = malloc(_sizes[i]);
+                allocs++;
+                failed += !_slots[i];
+            }
+        }
+        alloc_time += xtimer_now_usec() - start;
+
+        /* free about half of the blocks, so the heap fragments */
+        start = xtimer_now_usec();
+        for (unsigned i = 0; i < BENCH_SLOTS; i++) {
+            if (_slots[i] && (_sizes[i] & 0x1)) {
+                free(_slots[i]);
+                _slots[i] = NULL;
+                frees++;
+            }
+        }
+        free_time += xtimer_now_usec() - start;
+    }
+
+    size_t fragmented = _largest_block();
+    unsigned used = 0;
+    for (unsigned i = 0; i < BENCH_SLOTS; i++) {
+        used += (_slots[i] != NULL);
+        free(_slots[i]);
+        _slots[i] = NULL;
+    }
+#ifdef MODULE_TLSF_MALLOC
+    tlsf_malloc_cache_flush();
+#endif
+
+    printf("malloc: %u calls, %u failed, %" PRIu32 " ns on average\n",
+           allocs, failed, (uint32_t)((uint64_t)alloc_time * 1000 / allocs));
+    printf("free: %u calls, %" PRIu32 " ns on average\n",
+           frees, (uint32_t)((uint64_t)free_time * 1000 / frees));
+    printf("largest block: %u bytes before, %u bytes with %u blocks in use, "
+           "%u bytes after\n", (unsigned)largest, (unsigned)fragmented,
+           used, (unsigned)_largest_block());
+#ifdef MODULE_TLSF_MALLOC
+    tlsf_malloc_print_stats();
+#endif
+}
+
 int main(void)
 {
+    _bench();
+
     while (1) {
         struct node *head = malloc(sizeof(struct node));
         total += sizeof(struct node);
@@ -13,24 +13,47 @@
  * @file
  * @brief       Test application for testing mutexes
  *
+ * Checks that waiting threads get the mutex in the order of their priority,
+ * and measures how long a high priority thread waits for a mutex held by a
+ * low priority thread while a medium priority thread is ready to run, also
+ * when the low priority thread holds a second mutex and unlocks that first.
+ *
  * @author      Hauke Petersen <hauke.petersen@fu-berlin.de>
  * @}
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 
 #include "mutex.h"
 #include "thread.h"
+#include "xtimer.h"
 
 #define THREAD_NUMOF            (5U)
 
+#define PRIO_LOW                (THREAD_PRIORITY_MAIN - 1)
+#define PRIO_MEDIUM             (THREAD_PRIORITY_MAIN - 2)
+#define PRIO_HIGH               (THREAD_PRIORITY_MAIN - 3)
+#define PRIO_HIGHEST            (THREAD_PRIORITY_MAIN - 4)
+
+/* time the low priority thread holds the mutex, and the time the medium
+ * priority thread keeps the CPU busy */
+#define CRITICAL_US             (1000U)
+#define MEDIUM_US               (10U * CRITICAL_US)
+
 extern volatile thread_t *sched_active_thread;
 
 static char stacks[THREAD_NUMOF][THREAD_STACKSIZE_MAIN];
 
 static const char prios[THREAD_NUMOF] = {THREAD_PRIORITY_MAIN - 1, 4, 0, 2, 1};
 
-static mutex_t testlock;
+/* initialized locked, so that spawned threads have to wait, and so that main
+ * does not inherit their priorities */
+static mutex_t testlock = MUTEX_INIT_LOCKED;
+
+static mutex_t pi_lock = MUTEX_INIT;
+static mutex_t pi_lock_inner = MUTEX_INIT;
+static uint32_t wait_us;
 
 static void *lockme(void *arg)
 {
@@ -50,15 +73,88 @@ static void *lockme(void *arg)
     return NULL;
 }
 
+static void spin(uint32_t us)
+{
+    uint32_t start = xtimer_now_usec();
+
+    while ((xtimer_now_usec() - start) < us) {}
+}
+
+static void *high(void *arg)
+{
+    (void)arg;
+    uint32_t start = xtimer_now_usec();
+
+    mutex_lock(&pi_lock);
+    wait_us = xtimer_now_usec() - start;
+    mutex_unlock(&pi_lock);
+
+    return NULL;
+}
+
+static void *highest(void *arg)
+{
+    (void)arg;
+
+    mutex_lock(&pi_lock_inner);
+    mutex_unlock(&pi_lock_inner);
+
+    return NULL;
+}
+
+static void *medium(void *arg)
+{
+    (void)arg;
+
+    spin(MEDIUM_US);
+
+    return NULL;
+}
+
+static void *low(void *arg)
+{
+    (void)arg;
+
+    mutex_lock(&pi_lock);
+    /* preempts this thread and blocks on the mutex */
+    thread_create(stacks[1], sizeof(stacks[1]), PRIO_HIGH, 0,
+                  high, NULL, "high");
+    /* without priority inheritance, preempts this thread until done */
+    thread_create(stacks[2], sizeof(stacks[2]), PRIO_MEDIUM, 0,
+                  medium, NULL, "medium");
+    spin(CRITICAL_US);
+    mutex_unlock(&pi_lock);
+
+    return NULL;
+}
+
+static void *low_nested(void *arg)
+{
+    (void)arg;
+
+    mutex_lock(&pi_lock);
+    mutex_lock(&pi_lock_inner);
+    thread_create(stacks[1], sizeof(stacks[1]), PRIO_HIGHEST, 0,
+                  highest, NULL, "highest");
+    thread_create(stacks[2], sizeof(stacks[2]), PRIO_HIGH, 0,
+                  high, NULL, "high");
+    thread_create(stacks[3], sizeof(stacks[3]), PRIO_MEDIUM, 0,
+                  medium, NULL, "medium");
+    spin(CRITICAL_US);
+    /* the high priority thread still waits for the outer mutex, so this
+     * thread must keep its priority */
+    mutex_unlock(&pi_lock_inner);
+    spin(CRITICAL_US);
+    mutex_unlock(&pi_lock);
+
+    return NULL;
+}
+
 int main(void)
 {
     puts("Mutex order test");
     puts("Please refer to the README.md for more information\n");
 
-    mutex_init(&testlock);
-
-    /* lock mutex, so that spawned threads have to wait */
-    mutex_lock(&testlock);
     /* create threads */
     for (unsigned i = 0; i < THREAD_NUMOF; i++) {
         thread_create(stacks[i], sizeof(stacks[i]), prios[i], 0,
@@ -68,7 +164,27 @@ int main(void)
     mutex_unlock(&testlock);
 
     mutex_lock(&testlock);
-    puts("\nTest END, check the order of priorities above.");
+    puts("\nCheck the order of priorities above.");
+
+#ifdef MODULE_CORE_MUTEX_PRIORITY_INHERITANCE
+    puts("\nPriority inversion test, priority inheritance on");
+#else
+    puts("\nPriority inversion test, priority inheritance off");
+#endif
+    /* all threads have a higher priority than main, so main continues when
+     * they are done */
+    thread_create(stacks[0], sizeof(stacks[0]), PRIO_LOW, 0,
+                  low, NULL, "low");
+    printf("high priority thread waited %" PRIu32 " us, critical section %u us, "
+           "medium priority thread %u us\n", wait_us, CRITICAL_US, MEDIUM_US);
+
+    thread_create(stacks[0], sizeof(stacks[0]), PRIO_LOW, 0,
+                  low_nested, NULL, "low");
+    printf("nested: high priority thread waited %" PRIu32 " us, critical "
+           "section %u us, medium priority thread %u us\n", wait_us,
+           2 * CRITICAL_US, MEDIUM_US);
+
+    puts("\nTest END");
 
     return 0;
 }
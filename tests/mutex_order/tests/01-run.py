@@ -31,5 +31,19 @@ def testfunc(child):
         assert(int(child.match.group(1)) > last)
         last = int(child.match.group(1))
 
+    child.expect(u"priority inheritance (on|off)")
+    inheritance = (child.match.group(1) == "on")
+    for prefix in (u"", u"nested: "):
+        child.expect(prefix + u"high priority thread waited (\d+) us, "
+                     u"critical section (\d+) us, "
+                     u"medium priority thread (\d+) us")
+        wait, critical, medium = (int(x) for x in child.match.groups())
+        if inheritance:
+            # bounded by the critical section of the low priority thread
+            assert(wait < critical + medium / 2)
+        else:
+            # the medium priority thread runs first
+            assert(wait >= medium)
+
 if __name__ == "__main__":
     sys.exit(testrunner.run(testfunc))
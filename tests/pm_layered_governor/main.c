@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test for the pm_layered governor
+ *
+ * native does not use pm_layered, so the governor is built into this test
+ * for three made-up modes, with pm_set() and xtimer_next_event() mocked.
+ *
+ * @}
+ */
+
+/* mode 0 is never used by the idle thread, mode 1 needs a wake-up timer */
+#define PM_NUM_MODES            (3U)
+#define PM_MODE_LATENCY_US      { 1000, 1000, 0 }
+#define PM_MODE_RESIDENCY_US    { UINT32_MAX, 2000, 500 }
+#define PM_BLOCKER_INITIAL      { .val_u32 = 0 }
+
+#define MODULE_PM_LAYERED_GOVERNOR
+#define PROVIDES_PM_LAYERED_OFF
+/* native implements pm_set_lowest() itself */
+#define pm_set_lowest           governed_set_lowest
+#define xtimer_next_event       mock_next_event
+
+#include "../../sys/pm_layered/pm.c"
+
+/* precision of the wake-up time seen by pm_set() */
+#define WAKEUP_SLACK            (200U)
+
+static uint32_t _next;
+static unsigned _mode;
+static uint32_t _wakeup_in;
+
+xtimer_ticks32_t mock_next_event(void)
+{
+    return xtimer_ticks_from_usec(_next);
+}
+
+void pm_set(unsigned mode)
+{
+    _mode = mode;
+    _wakeup_in = _wakeup.target ? _wakeup.target - xtimer_now().ticks32 : 0;
+}
+
+static int _check(uint32_t next, unsigned mode, uint32_t wakeup_in,
+                  uint32_t demoted)
+{
+    pm_layered_stats_t stats;
+
+    _next = next;
+    _wakeup.target = 0;
+    governed_set_lowest();
+    pm_layered_get_stats(&stats);
+    printf("next %" PRIu32 ": mode %u, wake-up in %" PRIu32 ", demoted %"
+           PRIu32 "\n", next, _mode, _wakeup_in, stats.demoted);
+    if ((_mode != mode) || (stats.demoted != demoted) ||
+        (_wakeup_in > wakeup_in) || (_wakeup_in + WAKEUP_SLACK < wakeup_in)) {
+        puts("wrong decision");
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    /* mode 0 is skipped without counting as demotion */
+    if ((_check(100000, 1, 99000, 0) < 0) ||
+        /* mode 1 just fits, its latency is subtracted for the wake-up */
+        (_check(3000, 1, 2000, 0) < 0) ||
+        (_check(2999, 2, 0, 1) < 0) ||
+        (_check(499, 3, 0, 2) < 0)) {
+        return 1;
+    }
+    /* the blockers still decide where to start */
+    pm_block(1);
+    if (_check(100000, 2, 0, 2) < 0) {
+        return 1;
+    }
+    pm_unblock(1);
+
+    pm_layered_stats_t stats;
+    pm_layered_get_stats(&stats);
+    if ((stats.entries[0] != 0) || (stats.entries[1] != 2) ||
+        (stats.entries[2] != 2) || (stats.entries[3] != 1)) {
+        puts("wrong entries");
+        return 1;
+    }
+    pm_layered_print_stats();
+    puts("SUCCESS");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+def testfunc(child):
+    for next_us, mode in ((100000, 1), (3000, 1), (2999, 2), (499, 3),
+                          (100000, 2)):
+        child.expect(r'next %u: mode %u, wake-up in \d+, demoted \d+' %
+                     (next_us, mode))
+    child.expect(r'demoted: 2')
+    child.expect_exact('SUCCESS')
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc))
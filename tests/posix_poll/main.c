@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test for poll() and select() on POSIX sockets
+ *
+ * Also compares RAM usage and latency of one thread serving several sockets
+ * with poll() to one thread per socket.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "net/ipv6/addr.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define SOCKS_NUMOF         (3U)
+#define POLL_PORT           (10000U)
+#define THREAD_PORT         (10100U)
+#define PACKETS_NUMOF       (30U)
+#define POLL_TIMEOUT        (100U)      /* in ms */
+
+static char _poll_stack[THREAD_STACKSIZE_DEFAULT];
+static char _thread_stacks[SOCKS_NUMOF][THREAD_STACKSIZE_DEFAULT];
+static int _thread_socks[SOCKS_NUMOF];
+
+static uint32_t _start;
+static kernel_pid_t _main_pid;
+static int _client;
+
+static int _udp_socket(uint16_t port)
+{
+    struct sockaddr_in6 addr = { .sin6_family = AF_INET6,
+                                 .sin6_port = htons(port) };
+    int s = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+
+    if ((s < 0) ||
+        (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)) {
+        printf("error: can't create socket for port %u\n", port);
+        return -1;
+    }
+    return s;
+}
+
+static int _send(uint16_t port)
+{
+    struct sockaddr_in6 dst = { .sin6_family = AF_INET6,
+                                .sin6_port = htons(port) };
+
+    ipv6_addr_set_loopback((ipv6_addr_t *)&dst.sin6_addr);
+    return sendto(_client, "test", sizeof("test"), 0, (struct sockaddr *)&dst,
+                  sizeof(dst));
+}
+
+static void _received(int s)
+{
+    char buf[16];
+    msg_t msg;
+
+    if (recv(s, buf, sizeof(buf), 0) < 0) {
+        puts("error: receive failed");
+    }
+    msg.content.value = xtimer_now_usec() - _start;
+    msg_send(&msg, _main_pid);
+}
+
+static void *_poll_server(void *arg)
+{
+    struct pollfd *fds = arg;
+
+    while (1) {
+        if (poll(fds, SOCKS_NUMOF, -1) <= 0) {
+            puts("error: poll failed");
+            continue;
+        }
+        for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+            if (fds[i].revents & POLLIN) {
+                _received(fds[i].fd);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *_thread_server(void *arg)
+{
+    int s = (int)(intptr_t)arg;
+
+    while (1) {
+        _received(s);
+    }
+    return NULL;
+}
+
+static int _test_poll(void)
+{
+    struct pollfd fds[SOCKS_NUMOF];
+    char buf[16];
+    uint32_t start;
+    int res = 0;
+
+    for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+        fds[i].fd = _udp_socket(POLL_PORT + i);
+        fds[i].events = POLLIN;
+    }
+    start = xtimer_now_usec();
+    if ((poll(fds, SOCKS_NUMOF, POLL_TIMEOUT) != 0) ||
+        ((xtimer_now_usec() - start) < (POLL_TIMEOUT * US_PER_MS))) {
+        puts("error: poll did not time out");
+        res = -1;
+    }
+    else {
+        puts("poll: timeout");
+    }
+    _send(POLL_PORT + 1);
+    if ((poll(fds, SOCKS_NUMOF, -1) != 1) || (fds[0].revents != 0) ||
+        (fds[1].revents != POLLIN) || (fds[2].revents != 0)) {
+        puts("error: poll did not report the readable socket");
+        res = -1;
+    }
+    else {
+        puts("poll: readable");
+    }
+    recv(fds[1].fd, buf, sizeof(buf), 0);
+    for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+        close(fds[i].fd);
+    }
+    return res;
+}
+
+static int _test_select(void)
+{
+    struct timeval timeout = { .tv_sec = 1 };
+    fd_set readfds;
+    int s = _udp_socket(POLL_PORT);
+    char buf[16];
+    int res = 0;
+
+    FD_ZERO(&readfds);
+    FD_SET(s, &readfds);
+    if (select(s + 1, &readfds, NULL, NULL, &(struct timeval){ 0 }) != 0) {
+        puts("error: select reported a socket without data");
+        res = -1;
+    }
+    /* the socket is only bound to the stack once it is used */
+    _send(POLL_PORT);
+    FD_SET(s, &readfds);
+    if ((select(s + 1, &readfds, NULL, NULL, &timeout) != 1) ||
+        !FD_ISSET(s, &readfds)) {
+        puts("error: select did not report the readable socket");
+        res = -1;
+    }
+    else {
+        puts("select: readable");
+    }
+    recv(s, buf, sizeof(buf), 0);
+    close(s);
+    return res;
+}
+
+static uint32_t _measure(uint16_t port)
+{
+    uint32_t sum = 0;
+
+    for (unsigned i = 0; i < PACKETS_NUMOF; i++) {
+        msg_t msg;
+
+        _start = xtimer_now_usec();
+        _send(port + (i % SOCKS_NUMOF));
+        msg_receive(&msg);
+        sum += msg.content.value;
+    }
+    return sum / PACKETS_NUMOF;
+}
+
+static unsigned _stack_used(char *stack, size_t size)
+{
+    return size - thread_measure_stack_free(stack);
+}
+
+int main(void)
+{
+    static struct pollfd fds[SOCKS_NUMOF];
+    uint32_t poll_latency, thread_latency;
+    unsigned thread_used = 0;
+
+    puts("posix poll test");
+    _main_pid = thread_getpid();
+    _client = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+
+    if ((_test_poll() < 0) || (_test_select() < 0)) {
+        puts("[FAILED]");
+        return 1;
+    }
+
+    for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+        fds[i].fd = _udp_socket(POLL_PORT + i);
+        fds[i].events = POLLIN;
+        _thread_socks[i] = _udp_socket(THREAD_PORT + i);
+    }
+    thread_create(_poll_stack, sizeof(_poll_stack), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _poll_server, fds, "poll server");
+    for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+        thread_create(_thread_stacks[i], sizeof(_thread_stacks[i]),
+                      THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                      _thread_server, (void *)(intptr_t)_thread_socks[i],
+                      "socket server");
+    }
+
+    poll_latency = _measure(POLL_PORT);
+    thread_latency = _measure(THREAD_PORT);
+    for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+        thread_used += _stack_used(_thread_stacks[i],
+                                   sizeof(_thread_stacks[i]));
+    }
+    printf("poll server: 1 thread(s), stack %u B (used %u B), "
+           "latency %" PRIu32 " us\n", (unsigned)sizeof(_poll_stack),
+           _stack_used(_poll_stack, sizeof(_poll_stack)), poll_latency);
+    printf("thread-per-socket servers: %u thread(s), stack %u B (used %u B), "
+           "latency %" PRIu32 " us\n", SOCKS_NUMOF,
+           (unsigned)sizeof(_thread_stacks), thread_used, thread_latency);
+    puts("[SUCCESS]");
+    return 0;
+}
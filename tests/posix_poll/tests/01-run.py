@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+
+def testfunc(child):
+    child.expect_exact(u"posix poll test")
+    child.expect_exact(u"poll: timeout")
+    child.expect_exact(u"poll: readable")
+    child.expect_exact(u"select: readable")
+    child.expect(u"poll server: 1 thread\(s\), stack \d+ B \(used \d+ B\), "
+                 u"latency \d+ us")
+    child.expect(u"thread-per-socket servers: \d+ thread\(s\), stack \d+ B "
+                 u"\(used \d+ B\), latency \d+ us")
+    child.expect_exact(u"[SUCCESS]")
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc))
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the throughput of the selected PRNG
+ *
+ * Generates the same number of bytes with random_uint32(), with
+ * random_bytes() and with random_uint32_range(). The throughput is printed
+ * in bytes per second and, on boards that define CLOCK_CORECLOCK, in bytes
+ * per 1000 CPU cycles.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "periph_conf.h"
+#include "random.h"
+#include "xtimer.h"
+
+#define BYTES           (64U * 1024U)
+#define BUF_SIZE        (256U)
+
+static uint8_t _buf[BUF_SIZE];
+/* keeps the results alive */
+static volatile uint32_t _sink;
+
+static void _print(const char *name, uint32_t time)
+{
+    uint32_t rate = (uint32_t)(((uint64_t)BYTES * US_PER_SEC) /
+                               (time ? time : 1));
+
+#ifdef CLOCK_CORECLOCK
+    printf("+ %s: %" PRIu32 " bytes/s, %" PRIu32 " bytes per 1000 cycles\n",
+           name, rate,
+           (uint32_t)(((uint64_t)rate * 1000) / CLOCK_CORECLOCK));
+#else
+    printf("+ %s: %" PRIu32 " bytes/s\n", name, rate);
+#endif
+}
+
+int main(void)
+{
+    uint32_t start;
+
+    random_init(0x12345678);
+    printf("%u bytes each\n", BYTES);
+    puts("Start.");
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BYTES / sizeof(uint32_t); i++) {
+        _sink += random_uint32();
+    }
+    _print("random_uint32", xtimer_now_usec() - start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BYTES / sizeof(_buf); i++) {
+        random_bytes(_buf, sizeof(_buf));
+        _sink += _buf[0];
+    }
+    _print("random_bytes", xtimer_now_usec() - start);
+
+    /* the worst case range, half of the draws are rejected */
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BYTES / sizeof(uint32_t); i++) {
+        _sink += random_uint32_range(0, 0x80000001);
+    }
+    _print("random_uint32_range", xtimer_now_usec() - start);
+
+    puts("Done.");
+    return 0;
+}
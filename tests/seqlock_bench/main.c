@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compares how readers of a seqlock and of a reader count scale
+ *
+ * The readers are work queue jobs, so they run in parallel on threads of the
+ * host, while the main thread keeps changing the data. With a reader count,
+ * as used by reader-writer locks, every reader writes to the count, with a
+ * seqlock readers only read.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "seqlock.h"
+#include "workq.h"
+#include "xtimer.h"
+
+#define READS           (1000000U)
+#define WORDS           (8U)
+/* time between two writes */
+#define WRITE_PERIOD    (100U)
+
+typedef struct {
+    bool seqlock;
+    unsigned torn;
+} _reader_t;
+
+static uint32_t _data[WORDS];
+static seqlock_t _lock = SEQLOCK_INIT;
+/* > 0: number of readers, -1: a writer */
+static int _count;
+static unsigned _active;
+
+static _reader_t _readers[WORKQ_WORKERS];
+static workq_job_t _jobs[WORKQ_WORKERS];
+
+/* runs on a host thread, so it must not call into RIOT */
+static void _read(void *arg)
+{
+    _reader_t *reader = arg;
+    uint32_t copy[WORDS];
+
+    for (unsigned i = 0; i < READS; i++) {
+        if (reader->seqlock) {
+            unsigned seq;
+            do {
+                seq = seqlock_read_begin(&_lock);
+                for (unsigned j = 0; j < WORDS; j++) {
+                    copy[j] = __atomic_load_n(&_data[j], __ATOMIC_RELAXED);
+                }
+            } while (seqlock_read_retry(&_lock, seq));
+        }
+        else {
+            int count = __atomic_load_n(&_count, __ATOMIC_RELAXED);
+            while ((count < 0) ||
+                   !__atomic_compare_exchange_n(&_count, &count, count + 1,
+                                                true, __ATOMIC_ACQUIRE,
+                                                __ATOMIC_RELAXED)) {
+                count = __atomic_load_n(&_count, __ATOMIC_RELAXED);
+            }
+            for (unsigned j = 0; j < WORDS; j++) {
+                copy[j] = __atomic_load_n(&_data[j], __ATOMIC_RELAXED);
+            }
+            __atomic_sub_fetch(&_count, 1, __ATOMIC_RELEASE);
+        }
+        /* the writer writes the same value to all words */
+        for (unsigned j = 1; j < WORDS; j++) {
+            if (copy[j] != copy[0]) {
+                reader->torn++;
+                break;
+            }
+        }
+    }
+    __atomic_sub_fetch(&_active, 1, __ATOMIC_RELEASE);
+}
+
+static void _write(bool seqlock, uint32_t val)
+{
+    unsigned state = 0;
+
+    if (seqlock) {
+        state = seqlock_write_begin(&_lock);
+    }
+    else {
+        int count = 0;
+        while (!__atomic_compare_exchange_n(&_count, &count, -1, true,
+                                            __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+            count = 0;
+        }
+    }
+    for (unsigned j = 0; j < WORDS; j++) {
+        __atomic_store_n(&_data[j], val, __ATOMIC_RELAXED);
+    }
+    if (seqlock) {
+        seqlock_write_end(&_lock, state);
+    }
+    else {
+        __atomic_store_n(&_count, 0, __ATOMIC_RELEASE);
+    }
+}
+
+static void _bench(bool seqlock, unsigned numof)
+{
+    workq_batch_t batch;
+    uint32_t writes = 0;
+    unsigned torn = 0;
+
+    __atomic_store_n(&_active, numof, __ATOMIC_RELAXED);
+    uint32_t start = xtimer_now_usec();
+    workq_batch_init(&batch);
+    for (unsigned i = 0; i < numof; i++) {
+        _readers[i].seqlock = seqlock;
+        _readers[i].torn = 0;
+        workq_submit(&batch, &_jobs[i], _read, &_readers[i]);
+    }
+    /* the main thread is the writer, it waits for the batch only when all
+     * readers are done, so it does not run a reader itself */
+    uint32_t next = start;
+    while (__atomic_load_n(&_active, __ATOMIC_ACQUIRE)) {
+        if ((int32_t)(xtimer_now_usec() - next) >= 0) {
+            _write(seqlock, ++writes);
+            next += WRITE_PERIOD;
+        }
+    }
+    workq_wait(&batch);
+    uint32_t time = xtimer_now_usec() - start;
+
+    for (unsigned i = 0; i < numof; i++) {
+        torn += _readers[i].torn;
+    }
+    printf("+ %s, %u readers: %" PRIu32 " reads/ms, %" PRIu32 " writes, "
+           "%u torn\n", seqlock ? "seqlock" : "reader count", numof,
+           (uint32_t)(((uint64_t)READS * numof * 1000) / (time ? time : 1)),
+           writes, torn);
+}
+
+int main(void)
+{
+    printf("%u reads per reader, a write every %u us\n", READS, WRITE_PERIOD);
+    puts("Start.");
+    for (unsigned numof = 1; numof <= WORKQ_WORKERS; numof++) {
+        _bench(false, numof);
+        _bench(true, numof);
+    }
+    puts("Done.");
+    return 0;
+}
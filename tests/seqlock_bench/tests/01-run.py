@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2017 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+def testfunc(child):
+    child.expect_exact("Start.")
+    while True:
+        res = child.expect(['\+ (reader count|seqlock), \d+ readers: '
+                            '\d+ reads/ms, \d+ writes, (\d+) torn',
+                            'Done.'])
+        if res == 1:
+            break
+        assert int(child.match.group(2)) == 0
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc, timeout=120))
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test application for the stack monitor
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "stackmon.h"
+#include "thread.h"
+#include "xtimer.h"
+
+/* stack the worker uses for a buffer */
+#define BUF_SIZE        (THREAD_STACKSIZE_DEFAULT / 2)
+
+static char _stack[THREAD_STACKSIZE_DEFAULT];
+
+static void *_worker(void *arg)
+{
+    volatile char buf[BUF_SIZE];
+
+    (void)arg;
+    for (unsigned i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+    thread_sleep();
+    return NULL;
+}
+
+static int _check(kernel_pid_t pid)
+{
+    stackmon_stats_t stats;
+
+    if (stackmon_get(pid, &stats) < 0) {
+        puts("no record");
+        return -1;
+    }
+    printf("%s: size %u, peak %u\n", stats.name, stats.size, stats.peak);
+    if ((stats.peak < BUF_SIZE) || (stats.peak > stats.size)) {
+        puts("wrong peak");
+        return -1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    /* painted without THREAD_CREATE_STACKTEST as well */
+    kernel_pid_t pid = thread_create(_stack, sizeof(_stack),
+                                     THREAD_PRIORITY_MAIN - 1, 0,
+                                     _worker, NULL, "worker");
+
+    /* the idle thread checks one stack per wakeup, so it may not have got to
+     * the worker yet */
+    xtimer_usleep(100 * US_PER_MS);
+    stackmon_update(pid);
+    if (_check(pid) < 0) {
+        return 1;
+    }
+    /* the record stays after the thread exited */
+    thread_wakeup(pid);
+    if (_check(pid) < 0) {
+        return 1;
+    }
+    stackmon_print();
+    puts("SUCCESS");
+    return 0;
+}
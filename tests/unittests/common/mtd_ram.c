@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "mtd_ram.h"
+
+static uint32_t _size(const mtd_dev_t *dev)
+{
+    return dev->sector_count * dev->pages_per_sector * dev->page_size;
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int _read(mtd_dev_t *dev, void *buff, uint32_t addr, uint32_t size)
+{
+    mtd_ram_t *ram = (mtd_ram_t *)dev;
+
+    if (addr + size > _size(dev)) {
+        return -EOVERFLOW;
+    }
+    ram->reads++;
+    memcpy(buff, ram->memory + addr, size);
+    return size;
+}
+
+static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr,
+                  uint32_t size)
+{
+    mtd_ram_t *ram = (mtd_ram_t *)dev;
+    const uint8_t *in = buff;
+
+    if ((addr + size > _size(dev)) ||
+        ((addr % dev->page_size) + size > dev->page_size)) {
+        return -EOVERFLOW;
+    }
+    if (ram->write_error) {
+        return ram->write_error;
+    }
+    ram->writes++;
+    for (uint32_t i = 0; i < size; i++) {
+        ram->memory[addr + i] &= in[i];
+    }
+    return size;
+}
+
+static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
+{
+    mtd_ram_t *ram = (mtd_ram_t *)dev;
+    uint32_t sector_size = dev->pages_per_sector * dev->page_size;
+
+    if (((addr % sector_size) != 0) || ((size % sector_size) != 0) ||
+        (addr + size > _size(dev))) {
+        return -EOVERFLOW;
+    }
+    ram->erases++;
+    if (ram->sector_erases) {
+        for (uint32_t s = addr / sector_size; s < (addr + size) / sector_size;
+             s++) {
+            ram->sector_erases[s]++;
+        }
+    }
+    memset(ram->memory + addr, 0xff, size);
+    return 0;
+}
+
+static int _power(mtd_dev_t *dev, enum mtd_power_state power)
+{
+    (void)dev;
+    (void)power;
+    return 0;
+}
+
+const mtd_desc_t mtd_ram_driver = {
+    .init = _init,
+    .read = _read,
+    .write = _write,
+    .erase = _erase,
+    .power = _power,
+};
+
+void mtd_ram_reset(mtd_ram_t *ram)
+{
+    ram->reads = 0;
+    ram->writes = 0;
+    ram->erases = 0;
+    if (ram->sector_erases) {
+        memset(ram->sector_erases, 0,
+               ram->base.sector_count * sizeof(ram->sector_erases[0]));
+    }
+    ram->write_error = 0;
+}
+/** @} */
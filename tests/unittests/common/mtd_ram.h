@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief   RAM-based mtd with NOR flash semantics for unit tests
+ *
+ * Writes can only clear bits and must not cross a page, erases work on whole
+ * sectors. The device counts its transactions, so tests can check how a
+ * module uses it.
+ */
+#ifndef MTD_RAM_H
+#define MTD_RAM_H
+
+#include <stdint.h>
+
+#include "mtd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   RAM-based mtd device
+ */
+typedef struct {
+    mtd_dev_t base;             /**< mtd device, must be first */
+    uint8_t *memory;            /**< contents of the device */
+    unsigned reads;             /**< number of reads */
+    unsigned writes;            /**< number of writes */
+    unsigned erases;            /**< number of erases */
+    unsigned *sector_erases;    /**< erases per sector, may be NULL */
+    int write_error;            /**< if not 0, writes fail with this error */
+} mtd_ram_t;
+
+/**
+ * @brief   Driver of the RAM-based mtd device
+ */
+extern const mtd_desc_t mtd_ram_driver;
+
+/**
+ * @brief   Static initializer for a RAM-based mtd device
+ *
+ * @param[in] mem       memory of sectors * pages * page_size bytes
+ * @param[in] sectors   number of sectors
+ * @param[in] pages     number of pages per sector
+ * @param[in] page_sz   size of a page in bytes
+ */
+#define MTD_RAM_INIT(mem, sectors, pages, page_sz) { \
+        .base = { \
+            .driver = &mtd_ram_driver, \
+            .sector_count = (sectors), \
+            .pages_per_sector = (pages), \
+            .page_size = (page_sz), \
+        }, \
+        .memory = (mem), \
+    }
+
+/**
+ * @brief   Resets the transaction counters and the write error
+ *
+ * @param[in,out] ram   device to reset
+ */
+void mtd_ram_reset(mtd_ram_t *ram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_RAM_H */
+/** @} */
@@ -0,0 +1,541 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the streaming CBOR reader and writer
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "cbor.h"
+#include "xtimer.h"
+
+#define BENCH_LOOPS     (1000U)
+#define BENCH_VALUES    (64U)
+#define TRACE_SIZE      (1024U)
+
+static uint8_t _buf[256];
+static uint8_t _msg[256];
+static size_t _msg_len;
+
+/* sink appending to _msg */
+static int _sink(void *arg, const void *data, size_t len)
+{
+    (void)arg;
+    if (_msg_len + len > sizeof(_msg)) {
+        return -ENOSPC;
+    }
+    memcpy(&_msg[_msg_len], data, len);
+    _msg_len += len;
+    return 0;
+}
+
+static int _sink_fail(void *arg, const void *data, size_t len)
+{
+    (void)arg;
+    (void)data;
+    (void)len;
+    return -EIO;
+}
+
+static const char _long[] = "a byte string that is longer than the buffer";
+
+/* message using all item types, returns its length in _buf */
+static int _write_msg(cbor_writer_t *w)
+{
+    static const int32_t vals[] = { 0, 23, 24, -1, -25, 1000, -70000, INT32_MIN };
+
+    cbor_writer_map(w, 4);
+    cbor_writer_text(w, "ints", 4);
+    cbor_writer_int32_array(w, vals, sizeof(vals) / sizeof(vals[0]));
+    cbor_writer_text(w, "data", 4);
+    cbor_writer_bytes(w, _long, sizeof(_long));
+    cbor_writer_text(w, "misc", 4);
+    cbor_writer_array_indefinite(w);
+    cbor_writer_uint(w, UINT64_MAX);
+    cbor_writer_int(w, INT64_MIN);
+    cbor_writer_tag(w, 1);
+    cbor_writer_uint(w, 1500000000);
+    cbor_writer_bool(w, true);
+    cbor_writer_null(w);
+    cbor_writer_map(w, 0);
+    cbor_writer_break(w);
+    cbor_writer_text(w, "", 0);
+    cbor_writer_array(w, 1);
+    cbor_writer_array(w, 0);
+    return cbor_writer_finish(w);
+}
+
+/* decodes @p len bytes of @p msg in chunks of @p chunk bytes into a text
+ * trace of all items and string data */
+static int _trace(const uint8_t *msg, size_t len, size_t chunk, char *trace)
+{
+    cbor_reader_t reader;
+    cbor_item_t item;
+    const uint8_t *data;
+    size_t pos = 0;
+    int res;
+
+    cbor_reader_init(&reader);
+    trace[0] = '\0';
+    while (pos < len) {
+        size_t n = (len - pos < chunk) ? len - pos : chunk;
+        cbor_reader_feed(&reader, &msg[pos], n);
+        pos += n;
+        for (;;) {
+            /* read string data first, it may continue in the next chunk */
+            while ((res = cbor_reader_data(&reader, &data)) > 0) {
+                while (res--) {
+                    sprintf(trace + strlen(trace), "%02x", *data++);
+                }
+            }
+            if ((res < 0) || ((res = cbor_reader_next(&reader, &item)) < 0)) {
+                break;
+            }
+            sprintf(trace + strlen(trace), " %u/%u:%" PRIx32 "%08" PRIx32 "%s ",
+                    (unsigned)item.type, (unsigned)item.depth,
+                    (uint32_t)(item.val >> 32),
+                    (uint32_t)item.val, item.indefinite ? "_" : "");
+        }
+        if (res != -EAGAIN) {
+            return res;
+        }
+    }
+    return (reader.depth || reader.data_left) ? -EAGAIN : 0;
+}
+
+static void test_cbor_writer__items(void)
+{
+    static const uint8_t expected[] = {
+        0x83,                                   /* [ */
+        0x00, 0x38, 0x63,                       /* 0, -100, */
+        0x1b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, /* 2^32, */
+        0xbf, 0x62, 0x68, 0x69, 0xf5, 0xff,     /* {_ "hi": true} */
+    };
+    cbor_writer_t w;
+
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    cbor_writer_array(&w, 3);
+    cbor_writer_int(&w, 0);
+    cbor_writer_int(&w, -100);
+    cbor_writer_uint(&w, 0x100000000ULL);
+    cbor_writer_map_indefinite(&w);
+    cbor_writer_text(&w, "hi", 2);
+    cbor_writer_bool(&w, true);
+    cbor_writer_break(&w);
+    TEST_ASSERT_EQUAL_INT(sizeof(expected), cbor_writer_finish(&w));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(expected, _buf, sizeof(expected)));
+}
+
+static void test_cbor_writer__same_as_stream(void)
+{
+    static const int vals[] = { 0, 23, 24, 255, 256, 65536, -1, -24, -25, -65537 };
+    unsigned char data[64];
+    cbor_stream_t stream;
+    cbor_writer_t w;
+
+    cbor_init(&stream, data, sizeof(data));
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    cbor_serialize_array(&stream, sizeof(vals) / sizeof(vals[0]));
+    cbor_writer_array(&w, sizeof(vals) / sizeof(vals[0]));
+    for (unsigned i = 0; i < sizeof(vals) / sizeof(vals[0]); i++) {
+        cbor_serialize_int(&stream, vals[i]);
+        cbor_writer_int(&w, vals[i]);
+    }
+    cbor_serialize_byte_string(&stream, "bytes");
+    cbor_writer_bytes(&w, "bytes", 5);
+    cbor_serialize_unicode_string(&stream, "text");
+    cbor_writer_text(&w, "text", 4);
+    TEST_ASSERT_EQUAL_INT(stream.pos, cbor_writer_finish(&w));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, _buf, stream.pos));
+}
+
+static void test_cbor_writer__sink(void)
+{
+    uint8_t small[9];
+    cbor_writer_t w;
+    int len;
+
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    len = _write_msg(&w);
+    TEST_ASSERT(len > (int)sizeof(_long));
+
+    /* the long string does not fit and goes to the sink directly */
+    _msg_len = 0;
+    cbor_writer_init(&w, small, sizeof(small), _sink, NULL);
+    TEST_ASSERT_EQUAL_INT(len, _write_msg(&w));
+    TEST_ASSERT_EQUAL_INT(len, _msg_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buf, _msg, len));
+}
+
+static void test_cbor_writer__errors(void)
+{
+    uint8_t small[9];
+    cbor_writer_t w;
+
+    /* without a sink, the message has to fit into the buffer */
+    cbor_writer_init(&w, small, sizeof(small), NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, cbor_writer_uint(&w, UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, cbor_writer_null(&w));
+    /* errors are sticky */
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, cbor_writer_array(&w, 0));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, cbor_writer_finish(&w));
+
+    cbor_writer_init(&w, small, sizeof(small), _sink_fail, NULL);
+    TEST_ASSERT_EQUAL_INT(0, cbor_writer_uint(&w, UINT64_MAX));
+    TEST_ASSERT_EQUAL_INT(-EIO, cbor_writer_null(&w));
+    TEST_ASSERT_EQUAL_INT(-EIO, cbor_writer_finish(&w));
+}
+
+static void test_cbor_reader__items(void)
+{
+    /* {"a": 1, "b": [2, -3]} */
+    static const uint8_t msg[] = {
+        0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x22
+    };
+    cbor_reader_t reader;
+    cbor_item_t item;
+    const uint8_t *data;
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, msg, sizeof(msg));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_MAP, item.type);
+    TEST_ASSERT_EQUAL_INT(2, item.val);
+    TEST_ASSERT_EQUAL_INT(0, item.depth);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_TEXT, item.type);
+    TEST_ASSERT_EQUAL_INT(1, item.depth);
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_data(&reader, &data));
+    TEST_ASSERT_EQUAL_INT('a', *data);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_data(&reader, &data));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_UINT, item.type);
+    TEST_ASSERT_EQUAL_INT(1, item.val);
+    /* string data that is not read is skipped */
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_TEXT, item.type);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_ARRAY, item.type);
+    TEST_ASSERT_EQUAL_INT(1, item.depth);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(2, item.depth);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_NEGINT, item.type);
+    TEST_ASSERT_EQUAL_INT(2, item.val);
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(0, reader.depth);
+}
+
+static void test_cbor_reader__chunks(void)
+{
+    static char whole[TRACE_SIZE], chunked[TRACE_SIZE];
+    cbor_writer_t w;
+    int len;
+
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    len = _write_msg(&w);
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT_EQUAL_INT(0, _trace(_buf, len, len, whole));
+    /* heads and strings split at every possible position */
+    for (int chunk = 1; chunk < len; chunk++) {
+        TEST_ASSERT_EQUAL_INT(0, _trace(_buf, len, chunk, chunked));
+        TEST_ASSERT_EQUAL_STRING(&whole[0], &chunked[0]);
+    }
+    /* a cut message is incomplete */
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, _trace(_buf, len - 1, len, chunked));
+}
+
+static void test_cbor_reader__indefinite(void)
+{
+    /* [_ 1, [2, 3], [_ ], (_ h'0102', h'030405')] */
+    static const uint8_t msg[] = {
+        0x9f, 0x01, 0x82, 0x02, 0x03, 0x9f, 0xff,
+        0x5f, 0x42, 0x01, 0x02, 0x43, 0x03, 0x04, 0x05, 0xff, 0xff
+    };
+    static const uint8_t types[] = {
+        CBOR_ITEM_ARRAY, CBOR_ITEM_UINT, CBOR_ITEM_ARRAY, CBOR_ITEM_UINT,
+        CBOR_ITEM_UINT, CBOR_ITEM_ARRAY, CBOR_ITEM_BREAK, CBOR_ITEM_BYTES,
+        CBOR_ITEM_BYTES, CBOR_ITEM_BYTES, CBOR_ITEM_BREAK, CBOR_ITEM_BREAK
+    };
+    static const uint8_t depths[] = { 0, 1, 1, 2, 2, 1, 1, 1, 2, 2, 1, 0 };
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, msg, sizeof(msg));
+    for (unsigned i = 0; i < sizeof(types); i++) {
+        TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+        TEST_ASSERT_EQUAL_INT(types[i], item.type);
+        TEST_ASSERT_EQUAL_INT(depths[i], item.depth);
+    }
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, cbor_reader_next(&reader, &item));
+}
+
+static void test_cbor_reader__skip(void)
+{
+    /* [{"k": [1, [2]], "x": h'00'}, 7] */
+    static const uint8_t msg[] = {
+        0x82, 0xa2, 0x61, 0x6b, 0x82, 0x01, 0x81, 0x02,
+        0x61, 0x78, 0x41, 0x00, 0x07
+    };
+    cbor_reader_t reader;
+    cbor_item_t item;
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, msg, 6);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_MAP, item.type);
+    /* skipping resumes with the next chunk */
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, cbor_reader_skip(&reader));
+    cbor_reader_feed(&reader, &msg[6], sizeof(msg) - 6);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_skip(&reader));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_UINT, item.type);
+    TEST_ASSERT_EQUAL_INT(7, item.val);
+    TEST_ASSERT_EQUAL_INT(1, item.depth);
+}
+
+static void test_cbor_reader__invalid(void)
+{
+    static const uint8_t break_top[] = { 0xff };
+    static const uint8_t reserved[] = { 0x1c };
+    static const uint8_t indef_int[] = { 0x1f };
+    static const uint8_t bad_chunk[] = { 0x5f, 0x61, 0x61 };
+    static const uint8_t deep[] = {
+        0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81
+    };
+    cbor_reader_t reader;
+    cbor_item_t item;
+    int res;
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, break_top, sizeof(break_top));
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, cbor_reader_next(&reader, &item));
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, reserved, sizeof(reserved));
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, cbor_reader_next(&reader, &item));
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, indef_int, sizeof(indef_int));
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, cbor_reader_next(&reader, &item));
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, bad_chunk, sizeof(bad_chunk));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, cbor_reader_next(&reader, &item));
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, deep, sizeof(deep));
+    while ((res = cbor_reader_next(&reader, &item)) == 0) {}
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, res);
+    TEST_ASSERT_EQUAL_INT(CBOR_READER_DEPTH_MAX, reader.depth);
+}
+
+static void test_cbor_reader__int32_array(void)
+{
+    static const uint8_t out_of_range[] = { 0x82, 0x01, 0x1a, 0x80, 0x00, 0x00, 0x00 };
+    static const uint8_t not_int[] = { 0x9f, 0x01, 0x60, 0xff };
+    int32_t vals[BENCH_VALUES], read[BENCH_VALUES];
+    cbor_reader_t reader;
+    cbor_item_t item;
+    cbor_writer_t w;
+    int len, res;
+    size_t got = 0, pos = 0;
+
+    for (unsigned i = 0; i < BENCH_VALUES; i++) {
+        vals[i] = (i & 1) ? -(int32_t)(i * i * i * i) : (int32_t)(i * 7);
+    }
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    cbor_writer_int32_array(&w, vals, BENCH_VALUES);
+    cbor_writer_uint(&w, 42);
+    len = cbor_writer_finish(&w);
+    TEST_ASSERT(len > 0);
+
+    /* read in chunks of 3 bytes */
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, _buf, 3);
+    pos = 3;
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(BENCH_VALUES, item.val);
+    while ((res = cbor_reader_int32_array(&reader, &read[got],
+                                          BENCH_VALUES - got)) != 0) {
+        if (res == -EAGAIN) {
+            size_t n = ((size_t)len - pos < 3) ? (size_t)len - pos : 3;
+            TEST_ASSERT(n > 0);
+            cbor_reader_feed(&reader, &_buf[pos], n);
+            pos += n;
+            continue;
+        }
+        TEST_ASSERT(res > 0);
+        got += res;
+        if (got == BENCH_VALUES) {
+            /* the end of the array is reported */
+            TEST_ASSERT_EQUAL_INT(0, cbor_reader_int32_array(&reader, read, 1));
+            break;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(BENCH_VALUES, got);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(vals, read, sizeof(vals)));
+    while ((res = cbor_reader_next(&reader, &item)) == -EAGAIN) {
+        cbor_reader_feed(&reader, &_buf[pos], len - pos);
+        pos = len;
+    }
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(42, item.val);
+    TEST_ASSERT_EQUAL_INT(0, item.depth);
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, out_of_range, sizeof(out_of_range));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_int32_array(&reader, read, 2));
+    TEST_ASSERT_EQUAL_INT(-ERANGE, cbor_reader_int32_array(&reader, read, 2));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(0x80000000, item.val);
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, not_int, sizeof(not_int));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(1, cbor_reader_int32_array(&reader, read, 2));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, cbor_reader_int32_array(&reader, read, 2));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_TEXT, item.type);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_int32_array(&reader, read, 2));
+}
+
+#ifdef MODULE_CBOR_FLOAT
+static void test_cbor_reader__float_array(void)
+{
+    /* [1.0, 1.5, -4.1] as half, single and double */
+    static const uint8_t msg[] = {
+        0x83, 0xf9, 0x3c, 0x00, 0xfa, 0x3f, 0xc0, 0x00, 0x00,
+        0xfb, 0xc0, 0x10, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+    };
+    static const float vals[] = { 0.5f, -100000.f, 3.25f };
+    float read[3];
+    cbor_reader_t reader;
+    cbor_item_t item;
+    cbor_writer_t w;
+
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, msg, sizeof(msg));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(3, cbor_reader_float_array(&reader, read, 3));
+    TEST_ASSERT(read[0] == 1.0f);
+    TEST_ASSERT(read[1] == 1.5f);
+    TEST_ASSERT(read[2] == -4.1f);
+
+    cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+    cbor_writer_float_array(&w, vals, 3);
+    cbor_writer_double(&w, -4.1);
+    TEST_ASSERT_EQUAL_INT(1 + 3 * 5 + 9, cbor_writer_finish(&w));
+    cbor_reader_init(&reader);
+    cbor_reader_feed(&reader, _buf, 1 + 3 * 5 + 9);
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(3, cbor_reader_float_array(&reader, read, 3));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(vals, read, sizeof(vals)));
+    TEST_ASSERT_EQUAL_INT(0, cbor_reader_next(&reader, &item));
+    TEST_ASSERT_EQUAL_INT(CBOR_ITEM_FLOAT, item.type);
+    TEST_ASSERT_EQUAL_INT(8, item.size);
+    TEST_ASSERT(cbor_item_double(&item) == -4.1);
+}
+#endif /* MODULE_CBOR_FLOAT */
+
+static void test_cbor_stream__bench(void)
+{
+    int32_t vals[BENCH_VALUES];
+    unsigned char data[sizeof(_buf)];
+    cbor_stream_t stream;
+    cbor_reader_t reader;
+    cbor_item_t item;
+    cbor_writer_t w;
+    uint32_t start, enc_stream, enc_writer, dec_stream, dec_reader;
+    size_t len = 0;
+
+    for (unsigned i = 0; i < BENCH_VALUES; i++) {
+        vals[i] = (i & 1) ? -(int32_t)(i * 1000) : (int32_t)i;
+    }
+
+    cbor_init(&stream, data, sizeof(data));
+    start = xtimer_now_usec();
+    for (unsigned n = 0; n < BENCH_LOOPS; n++) {
+        cbor_clear(&stream);
+        cbor_serialize_array(&stream, BENCH_VALUES);
+        for (unsigned i = 0; i < BENCH_VALUES; i++) {
+            cbor_serialize_int(&stream, vals[i]);
+        }
+    }
+    enc_stream = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned n = 0; n < BENCH_LOOPS; n++) {
+        cbor_writer_init(&w, _buf, sizeof(_buf), NULL, NULL);
+        cbor_writer_int32_array(&w, vals, BENCH_VALUES);
+        len = cbor_writer_finish(&w);
+    }
+    enc_writer = xtimer_now_usec() - start;
+    TEST_ASSERT_EQUAL_INT(stream.pos, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, _buf, len));
+
+    start = xtimer_now_usec();
+    for (unsigned n = 0; n < BENCH_LOOPS; n++) {
+        size_t count, offset = cbor_deserialize_array(&stream, 0, &count);
+        for (unsigned i = 0; i < count; i++) {
+            int val;
+            offset += cbor_deserialize_int(&stream, offset, &val);
+            vals[i] = val;
+        }
+    }
+    dec_stream = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned n = 0; n < BENCH_LOOPS; n++) {
+        cbor_reader_init(&reader);
+        cbor_reader_feed(&reader, _buf, len);
+        cbor_reader_next(&reader, &item);
+        cbor_reader_int32_array(&reader, vals, item.val);
+    }
+    dec_reader = xtimer_now_usec() - start;
+
+    printf("\ncbor: %u x %u ints: encode stream %" PRIu32 " us, "
+           "writer %" PRIu32 " us; decode stream %" PRIu32 " us, "
+           "reader %" PRIu32 " us\n", BENCH_LOOPS, BENCH_VALUES,
+           enc_stream, enc_writer, dec_stream, dec_reader);
+}
+
+TestRef tests_cbor_stream_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_cbor_writer__items),
+        new_TestFixture(test_cbor_writer__same_as_stream),
+        new_TestFixture(test_cbor_writer__sink),
+        new_TestFixture(test_cbor_writer__errors),
+        new_TestFixture(test_cbor_reader__items),
+        new_TestFixture(test_cbor_reader__chunks),
+        new_TestFixture(test_cbor_reader__indefinite),
+        new_TestFixture(test_cbor_reader__skip),
+        new_TestFixture(test_cbor_reader__invalid),
+        new_TestFixture(test_cbor_reader__int32_array),
+#ifdef MODULE_CBOR_FLOAT
+        new_TestFixture(test_cbor_reader__float_array),
+#endif /* MODULE_CBOR_FLOAT */
+        new_TestFixture(test_cbor_stream__bench),
+    };
+
+    EMB_UNIT_TESTCALLER(cbor_stream_tests, NULL, NULL, fixtures);
+
+    return (TestRef)&cbor_stream_tests;
+}
+
+/** @} */
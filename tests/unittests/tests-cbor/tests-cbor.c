@@ -803,7 +803,10 @@ TestRef tests_cbor_all(void)
     return (TestRef)&CborTest;
 }
 
+TestRef tests_cbor_stream_tests(void);
+
 void tests_cbor(void)
 {
     TESTS_RUN(tests_cbor_all());
+    TESTS_RUN(tests_cbor_stream_tests());
 }
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "embUnit.h"
+
+#include "seqlock.h"
+
+#include "tests-core.h"
+
+static seqlock_t lock;
+
+static void set_up(void)
+{
+    seqlock_init(&lock);
+}
+
+static void test_seqlock_read_unchanged(void)
+{
+    unsigned seq = seqlock_read_begin(&lock);
+
+    TEST_ASSERT(!seqlock_read_retry(&lock, seq));
+}
+
+static void test_seqlock_read_changed(void)
+{
+    unsigned seq = seqlock_read_begin(&lock);
+    unsigned state = seqlock_write_begin(&lock);
+
+    seqlock_write_end(&lock, state);
+    TEST_ASSERT(seqlock_read_retry(&lock, seq));
+
+    /* reading again succeeds */
+    seq = seqlock_read_begin(&lock);
+    TEST_ASSERT(!seqlock_read_retry(&lock, seq));
+}
+
+static void test_seqlock_read_during_write(void)
+{
+    unsigned seq = seqlock_read_begin(&lock);
+    unsigned state = seqlock_write_begin(&lock);
+
+    /* e.g. an interrupt that started reading before the write */
+    TEST_ASSERT(seqlock_read_retry(&lock, seq));
+    seqlock_write_end(&lock, state);
+    TEST_ASSERT(seqlock_read_retry(&lock, seq));
+}
+
+static void test_seqlock_static_init(void)
+{
+    seqlock_t tmp = SEQLOCK_INIT;
+    unsigned seq = seqlock_read_begin(&tmp);
+
+    TEST_ASSERT_EQUAL_INT(0, seq);
+    TEST_ASSERT(!seqlock_read_retry(&tmp, seq));
+}
+
+Test *tests_core_seqlock_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_seqlock_read_unchanged),
+        new_TestFixture(test_seqlock_read_changed),
+        new_TestFixture(test_seqlock_read_during_write),
+        new_TestFixture(test_seqlock_static_init),
+    };
+
+    EMB_UNIT_TESTCALLER(core_seqlock_tests, set_up, NULL, fixtures);
+
+    return (Test *)&core_seqlock_tests;
+}
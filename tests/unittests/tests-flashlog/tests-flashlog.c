@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <string.h>
+#include <errno.h>
+
+#include "embUnit.h"
+
+#include "flashlog.h"
+#include "mtd_ram.h"
+
+#include "tests-flashlog.h"
+
+/* geometry of the RAM-based mtd the log is tested on */
+#define SECTOR_COUNT    (4U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+
+/* size of a record with a 4 byte payload on the device */
+#define REC_SIZE        (12U)
+
+static uint8_t _memory[SECTOR_SIZE * SECTOR_COUNT];
+static mtd_ram_t _ram = MTD_RAM_INIT(_memory, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                     PAGE_SIZE);
+
+static uint8_t _page_buf[PAGE_SIZE];
+static flashlog_sector_t _sectors[SECTOR_COUNT];
+static flashlog_t _log;
+
+static int _mount(void)
+{
+    memset(&_log, 0, sizeof(_log));
+    _log.mtd = &_ram.base;
+    _log.page_buf = _page_buf;
+    _log.sectors = _sectors;
+    return flashlog_mount(&_log);
+}
+
+static void _append(uint32_t first, uint32_t last)
+{
+    for (uint32_t ts = first; ts <= last; ts++) {
+        TEST_ASSERT_EQUAL_INT(0, flashlog_append(&_log, ts, &ts, sizeof(ts)));
+    }
+}
+
+/* checks that the records of [first, last] are read back in order */
+static void _check(uint32_t from, uint32_t to, uint32_t first, uint32_t last)
+{
+    flashlog_iter_t iter;
+    uint32_t data, ts;
+    uint32_t expected = first;
+    int res;
+
+    flashlog_iter_init(&_log, &iter, from, to);
+    while ((res = flashlog_iter_next(&_log, &iter, &ts, &data,
+                                     sizeof(data))) >= 0) {
+        TEST_ASSERT_EQUAL_INT(sizeof(data), res);
+        TEST_ASSERT_EQUAL_INT(expected, ts);
+        TEST_ASSERT_EQUAL_INT(expected, data);
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOENT, res);
+    TEST_ASSERT_EQUAL_INT(last + 1, expected);
+}
+
+static void setup(void)
+{
+    memset(_memory, 0xff, sizeof(_memory));
+    _mount();
+    mtd_ram_reset(&_ram);
+}
+
+static void teardown(void)
+{
+}
+
+static void test_flashlog_mount__empty(void)
+{
+    flashlog_iter_t iter;
+    uint8_t buf[4];
+
+    TEST_ASSERT(_log.empty);
+    flashlog_iter_init(&_log, &iter, 0, FLASHLOG_TS_MAX);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, flashlog_iter_next(&_log, &iter, NULL, buf,
+                                                      sizeof(buf)));
+}
+
+static void test_flashlog_mount__EINVAL(void)
+{
+    _ram.base.sector_count = 1;
+    TEST_ASSERT_EQUAL_INT(-EINVAL, _mount());
+    _ram.base.sector_count = SECTOR_COUNT;
+}
+
+static void test_flashlog_append__batched(void)
+{
+    /* sector header and 4 records fill the first page */
+    _append(1, 4);
+    TEST_ASSERT_EQUAL_INT(1, _ram.erases);
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    _append(5, 6);
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    /* unwritten records are read from the page buffer */
+    _check(0, FLASHLOG_TS_MAX, 1, 6);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(2, _ram.writes);
+    /* flushing again is a no-op, only new data is programmed next time */
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(2, _ram.writes);
+    _append(7, 7);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(3, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(16 + 7 * REC_SIZE, _log.stats.bytes_programmed);
+    TEST_ASSERT_EQUAL_INT(7, _log.stats.appends);
+    _check(0, FLASHLOG_TS_MAX, 1, 7);
+}
+
+static void test_flashlog_append__rotate(void)
+{
+    /* (256 - 16) / 12 = 20 records per sector, 5 rounds over all sectors */
+    _append(1, 400);
+    TEST_ASSERT_EQUAL_INT(20, _ram.erases);
+    for (unsigned i = 0; i < SECTOR_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT(5, _sectors[i].erase_count);
+    }
+    /* the last round filled all sectors */
+    _check(0, FLASHLOG_TS_MAX, 321, 400);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(5, _sectors[0].erase_count);
+    _check(0, FLASHLOG_TS_MAX, 321, 400);
+}
+
+static void test_flashlog_append__EMSGSIZE(void)
+{
+    static uint8_t buf[SECTOR_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(-EMSGSIZE, flashlog_append(&_log, 1, buf,
+                                                     sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, flashlog_append(&_log, 1, buf,
+                                             SECTOR_SIZE - 16 - 8));
+}
+
+static void test_flashlog_mount__recover(void)
+{
+    _append(1, 50);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    /* records that were not flushed are lost */
+    _append(51, 52);
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT(!_log.empty);
+    TEST_ASSERT_EQUAL_INT(50, _log.last_ts);
+    _check(0, FLASHLOG_TS_MAX, 1, 50);
+    /* appending continues in the partially filled page */
+    _append(51, 60);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    _check(0, FLASHLOG_TS_MAX, 1, 60);
+}
+
+static void test_flashlog_mount__damaged(void)
+{
+    _append(1, 3);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    /* cut the payload of the second record */
+    _memory[16 + REC_SIZE + 8] = 0;
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(3, _log.last_ts);
+
+    flashlog_iter_t iter;
+    uint32_t data, ts;
+    flashlog_iter_init(&_log, &iter, 0, FLASHLOG_TS_MAX);
+    TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data, 4));
+    TEST_ASSERT_EQUAL_INT(1, ts);
+    TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data, 4));
+    TEST_ASSERT_EQUAL_INT(3, ts);
+
+    /* cut a record header, the sector is not appended to anymore */
+    _memory[16 + 2 * REC_SIZE + 1] = 0x0f;
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(SECTOR_SIZE, _log.offset);
+    _append(4, 4);
+    TEST_ASSERT_EQUAL_INT(1, _log.head);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    flashlog_iter_init(&_log, &iter, 2, FLASHLOG_TS_MAX);
+    TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data, 4));
+    TEST_ASSERT_EQUAL_INT(4, ts);
+}
+
+static void test_flashlog_iter__range(void)
+{
+    _append(1, 70);
+    _check(35, 45, 35, 45);
+    _check(0, 10, 1, 10);
+    _check(60, FLASHLOG_TS_MAX, 60, 70);
+    _check(71, FLASHLOG_TS_MAX, 71, 70);
+}
+
+static void test_flashlog_iter__follow(void)
+{
+    flashlog_iter_t iter;
+    uint32_t data, ts;
+
+    _append(1, 1);
+    flashlog_iter_init(&_log, &iter, 0, FLASHLOG_TS_MAX);
+    TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data, 4));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, flashlog_iter_next(&_log, &iter, &ts,
+                                                      &data, 4));
+    /* new records are returned by an iterator at the end of the log */
+    _append(2, 30);
+    for (uint32_t i = 2; i <= 30; i++) {
+        TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data,
+                                                    4));
+        TEST_ASSERT_EQUAL_INT(i, ts);
+    }
+    /* too small buffer skips the record */
+    _append(31, 32);
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, flashlog_iter_next(&_log, &iter, &ts,
+                                                       &data, 2));
+    TEST_ASSERT_EQUAL_INT(4, flashlog_iter_next(&_log, &iter, &ts, &data, 4));
+    TEST_ASSERT_EQUAL_INT(32, ts);
+    /* overwritten sectors are detected */
+    _append(33, 120);
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, flashlog_iter_next(&_log, &iter, &ts,
+                                                      &data, 4));
+}
+
+static void test_flashlog_format(void)
+{
+    _append(1, 30);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_format(&_log));
+    _check(0, FLASHLOG_TS_MAX, 1, 0);
+    _append(31, 32);
+    TEST_ASSERT_EQUAL_INT(0, flashlog_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    _check(0, FLASHLOG_TS_MAX, 31, 32);
+}
+
+Test *tests_flashlog_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_flashlog_mount__empty),
+        new_TestFixture(test_flashlog_mount__EINVAL),
+        new_TestFixture(test_flashlog_append__batched),
+        new_TestFixture(test_flashlog_append__rotate),
+        new_TestFixture(test_flashlog_append__EMSGSIZE),
+        new_TestFixture(test_flashlog_mount__recover),
+        new_TestFixture(test_flashlog_mount__damaged),
+        new_TestFixture(test_flashlog_iter__range),
+        new_TestFixture(test_flashlog_iter__follow),
+        new_TestFixture(test_flashlog_format),
+    };
+
+    EMB_UNIT_TESTCALLER(flashlog_tests, setup, teardown, fixtures);
+
+    return (Test *)&flashlog_tests;
+}
+
+void tests_flashlog(void)
+{
+    TESTS_RUN(tests_flashlog_tests());
+}
+/** @} */
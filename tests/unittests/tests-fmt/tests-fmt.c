@@ -20,6 +20,98 @@
 #include "fmt.h"
 #include "tests-fmt.h"
 
+/* straightforward implementations the optimized ones are compared with */
+static size_t _ref_u64_dec(char *out, uint64_t val)
+{
+    char tmp[20];
+    size_t len = 0;
+
+    do {
+        tmp[len++] = '0' + (val % 10);
+    } while ((val /= 10));
+    for (size_t i = 0; i < len; i++) {
+        out[i] = tmp[len - 1 - i];
+    }
+    return len;
+}
+
+static size_t _ref_s32_dfp(char *out, int32_t val, unsigned fp_digits)
+{
+    int64_t absolute = (val < 0) ? -(int64_t)val : val;
+    uint32_t e = 1;
+    size_t len = 0;
+
+    for (unsigned i = 0; i < fp_digits; i++) {
+        e *= 10;
+    }
+    if (val < 0) {
+        out[len++] = '-';
+    }
+    len += _ref_u64_dec(&out[len], absolute / e);
+    if (fp_digits) {
+        char frac[8];
+        size_t frac_len = _ref_u64_dec(frac, absolute % e);
+        out[len++] = '.';
+        for (size_t i = frac_len; i < fp_digits; i++) {
+            out[len++] = '0';
+        }
+        memcpy(&out[len], frac, frac_len);
+        len += frac_len;
+    }
+    return len;
+}
+
+static uint32_t _xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void _check_u64_dec(uint64_t val)
+{
+    char out[21], ref[21];
+    size_t len = fmt_u64_dec(out, val);
+    size_t ref_len = _ref_u64_dec(ref, val);
+
+    out[len] = '\0';
+    ref[ref_len] = '\0';
+    TEST_ASSERT_EQUAL_INT(ref_len, len);
+    TEST_ASSERT_EQUAL_INT(ref_len, fmt_u64_dec(NULL, val));
+    TEST_ASSERT_EQUAL_STRING((char *)ref, (char *)out);
+    TEST_ASSERT(scn_u64_dec(out, len) == val);
+}
+
+static void _check_u32_dec(uint32_t val)
+{
+    char out[11], ref[11];
+    size_t len = fmt_u32_dec(out, val);
+    size_t ref_len = _ref_u64_dec(ref, val);
+
+    out[len] = '\0';
+    ref[ref_len] = '\0';
+    TEST_ASSERT_EQUAL_INT(ref_len, len);
+    TEST_ASSERT_EQUAL_INT(ref_len, fmt_u32_dec(NULL, val));
+    TEST_ASSERT_EQUAL_STRING((char *)ref, (char *)out);
+    TEST_ASSERT(scn_u32_dec(out, len) == val);
+}
+
+static void _check_s32_dfp(int32_t val, unsigned fp_digits)
+{
+    char out[13], ref[13];
+    size_t len = fmt_s32_dfp(out, val, fp_digits);
+    size_t ref_len = _ref_s32_dfp(ref, val, fp_digits);
+
+    out[len] = '\0';
+    ref[ref_len] = '\0';
+    TEST_ASSERT_EQUAL_INT(ref_len, len);
+    TEST_ASSERT_EQUAL_INT(ref_len, fmt_s32_dfp(NULL, val, fp_digits));
+    TEST_ASSERT_EQUAL_STRING((char *)ref, (char *)out);
+}
+
 static void test_fmt_byte_hex(void)
 {
     char out[3] = "--";
@@ -303,6 +395,86 @@ static void test_fmt_s32_dfp(void)
     TEST_ASSERT_EQUAL_STRING("-123456789", (char *)out);
 }
 
+static void test_fmt_s32_dec_min(void)
+{
+    char out[13];
+    size_t len;
+
+    len = fmt_s32_dec(out, INT32_MIN);
+    out[len] = '\0';
+    TEST_ASSERT_EQUAL_INT(11, len);
+    TEST_ASSERT_EQUAL_STRING("-2147483648", (char *)out);
+
+    len = fmt_s32_dfp(out, INT32_MIN, 7);
+    out[len] = '\0';
+    TEST_ASSERT_EQUAL_INT(12, len);
+    TEST_ASSERT_EQUAL_STRING("-214.7483648", (char *)out);
+}
+
+static void test_fmt_dec_all_16bit(void)
+{
+    for (uint32_t i = 0; i <= UINT16_MAX; i++) {
+        char out[8], ref[8];
+        size_t len = fmt_u16_dec(out, i);
+
+        TEST_ASSERT_EQUAL_INT(_ref_u64_dec(ref, i), len);
+        TEST_ASSERT(memcmp(out, ref, len) == 0);
+
+        /* all values and scales phydat_dump() prints as fixed point */
+        for (unsigned fp_digits = 0; fp_digits <= 4; fp_digits++) {
+            _check_s32_dfp((int16_t)i, fp_digits);
+        }
+    }
+}
+
+static void test_fmt_dec_boundaries(void)
+{
+    uint64_t pow10 = 1;
+
+    for (unsigned i = 0; i < 20; i++) {
+        _check_u64_dec(pow10 - 1);
+        _check_u64_dec(pow10);
+        _check_u64_dec(pow10 + 1);
+        if (pow10 <= UINT32_MAX) {
+            _check_u32_dec(pow10 - 1);
+            _check_u32_dec(pow10);
+            _check_u32_dec(pow10 + 1);
+        }
+        pow10 *= 10;
+    }
+    for (unsigned i = 0; i < 64; i++) {
+        uint64_t pow2 = (uint64_t)1 << i;
+        _check_u64_dec(pow2 - 1);
+        _check_u64_dec(pow2);
+        if (i < 32) {
+            _check_u32_dec(pow2 - 1);
+            _check_u32_dec(pow2);
+        }
+    }
+    _check_u64_dec(UINT64_MAX);
+    _check_u32_dec(UINT32_MAX);
+    for (unsigned fp_digits = 0; fp_digits < 8; fp_digits++) {
+        _check_s32_dfp(INT32_MAX, fp_digits);
+        _check_s32_dfp(INT32_MIN + 1, fp_digits);
+    }
+}
+
+static void test_fmt_dec_random(void)
+{
+    uint32_t state = 0x12345678;
+
+    for (unsigned i = 0; i < 10000; i++) {
+        uint32_t a = _xorshift32(&state);
+        uint32_t b = _xorshift32(&state);
+
+        _check_u32_dec(a);
+        /* shifting spreads the values over all lengths */
+        _check_u32_dec(a >> (b & 0x1f));
+        _check_u64_dec((((uint64_t)a << 32) | b) >> (b & 0x3f));
+        _check_s32_dfp((int32_t)a >> (b & 0x1f), b % 8);
+    }
+}
+
 static void test_fmt_strlen(void)
 {
     const char *empty_str = "";
@@ -333,6 +505,34 @@ static void test_scn_u32_dec(void)
     TEST_ASSERT_EQUAL_INT(val2, scn_u32_dec(string1, 5));
 }
 
+static void test_scn_u64_dec(void)
+{
+    const char *string1 = "18446744073709551615";
+    const char *string2 = "1234567890123456789x1";
+
+    TEST_ASSERT(scn_u64_dec(string1, 20) == UINT64_MAX);
+    TEST_ASSERT(scn_u64_dec(string1, 10) == 1844674407LLU);
+    TEST_ASSERT(scn_u64_dec(string2, 21) == 1234567890123456789LLU);
+    TEST_ASSERT(scn_u64_dec("", 1) == 0);
+}
+
+static void test_scn_s32_dec(void)
+{
+    TEST_ASSERT_EQUAL_INT(-2147483647 - 1, scn_s32_dec("-2147483648", 11));
+    TEST_ASSERT_EQUAL_INT(2147483647, scn_s32_dec("+2147483647", 11));
+    TEST_ASSERT_EQUAL_INT(-123, scn_s32_dec("-12345", 4));
+    TEST_ASSERT_EQUAL_INT(42, scn_s32_dec("42", 2));
+    TEST_ASSERT_EQUAL_INT(0, scn_s32_dec("-", 1));
+}
+
+static void test_scn_u32_hex(void)
+{
+    TEST_ASSERT(scn_u32_hex("DEADbeef", 8) == 0xdeadbeef);
+    TEST_ASSERT(scn_u32_hex("0123456789abcdef", 4) == 0x0123);
+    TEST_ASSERT(scn_u32_hex("afg", 3) == 0xaf);
+    TEST_ASSERT(scn_u32_hex("x", 1) == 0);
+}
+
 static void test_fmt_lpad(void)
 {
     const char base[] = "abcd";
@@ -381,9 +581,16 @@ Test *tests_fmt_tests(void)
         new_TestFixture(test_fmt_s16_dec),
         new_TestFixture(test_fmt_s16_dfp),
         new_TestFixture(test_fmt_s32_dfp),
+        new_TestFixture(test_fmt_s32_dec_min),
+        new_TestFixture(test_fmt_dec_all_16bit),
+        new_TestFixture(test_fmt_dec_boundaries),
+        new_TestFixture(test_fmt_dec_random),
         new_TestFixture(test_fmt_strlen),
         new_TestFixture(test_fmt_str),
         new_TestFixture(test_scn_u32_dec),
+        new_TestFixture(test_scn_u64_dec),
+        new_TestFixture(test_scn_s32_dec),
+        new_TestFixture(test_scn_u32_hex),
         new_TestFixture(test_fmt_lpad),
     };
 
@@ -253,6 +253,203 @@ static void test_gcoap__server_con_resp(void)
     TEST_ASSERT_EQUAL_INT(sizeof(resp_data), res);
 }
 
+/*
+ * Helper for block-wise tests below.
+ * Request for block 1 of a resource, with 64 byte blocks.
+ * Includes 2-byte token, Uri-Path "/large" and Block2 option.
+ */
+static int _read_block2_req(coap_pkt_t *pdu, uint8_t *buf)
+{
+    uint8_t pdu_data[] = {
+        0x52, 0x01, 0x20, 0xb7, 0x35, 0x62, 0xb5, 0x6c,
+        0x61, 0x72, 0x67, 0x65, 0xc1, 0x12
+    };
+    memcpy(buf, pdu_data, sizeof(pdu_data));
+
+    int res = coap_parse(pdu, buf, sizeof(pdu_data));
+    /* no payload; the options end with the PDU, as set by gcoap on receipt */
+    pdu->payload = buf + sizeof(pdu_data);
+    return res;
+}
+
+/* Writes a 200 byte representation; byte value is its offset */
+static ssize_t _block2_writer(size_t offset, uint8_t *buf, size_t len,
+                              void *arg)
+{
+    size_t total = 200;
+    (void)arg;
+
+    if (offset >= total) {
+        return 0;
+    }
+    if (len > total - offset) {
+        len = total - offset;
+    }
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(offset + i);
+    }
+    return len;
+}
+
+/* Server Block2 request. Validate Block2 option is read. */
+static void test_gcoap__server_block2_req(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    gcoap_block_t block;
+
+    _read_block2_req(&pdu, &buf[0]);
+
+    TEST_ASSERT_EQUAL_INT(1, gcoap_get_block(&pdu, COAP_OPT_BLOCK2, &block));
+    TEST_ASSERT_EQUAL_INT(1, block.num);
+    TEST_ASSERT_EQUAL_INT(2, block.szx);
+    TEST_ASSERT_EQUAL_INT(0, block.more);
+    TEST_ASSERT_EQUAL_INT(64, gcoap_block_offset(&block));
+
+    TEST_ASSERT_EQUAL_INT(0, gcoap_get_block(&pdu, COAP_OPT_BLOCK1, &block));
+    TEST_ASSERT_EQUAL_INT(0, block.num);
+    TEST_ASSERT_EQUAL_INT(GCOAP_BLOCK_SZX_MAX, block.szx);
+}
+
+/*
+ * Server Block2 response. Test writing the requested block, the Block2
+ * option and the more flag.
+ */
+static void test_gcoap__server_block2_resp(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    gcoap_block_t block;
+
+    _read_block2_req(&pdu, &buf[0]);
+
+    ssize_t res = gcoap_block2_response(&pdu, &buf[0], sizeof(buf),
+                                        COAP_FORMAT_TEXT, _block2_writer, NULL);
+
+    /* header, Content-Format, Block2 1/1/64, marker, payload */
+    TEST_ASSERT_EQUAL_INT(6 + 1 + 2 + 1 + 64, res);
+
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&pdu, &buf[0], res));
+    TEST_ASSERT_EQUAL_INT(COAP_CLASS_SUCCESS, coap_get_code_class(&pdu));
+    TEST_ASSERT_EQUAL_INT(64, pdu.payload_len);
+    TEST_ASSERT_EQUAL_INT(64, pdu.payload[0]);
+    TEST_ASSERT_EQUAL_INT(127, pdu.payload[63]);
+
+    TEST_ASSERT_EQUAL_INT(1, gcoap_get_block(&pdu, COAP_OPT_BLOCK2, &block));
+    TEST_ASSERT_EQUAL_INT(1, block.num);
+    TEST_ASSERT_EQUAL_INT(2, block.szx);
+    TEST_ASSERT_EQUAL_INT(1, block.more);
+
+    gcoap_block_advance(&block, 1);
+    TEST_ASSERT_EQUAL_INT(4, block.num);
+    TEST_ASSERT_EQUAL_INT(1, block.szx);
+}
+
+/* Client Block1 request. Test writing the Block1 option. */
+static void test_gcoap__client_block1_req(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    gcoap_block_t block = { .num = 2, .szx = 1, .more = 1 };
+    char path[] = "/log";
+
+    gcoap_req_init(&pdu, &buf[0], sizeof(buf), COAP_METHOD_PUT, &path[0]);
+    memset(pdu.payload, 'x', gcoap_block_size(&block));
+    ssize_t len = gcoap_finish_block(&pdu, gcoap_block_size(&block),
+                                     COAP_FORMAT_TEXT, COAP_OPT_BLOCK1, &block);
+
+    /* header, Uri-Path, Content-Format, Block1 2/1/32, marker, payload */
+    TEST_ASSERT_EQUAL_INT(4 + GCOAP_TOKENLEN + 4 + 1 + 3 + 1 + 32, len);
+
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&pdu, &buf[0], len));
+    TEST_ASSERT_EQUAL_INT(32, pdu.payload_len);
+
+    memset(&block, 0, sizeof(block));
+    TEST_ASSERT_EQUAL_INT(1, gcoap_get_block(&pdu, COAP_OPT_BLOCK1, &block));
+    TEST_ASSERT_EQUAL_INT(2, block.num);
+    TEST_ASSERT_EQUAL_INT(1, block.szx);
+    TEST_ASSERT_EQUAL_INT(1, block.more);
+}
+
+static size_t _block1_offset;
+static size_t _block1_len;
+
+static int _block1_reader(size_t offset, const uint8_t *buf, size_t len,
+                          int more, void *arg)
+{
+    (void)buf;
+    (void)more;
+    (void)arg;
+
+    _block1_offset = offset;
+    _block1_len    = len;
+    return 0;
+}
+
+/* Server Block1 response. Test consuming a block and responding Continue. */
+static void test_gcoap__server_block1_resp(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    gcoap_block_t block = { .num = 2, .szx = 1, .more = 1 };
+    char path[] = "/log";
+
+    gcoap_req_init(&pdu, &buf[0], sizeof(buf), COAP_METHOD_PUT, &path[0]);
+    memset(pdu.payload, 'x', gcoap_block_size(&block));
+    ssize_t len = gcoap_finish_block(&pdu, gcoap_block_size(&block),
+                                     COAP_FORMAT_TEXT, COAP_OPT_BLOCK1, &block);
+    coap_parse(&pdu, &buf[0], len);
+
+    len = gcoap_block1_response(&pdu, &buf[0], sizeof(buf), COAP_CODE_CHANGED,
+                                _block1_reader, NULL);
+
+    TEST_ASSERT_EQUAL_INT(64, _block1_offset);
+    TEST_ASSERT_EQUAL_INT(32, _block1_len);
+    TEST_ASSERT_EQUAL_INT(2, coap_get_code_class(&pdu));
+    TEST_ASSERT_EQUAL_INT(31, coap_get_code_detail(&pdu));
+
+    coap_parse(&pdu, &buf[0], len);
+    pdu.payload = &buf[len];
+    TEST_ASSERT_EQUAL_INT(1, gcoap_get_block(&pdu, COAP_OPT_BLOCK1, &block));
+    TEST_ASSERT_EQUAL_INT(2, block.num);
+    TEST_ASSERT_EQUAL_INT(1, block.more);
+}
+
+/*
+ * Server Block1 response to a block larger than supported. Test echoing the
+ * block number and proposing the smaller size.
+ */
+static void test_gcoap__server_block1_resp_szx(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t pdu;
+    /* final block may be shorter than the block size */
+    gcoap_block_t block = { .num = 1, .szx = GCOAP_BLOCK_SZX_MAX + 1,
+                            .more = 0 };
+    char path[] = "/log";
+
+    gcoap_req_init(&pdu, &buf[0], sizeof(buf), COAP_METHOD_PUT, &path[0]);
+    memset(pdu.payload, 'x', 16);
+    ssize_t len = gcoap_finish_block(&pdu, 16, COAP_FORMAT_TEXT,
+                                     COAP_OPT_BLOCK1, &block);
+    coap_parse(&pdu, &buf[0], len);
+
+    len = gcoap_block1_response(&pdu, &buf[0], sizeof(buf), COAP_CODE_CHANGED,
+                                _block1_reader, NULL);
+
+    TEST_ASSERT_EQUAL_INT(1 << (GCOAP_BLOCK_SZX_MAX + 5), _block1_offset);
+    TEST_ASSERT_EQUAL_INT(16, _block1_len);
+    TEST_ASSERT_EQUAL_INT(2, coap_get_code_class(&pdu));
+    TEST_ASSERT_EQUAL_INT(4, coap_get_code_detail(&pdu));
+
+    coap_parse(&pdu, &buf[0], len);
+    pdu.payload = &buf[len];
+    TEST_ASSERT_EQUAL_INT(1, gcoap_get_block(&pdu, COAP_OPT_BLOCK1, &block));
+    TEST_ASSERT_EQUAL_INT(1, block.num);
+    TEST_ASSERT_EQUAL_INT(GCOAP_BLOCK_SZX_MAX, block.szx);
+    TEST_ASSERT_EQUAL_INT(0, block.more);
+}
+
 /*
  * Test the export of configured resources as CoRE link format string
  */
@@ -287,6 +484,11 @@ Test *tests_gcoap_tests(void)
         new_TestFixture(test_gcoap__server_get_resp),
         new_TestFixture(test_gcoap__server_con_req),
         new_TestFixture(test_gcoap__server_con_resp),
+        new_TestFixture(test_gcoap__server_block2_req),
+        new_TestFixture(test_gcoap__server_block2_resp),
+        new_TestFixture(test_gcoap__client_block1_req),
+        new_TestFixture(test_gcoap__server_block1_resp),
+        new_TestFixture(test_gcoap__server_block1_resp_szx),
         new_TestFixture(test_gcoap__server_get_resource_list)
     };
 
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "kvstore.h"
+#include "mtd_ram.h"
+
+#include "tests-kvstore.h"
+
+/* geometry of the RAM-based mtd the store is tested on */
+#define SECTOR_COUNT    (4U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+#define INDEX_SIZE      (16U)
+
+static uint8_t _memory[SECTOR_SIZE * SECTOR_COUNT];
+static unsigned _erases[SECTOR_COUNT];
+static mtd_ram_t _ram = MTD_RAM_INIT(_memory, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                     PAGE_SIZE);
+
+static uint8_t _page_buf[PAGE_SIZE];
+static kvstore_slot_t _index[INDEX_SIZE];
+static kvstore_t _kv;
+
+static int _mount(void)
+{
+    memset(&_kv, 0, sizeof(_kv));
+    _kv.mtd = &_ram.base;
+    _kv.page_buf = _page_buf;
+    _kv.index = _index;
+    _kv.index_size = INDEX_SIZE;
+    return kvstore_mount(&_kv);
+}
+
+static void _check(const char *key, const char *val)
+{
+    char buf[64];
+    int res = kvstore_get(&_kv, key, buf, sizeof(buf));
+
+    TEST_ASSERT_EQUAL_INT(strlen(val), res);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(val, buf, res));
+}
+
+static void setup(void)
+{
+    memset(_memory, 0xff, sizeof(_memory));
+    _mount();
+    _ram.sector_erases = _erases;
+    mtd_ram_reset(&_ram);
+}
+
+static void teardown(void)
+{
+}
+
+static void test_kvstore_put_get(void)
+{
+    char buf[8];
+
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", "beta", 4));
+    /* nothing was programmed but the sector header */
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "empty", NULL, 0));
+    _check("a", "alpha");
+    _check("b", "beta");
+    _check("empty", "");
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, kvstore_get(&_kv, "a", buf, 4));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "c", buf, sizeof(buf)));
+}
+
+static void test_kvstore_put__overwrite(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "omega", 5));
+    _check("a", "omega");
+    TEST_ASSERT_EQUAL_INT(2, _kv.stats.puts);
+    /* storing the same value again does not append anything */
+    uint32_t offset = _kv.offset;
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "omega", 5));
+    TEST_ASSERT_EQUAL_INT(offset, _kv.offset);
+    TEST_ASSERT_EQUAL_INT(1, _kv.stats.puts_unchanged);
+    TEST_ASSERT_EQUAL_INT(1, _kv.index_used);
+}
+
+static void test_kvstore_put__invalid(void)
+{
+    static uint8_t big[SECTOR_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(-EINVAL, kvstore_put(&_kv, "", "x", 1));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, kvstore_put(&_kv,
+                          "123456789012345678901234567890123", "x", 1));
+    TEST_ASSERT_EQUAL_INT(-EMSGSIZE, kvstore_put(&_kv, "big", big,
+                                                 sizeof(big)));
+}
+
+static void test_kvstore_put__ENOMEM(void)
+{
+    char key[4], buf[1];
+
+    /* one slot is kept free */
+    for (unsigned i = 0; i < INDEX_SIZE - 1; i++) {
+        sprintf(key, "k%u", i);
+        TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, key, "", 0));
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOMEM, kvstore_put(&_kv, "new", "", 0));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "k3"));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "new", "", 0));
+    for (unsigned i = 0; i < INDEX_SIZE - 1; i++) {
+        sprintf(key, "k%u", i);
+        TEST_ASSERT_EQUAL_INT((i == 3) ? -ENOENT : 0,
+                              kvstore_get(&_kv, key, buf, sizeof(buf)));
+    }
+}
+
+static void test_kvstore_delete(void)
+{
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_delete(&_kv, "a"));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", "beta", 4));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "a"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_delete(&_kv, "a"));
+    _check("b", "beta");
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", NULL, 0));
+    _check("b", "beta");
+}
+
+static void test_kvstore_delete__error(void)
+{
+    static char val[100];
+
+    memset(val, 'v', sizeof(val));
+    /* fill the sector, so the tombstone needs a new one */
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", val, sizeof(val)));
+    _ram.write_error = -EIO;
+    TEST_ASSERT_EQUAL_INT(-EIO, kvstore_delete(&_kv, "a"));
+    _ram.write_error = 0;
+    /* the key was not deleted */
+    TEST_ASSERT_EQUAL_INT(sizeof(val), kvstore_get(&_kv, "a", val,
+                                                   sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(2, _kv.index_used);
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "a"));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(sizeof(val), kvstore_get(&_kv, "b", val,
+                                                   sizeof(val)));
+}
+
+static void test_kvstore_mount__rebuild(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", "beta", 4));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "omega", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    /* not committed, lost on remount */
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "c", "gamma", 5));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT(!_kv.index_valid);
+    _check("a", "omega");
+    TEST_ASSERT(_kv.index_valid);
+    _check("b", "beta");
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "c", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(2, _kv.index_used);
+    /* appending continues where the log ended */
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "c", "gamma", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    _check("a", "omega");
+    _check("c", "gamma");
+}
+
+static void test_kvstore_mount__damaged(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", "beta", 4));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    /* cut the value of "b": sector header, entry "a", header and key of "b" */
+    _memory[16 + 20 + 12 + 1] = 0;
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    _check("a", "alpha");
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "b", NULL, 0));
+}
+
+static void test_kvstore_mount__torn(void)
+{
+    static char val[100];
+
+    memset(val, 'a', sizeof(val));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", val, sizeof(val)));
+    memset(val, 'b', sizeof(val));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", val, sizeof(val)));
+    /* the head moves on to the next sector */
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT(_kv.head != 0);
+    /* cut the value of the second entry of "a" in the first sector: sector
+     * header, first entry, header and key */
+    _memory[16 + 116 + 12 + 1 + 50] = 0;
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    memset(val, 0, sizeof(val));
+    TEST_ASSERT_EQUAL_INT(sizeof(val), kvstore_get(&_kv, "a", val,
+                                                   sizeof(val)));
+    TEST_ASSERT_EQUAL_INT('a', val[0]);
+    TEST_ASSERT_EQUAL_INT('a', val[sizeof(val) - 1]);
+}
+
+static void test_kvstore_gc(void)
+{
+    char key[4], val[24];
+
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "gone", "x", 1));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "gone"));
+    for (unsigned round = 0; round < 100; round++) {
+        for (unsigned i = 0; i < 4; i++) {
+            sprintf(key, "k%u", i);
+            sprintf(val, "value %u of %u", round, i);
+            TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, key, val, strlen(val)));
+        }
+        if (round == 50) {
+            TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "const", "c", 1));
+        }
+    }
+    TEST_ASSERT(_kv.stats.gc_runs > 0);
+    TEST_ASSERT(_kv.stats.gc_bytes_copied > 0);
+    /* sectors are erased evenly */
+    for (unsigned i = 1; i < SECTOR_COUNT; i++) {
+        TEST_ASSERT(_erases[i] + 1 >= _erases[0]);
+        TEST_ASSERT(_erases[i] <= _erases[0] + 1);
+    }
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    for (unsigned i = 0; i < 4; i++) {
+        sprintf(key, "k%u", i);
+        sprintf(val, "value 99 of %u", i);
+        _check(key, val);
+    }
+    _check("const", "c");
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "gone", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(5, _kv.index_used);
+}
+
+static void test_kvstore_gc__ENOSPC(void)
+{
+    static char val[100];
+    char key[4];
+    unsigned n;
+    int res = 0;
+
+    memset(val, 'v', sizeof(val));
+    /* two entries fit into a sector, one sector is kept free */
+    for (n = 0; n < 10; n++) {
+        sprintf(key, "k%u", n);
+        if ((res = kvstore_put(&_kv, key, val, sizeof(val))) < 0) {
+            break;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, res);
+    TEST_ASSERT_EQUAL_INT(6, n);
+    /* deleting makes room again */
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "k0"));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_delete(&_kv, "k1"));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "k6", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    for (unsigned i = 0; i <= 6; i++) {
+        sprintf(key, "k%u", i);
+        TEST_ASSERT_EQUAL_INT((i < 2) ? -ENOENT : (int)sizeof(val),
+                              kvstore_get(&_kv, key, val, sizeof(val)));
+    }
+}
+
+static void test_kvstore_mount__interrupted_gc(void)
+{
+    static char val[100];
+    uint32_t hdr[4] = { 0x53564b52, 0, 1, 0xffffffff };
+
+    memset(val, 'v', sizeof(val));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "c", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "d", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "e", "e", 1));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(3, _kv.used);
+    /* power failure after the last free sector was opened for collecting */
+    hdr[1] = _kv.seq + 1;
+    memcpy(&_memory[3 * SECTOR_SIZE], hdr, sizeof(hdr));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(3, _kv.used);
+    TEST_ASSERT_EQUAL_INT(2, _kv.head);
+    _check("e", "e");
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "f", val, sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(sizeof(val), kvstore_get(&_kv, "a", val,
+                                                   sizeof(val)));
+    TEST_ASSERT_EQUAL_INT(sizeof(val), kvstore_get(&_kv, "f", val,
+                                                   sizeof(val)));
+}
+
+static void test_kvstore_format(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "a", "alpha", 5));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_commit(&_kv));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_format(&_kv));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, _mount());
+    TEST_ASSERT_EQUAL_INT(-ENOENT, kvstore_get(&_kv, "a", NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, kvstore_put(&_kv, "b", "beta", 4));
+    _check("b", "beta");
+}
+
+Test *tests_kvstore_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_kvstore_put_get),
+        new_TestFixture(test_kvstore_put__overwrite),
+        new_TestFixture(test_kvstore_put__invalid),
+        new_TestFixture(test_kvstore_put__ENOMEM),
+        new_TestFixture(test_kvstore_delete),
+        new_TestFixture(test_kvstore_delete__error),
+        new_TestFixture(test_kvstore_mount__rebuild),
+        new_TestFixture(test_kvstore_mount__damaged),
+        new_TestFixture(test_kvstore_mount__torn),
+        new_TestFixture(test_kvstore_gc),
+        new_TestFixture(test_kvstore_gc__ENOSPC),
+        new_TestFixture(test_kvstore_mount__interrupted_gc),
+        new_TestFixture(test_kvstore_format),
+    };
+
+    EMB_UNIT_TESTCALLER(kvstore_tests, setup, teardown, fixtures);
+
+    return (Test *)&kvstore_tests;
+}
+
+void tests_kvstore(void)
+{
+    TESTS_RUN(tests_kvstore_tests());
+}
+/** @} */
@@ -0,0 +1,652 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "cbor.h"
+#include "kernel_defines.h"
+#include "marshal.h"
+#include "ubjson.h"
+#include "xtimer.h"
+
+#include "tests-marshal.h"
+
+#define BENCH_LOOPS     (200U)
+#define BENCH_RECORDS   (16U)
+
+/* all kinds of fields */
+#define RECORD_FIELDS(FIELD)                \
+    FIELD(TEXT,   name,  "name", 12)        \
+    FIELD(INT32,  time,  "t",    0)         \
+    FIELD(UINT32, count, "c",    0)         \
+    FIELD(FLOAT,  value, "v",    0)         \
+    FIELD(BOOL,   valid, "ok",   0)
+
+/* a typical sensor reading, encodes like the generic APIs */
+#define SAMPLE_FIELDS(FIELD)                \
+    FIELD(TEXT,   unit,  "u",    8)         \
+    FIELD(INT32,  time,  "t",    0)         \
+    FIELD(INT32,  raw,   "r",    0)         \
+    FIELD(FLOAT,  value, "v",    0)
+
+MARSHAL_STRUCT(record_t, RECORD_FIELDS);
+MARSHAL_CBOR_DECLARE(record, record_t);
+MARSHAL_UBJSON_DECLARE(record, record_t);
+MARSHAL_CBOR(record, record_t, RECORD_FIELDS)
+MARSHAL_UBJSON(record, record_t, RECORD_FIELDS)
+
+MARSHAL_STRUCT(sample_t, SAMPLE_FIELDS);
+MARSHAL_CBOR_DECLARE(sample, sample_t);
+MARSHAL_UBJSON_DECLARE(sample, sample_t);
+MARSHAL_CBOR(sample, sample_t, SAMPLE_FIELDS)
+MARSHAL_UBJSON(sample, sample_t, SAMPLE_FIELDS)
+
+static const record_t _record = {
+    .name = "node-17", .time = -100000, .count = 4000000000U,
+    .value = 21.5f, .valid = true,
+};
+
+static uint8_t _buf[1024];
+static uint8_t _ref[1024];
+
+typedef struct {
+    ubjson_cookie_t cookie;
+    uint8_t *buf;
+    size_t pos;
+    size_t len;
+} _ubjson_buf_t;
+
+static ssize_t _ubjson_write(ubjson_cookie_t *restrict cookie, const void *buf,
+                             size_t len)
+{
+    _ubjson_buf_t *b = container_of(cookie, _ubjson_buf_t, cookie);
+
+    memcpy(&b->buf[b->pos], buf, len);
+    b->pos += len;
+    return len;
+}
+
+static ssize_t _ubjson_read(ubjson_cookie_t *restrict cookie, void *buf,
+                            size_t len)
+{
+    _ubjson_buf_t *b = container_of(cookie, _ubjson_buf_t, cookie);
+
+    if (len > b->len - b->pos) {
+        len = b->len - b->pos;
+    }
+    memcpy(buf, &b->buf[b->pos], len);
+    b->pos += len;
+    return len;
+}
+
+static void _sample(sample_t *s, unsigned i)
+{
+    strcpy(s->unit, (i & 1) ? "hPa" : "degC");
+    s->time = 1000000 + (int32_t)i * 1000;
+    s->raw = (i & 1) ? -(int32_t)(i * 300) : (int32_t)i;
+    s->value = i * 0.25f;
+}
+
+/* encodes a sample with the generic CBOR API */
+static void _sample_cbor(cbor_stream_t *stream, const sample_t *s)
+{
+    cbor_serialize_map(stream, 4);
+    cbor_serialize_unicode_string(stream, "u");
+    cbor_serialize_unicode_string(stream, s->unit);
+    cbor_serialize_unicode_string(stream, "t");
+    cbor_serialize_int(stream, s->time);
+    cbor_serialize_unicode_string(stream, "r");
+    cbor_serialize_int(stream, s->raw);
+    cbor_serialize_unicode_string(stream, "v");
+    cbor_serialize_float(stream, s->value);
+}
+
+/* decodes a sample with the generic CBOR API */
+static size_t _sample_cbor_decode(const cbor_stream_t *stream, size_t offset,
+                                  sample_t *s)
+{
+    size_t pairs;
+    int val;
+
+    offset += cbor_deserialize_map(stream, offset, &pairs);
+    while (pairs--) {
+        char key[4];
+
+        offset += cbor_deserialize_unicode_string(stream, offset, key,
+                                                  sizeof(key));
+        switch (key[0]) {
+            case 'u':
+                offset += cbor_deserialize_unicode_string(stream, offset,
+                                                          s->unit,
+                                                          sizeof(s->unit));
+                break;
+            case 't':
+                offset += cbor_deserialize_int(stream, offset, &val);
+                s->time = val;
+                break;
+            case 'r':
+                offset += cbor_deserialize_int(stream, offset, &val);
+                s->raw = val;
+                break;
+            default:
+                offset += cbor_deserialize_float(stream, offset, &s->value);
+                break;
+        }
+    }
+    return offset;
+}
+
+/* encodes a sample with the generic UBJSON API */
+static void _sample_ubjson(ubjson_cookie_t *cookie, const sample_t *s)
+{
+    ubjson_open_object(cookie);
+    ubjson_write_key(cookie, "u", 1);
+    ubjson_write_string(cookie, s->unit, strlen(s->unit));
+    ubjson_write_key(cookie, "t", 1);
+    ubjson_write_i32(cookie, s->time);
+    ubjson_write_key(cookie, "r", 1);
+    ubjson_write_i32(cookie, s->raw);
+    ubjson_write_key(cookie, "v", 1);
+    ubjson_write_float(cookie, s->value);
+    ubjson_close_object(cookie);
+}
+
+typedef struct {
+    _ubjson_buf_t b;
+    sample_t *samples;
+    unsigned count;
+} _ubjson_sample_reader_t;
+
+/* decodes an array of samples with the generic UBJSON API */
+static ubjson_read_callback_result_t _sample_ubjson_cb(
+    ubjson_cookie_t *restrict cookie, ubjson_type_t type1, ssize_t content1,
+    ubjson_type_t type2, ssize_t content2)
+{
+    _ubjson_sample_reader_t *r = container_of(cookie, _ubjson_sample_reader_t,
+                                              b.cookie);
+    sample_t *s = &r->samples[r->count];
+    char key[4];
+
+    switch (type1) {
+        case UBJSON_ENTER_ARRAY:
+            return ubjson_read_array(cookie);
+        case UBJSON_INDEX:
+            if ((ubjson_peek_value(cookie, &type2, &content2) != UBJSON_OKAY) ||
+                (type2 != UBJSON_ENTER_OBJECT)) {
+                return UBJSON_ABORTED;
+            }
+            return ubjson_read_object(cookie);
+        case UBJSON_KEY:
+            break;
+        default:
+            return UBJSON_ABORTED;
+    }
+    if ((content1 >= (ssize_t)sizeof(key)) ||
+        (ubjson_get_string(cookie, content1, key) != content1) ||
+        (ubjson_peek_value(cookie, &type2, &content2) != UBJSON_OKAY)) {
+        return UBJSON_ABORTED;
+    }
+    switch (key[0]) {
+        case 'u':
+            if ((type2 != UBJSON_TYPE_STRING) ||
+                (content2 >= (ssize_t)sizeof(s->unit))) {
+                return UBJSON_ABORTED;
+            }
+            ubjson_get_string(cookie, content2, s->unit);
+            s->unit[content2] = '\0';
+            break;
+        case 't':
+            ubjson_get_i32(cookie, content2, &s->time);
+            break;
+        case 'r':
+            ubjson_get_i32(cookie, content2, &s->raw);
+            break;
+        default:
+            ubjson_get_float(cookie, content2, &s->value);
+            /* the last key of a sample */
+            r->count++;
+            break;
+    }
+    return UBJSON_OKAY;
+}
+
+static void _assert_record(const record_t *expected, const record_t *actual)
+{
+    TEST_ASSERT_EQUAL_STRING(&expected->name[0], &actual->name[0]);
+    TEST_ASSERT_EQUAL_INT(expected->time, actual->time);
+    TEST_ASSERT(expected->count == actual->count);
+    TEST_ASSERT(expected->value == actual->value);
+    TEST_ASSERT(expected->valid == actual->valid);
+}
+
+static void _assert_sample(const sample_t *expected, const sample_t *actual)
+{
+    TEST_ASSERT_EQUAL_STRING(&expected->unit[0], &actual->unit[0]);
+    TEST_ASSERT_EQUAL_INT(expected->time, actual->time);
+    TEST_ASSERT_EQUAL_INT(expected->raw, actual->raw);
+    TEST_ASSERT(expected->value == actual->value);
+}
+
+static void test_marshal_max(void)
+{
+    TEST_ASSERT_EQUAL_INT(5, MARSHAL_FIELD_COUNT(RECORD_FIELDS));
+    /* 1 + (5 + 14) + (2 + 5) + (2 + 5) + (2 + 5) + (3 + 1) */
+    TEST_ASSERT_EQUAL_INT(45, MARSHAL_CBOR_MAX(RECORD_FIELDS));
+    /* 2 + (6 + 17) + (3 + 5) + (3 + 9) + (3 + 5) + (4 + 1) */
+    TEST_ASSERT_EQUAL_INT(58, MARSHAL_UBJSON_MAX(RECORD_FIELDS));
+}
+
+static void test_marshal_cbor_roundtrip(void)
+{
+    record_t rec;
+    int len;
+
+    len = record_cbor_encode(&_record, _buf, sizeof(_buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT((size_t)len <= MARSHAL_CBOR_MAX(RECORD_FIELDS));
+    TEST_ASSERT_EQUAL_INT(len, record_cbor_decode(&rec, _buf, len));
+    _assert_record(&_record, &rec);
+
+    /* a buffer smaller than the worst case */
+    TEST_ASSERT_EQUAL_INT(len, record_cbor_encode(&_record, _ref, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buf, _ref, len));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, record_cbor_encode(&_record, _ref,
+                                                       len - 1));
+}
+
+static void test_marshal_ubjson_roundtrip(void)
+{
+    record_t rec;
+    int len;
+
+    len = record_ubjson_encode(&_record, _buf, sizeof(_buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT((size_t)len <= MARSHAL_UBJSON_MAX(RECORD_FIELDS));
+    TEST_ASSERT_EQUAL_INT(len, record_ubjson_decode(&rec, _buf, len));
+    _assert_record(&_record, &rec);
+
+    TEST_ASSERT_EQUAL_INT(len, record_ubjson_encode(&_record, _ref, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buf, _ref, len));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, record_ubjson_encode(&_record, _ref,
+                                                         len - 1));
+}
+
+static void test_marshal_cbor_same_as_generic(void)
+{
+    static const int32_t ints[] = {
+        0, 23, 24, 255, 256, 65535, 65536, INT32_MAX, -1, -24, -25, -256,
+        -257, -65536, -65537, INT32_MIN,
+    };
+    cbor_stream_t stream;
+    sample_t s, out;
+
+    for (unsigned i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        _sample(&s, i);
+        s.raw = ints[i];
+        cbor_init(&stream, _ref, sizeof(_ref));
+        _sample_cbor(&stream, &s);
+        TEST_ASSERT_EQUAL_INT(stream.pos,
+                              sample_cbor_encode(&s, _buf, sizeof(_buf)));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(_ref, _buf, stream.pos));
+        TEST_ASSERT_EQUAL_INT(stream.pos,
+                              sample_cbor_decode(&out, _ref, stream.pos));
+        _assert_sample(&s, &out);
+    }
+}
+
+static void test_marshal_ubjson_same_as_generic(void)
+{
+    /* the generic writer uses int16 up to UINT16_MAX, leave that range out */
+    static const int32_t ints[] = {
+        0, 127, 128, 255, 256, INT16_MAX, 65536, INT32_MAX, -1, -128, -129,
+        INT16_MIN, INT16_MIN - 1, INT32_MIN,
+    };
+    _ubjson_buf_t b = { .buf = _ref };
+    sample_t s, out;
+
+    for (unsigned i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        _sample(&s, i);
+        s.raw = ints[i];
+        b.pos = 0;
+        ubjson_write_init(&b.cookie, _ubjson_write);
+        _sample_ubjson(&b.cookie, &s);
+        TEST_ASSERT_EQUAL_INT(b.pos,
+                              sample_ubjson_encode(&s, _buf, sizeof(_buf)));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(_ref, _buf, b.pos));
+        TEST_ASSERT_EQUAL_INT(b.pos, sample_ubjson_decode(&out, _ref, b.pos));
+        _assert_sample(&s, &out);
+    }
+}
+
+static void test_marshal_cbor_array(void)
+{
+    sample_t in[BENCH_RECORDS], out[BENCH_RECORDS];
+    size_t n = BENCH_RECORDS;
+    int len;
+
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _sample(&in[i], i);
+    }
+    len = sample_cbor_encode_array(in, BENCH_RECORDS, _buf, sizeof(_buf));
+    TEST_ASSERT(len > 0);
+    /* the exact size takes the checked path and gives the same result */
+    TEST_ASSERT_EQUAL_INT(len, sample_cbor_encode_array(in, BENCH_RECORDS,
+                                                        _ref, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buf, _ref, len));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, sample_cbor_encode_array(in,
+                                                             BENCH_RECORDS,
+                                                             _ref, len - 1));
+
+    TEST_ASSERT_EQUAL_INT(len, sample_cbor_decode_array(out, &n, _buf, len));
+    TEST_ASSERT_EQUAL_INT(BENCH_RECORDS, n);
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _assert_sample(&in[i], &out[i]);
+    }
+    n = BENCH_RECORDS - 1;
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, sample_cbor_decode_array(out, &n, _buf,
+                                                             len));
+}
+
+static void test_marshal_ubjson_array(void)
+{
+    sample_t in[BENCH_RECORDS], out[BENCH_RECORDS];
+    size_t n = BENCH_RECORDS;
+    int len;
+
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _sample(&in[i], i);
+    }
+    len = sample_ubjson_encode_array(in, BENCH_RECORDS, _buf, sizeof(_buf));
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT_EQUAL_INT(len, sample_ubjson_encode_array(in, BENCH_RECORDS,
+                                                          _ref, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buf, _ref, len));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, sample_ubjson_encode_array(in,
+                                                               BENCH_RECORDS,
+                                                               _ref, len - 1));
+
+    TEST_ASSERT_EQUAL_INT(len, sample_ubjson_decode_array(out, &n, _buf, len));
+    TEST_ASSERT_EQUAL_INT(BENCH_RECORDS, n);
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _assert_sample(&in[i], &out[i]);
+    }
+    n = BENCH_RECORDS - 1;
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, sample_ubjson_decode_array(out, &n, _buf,
+                                                               len));
+}
+
+static void test_marshal_cbor_unknown_keys(void)
+{
+    cbor_stream_t stream;
+    record_t rec;
+
+    /* reordered, with unknown keys and without "c" */
+    cbor_init(&stream, _buf, sizeof(_buf));
+    cbor_serialize_map(&stream, 6);
+    cbor_serialize_unicode_string(&stream, "ok");
+    cbor_serialize_bool(&stream, true);
+    cbor_serialize_unicode_string(&stream, "extra");
+    cbor_serialize_array(&stream, 2);
+    cbor_serialize_int(&stream, 1);
+    cbor_serialize_unicode_string(&stream, "nested");
+    cbor_serialize_int(&stream, 7);
+    cbor_serialize_map(&stream, 1);
+    cbor_serialize_int(&stream, 1);
+    cbor_serialize_byte_string(&stream, "xyz");
+    cbor_serialize_unicode_string(&stream, "v");
+    cbor_serialize_float(&stream, 21.5f);
+    cbor_serialize_unicode_string(&stream, "t");
+    cbor_serialize_int(&stream, -100000);
+    cbor_serialize_unicode_string(&stream, "name");
+    cbor_serialize_unicode_string(&stream, "node-17");
+
+    TEST_ASSERT_EQUAL_INT(stream.pos, record_cbor_decode(&rec, _buf,
+                                                         stream.pos));
+    TEST_ASSERT_EQUAL_STRING("node-17", &rec.name[0]);
+    TEST_ASSERT_EQUAL_INT(-100000, rec.time);
+    TEST_ASSERT_EQUAL_INT(0, rec.count);
+    TEST_ASSERT(rec.value == 21.5f);
+    TEST_ASSERT(rec.valid);
+}
+
+static void test_marshal_cbor_half_float(void)
+{
+    /* {"v": 21.5}, {"v": -2^-24}, with half precision values */
+    static const uint8_t normal[] = {
+        MARSHAL_CBOR_MAP | 1, MARSHAL_CBOR_TEXT | 1, 'v', 0xf9, 0x4d, 0x60,
+    };
+    static const uint8_t subnormal[] = {
+        MARSHAL_CBOR_MAP | 1, MARSHAL_CBOR_TEXT | 1, 'v', 0xf9, 0x80, 0x01,
+    };
+    record_t rec;
+
+    TEST_ASSERT_EQUAL_INT(sizeof(normal), record_cbor_decode(&rec, normal,
+                                                             sizeof(normal)));
+    TEST_ASSERT(rec.value == 21.5f);
+    TEST_ASSERT_EQUAL_INT(sizeof(subnormal),
+                          record_cbor_decode(&rec, subnormal,
+                                             sizeof(subnormal)));
+    TEST_ASSERT(rec.value == -1.0f / 16777216.0f);
+}
+
+static void test_marshal_ubjson_unknown_keys(void)
+{
+    static const uint8_t data[] = {
+        '{',
+        'i', 2, 'o', 'k', 'T',
+        'N',
+        'i', 5, 'e', 'x', 't', 'r', 'a', 'S', 'i', 3, 'a', 'b', 'c',
+        'i', 1, 'x', 'Z',
+        'i', 1, 'y', 'D', 0x40, 0x35, 0x80, 0, 0, 0, 0, 0,
+        'U', 1, 'v', 'D', 0x40, 0x35, 0x80, 0, 0, 0, 0, 0,
+        'i', 1, 't', 'L', 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x79, 0x60,
+        'i', 1, 'c', 'l', 0, 1, 0, 0,
+        'N', 'N',
+        '}',
+    };
+    record_t rec;
+
+    TEST_ASSERT_EQUAL_INT(sizeof(data), record_ubjson_decode(&rec, data,
+                                                             sizeof(data)));
+    TEST_ASSERT_EQUAL_STRING("", &rec.name[0]);
+    TEST_ASSERT_EQUAL_INT(-100000, rec.time);
+    TEST_ASSERT_EQUAL_INT(65536, rec.count);
+    TEST_ASSERT(rec.value == 21.5f);
+    TEST_ASSERT(rec.valid);
+}
+
+static void test_marshal_errors(void)
+{
+    record_t rec = _record;
+    int len;
+
+    /* every truncation is detected */
+    len = record_cbor_encode(&_record, _buf, sizeof(_buf));
+    for (int i = 0; i < len; i++) {
+        TEST_ASSERT(record_cbor_decode(&rec, _buf, i) < 0);
+    }
+    len = record_ubjson_encode(&_record, _buf, sizeof(_buf));
+    for (int i = 0; i < len; i++) {
+        TEST_ASSERT(record_ubjson_decode(&rec, _buf, i) < 0);
+    }
+
+    /* wrong types */
+    len = record_cbor_encode(&_record, _buf, sizeof(_buf));
+    _buf[0] = MARSHAL_CBOR_ARRAY | 5;
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, record_cbor_decode(&rec, _buf, len));
+    len = record_ubjson_encode(&_record, _buf, sizeof(_buf));
+    _buf[0] = '[';
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, record_ubjson_decode(&rec, _buf, len));
+
+    /* text too long for the member, numbers out of range */
+    static const uint8_t cbor_name[] = {
+        MARSHAL_CBOR_MAP | 1, MARSHAL_CBOR_TEXT | 4, 'n', 'a', 'm', 'e',
+        MARSHAL_CBOR_TEXT | 12, '0', '1', '2', '3', '4', '5', '6', '7', '8',
+        '9', 'a', 'b',
+    };
+    static const uint8_t cbor_time[] = {
+        MARSHAL_CBOR_MAP | 1, MARSHAL_CBOR_TEXT | 1, 't',
+        MARSHAL_CBOR_UINT | 26, 0x80, 0, 0, 0,
+    };
+    static const uint8_t ubjson_name[] = {
+        '{', 'i', 4, 'n', 'a', 'm', 'e', 'S', 'i', 12, '0', '1', '2', '3',
+        '4', '5', '6', '7', '8', '9', 'a', 'b', '}',
+    };
+    static const uint8_t ubjson_count[] = {
+        '{', 'i', 1, 'c', 'i', 0xff, '}',
+    };
+    TEST_ASSERT_EQUAL_INT(-EMSGSIZE, record_cbor_decode(&rec, cbor_name,
+                                                        sizeof(cbor_name)));
+    TEST_ASSERT_EQUAL_INT(-ERANGE, record_cbor_decode(&rec, cbor_time,
+                                                      sizeof(cbor_time)));
+    TEST_ASSERT_EQUAL_INT(-EMSGSIZE, record_ubjson_decode(&rec, ubjson_name,
+                                                          sizeof(ubjson_name)));
+    TEST_ASSERT_EQUAL_INT(-ERANGE, record_ubjson_decode(&rec, ubjson_count,
+                                                        sizeof(ubjson_count)));
+}
+
+static void test_marshal__bench(void)
+{
+    sample_t in[BENCH_RECORDS], out[BENCH_RECORDS];
+    uint32_t start, enc_generic, enc_marshal, dec_generic, dec_marshal;
+    cbor_stream_t stream;
+    size_t n;
+    int len = 0;
+
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _sample(&in[i], i);
+    }
+
+    cbor_init(&stream, _ref, sizeof(_ref));
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        cbor_clear(&stream);
+        cbor_serialize_array(&stream, BENCH_RECORDS);
+        for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+            _sample_cbor(&stream, &in[i]);
+        }
+    }
+    enc_generic = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        len = sample_cbor_encode_array(in, BENCH_RECORDS, _buf, sizeof(_buf));
+    }
+    enc_marshal = xtimer_now_usec() - start;
+    TEST_ASSERT_EQUAL_INT(stream.pos, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_ref, _buf, len));
+
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        size_t count, offset = cbor_deserialize_array(&stream, 0, &count);
+        for (unsigned i = 0; i < count; i++) {
+            offset = _sample_cbor_decode(&stream, offset, &out[i]);
+        }
+    }
+    dec_generic = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        n = BENCH_RECORDS;
+        sample_cbor_decode_array(out, &n, _buf, len);
+    }
+    dec_marshal = xtimer_now_usec() - start;
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _assert_sample(&in[i], &out[i]);
+    }
+
+    printf("\nmarshal: %u x %u records, cbor: encode generic %" PRIu32 " us, "
+           "marshal %" PRIu32 " us; decode generic %" PRIu32 " us, "
+           "marshal %" PRIu32 " us\n", BENCH_LOOPS, BENCH_RECORDS,
+           enc_generic, enc_marshal, dec_generic, dec_marshal);
+
+    _ubjson_sample_reader_t r = { .b.buf = _ref, .samples = out };
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        r.b.pos = 0;
+        ubjson_write_init(&r.b.cookie, _ubjson_write);
+        ubjson_open_array(&r.b.cookie);
+        for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+            _sample_ubjson(&r.b.cookie, &in[i]);
+        }
+        ubjson_close_array(&r.b.cookie);
+    }
+    enc_generic = xtimer_now_usec() - start;
+
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        len = sample_ubjson_encode_array(in, BENCH_RECORDS, _buf,
+                                         sizeof(_buf));
+    }
+    enc_marshal = xtimer_now_usec() - start;
+    TEST_ASSERT_EQUAL_INT(r.b.pos, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_ref, _buf, len));
+
+    r.b.len = len;
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        r.b.pos = 0;
+        r.count = 0;
+        ubjson_read(&r.b.cookie, _ubjson_read, _sample_ubjson_cb);
+    }
+    dec_generic = xtimer_now_usec() - start;
+    TEST_ASSERT_EQUAL_INT(BENCH_RECORDS, r.count);
+
+    start = xtimer_now_usec();
+    for (unsigned l = 0; l < BENCH_LOOPS; l++) {
+        n = BENCH_RECORDS;
+        sample_ubjson_decode_array(out, &n, _buf, len);
+    }
+    dec_marshal = xtimer_now_usec() - start;
+    for (unsigned i = 0; i < BENCH_RECORDS; i++) {
+        _assert_sample(&in[i], &out[i]);
+    }
+
+    printf("marshal: %u x %u records, ubjson: encode generic %" PRIu32 " us, "
+           "marshal %" PRIu32 " us; decode generic %" PRIu32 " us, "
+           "marshal %" PRIu32 " us\n", BENCH_LOOPS, BENCH_RECORDS,
+           enc_generic, enc_marshal, dec_generic, dec_marshal);
+}
+
+Test *tests_marshal_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_marshal_max),
+        new_TestFixture(test_marshal_cbor_roundtrip),
+        new_TestFixture(test_marshal_ubjson_roundtrip),
+        new_TestFixture(test_marshal_cbor_same_as_generic),
+        new_TestFixture(test_marshal_ubjson_same_as_generic),
+        new_TestFixture(test_marshal_cbor_array),
+        new_TestFixture(test_marshal_ubjson_array),
+        new_TestFixture(test_marshal_cbor_unknown_keys),
+        new_TestFixture(test_marshal_cbor_half_float),
+        new_TestFixture(test_marshal_ubjson_unknown_keys),
+        new_TestFixture(test_marshal_errors),
+        new_TestFixture(test_marshal__bench),
+    };
+
+    EMB_UNIT_TESTCALLER(marshal_tests, NULL, NULL, fixtures);
+
+    return (Test *)&marshal_tests;
+}
+
+void tests_marshal(void)
+{
+    TESTS_RUN(tests_marshal_tests());
+}
+/** @} */
@@ -239,6 +239,30 @@ static void test_mtd_write_read_flash(void)
 }
 #endif
 
+#ifdef MODULE_MTD_NATIVE
+static void test_mtd_native_erase_count(void)
+{
+    mtd_native_dev_t *native = (mtd_native_dev_t *)dev;
+    uint32_t sector_size = dev->pages_per_sector * dev->page_size;
+
+    TEST_ASSERT_NOT_NULL(native->erase_count);
+    uint32_t count0 = native->erase_count[0];
+    uint32_t count1 = native->erase_count[1];
+    uint32_t count2 = native->erase_count[2];
+
+    int ret = mtd_erase(dev, sector_size, sector_size);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+    TEST_ASSERT_EQUAL_INT(count0, native->erase_count[0]);
+    TEST_ASSERT_EQUAL_INT(count1 + 1, native->erase_count[1]);
+    TEST_ASSERT_EQUAL_INT(count2, native->erase_count[2]);
+
+    /* failed erase is not counted */
+    ret = mtd_erase(dev, sector_size, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, ret);
+    TEST_ASSERT_EQUAL_INT(count1 + 1, native->erase_count[1]);
+}
+#endif
+
 #if MODULE_VFS
 static void test_mtd_vfs(void)
 {
@@ -278,6 +302,9 @@ Test *tests_mtd_tests(void)
 #ifdef MTD_0
         new_TestFixture(test_mtd_write_read_flash),
 #endif
+#ifdef MODULE_MTD_NATIVE
+        new_TestFixture(test_mtd_native_erase_count),
+#endif
 #if MODULE_VFS
         new_TestFixture(test_mtd_vfs),
 #endif
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <string.h>
+#include <errno.h>
+
+#include "embUnit.h"
+
+#include "mtd_cache.h"
+#include "mtd_ram.h"
+
+#include "tests-mtd_cache.h"
+
+/* geometry of the RAM-based mtd backing the cache */
+#define SECTOR_COUNT    (4U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (32U)
+#define LINE_PAGES      (2U)
+#define LINE_SIZE       (LINE_PAGES * PAGE_SIZE)
+#define LINES_NUMOF     (2U)
+
+static uint8_t _memory[PAGE_PER_SECTOR * PAGE_SIZE * SECTOR_COUNT];
+static mtd_ram_t _ram = MTD_RAM_INIT(_memory, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                     PAGE_SIZE);
+
+static uint8_t _cache_buf[LINES_NUMOF * LINE_SIZE];
+static mtd_cache_t _cache;
+static mtd_dev_t *dev = &_cache.base;
+
+static void setup(void)
+{
+    for (unsigned i = 0; i < sizeof(_memory); i++) {
+        _memory[i] = (uint8_t)i;
+    }
+    memset(&_cache, 0, sizeof(_cache));
+    _cache.base.driver = &mtd_cache_driver;
+    _cache.mtd = &_ram.base;
+    _cache.buf = _cache_buf;
+    _cache.buf_size = sizeof(_cache_buf);
+    _cache.line_pages = LINE_PAGES;
+    _cache.nor_flash = true;
+    mtd_init(dev);
+    mtd_ram_reset(&_ram);
+}
+
+static void teardown(void)
+{
+}
+
+static void test_mtd_cache_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(SECTOR_COUNT, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(PAGE_PER_SECTOR, dev->pages_per_sector);
+    TEST_ASSERT_EQUAL_INT(PAGE_SIZE, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(LINES_NUMOF, _cache.lines_numof);
+    TEST_ASSERT_EQUAL_INT(LINE_SIZE, _cache.line_size);
+}
+
+static void test_mtd_cache_init__ENOMEM(void)
+{
+    _cache.buf_size = LINE_SIZE - 1;
+    TEST_ASSERT_EQUAL_INT(-ENOMEM, mtd_init(dev));
+}
+
+static void test_mtd_cache_read__hit(void)
+{
+    uint8_t buf[8];
+
+    TEST_ASSERT_EQUAL_INT(4, mtd_read(dev, buf, 2, 4));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, &_memory[2], 4));
+    /* rest of the line was read ahead */
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_read(dev, buf, LINE_SIZE - 8,
+                                                sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, &_memory[LINE_SIZE - 8], sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _ram.reads);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.read_misses);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.read_hits);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.bus_reads);
+}
+
+static void test_mtd_cache_read__span_lines(void)
+{
+    uint8_t buf[16];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_read(dev, buf, LINE_SIZE - 8,
+                                                sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, &_memory[LINE_SIZE - 8], sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(2, _ram.reads);
+}
+
+static void test_mtd_cache_read__bypass(void)
+{
+    uint8_t buf[4 * LINE_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_read(dev, buf, 0, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, _memory, sizeof(buf)));
+    /* all lines in one transaction and none of them was cached */
+    TEST_ASSERT_EQUAL_INT(1, _ram.reads);
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, buf, 0, 1));
+    TEST_ASSERT_EQUAL_INT(2, _ram.reads);
+}
+
+static void test_mtd_cache_read__EOVERFLOW(void)
+{
+    uint8_t buf[4];
+
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_read(dev, buf, sizeof(_memory) - 2,
+                                               sizeof(buf)));
+}
+
+static void test_mtd_cache_write__coalesce(void)
+{
+    uint8_t data[4] = { 0xaa, 0x55, 0x0f, 0xf0 };
+
+    memset(_memory, 0xff, sizeof(_memory));
+    for (unsigned i = 0; i < PAGE_SIZE; i += sizeof(data)) {
+        TEST_ASSERT_EQUAL_INT(sizeof(data),
+                              mtd_write(dev, data, i, sizeof(data)));
+    }
+    /* nothing written to the device yet */
+    TEST_ASSERT_EQUAL_INT(0, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(0xff, _memory[0]);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.write_misses);
+    TEST_ASSERT_EQUAL_INT(PAGE_SIZE / sizeof(data) - 1,
+                          _cache.stats.write_hits);
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_sync(&_cache));
+    /* one program operation for the whole page */
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    for (unsigned i = 0; i < PAGE_SIZE; i += sizeof(data)) {
+        TEST_ASSERT_EQUAL_INT(0, memcmp(&_memory[i], data, sizeof(data)));
+    }
+    TEST_ASSERT_EQUAL_INT(0xff, _memory[PAGE_SIZE]);
+    /* line is clean now */
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_sync(&_cache));
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+}
+
+static void test_mtd_cache_write__nor_flash(void)
+{
+    uint8_t byte = 0x0f;
+
+    memset(_memory, 0xff, sizeof(_memory));
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &byte, 5, 1));
+    byte = 0xf5;
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &byte, 5, 1));
+    byte = 0xff;
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, 5, 1));
+    TEST_ASSERT_EQUAL_INT(0x05, byte);
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_sync(&_cache));
+    TEST_ASSERT_EQUAL_INT(0x05, _memory[5]);
+}
+
+static void test_mtd_cache_write__evict(void)
+{
+    uint8_t byte = 0;
+
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &byte, 1, 1));
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, LINE_SIZE, 1));
+    TEST_ASSERT_EQUAL_INT(0, _ram.writes);
+    /* the least recently used line (0) is replaced */
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, 2 * LINE_SIZE, 1));
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(0, _memory[1]);
+    /* line 1 is still cached */
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, LINE_SIZE + 1, 1));
+    TEST_ASSERT_EQUAL_INT(3, _ram.reads);
+}
+
+static void test_mtd_cache_erase(void)
+{
+    uint8_t buf[4] = { 0 };
+
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_write(dev, buf, 8, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase(dev, 0, PAGE_PER_SECTOR * PAGE_SIZE));
+    /* pending data was erased anyway */
+    TEST_ASSERT_EQUAL_INT(0, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(1, _ram.erases);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.bus_erases);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_read(dev, buf, 8, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0xff, buf[0]);
+    TEST_ASSERT_EQUAL_INT(0xff, buf[3]);
+    /* erased line is still cached */
+    TEST_ASSERT_EQUAL_INT(1, _ram.reads);
+}
+
+static void test_mtd_cache_power(void)
+{
+    uint8_t byte = 0;
+
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &byte, 3, 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_power(dev, MTD_POWER_DOWN));
+    TEST_ASSERT_EQUAL_INT(1, _ram.writes);
+    TEST_ASSERT_EQUAL_INT(0, _memory[3]);
+}
+
+static void test_mtd_cache_invalidate(void)
+{
+    uint8_t byte;
+
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, 0, 1));
+    _memory[0] = 0x42;
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_invalidate(&_cache));
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &byte, 0, 1));
+    TEST_ASSERT_EQUAL_INT(0x42, byte);
+    TEST_ASSERT_EQUAL_INT(2, _ram.reads);
+}
+
+Test *tests_mtd_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_cache_init),
+        new_TestFixture(test_mtd_cache_init__ENOMEM),
+        new_TestFixture(test_mtd_cache_read__hit),
+        new_TestFixture(test_mtd_cache_read__span_lines),
+        new_TestFixture(test_mtd_cache_read__bypass),
+        new_TestFixture(test_mtd_cache_read__EOVERFLOW),
+        new_TestFixture(test_mtd_cache_write__coalesce),
+        new_TestFixture(test_mtd_cache_write__nor_flash),
+        new_TestFixture(test_mtd_cache_write__evict),
+        new_TestFixture(test_mtd_cache_erase),
+        new_TestFixture(test_mtd_cache_power),
+        new_TestFixture(test_mtd_cache_invalidate),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_cache_tests, setup, teardown, fixtures);
+
+    return (Test *)&mtd_cache_tests;
+}
+
+void tests_mtd_cache(void)
+{
+    TESTS_RUN(tests_mtd_cache_tests());
+}
+/** @} */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "objpool.h"
+
+#define OBJ_NUMOF   (4U)
+
+typedef struct {
+    uint8_t data[3];
+} small_t;
+
+typedef struct {
+    uint32_t a;
+    uint16_t b;
+} obj_t;
+
+static OBJPOOL_SLOT(obj_t) _slots[OBJ_NUMOF];
+static objpool_t _pool;
+
+static void set_up(void)
+{
+    memset(_slots, 0, sizeof(_slots));
+}
+
+static void _alloc_all(objpool_t *pool, void **objs)
+{
+    for (unsigned i = 0; i < OBJ_NUMOF; i++) {
+        objs[i] = objpool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+        for (unsigned j = 0; j < i; j++) {
+            TEST_ASSERT(objs[i] != objs[j]);
+        }
+    }
+    TEST_ASSERT_NULL(objpool_alloc(pool));
+}
+
+static void _test_mode(unsigned mode)
+{
+    void *objs[OBJ_NUMOF];
+
+    objpool_init(&_pool, "test", _slots, sizeof(_slots[0]), OBJ_NUMOF, mode);
+    _alloc_all(&_pool, objs);
+    TEST_ASSERT_EQUAL_INT(OBJ_NUMOF, objpool_used(&_pool));
+
+    /* objects are returned in last in, first out order */
+    objpool_free(&_pool, objs[1]);
+    objpool_free(&_pool, objs[3]);
+    TEST_ASSERT_EQUAL_INT(OBJ_NUMOF - 2, objpool_used(&_pool));
+    TEST_ASSERT(objpool_alloc(&_pool) == objs[3]);
+    TEST_ASSERT(objpool_alloc(&_pool) == objs[1]);
+    TEST_ASSERT_NULL(objpool_alloc(&_pool));
+
+    for (unsigned i = 0; i < OBJ_NUMOF; i++) {
+        objpool_free(&_pool, objs[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(0, objpool_used(&_pool));
+    _alloc_all(&_pool, objs);
+
+    TEST_ASSERT_EQUAL_INT(OBJ_NUMOF, _pool.max_used);
+    TEST_ASSERT_EQUAL_INT(3, _pool.failed);
+}
+
+static void test_objpool_unlocked(void)
+{
+    _test_mode(OBJPOOL_UNLOCKED);
+}
+
+static void test_objpool_irqsafe(void)
+{
+    _test_mode(OBJPOOL_IRQSAFE);
+}
+
+static void test_objpool_lockfree(void)
+{
+    _test_mode(OBJPOOL_LOCKFREE);
+}
+
+static void test_objpool_define(void)
+{
+    OBJPOOL_DEFINE(_small, small_t, 3, OBJPOOL_UNLOCKED);
+    small_t *a, *b;
+
+    TEST_ASSERT(sizeof(_small_slots[0]) >= sizeof(uintptr_t));
+    TEST_ASSERT_EQUAL_INT(3, _small.num);
+
+    a = objpool_alloc(&_small);
+    TEST_ASSERT_NOT_NULL(a);
+    memset(a, 0xff, sizeof(*a));
+    b = objpool_alloc(&_small);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT((uint8_t *)b - (uint8_t *)a == sizeof(_small_slots[0]));
+    objpool_free(&_small, a);
+    objpool_free(&_small, NULL);
+    TEST_ASSERT_EQUAL_INT(1, objpool_used(&_small));
+    TEST_ASSERT(objpool_alloc(&_small) == a);
+    TEST_ASSERT_EQUAL_INT(2, _small.max_used);
+}
+
+static void test_objpool_data_kept(void)
+{
+    obj_t *objs[OBJ_NUMOF];
+
+    objpool_init(&_pool, "test", _slots, sizeof(_slots[0]), OBJ_NUMOF,
+                 OBJPOOL_UNLOCKED);
+    for (unsigned i = 0; i < OBJ_NUMOF; i++) {
+        objs[i] = objpool_alloc(&_pool);
+        objs[i]->a = 0x11111111 * i;
+        objs[i]->b = i;
+    }
+    /* releasing an object must not touch the others */
+    objpool_free(&_pool, objs[2]);
+    objpool_free(&_pool, objs[0]);
+    TEST_ASSERT_EQUAL_INT(0x11111111, objs[1]->a);
+    TEST_ASSERT_EQUAL_INT(1, objs[1]->b);
+    TEST_ASSERT_EQUAL_INT(0x33333333, objs[3]->a);
+    TEST_ASSERT_EQUAL_INT(3, objs[3]->b);
+}
+
+Test *tests_objpool_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_objpool_unlocked),
+        new_TestFixture(test_objpool_irqsafe),
+        new_TestFixture(test_objpool_lockfree),
+        new_TestFixture(test_objpool_define),
+        new_TestFixture(test_objpool_data_kept),
+    };
+
+    EMB_UNIT_TESTCALLER(objpool_tests, set_up, NULL, fixtures);
+
+    return (Test *)&objpool_tests;
+}
+
+void tests_objpool(void)
+{
+    TESTS_RUN(tests_objpool_tests());
+}
@@ -25,6 +25,9 @@
 
 #include "vfs.h"
 #include "fs/constfs.h"
+#ifdef MODULE_GNRC_PKTBUF
+#include "net/gnrc/vfs.h"
+#endif
 
 #include "tests-vfs.h"
 
@@ -171,6 +174,103 @@ static void test_vfs_constfs_read_lseek(void)
     TEST_ASSERT_EQUAL_INT(0, res);
 }
 
+static void test_vfs_constfs_readv(void)
+{
+    int res;
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/data.bin", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    uint8_t head[4];
+    uint8_t tail[64];
+    struct iovec iov[] = {
+        { .iov_base = head, .iov_len = sizeof(head) },
+        { .iov_base = NULL, .iov_len = 0 },
+        { .iov_base = tail, .iov_len = sizeof(tail) },
+    };
+    ssize_t nbytes = vfs_readv(fd, iov, sizeof(iov) / sizeof(iov[0]));
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data), nbytes);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(head, bin_data, sizeof(head)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(tail, &bin_data[sizeof(head)],
+                                    sizeof(bin_data) - sizeof(head)));
+    nbytes = vfs_readv(fd, iov, sizeof(iov) / sizeof(iov[0]));
+    TEST_ASSERT_EQUAL_INT(0, nbytes);
+
+    nbytes = vfs_writev(fd, iov, sizeof(iov) / sizeof(iov[0]));
+    TEST_ASSERT_EQUAL_INT(-EBADF, nbytes);
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
+static void test_vfs_constfs_map(void)
+{
+    int res;
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/test.txt", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    const void *ptr;
+    ssize_t nbytes = vfs_map(fd, &ptr, 5);
+    TEST_ASSERT_EQUAL_INT(5, nbytes);
+    /* no copy is made */
+    TEST_ASSERT(ptr == (const void *)str_data);
+    nbytes = vfs_map(fd, &ptr, sizeof(str_data));
+    TEST_ASSERT_EQUAL_INT(sizeof(str_data) - 5, nbytes);
+    TEST_ASSERT(ptr == (const void *)&str_data[5]);
+    nbytes = vfs_map(fd, &ptr, sizeof(str_data));
+    TEST_ASSERT_EQUAL_INT(0, nbytes);
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
+#ifdef MODULE_GNRC_PKTBUF
+static void test_vfs_constfs_sendfile(void)
+{
+    int res;
+    gnrc_pktbuf_init();
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/data.bin", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    gnrc_pktsnip_t *pkt;
+    ssize_t nbytes = vfs_sendfile(fd, 16, GNRC_NETTYPE_UNDEF, &pkt);
+    TEST_ASSERT_EQUAL_INT(16, nbytes);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(16, pkt->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(pkt->data, bin_data, 16));
+    gnrc_pktbuf_release(pkt);
+    nbytes = vfs_sendfile(fd, 64, GNRC_NETTYPE_UNDEF, &pkt);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data) - 16, nbytes);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data) - 16, pkt->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(pkt->data, &bin_data[16], pkt->size));
+    gnrc_pktbuf_release(pkt);
+    nbytes = vfs_sendfile(fd, 64, GNRC_NETTYPE_UNDEF, &pkt);
+    TEST_ASSERT_EQUAL_INT(0, nbytes);
+    TEST_ASSERT_NULL(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+#endif
+
 #if MODULE_NEWLIB || defined(BOARD_NATIVE)
 static void test_vfs_constfs__posix(void)
 {
@@ -210,6 +310,11 @@ Test *tests_vfs_mount_constfs_tests(void)
         new_TestFixture(test_vfs_umount__invalid_mount),
         new_TestFixture(test_vfs_constfs_open),
         new_TestFixture(test_vfs_constfs_read_lseek),
+        new_TestFixture(test_vfs_constfs_readv),
+        new_TestFixture(test_vfs_constfs_map),
+#ifdef MODULE_GNRC_PKTBUF
+        new_TestFixture(test_vfs_constfs_sendfile),
+#endif
 #if MODULE_NEWLIB || defined(BOARD_NATIVE)
         new_TestFixture(test_vfs_constfs__posix),
 #endif
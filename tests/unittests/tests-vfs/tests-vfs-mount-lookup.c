@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief       Unittests for path resolution on nested mounts and fd
+ *              allocation
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "embUnit/embUnit.h"
+
+#include "vfs.h"
+#include "fs/constfs.h"
+#include "xtimer.h"
+
+#include "tests-vfs.h"
+
+#define BENCH_LOOPS     (1000U)
+
+static const uint8_t outer_data[] = "outer";
+static const uint8_t inner_data[] = "inner file";
+
+static const constfs_file_t _outer_files[] = {
+    {
+        .path = "/outer.txt",
+        .data = outer_data,
+        .size = sizeof(outer_data),
+    },
+};
+
+static const constfs_file_t _inner_files[] = {
+    {
+        .path = "/inner.txt",
+        .data = inner_data,
+        .size = sizeof(inner_data),
+    },
+};
+
+static const constfs_t _outer_fs = {
+    .files = _outer_files,
+    .nfiles = sizeof(_outer_files) / sizeof(_outer_files[0]),
+};
+
+static const constfs_t _inner_fs = {
+    .files = _inner_files,
+    .nfiles = sizeof(_inner_files) / sizeof(_inner_files[0]),
+};
+
+static vfs_mount_t _outer_mount = {
+    .mount_point = "/lookup",
+    .fs = &constfs_file_system,
+    .private_data = (void *)&_outer_fs,
+};
+
+static vfs_mount_t _inner_mount = {
+    .mount_point = "/lookup/inner",
+    .fs = &constfs_file_system,
+    .private_data = (void *)&_inner_fs,
+};
+
+static vfs_mount_t _shadow_mount = {
+    .mount_point = "/lookup",
+    .fs = &constfs_file_system,
+    .private_data = (void *)&_inner_fs,
+};
+
+static vfs_mount_t _other_mounts[] = {
+    {
+        .mount_point = "/lookupx",
+        .fs = &constfs_file_system,
+        .private_data = (void *)&_inner_fs,
+    },
+    {
+        .mount_point = "/dev2",
+        .fs = &constfs_file_system,
+        .private_data = (void *)&_inner_fs,
+    },
+    {
+        .mount_point = "/mnt/a",
+        .fs = &constfs_file_system,
+        .private_data = (void *)&_inner_fs,
+    },
+    {
+        .mount_point = "/mnt/b",
+        .fs = &constfs_file_system,
+        .private_data = (void *)&_inner_fs,
+    },
+};
+
+static void _mount_others(void)
+{
+    for (unsigned i = 0; i < sizeof(_other_mounts) / sizeof(_other_mounts[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_other_mounts[i]));
+    }
+}
+
+static void _umount_others(void)
+{
+    for (unsigned i = 0; i < sizeof(_other_mounts) / sizeof(_other_mounts[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_other_mounts[i]));
+    }
+}
+
+/* returns the size of the file or a negative errno */
+static int _size(const char *path)
+{
+    struct stat st;
+    int res = vfs_stat(path, &st);
+
+    return (res < 0) ? res : (int)st.st_size;
+}
+
+static void test_vfs_mount_lookup__nested(void)
+{
+    _mount_others();
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_inner_mount));
+
+    TEST_ASSERT_EQUAL_INT(sizeof(outer_data), _size("/lookup/outer.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/lookup/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/lookup/inner/outer.txt"));
+    /* "/lookupx" is not below "/lookup" */
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookupx/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/mnt/b/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/mnt/inner.txt"));
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_inner_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+    _umount_others();
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/lookup/outer.txt"));
+}
+
+static void test_vfs_mount_lookup__mount_order(void)
+{
+    /* mount the inner file system first, it has to be moved below the outer
+     * one and back to the top level on umount */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_inner_mount));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(sizeof(outer_data), _size("/lookup/outer.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/lookup/outer.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_inner_mount));
+}
+
+static void test_vfs_mount_lookup__shadow(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_inner_mount));
+    /* the last mount on the same mount point wins */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_shadow_mount));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _size("/lookup/outer.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_shadow_mount));
+    TEST_ASSERT_EQUAL_INT(sizeof(outer_data), _size("/lookup/outer.txt"));
+    TEST_ASSERT_EQUAL_INT(sizeof(inner_data), _size("/lookup/inner/inner.txt"));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_inner_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+}
+
+static void test_vfs_mount_lookup__umount_busy(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_inner_mount));
+    int fd = vfs_open("/lookup/inner/inner.txt", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(-EBUSY, vfs_umount(&_inner_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_inner_mount));
+}
+
+static void test_vfs_mount_lookup__fd_reuse(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    int fd1 = vfs_open("/lookup/outer.txt", O_RDONLY, 0);
+    int fd2 = vfs_open("/lookup/outer.txt", O_RDONLY, 0);
+    TEST_ASSERT(fd1 >= 0);
+    TEST_ASSERT(fd2 > fd1);
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd1));
+    /* lowest free number is allocated */
+    TEST_ASSERT_EQUAL_INT(fd1, vfs_open("/lookup/outer.txt", O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd1));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd2));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+}
+
+static void test_vfs_mount_lookup__fd_exhaust(void)
+{
+    int fds[VFS_MAX_OPEN_FILES];
+    unsigned n = 0;
+    int fd;
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    while ((fd = vfs_open("/lookup/outer.txt", O_RDONLY, 0)) >= 0) {
+        TEST_ASSERT(n < VFS_MAX_OPEN_FILES);
+        fds[n++] = fd;
+    }
+    TEST_ASSERT_EQUAL_INT(-ENFILE, fd);
+    TEST_ASSERT(n > 0);
+    while (n > 0) {
+        TEST_ASSERT_EQUAL_INT(0, vfs_close(fds[--n]));
+    }
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+}
+
+static void test_vfs_mount_lookup__bench(void)
+{
+    struct stat st;
+    uint32_t start, open_close, stat;
+
+    _mount_others();
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_outer_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_inner_mount));
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        int fd = vfs_open("/lookup/inner/inner.txt", O_RDONLY, 0);
+        TEST_ASSERT(fd >= 0);
+        vfs_close(fd);
+    }
+    open_close = xtimer_now_usec() - start;
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, vfs_stat("/lookup/outer.txt", &st));
+    }
+    stat = xtimer_now_usec() - start;
+    printf("\nvfs: %u x open/close: %" PRIu32 " us, %u x stat: %" PRIu32 " us\n",
+           BENCH_LOOPS, open_close, BENCH_LOOPS, stat);
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_inner_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_outer_mount));
+    _umount_others();
+}
+
+Test *tests_vfs_mount_lookup_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_vfs_mount_lookup__nested),
+        new_TestFixture(test_vfs_mount_lookup__mount_order),
+        new_TestFixture(test_vfs_mount_lookup__shadow),
+        new_TestFixture(test_vfs_mount_lookup__umount_busy),
+        new_TestFixture(test_vfs_mount_lookup__fd_reuse),
+        new_TestFixture(test_vfs_mount_lookup__fd_exhaust),
+        new_TestFixture(test_vfs_mount_lookup__bench),
+    };
+
+    EMB_UNIT_TESTCALLER(vfs_mount_lookup_tests, NULL, NULL, fixtures);
+
+    return (Test *)&vfs_mount_lookup_tests;
+}
+
+/** @} */
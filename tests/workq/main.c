@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Work queue test and scaling benchmark
+ *
+ * Hashes a number of blocks repeatedly with SHA-256, once one block after
+ * the other and once as one job per block in a work queue batch, checks that
+ * both give the same digests and prints both times.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hashes/sha256.h"
+#include "workq.h"
+#include "xtimer.h"
+
+#ifdef CPU_NATIVE
+#define BLOCK_NUMOF         (64U)
+#define BLOCK_ROUNDS        (256U)
+#else
+#define BLOCK_NUMOF         (8U)
+#define BLOCK_ROUNDS        (4U)
+#endif
+#define BLOCK_SIZE          (1024U)
+
+typedef struct {
+    uint8_t data[BLOCK_SIZE];
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+} _block_t;
+
+static _block_t _blocks[BLOCK_NUMOF];
+static uint8_t _digests[BLOCK_NUMOF][SHA256_DIGEST_LENGTH];
+static workq_job_t _jobs[BLOCK_NUMOF];
+
+/* runs on a host thread on native, so it must not call into RIOT */
+static void _hash(void *arg)
+{
+    _block_t *block = arg;
+    sha256_context_t ctx;
+
+    memset(block->digest, 0, sizeof(block->digest));
+    for (unsigned i = 0; i < BLOCK_ROUNDS; i++) {
+        sha256_init(&ctx);
+        sha256_update(&ctx, block->digest, sizeof(block->digest));
+        sha256_update(&ctx, block->data, sizeof(block->data));
+        sha256_final(&ctx, block->digest);
+    }
+}
+
+int main(void)
+{
+    uint32_t start, seq_time, workq_time;
+    workq_batch_t batch;
+
+    puts("workq benchmark");
+
+    for (unsigned i = 0; i < BLOCK_NUMOF; i++) {
+        memset(_blocks[i].data, i, sizeof(_blocks[i].data));
+    }
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BLOCK_NUMOF; i++) {
+        _hash(&_blocks[i]);
+    }
+    seq_time = xtimer_now_usec() - start;
+    for (unsigned i = 0; i < BLOCK_NUMOF; i++) {
+        memcpy(_digests[i], _blocks[i].digest, SHA256_DIGEST_LENGTH);
+    }
+
+    start = xtimer_now_usec();
+    workq_batch_init(&batch);
+    for (unsigned i = 0; i < BLOCK_NUMOF; i++) {
+        workq_submit(&batch, &_jobs[i], _hash, &_blocks[i]);
+    }
+    workq_wait(&batch);
+    workq_time = xtimer_now_usec() - start;
+
+    int failed = 0;
+    for (unsigned i = 0; i < BLOCK_NUMOF; i++) {
+        failed |= memcmp(_digests[i], _blocks[i].digest, SHA256_DIGEST_LENGTH);
+    }
+
+    printf("%u blocks, %u workers: sequential %" PRIu32 " us, "
+           "work queue %" PRIu32 " us, speedup %" PRIu32 ".%02" PRIu32 "\n",
+           BLOCK_NUMOF, WORKQ_WORKERS, seq_time, workq_time,
+           seq_time / workq_time, (seq_time % workq_time) * 100 / workq_time);
+    puts(failed ? "[FAILED]" : "[SUCCESS]");
+    return 0;
+}